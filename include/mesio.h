@@ -42,6 +42,7 @@ typedef enum {
     MESIO_ENSIGHT,
     MESIO_VTK_LEGACY,
     MESIO_XDMF,
+    MESIO_GMSH,
 } MESIOFormat;
 
 typedef enum {
@@ -79,6 +80,27 @@ typedef enum {
     SIZE
 } MESIOElementType;
 
+typedef struct {
+    MESIOInt  edgecut;              // number of faces shared by elements of different processes
+    MESIOInt  decomposerEdgecut;    // edge cut reported by the parallel decomposer (-1 if not called)
+    MESIOInt  volume;               // number of nodes values sent by all processes
+    MESIOInt  maxVolume;            // number of nodes values sent by the busiest process
+    MESIOInt  minNeighbors;
+    MESIOInt  maxNeighbors;
+    MESIOReal avgNeighbors;
+    MESIOReal elementImbalance;     // max / avg number of elements per process
+    MESIOReal nodeImbalance;        // max / avg number of unique nodes per process
+    MESIOInt  clusters;
+    MESIOInt  disconnectedClusters; // clusters with more than one face connected part
+    MESIOInt  maxClusterParts;
+    MESIOInt  domains;
+    MESIOInt  disconnectedDomains;  // domains with more than one face connected part
+    MESIOInt  maxDomainParts;
+    MESIOReal minInterfaceRatio;    // interface nodes / nodes per process
+    MESIOReal avgInterfaceRatio;
+    MESIOReal maxInterfaceRatio;
+} MESIOPartitionInfo;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -574,6 +596,20 @@ void MESIOBoundaryRegionCounters(
     MESIOInt*       totalSize
 );
 
+/// Returns quality of the mesh partition
+/**
+ * Returns statistics of the elements distribution among processes
+ * and domains (edge cut, communication volume, imbalances, etc.).
+ * All values are global, hence the same on all processes.
+ *
+ * @param mesio mesio handler with the loaded mesh
+ * @param partition partition statistics
+ */
+void MESIOPartition(
+    MESIO               mesio,
+    MESIOPartitionInfo* partition
+);
+
 /*-----------------------------------------------------------------------------
  Destroy an arbitrary internal structure
 ------------------------------------------------------------------------------*/
@@ -87,6 +87,7 @@ void MESIOLoad(
 	case MESIO_ENSIGHT: info::config::input.format = InputConfiguration::FORMAT::ENSIGHT; break;
 	case MESIO_VTK_LEGACY: info::config::input.format = InputConfiguration::FORMAT::VTK_LEGACY; break;
 	case MESIO_XDMF: info::config::input.format = InputConfiguration::FORMAT::XDMF; break;
+	case MESIO_GMSH: info::config::input.format = InputConfiguration::FORMAT::GMSH; break;
 	}
 	info::config::input.path = path;
 	switch (decomposer) {
@@ -349,3 +350,28 @@ void MESIOBoundaryRegionCounters(
 	*offset = info::mesh->boundaryRegions[region]->distribution.code[etype].offset;
 	*totalSize = info::mesh->boundaryRegions[region]->distribution.code[etype].totalSize;
 }
+
+void MESIOPartition(
+	MESIO               mesio,
+	MESIOPartitionInfo* partition)
+{
+	const PartitionInfo &pinfo = info::mesh->partitionInfo;
+	partition->edgecut = pinfo.edgecut;
+	partition->decomposerEdgecut = pinfo.decomposerEdgecut;
+	partition->volume = pinfo.volume;
+	partition->maxVolume = pinfo.maxVolume;
+	partition->minNeighbors = pinfo.minNeighbors;
+	partition->maxNeighbors = pinfo.maxNeighbors;
+	partition->avgNeighbors = pinfo.avgNeighbors;
+	partition->elementImbalance = pinfo.elementImbalance;
+	partition->nodeImbalance = pinfo.nodeImbalance;
+	partition->clusters = pinfo.clusters;
+	partition->disconnectedClusters = pinfo.disconnectedClusters;
+	partition->maxClusterParts = pinfo.maxClusterParts;
+	partition->domains = pinfo.domains;
+	partition->disconnectedDomains = pinfo.disconnectedDomains;
+	partition->maxDomainParts = pinfo.maxDomainParts;
+	partition->minInterfaceRatio = pinfo.minInterfaceRatio;
+	partition->avgInterfaceRatio = pinfo.avgInterfaceRatio;
+	partition->maxInterfaceRatio = pinfo.maxInterfaceRatio;
+}
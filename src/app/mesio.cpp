@@ -10,19 +10,92 @@
 #include "basis/logging/logger.h"
 #include "basis/logging/progresslogger.h"
 #include "basis/logging/timelogger.h"
+#include "basis/logging/tracelogger.h"
 
+#include "basis/io/autotune.h"
+#include "mesh/store/elementstore.h"
+#include "mesh/store/nodestore.h"
 #include "output/output.h"
 
 #include <getopt.h>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace mesio;
 
+// parameters set by configuration files (-c FILE) and by '--parameter=value' arguments
+static std::vector<std::pair<std::string, std::string> > parameters;
+
+// ALL or a list of restrictions 'ranks=0,1:regions=NAME1,NAME2:box=xmin,ymin,zmin,xmax,ymax,zmax'
+static void debug(const char *options)
+{
+	info::config::output.debug = 1;
+	if (strcmp(options, "ALL") == 0) {
+		return;
+	}
+	std::stringstream ss(options);
+	std::string option;
+	while (std::getline(ss, option, ':')) {
+		size_t eq = option.find('=');
+		std::string key = option.substr(0, eq), item;
+		std::stringstream values(eq == std::string::npos ? "" : option.substr(eq + 1));
+		while (std::getline(values, item, ',')) {
+			char *end;
+			if (key == "ranks") {
+				long rank = strtol(item.c_str(), &end, 10);
+				if (item.empty() || *end != '\0' || rank < 0 || rank > INT_MAX) {
+					eslog::globalerror("MESIO: invalid debug rank '%s'.\n", item.c_str());
+				}
+				info::config::output.debug_ranks.push_back(rank);
+			} else if (key == "regions") {
+				info::config::output.debug_regions.push_back(item);
+			} else if (key == "box") {
+				double value = strtod(item.c_str(), &end);
+				if (item.empty() || *end != '\0') {
+					eslog::globalerror("MESIO: invalid debug box value '%s'.\n", item.c_str());
+				}
+				info::config::output.debug_box.push_back(value);
+			} else {
+				eslog::globalerror("MESIO: unknown debug option '%s'.\n", key.c_str());
+			}
+		}
+	}
+	if (info::config::output.debug_box.size() && info::config::output.debug_box.size() != 6) {
+		eslog::globalerror("MESIO: debug box has to be given by 6 values.\n");
+	}
+}
+
 bool set(int &argc, char** &argv)
 {
+	std::vector<std::pair<std::string, std::string> > arguments;
+	int args = 1;
+	for (int i = 1; i < argc; ++i) {
+		if (strncmp(argv[i], "--", 2) == 0) {
+			std::string argument(argv[i] + 2);
+			size_t eq = argument.find('=');
+			if (argument == "autotune") {
+				arguments.push_back(std::make_pair("input.autotune", "1"));
+			} else {
+				arguments.push_back(std::make_pair(argument.substr(0, eq), eq == std::string::npos ? "" : argument.substr(eq + 1)));
+			}
+		} else {
+			argv[args++] = argv[i];
+		}
+	}
+	argc = args;
+
 	int c, set = 0;
-	while ((c = getopt (argc, argv, "p:i:o:s:")) != -1)
+	while ((c = getopt (argc, argv, "p:i:o:s:w:d:c:")) != -1)
 		switch (c) {
+		case 'c':
+			if (!info::config::read(optarg, parameters)) {
+				eslog::globalerror("MESIO: cannot read configuration file '%s'.\n", optarg);
+			}
+			break;
 		case 'p':
 			set |= 1;
 			info::config::input.path = optarg;
@@ -60,6 +133,18 @@ bool set(int &argc, char** &argv)
 				set |= 2;
 				info::config::input.format = InputConfiguration::FORMAT::NEPER;
 			}
+			if (memcmp(optarg, "STL", 3) == 0) {
+				set |= 2;
+				info::config::input.format = InputConfiguration::FORMAT::STL;
+			}
+			if (memcmp(optarg, "GMSH", 4) == 0) {
+				set |= 2;
+				info::config::input.format = InputConfiguration::FORMAT::GMSH;
+			}
+			if (memcmp(optarg, "GENERATOR", 9) == 0) {
+				set |= 2;
+				info::config::input.format = InputConfiguration::FORMAT::GENERATOR;
+			}
 			break;
 		case 'o':
 			if (memcmp(optarg, "VTK_LEGACY", 10) == 0) {
@@ -82,13 +167,35 @@ bool set(int &argc, char** &argv)
 				set |= 4;
 				info::config::output.format = OutputConfiguration::FORMAT::NETGEN;
 			}
+			if (memcmp(optarg, "VTK_LEGACY_BINARY", 17) == 0) {
+				set |= 4;
+				info::config::output.format = OutputConfiguration::FORMAT::VTK_LEGACY_BINARY;
+			}
 			break;
 		case 's':
 			set |= 8;
 			info::config::output.path = optarg;
 			break;
+		case 'w':
+			if (strcmp(optarg, "MPI") == 0) {
+				info::config::output.writer = OutputConfiguration::WRITER::MPI;
+			}
+			if (strcmp(optarg, "MPI_COLLECTIVE") == 0) {
+				info::config::output.writer = OutputConfiguration::WRITER::MPI_COLLECTIVE;
+			}
+			if (strcmp(optarg, "POSIX") == 0) {
+				info::config::output.writer = OutputConfiguration::WRITER::POSIX;
+			}
+			if (strcmp(optarg, "POSIX_DIRECT") == 0) {
+				info::config::output.writer = OutputConfiguration::WRITER::POSIX;
+				info::config::output.direct = true;
+			}
+			break;
+		case 'd':
+			debug(optarg);
+			break;
 		case '?':
-			if (optopt == 'p' || optopt == 'i' || optopt == 'o' || optopt == 's') {
+			if (optopt == 'p' || optopt == 'i' || optopt == 'o' || optopt == 's' || optopt == 'w' || optopt == 'd' || optopt == 'c') {
 				eslog::info(" MESIO: Option -%c requires an argument.\n", optopt);
 			} else {
 				eslog::info(" MESIO: Unknown option character `\\x%x'.\n", optopt);
@@ -98,12 +205,37 @@ bool set(int &argc, char** &argv)
 			break;
 	}
 
+	// arguments have priority over configuration files
+	parameters.insert(parameters.end(), arguments.begin(), arguments.end());
+	for (size_t i = 0; i < parameters.size(); ++i) {
+		if (!info::config::set(parameters[i].first, parameters[i].second)) {
+			eslog::globalerror("MESIO: invalid parameter '%s' or its value '%s'.\n", parameters[i].first.c_str(), parameters[i].second.c_str());
+		}
+		if (parameters[i].first == "input.path")    { set |= 1; }
+		if (parameters[i].first == "input.format")  { set |= 2; }
+		if (parameters[i].first == "output.format") { set |= 4; }
+		if (parameters[i].first == "output.path")   { set |= 8; }
+	}
+
 	if (set != 15) {
 		eslog::info(" MESIO: INVALID CONFIGURATION DETECTED.\n");
 		eslog::info(" MESIO:\n");
 		eslog::info(" MESIO: RUN:\n");
 		eslog::info(" MESIO: mpirun -n #PROCS mesio -i INPUT_FORMAT -p INPUT_PATH -o OUTPUT_FORMAT -s STORE_PATH\n");
 		eslog::info(" MESIO:\n");
+		eslog::info(" MESIO: OPTIONAL ARGUMENTS:\n");
+		eslog::info(" MESIO:   -c CONFIGURATION_FILE    file with 'PARAMETER = VALUE' lines\n");
+		eslog::info(" MESIO:   --PARAMETER=VALUE        set a parameter (see the list below)\n");
+		eslog::info(" MESIO:   --autotune               benchmark and store the best reader setting\n");
+		eslog::info(" MESIO:\n");
+		eslog::info(" MESIO: PARAMETERS [VALUES]:\n");
+		std::vector<std::string> names = info::config::parameters();
+		for (size_t i = 0; i < names.size(); ++i) {
+			std::string value;
+			info::config::get(names[i], value);
+			eslog::info(" MESIO:   %-50s [%s]\n", names[i].c_str(), value.c_str());
+		}
+		eslog::info(" MESIO:\n");
 		eslog::info(" MESIO: FINISHED\n");
 		return false;
 	}
@@ -117,13 +249,22 @@ int main(int argc, char** argv)
 	info::mpi::init(&argc, &argv);
 	MPITools::init();
 
-	eslog::init(new Logger<TimeLogger, ProgressTerminalLogger>);
+	eslog::init(new Logger<TimeLogger, ProgressTerminalLogger, TraceLogger>);
 	eslog::startln("MESIO: STARTED", "MESIO");
 
 	if (set(argc, argv)) {
 //		MPITools::setSubset(info::config::input.third_party_scalability_limit);
-		info::config::output.mode = OutputConfiguration::MODE::SYNC;
 
+		if (info::config::input.autotune) {
+			autotune::run();
+		} else if (autotune::apply()) {
+			for (size_t i = 0; i < parameters.size(); ++i) { // explicitly set parameters have priority
+				info::config::set(parameters[i].first, parameters[i].second);
+			}
+		}
+		if (info::config::input.readers) {
+			MPITools::setSubset(info::config::input.readers);
+		}
 		eslog::printRunInfo(&argc, &argv);
 		Mesh::init();
 		eslog::checkpointln("MESIO: RUN INITIALIZED");
@@ -135,8 +276,12 @@ int main(int argc, char** argv)
 		eslog::checkpointln("MESIO: MESH PREPROCESSED");
 	//	info::mesh->printMeshStatistics();
 	//	info::mesh->printDecompositionStatistics();
+		info::mesh->printPartitionStatistics();
 
 		info::mesh->output->updateMesh();
+		if (info::mesh->nodes->data.size() || info::mesh->elements->data.size()) {
+			info::mesh->output->updateSolution(); // fields loaded from the input
+		}
 		eslog::endln("MESIO: MESH STORED");
 
 		Mesh::finish();
@@ -2,12 +2,78 @@
 #ifndef SRC_BASIS_CONTAINERS_ALLOCATORS_H_
 #define SRC_BASIS_CONTAINERS_ALLOCATORS_H_
 
+#include "esinfo/envinfo.h"
+
 #include <memory>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <omp.h>
 
 namespace mesio {
+namespace memory {
+
+	enum: size_t {
+		hugePageSize = 2 * 1024 * 1024,
+		firstTouchLimit = 1024 * 1024 // smaller allocations are not spread among NUMA nodes
+	};
+
+	inline size_t pageSize()
+	{
+		static size_t size = sysconf(_SC_PAGESIZE);
+		return size;
+	}
+
+	// memory allocated by 'allocate' has to be released by 'release'
+	inline void* allocate(size_t bytes)
+	{
+		void *ptr = NULL;
+		if (info::env::hugepages && bytes >= hugePageSize) {
+			if (posix_memalign(&ptr, hugePageSize, bytes) == 0) {
+#ifdef MADV_HUGEPAGE
+				madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+				return ptr;
+			}
+		}
+		if (posix_memalign(&ptr, 64, bytes ? bytes : 1) != 0) {
+			throw std::bad_alloc();
+		}
+		return ptr;
+	}
+
+	inline void release(void *ptr)
+	{
+		free(ptr);
+	}
+
+	// write to every page of <begin, end) -> the page is placed to the NUMA node of the calling thread
+	inline void touch(char *begin, char *end)
+	{
+		if (begin == end) {
+			return;
+		}
+		volatile char *page = begin;
+		*page = 0;
+		for (page = begin + pageSize() - reinterpret_cast<size_t>(begin) % pageSize(); page < end; page += pageSize()) {
+			*page = 0;
+		}
+	}
+
+	// pages are touched by threads according to the distribution, i.e., in the same way as they are processed by 'omp for'
+	inline void firsttouch(char *data, size_t size, const std::vector<size_t> &distribution)
+	{
+		#pragma omp parallel for
+		for (size_t t = 0; t < distribution.size() - 1; t++) {
+			touch(data + size * distribution[t], data + size * distribution[t + 1]);
+		}
+	}
+}
 
 // allocator that allows to mimic new[] behavior
 // it skipes initialization when vector.resize(size) is called
+// large allocations are first-touched by all threads in order to spread pages among NUMA nodes
 template<typename T, typename A = std::allocator<T> >
 class initless_allocator: public A {
 	typedef std::allocator_traits<A> a_t;
@@ -18,6 +84,19 @@ public:
 
 	using A::A;
 
+	T* allocate(size_t n)
+	{
+		T *ptr = a_t::allocate(static_cast<A&>(*this), n);
+		if (n * sizeof(T) >= memory::firstTouchLimit && !omp_in_parallel()) {
+			std::vector<size_t> distribution(info::env::threads + 1);
+			for (int t = 1; t <= info::env::threads; t++) {
+				distribution[t] = n * t / info::env::threads;
+			}
+			memory::firsttouch(reinterpret_cast<char*>(ptr), sizeof(T), distribution);
+		}
+		return ptr;
+	}
+
 	template<typename U>
 	void construct(U* ptr) noexcept(std::is_nothrow_default_constructible<U>::value) {
 		::new (static_cast<void*>(ptr)) U;
@@ -0,0 +1,126 @@
+
+#include "arena.h"
+#include "allocators.h"
+#include "esinfo/eslog.hpp"
+
+#include <mutex>
+#include <algorithm>
+
+using namespace mesio;
+
+static std::mutex _registration;
+static std::vector<Arena*> _arenas;
+
+Arena& Arena::local()
+{
+	// arenas are never destroyed since they are shared by all stages
+	thread_local Arena *arena = NULL;
+	if (arena == NULL) {
+		std::lock_guard<std::mutex> lock(_registration);
+		_arenas.push_back(arena = new Arena());
+	}
+	return *arena;
+}
+
+Arena::Scope::Scope()
+{
+	std::lock_guard<std::mutex> lock(_registration);
+	for (size_t a = 0; a < _arenas.size(); ++a) {
+		_marks.push_back(Mark{ _arenas[a]->_block, _arenas[a]->_offset, _arenas[a]->_used, _arenas[a]->_peak, _arenas[a]->_live });
+		_arenas[a]->_peak = _arenas[a]->_used;
+	}
+}
+
+Arena::Scope::~Scope()
+{
+	std::lock_guard<std::mutex> lock(_registration);
+	// a buffer can be freed by other thread than the allocating one, hence, only the sum over arenas is checked
+	size_t live = 0;
+	for (size_t a = 0; a < _arenas.size(); ++a) {
+		live += _arenas[a]->_live - (a < _marks.size() ? _marks[a].live : 0);
+	}
+	if (live) {
+		eslog::internalFailure("arena memory allocated within a stage is still in use at its end.\n");
+	}
+	for (size_t a = 0; a < _arenas.size(); ++a) {
+		// arenas of threads that have not allocated before the scope are recycled completely
+		Mark mark = a < _marks.size() ? _marks[a] : Mark{ 0, 0, 0, 0, 0 };
+		_arenas[a]->_live = mark.live;
+		_arenas[a]->_block = mark.block;
+		_arenas[a]->_offset = mark.offset;
+		_arenas[a]->_used = mark.used;
+		_arenas[a]->_peak = std::max(mark.peak, _arenas[a]->_peak);
+	}
+}
+
+void Arena::release()
+{
+	std::lock_guard<std::mutex> lock(_registration);
+	size_t live = 0;
+	for (size_t a = 0; a < _arenas.size(); ++a) {
+		live += _arenas[a]->_live;
+	}
+	if (live) {
+		eslog::internalFailure("cannot release arena memory that is still in use.\n");
+	}
+	for (size_t a = 0; a < _arenas.size(); ++a) {
+		_arenas[a]->_live = 0;
+		for (size_t b = 0; b < _arenas[a]->_blocks.size(); ++b) {
+			memory::release(_arenas[a]->_blocks[b].data);
+		}
+		_arenas[a]->_blocks.clear();
+		_arenas[a]->_block = _arenas[a]->_offset = _arenas[a]->_used = _arenas[a]->_peak = 0;
+	}
+}
+
+size_t Arena::highWaterMark()
+{
+	std::lock_guard<std::mutex> lock(_registration);
+	size_t peak = 0;
+	for (size_t a = 0; a < _arenas.size(); ++a) {
+		peak += _arenas[a]->_peak;
+	}
+	return peak;
+}
+
+size_t Arena::reserved()
+{
+	std::lock_guard<std::mutex> lock(_registration);
+	size_t size = 0;
+	for (size_t a = 0; a < _arenas.size(); ++a) {
+		for (size_t b = 0; b < _arenas[a]->_blocks.size(); ++b) {
+			size += _arenas[a]->_blocks[b].size;
+		}
+	}
+	return size;
+}
+
+void* Arena::allocate(size_t bytes)
+{
+	bytes = (bytes + alignment - 1) / alignment * alignment;
+	while (_block < _blocks.size() && _blocks[_block].size < _offset + bytes) {
+		++_block;
+		_offset = 0;
+	}
+	if (_block == _blocks.size()) {
+		_blocks.push_back(Block{ static_cast<char*>(memory::allocate(std::max((size_t)blockSize, bytes))), std::max((size_t)blockSize, bytes) });
+		_offset = 0;
+	}
+	void *ptr = _blocks[_block].data + _offset;
+	_offset += bytes;
+	_used += bytes;
+	_peak = std::max(_peak, _used);
+	++_live;
+	return ptr;
+}
+
+void Arena::deallocate(void *ptr, size_t bytes)
+{
+	// only the last allocation of the calling thread can be returned (e.g. a temporary buffer)
+	--_live;
+	bytes = (bytes + alignment - 1) / alignment * alignment;
+	if (_block < _blocks.size() && bytes <= _offset && static_cast<char*>(ptr) == _blocks[_block].data + _offset - bytes) {
+		_offset -= bytes;
+		_used -= bytes;
+	}
+}
@@ -0,0 +1,89 @@
+
+#ifndef SRC_BASIS_CONTAINERS_ARENA_H_
+#define SRC_BASIS_CONTAINERS_ARENA_H_
+
+#include <vector>
+#include <cstddef>
+
+namespace mesio {
+
+// Monotonic (bump) allocator for short-lived temporaries (e.g., send/receive buffers).
+// Each thread allocates from its own arena. Memory is not returned by 'deallocate' (except the last allocation),
+// it is recycled when the 'Arena::Scope' of a stage ends. Hence, no data allocated in an arena can outlive its stage.
+class Arena {
+public:
+	// memory allocated by all threads within the scope is recycled by the destructor, older data stay valid
+	// the scope must be created and destroyed outside parallel regions and all its arena buffers must be freed before its end
+	class Scope {
+	public:
+		Scope();
+		~Scope();
+
+	private:
+		struct Mark {
+			size_t block, offset, used, peak, live;
+		};
+
+		std::vector<Mark> _marks;
+	};
+
+	enum: size_t {
+		blockSize = 4 * 1024 * 1024,
+		alignment = 64
+	};
+
+	// arena of the calling thread
+	static Arena& local();
+
+	// the following functions touch arenas of all threads -> call them outside parallel regions only
+	static void release();        // free all blocks (no arena buffer can be in use)
+	static size_t highWaterMark(); // peak of allocated bytes since the innermost scope began (sum over threads)
+	static size_t reserved();      // size of all blocks
+
+	void* allocate(size_t bytes);
+	void deallocate(void *ptr, size_t bytes);
+
+private:
+	struct Block {
+		char *data;
+		size_t size;
+	};
+
+	Arena(): _block(0), _offset(0), _used(0), _peak(0), _live(0) {}
+
+	std::vector<Block> _blocks;
+	size_t _block, _offset;
+	size_t _used, _peak;
+	size_t _live; // the number of allocations not returned by 'deallocate'
+
+};
+
+// STL allocator that uses the arena of the calling thread
+template <typename T>
+class arena_allocator {
+public:
+	typedef T value_type;
+
+	arena_allocator() noexcept {}
+	template <typename U> arena_allocator(const arena_allocator<U>&) noexcept {}
+
+	T* allocate(size_t n)
+	{
+		return static_cast<T*>(Arena::local().allocate(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t n)
+	{
+		Arena::local().deallocate(ptr, n * sizeof(T));
+	}
+
+	template <typename U> bool operator==(const arena_allocator<U>&) const noexcept { return true; }
+	template <typename U> bool operator!=(const arena_allocator<U>&) const noexcept { return false; }
+};
+
+template <typename T>
+using arenavector = std::vector<T, arena_allocator<T> >;
+
+}
+
+#endif /* SRC_BASIS_CONTAINERS_ARENA_H_ */
@@ -7,6 +7,7 @@
 #include "basis/utilities/packing.h"
 
 #include <vector>
+#include <algorithm>
 
 namespace mesio {
 
@@ -16,7 +17,6 @@ class serializededata {
 public:
 	static void balance(size_t esize, std::vector<std::vector<TEData> > &data, const std::vector<size_t> *distribution = NULL)
 	{
-//		profiler::syncstart("balance_fixed");
 		std::vector<size_t> _distribution;
 		if (distribution == NULL) {
 			size_t size = 0;
@@ -24,46 +24,26 @@ public:
 				size += data[t].size();
 			}
 
-			_distribution = tarray<size_t>::distribute(data.size(), size);
+			_distribution = tarray<size_t>::distribute(data.size(), size / esize);
 		} else {
 			_distribution = *distribution;
 		}
 
-//		profiler::syncparam("size", _distribution.back());
-		for (size_t t = 0, tt = 0; t < data.size(); tt = ++t) {
-			while (++tt && data[t].size() < esize * (_distribution[t + 1] - _distribution[t])) {
-				size_t diff = esize * (_distribution[t + 1] - _distribution[t]) - data[t].size();
-				if (diff < data[tt].size()) {
-					data[t].insert(data[t].end(), data[tt].begin(), data[tt].begin() + diff);
-					data[tt].erase(data[tt].begin(), data[tt].begin() + diff);
-				} else {
-					data[t].insert(data[t].end(), data[tt].begin(), data[tt].end());
-					data[tt].clear();
-
-				}
-			}
-			if (data[t].size() > esize * (_distribution[t + 1] - _distribution[t])) {
-				size_t diff = data[t].size() - esize * (_distribution[t + 1] - _distribution[t]);
-				data[t + 1].insert(data[t + 1].begin(), data[t].end() - diff, data[t].end());
-				data[t].erase(data[t].end() - diff, data[t].end());
-			}
+		std::vector<std::vector<TEData> > balanced(data.size());
+		#pragma omp parallel for
+		for (size_t t = 0; t < data.size(); t++) {
+			gather(data, esize * _distribution[t], esize * _distribution[t + 1], balanced[t]);
 		}
-//		profiler::syncend("balance_fixed");
+		data.swap(balanced);
 	}
 
 	static void balance(std::vector<std::vector<TEBoundaries> > &boundaries, std::vector<std::vector<TEData> > &data, const std::vector<size_t> *distribution = NULL)
 	{
-//		profiler::syncstart("balance_various");
 		size_t size = 0;
-		std::vector<size_t> sizes(boundaries.size());
 		for (size_t t = 0; t < boundaries.size(); t++) {
-			sizes[t] = boundaries[t].size();
 			size += boundaries[t].size();
 		}
-		--sizes[0];
-//		profiler::syncparam("size", size);
 		if (size == 0) {
-//			profiler::syncend("balance_various");
 			return;
 		}
 
@@ -74,44 +54,94 @@ public:
 			_distribution = *distribution;
 		}
 
-		for (size_t t = 0, tt = 0; t < boundaries.size(); tt = ++t) {
-			while (++tt && sizes[t] < _distribution[t + 1] - _distribution[t]) {
-				size_t diff = _distribution[t + 1] - _distribution[t] - sizes[t];
-				if (diff < sizes[tt]) {
-					size_t ttt = 0;
-					while (boundaries[tt - ++ttt].size() == 0);
-					size_t ediff = *(boundaries[tt].begin() + diff - 1) - boundaries[tt - ttt].back();
-					data[t].insert(data[t].end(), data[tt].begin(), data[tt].begin() + ediff);
-					data[tt].erase(data[tt].begin(), data[tt].begin() + ediff);
-
-					boundaries[t].insert(boundaries[t].end(), boundaries[tt].begin(), boundaries[tt].begin() + diff);
-					boundaries[tt].erase(boundaries[tt].begin(), boundaries[tt].begin() + diff);
-					sizes[t]  += diff;
-					sizes[tt] -= diff;
-				} else {
-					sizes[t]  += boundaries[tt].size();
-					sizes[tt] -= boundaries[tt].size();
+		// boundaries are global offsets and the first thread contains the leading zero
+		std::vector<std::vector<TEBoundaries> > bbalanced(boundaries.size());
+		std::vector<std::vector<TEData> > dbalanced(data.size());
+		#pragma omp parallel for
+		for (size_t t = 0; t < boundaries.size(); t++) {
+			gather(boundaries, t == 0 ? 0 : _distribution[t] + 1, _distribution[t + 1] + 1, bbalanced[t]);
+		}
+		TEBoundaries base = at(boundaries, 0);
+		#pragma omp parallel for
+		for (size_t t = 0; t < data.size(); t++) {
+			if (bbalanced[t].size()) {
+				gather(data, (t == 0 ? bbalanced[t].front() : at(boundaries, _distribution[t])) - base, bbalanced[t].back() - base, dbalanced[t]);
+			}
+		}
+		boundaries.swap(bbalanced);
+		data.swap(dbalanced);
+	}
 
-					data[t].insert(data[t].end(), data[tt].begin(), data[tt].end());
-					data[tt].clear();
+	// Two-pass (CSR) construction of non-uniform data without intermediate per-thread vectors.
+	// Structures are assigned to threads according to 'distribution'. Both functors are called
+	// for all structures of a thread in ascending order (hence, they can keep a per-thread cursor):
+	//   count(t, s)      returns the number of values of the structure 's'
+	//   fill(t, s, data) stores exactly 'count(t, s)' values to 'data'
+	template <typename TCount, typename TFill>
+	static serializededata<TEBoundaries, TEData>* build(const std::vector<size_t> &distribution, TCount count, TFill fill)
+	{
+		size_t threads = distribution.size() - 1;
+		std::vector<size_t> bdistribution = distribution;
+		for (size_t t = 1; t <= threads; t++) {
+			++bdistribution[t];
+		}
 
-					boundaries[t].insert(boundaries[t].end(), boundaries[tt].begin(), boundaries[tt].end());
-					boundaries[tt].clear();
-				}
+		tarray<TEBoundaries> boundaries(bdistribution, 1, true);
+		std::vector<size_t> ddistribution(threads + 1);
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			TEBoundaries sum = 0;
+			for (size_t s = distribution[t]; s < distribution[t + 1]; ++s) {
+				boundaries[s + 1] = sum += count(t, s);
+			}
+			ddistribution[t + 1] = sum;
+		}
+		boundaries[0] = 0;
+		for (size_t t = 1; t <= threads; t++) {
+			ddistribution[t] += ddistribution[t - 1];
+		}
+
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			for (size_t s = distribution[t]; s < distribution[t + 1]; ++s) {
+				boundaries[s + 1] += ddistribution[t];
 			}
-			if (sizes[t] > _distribution[t + 1] - _distribution[t]) {
-				size_t diff = sizes[t] - (_distribution[t + 1] - _distribution[t]);
-				size_t ediff = boundaries[t].back() - *(boundaries[t].end() - diff - 1);
-				data[t + 1].insert(data[t + 1].begin(), data[t].end() - ediff, data[t].end());
-				data[t].erase(data[t].end() - ediff, data[t].end());
-
-				boundaries[t + 1].insert(boundaries[t + 1].begin(), boundaries[t].end() - diff, boundaries[t].end());
-				boundaries[t].erase(boundaries[t].end() - diff, boundaries[t].end());
-				sizes[t]     -= diff;
-				sizes[t + 1] += diff;
+		}
+
+		tarray<TEData> data(ddistribution, 1, true);
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			for (size_t s = distribution[t]; s < distribution[t + 1]; ++s) {
+				fill(t, s, data.data() + boundaries[s]);
 			}
 		}
-//		profiler::syncend("balance_various");
+
+		return new serializededata<TEBoundaries, TEData>(std::move(boundaries), std::move(data));
+	}
+
+	// Two-pass construction of uniform data with 'edatasize' values per structure.
+	//   count(t)      returns the number of structures produced by the thread 't'
+	//   fill(t, data) stores them to 'data'
+	// The result is balanced to threads regardless of the numbers of produced structures.
+	template <typename TCount, typename TFill>
+	static serializededata<TEBoundaries, TEData>* build(size_t edatasize, size_t threads, TCount count, TFill fill)
+	{
+		std::vector<size_t> offset(threads + 1);
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			offset[t + 1] = count(t);
+		}
+		for (size_t t = 1; t <= threads; t++) {
+			offset[t] += offset[t - 1];
+		}
+
+		tarray<TEData> data(tarray<size_t>::distribute(threads, offset.back()), edatasize, true);
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			fill(t, data.data() + edatasize * offset[t]);
+		}
+
+		return new serializededata<TEBoundaries, TEData>(edatasize, std::move(data));
 	}
 
 private:
@@ -419,6 +449,31 @@ private:
 //		profiler::syncend("permute_non_uniform_data");
 	}
 
+	// access to the 'index'-th value of data divided into per-thread vectors
+	template <typename TType>
+	static const TType& at(const std::vector<std::vector<TType> > &data, size_t index)
+	{
+		size_t t = 0;
+		while (index >= data[t].size()) {
+			index -= data[t++].size();
+		}
+		return data[t][index];
+	}
+
+	// copy values <begin, end) of data divided into per-thread vectors
+	template <typename TType>
+	static void gather(const std::vector<std::vector<TType> > &data, size_t begin, size_t end, std::vector<TType> &result)
+	{
+		result.reserve(end - begin);
+		for (size_t t = 0, offset = 0; t < data.size() && offset < end; offset += data[t++].size()) {
+			if (begin < offset + data[t].size()) {
+				size_t first = begin > offset ? begin - offset : 0;
+				size_t last = std::min(end - offset, data[t].size());
+				result.insert(result.end(), data[t].begin() + first, data[t].begin() + last);
+			}
+		}
+	}
+
 	tarray<TEBoundaries> _eboundaries;
 	tarray<TEData> _edata;
 
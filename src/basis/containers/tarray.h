@@ -5,6 +5,7 @@
 #include <cmath>
 #include <vector>
 #include <cstring>
+#include <type_traits>
 
 #include <omp.h>
 
@@ -14,6 +15,7 @@ namespace mesio {
 /// Threaded array
 template <typename TType>
 class tarray {
+	static_assert(std::is_trivially_destructible<TType>::value, "tarray stores trivially destructible types only");
 
 public:
 	static std::vector<TType> distribute(int threads, TType size, TType minchunk = 0);
@@ -25,6 +27,7 @@ public:
 	tarray(const std::vector<TType> &data, size_t alignment = 0);
 	tarray(const std::vector<size_t> &distribution, const std::vector<TType> &data, size_t alignment = 0);
 	tarray(const std::vector<size_t> &distribution, size_t duplication, TType init = TType{}, size_t alignment = 0);
+	tarray(const std::vector<size_t> &distribution, size_t duplication, bool skipinit, size_t alignment = 0);
 
 	tarray(const tarray<TType> &other);
 	tarray(tarray<TType> &&other);
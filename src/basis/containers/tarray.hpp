@@ -3,7 +3,10 @@
 #define SRC_BASIS_CONTAINERS_TARRAY_HPP_
 
 #include "tarray.h"
+#include "allocators.h"
+
 #include <memory>
+#include <type_traits>
 
 namespace mesio {
 
@@ -194,6 +197,27 @@ tarray<TType>::tarray(const std::vector<size_t> &distribution, size_t duplicatio
 	}
 }
 
+template <typename TType>
+tarray<TType>::tarray(const std::vector<size_t> &distribution, size_t duplication, bool skipinit, size_t alignment)
+: _size(duplication * distribution.back()), _alignment(alignment), _data(NULL), _dataUnaligned(NULL), _distribution(distribution)
+{
+	for (size_t t = 1; t < _distribution.size(); t++) {
+		_distribution[t] *= duplication;
+	}
+
+	if (_size) {
+		this->allocate();
+		if (!skipinit) {
+			#pragma omp parallel for
+			for (size_t t = 0; t < _distribution.size() - 1; t++) {
+				for (size_t i = _distribution[t]; i < _distribution[t + 1]; i++) {
+					_data[i] = TType{};
+				}
+			}
+		}
+	}
+}
+
 template <typename TType>
 size_t tarray<TType>::packedSize() const
 {
@@ -251,17 +275,27 @@ tarray<TType>::~tarray()
 template <typename TType>
 void tarray<TType>::allocate()
 {
-	if(_alignment != 0){
-		size_t sizeInElements = _size + ((_alignment - 1) / sizeof(TType)) +1;
-		size_t sizeInBytes = sizeInElements*sizeof(TType);
-		_dataUnaligned = new TType[sizeInElements];
+	size_t padding = _alignment ? (_alignment - 1) / sizeof(TType) + 1 : 0;
+	_dataUnaligned = static_cast<TType*>(memory::allocate((_size + padding) * sizeof(TType)));
+	_data = _dataUnaligned;
+	if (_alignment) {
+		size_t sizeInBytes = (_size + padding) * sizeof(TType);
 		void* tmp = static_cast<void *>(_dataUnaligned);
-		_data = static_cast<TType *>(std::align(_alignment, _size*sizeof(TType), tmp, sizeInBytes));
+		_data = static_cast<TType *>(std::align(_alignment, _size * sizeof(TType), tmp, sizeInBytes));
 	}
-	else
-	{
-		_dataUnaligned = new TType[_size];
-		_data = _dataUnaligned;
+
+	// pages are first-touched (or elements constructed) by the thread that process them
+	if (std::is_trivially_default_constructible<TType>::value) {
+		if (_size * sizeof(TType) >= memory::firstTouchLimit) {
+			memory::firsttouch(reinterpret_cast<char*>(_data), sizeof(TType), _distribution);
+		}
+	} else {
+		#pragma omp parallel for
+		for (size_t t = 0; t < _distribution.size() - 1; t++) {
+			for (size_t i = _distribution[t]; i < _distribution[t + 1]; i++) {
+				new (_data + i) TType;
+			}
+		}
 	}
 }
 
@@ -269,7 +303,7 @@ template <typename TType>
 void tarray<TType>::deallocate()
 {
 	if (_dataUnaligned) {
-		delete[] _dataUnaligned;
+		memory::release(_dataUnaligned);
 		_dataUnaligned = NULL;
 		_data = NULL;
 	}
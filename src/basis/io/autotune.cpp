@@ -0,0 +1,254 @@
+
+#include "autotune.h"
+#include "loader.h"
+
+#include "basis/utilities/parser.h"
+#include "basis/utilities/sysutils.h"
+#include "wrappers/mpi/communication.h"
+#include "esinfo/config.h"
+#include "esinfo/mpiinfo.h"
+#include "esinfo/eslog.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <climits>
+#include <fstream>
+#include <functional>
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace mesio;
+
+// the sample is read from disjoint parts of the file (if the file is large enough) in order to avoid cached data
+static const size_t maxsample = 64 * 1024 * 1024, minsample = 1024 * 1024;
+static const char* loaders[] = { "MPI", "MPI_COLLECTIVE", "POSIX" };
+
+struct Setting {
+	InputConfiguration::LOADER loader;
+	int readers;
+	size_t stripe;
+	double time;
+};
+
+static std::string database()
+{
+	if (info::config::input.autotune_database.size()) {
+		return info::config::input.autotune_database;
+	}
+	const char *home = getenv("HOME");
+	return std::string(home ? home : ".") + "/.mesio.autotune";
+}
+
+// the input file or the largest file in the input directory (e.g., geometry of EnSight, OpenFOAM directories)
+static std::string sampleFile(size_t &size)
+{
+	struct stat st;
+	std::string path = info::config::input.path;
+	bool isdir = stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+	if (!isdir && stat(path.c_str(), &st) == 0 && (size_t)st.st_size >= minsample) {
+		size = st.st_size;
+		return path;
+	}
+
+	// files of the same name (e.g., 'mesh.case' and 'mesh.geo') are preferred
+	std::string dir = isdir ? path : utils::getFileDirectory(path), base = path.substr(path.find_last_of('/') + 1);
+	std::string file = isdir ? "" : path, stem = isdir ? "" : dir + "/" + base.substr(0, base.find_last_of('.'));
+	size = isdir ? 0 : st.st_size;
+	bool named = false;
+	std::function<void(const std::string&)> search = [&] (const std::string &dir) {
+		DIR *d = opendir(dir.c_str());
+		if (d == NULL) {
+			return;
+		}
+		for (dirent *entry = readdir(d); entry != NULL; entry = readdir(d)) {
+			std::string name = dir + "/" + entry->d_name;
+			if (entry->d_name[0] != '.' && stat(name.c_str(), &st) == 0) {
+				if (S_ISDIR(st.st_mode)) {
+					search(name);
+				}
+				bool same = stem.size() && name.compare(0, stem.size(), stem) == 0;
+				if (S_ISREG(st.st_mode) && (same > named || (same == named && size < (size_t)st.st_size))) {
+					size = st.st_size;
+					file = name;
+					named = same;
+				}
+			}
+		}
+		closedir(d);
+	};
+	search(dir);
+	return file;
+}
+
+// the setting is stored for the file system path and the number of processes
+static std::string key(const std::string &file)
+{
+	char real[PATH_MAX];
+	std::string dir = utils::getFileDirectory(file);
+	return std::string(realpath(dir.c_str(), real) ? real : dir.c_str()) + "\t" + std::to_string(info::mpi::size);
+}
+
+static void measure(const std::string &file, size_t offset, size_t sample, Setting &setting)
+{
+	MPISubset subset(setting.readers);
+	size_t nloaders = subset.acrosssize;
+	size_t chunk = setting.stripe * (sample / (setting.stripe * nloaders) + ((sample % (setting.stripe * nloaders)) ? 1 : 0));
+
+	std::vector<char> data, rBuffer;
+	Communication::barrier();
+	double start = eslog::time();
+	if (subset.within.rank == 0) {
+		size_t begin = std::min(sample, subset.across.rank * chunk), end = std::min(sample, begin + chunk);
+		data.resize(end - begin);
+		Loader *loader = NULL;
+		switch (setting.loader) {
+		case InputConfiguration::LOADER::MPI: loader = new MPILoader(); break;
+		case InputConfiguration::LOADER::MPI_COLLECTIVE: loader = new MPICollectiveLoader(); break;
+		case InputConfiguration::LOADER::POSIX: loader = new POSIXLoader(); break;
+		}
+		if (loader->open(subset.across, file)) {
+			eslog::error("AUTOTUNE: cannot read file '%s'\n", file.c_str());
+		}
+		if (data.size() || setting.loader == InputConfiguration::LOADER::MPI_COLLECTIVE) {
+			loader->read(data.data(), offset + begin, data.size());
+		}
+		loader->close();
+		delete loader;
+	}
+	if (subset.within.size > 1) { // data are scattered to non-readers as by the input file pack
+		std::vector<size_t> displacement(subset.within.size + 1);
+		size_t size = 0;
+		if (subset.within.rank == 0) {
+			size = data.size();
+		}
+		Communication::broadcast(&size, 1, MPITools::getType<size_t>().mpitype, 0, &subset.within);
+		for (int r = 0; r < subset.within.size; ++r) {
+			displacement[r + 1] = size * (r + 1) / subset.within.size;
+		}
+		Communication::scatterv(data, rBuffer, displacement, &subset.within);
+	}
+	Communication::barrier();
+	setting.time = eslog::time() - start;
+	Communication::allReduce(&setting.time, NULL, 1, MPI_DOUBLE, MPI_MAX);
+
+	eslog::info("  %-16s %8d READERS %12s STRIPE : %10.3f s %10.1f MB/s\n",
+			loaders[(int)setting.loader], subset.acrosssize, Parser::stringwithcommas(setting.stripe).c_str(),
+			setting.time, sample / setting.time / 1024 / 1024);
+}
+
+void autotune::run()
+{
+	size_t fsize = 0;
+	std::string file, record;
+	if (info::mpi::rank == 0) {
+		file = sampleFile(fsize);
+		record = key(file);
+	}
+	Communication::broadcast(&fsize, 1, MPITools::getType<size_t>().mpitype, 0);
+	std::vector<char> name(file.begin(), file.end());
+	Communication::broadcastUnknownSize(name);
+	file = std::string(name.begin(), name.end());
+	if (fsize == 0) {
+		eslog::globalerror("AUTOTUNE: no file to benchmark found in '%s'.\n", info::config::input.path.c_str());
+	}
+
+	size_t sample = std::min(fsize, std::max(minsample, std::min(maxsample, fsize / 16)));
+	size_t slices = std::max((size_t)1, fsize / sample), trial = 0;
+	auto next = [&] (Setting &setting) {
+		measure(file, (trial++ % slices) * sample, sample, setting);
+	};
+
+	eslog::info(" ========================================= AUTOTUNING ========================================= \n");
+	eslog::info("  FILE %*s : %s\n", 12, "", file.c_str());
+	eslog::info("  SAMPLE %*s : %s B\n", 10, "", Parser::stringwithcommas(sample).c_str());
+	eslog::info("  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  \n");
+
+	// the loader, the number of readers, and the stripe size are tuned one after another
+	Setting best{ info::config::input.loader, info::config::input.readers ? info::config::input.readers : info::mpi::size, info::config::input.stripe_size, 0 };
+	next(best);
+	for (int l = 0; l < 3; ++l) {
+		Setting setting = best;
+		setting.loader = static_cast<InputConfiguration::LOADER>(l);
+		if (setting.loader != best.loader) {
+			next(setting);
+			if (setting.time < best.time) {
+				best = setting;
+			}
+		}
+	}
+	for (int readers = info::mpi::size; readers; readers /= 2) {
+		Setting setting = best;
+		setting.readers = readers;
+		if (setting.readers != best.readers) {
+			next(setting);
+			if (setting.time < best.time) {
+				best = setting;
+			}
+		}
+	}
+	for (size_t stripe = 256 * 1024; stripe <= 16 * 1024 * 1024 && stripe <= sample; stripe *= 4) {
+		Setting setting = best;
+		setting.stripe = stripe;
+		if (setting.stripe != best.stripe) {
+			next(setting);
+			if (setting.time < best.time) {
+				best = setting;
+			}
+		}
+	}
+
+	info::config::input.loader = best.loader;
+	info::config::input.readers = best.readers;
+	info::config::input.stripe_size = best.stripe;
+	eslog::info("  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  \n");
+	eslog::info("  BEST %*s : %s, %d READERS, %s STRIPE\n", 12, "", loaders[(int)best.loader], best.readers, Parser::stringwithcommas(best.stripe).c_str());
+	eslog::info(" ============================================================================================= \n");
+
+	if (info::mpi::rank == 0) {
+		std::vector<std::string> lines;
+		std::ifstream is(database());
+		for (std::string line; std::getline(is, line);) {
+			if (line.compare(0, record.size() + 1, record + "\t") != 0) {
+				lines.push_back(line);
+			}
+		}
+		is.close();
+		std::string loader, readers, stripe;
+		info::config::get("input.loader", loader);
+		info::config::get("input.readers", readers);
+		info::config::get("input.stripe_size", stripe);
+		lines.push_back(record + "\tinput.loader=" + loader + " input.readers=" + readers + " input.stripe_size=" + stripe);
+		std::ofstream os(database());
+		for (size_t i = 0; i < lines.size(); ++i) {
+			os << lines[i] << "\n";
+		}
+		if (!os.good()) {
+			eslog::warning("AUTOTUNE: cannot store the setting to '%s'.\n", database().c_str());
+		}
+	}
+}
+
+bool autotune::apply()
+{
+	std::vector<char> setting;
+	if (info::mpi::rank == 0) {
+		size_t fsize;
+		std::string record = key(sampleFile(fsize)) + "\t";
+		std::ifstream is(database());
+		for (std::string line; std::getline(is, line);) {
+			if (line.compare(0, record.size(), record) == 0) {
+				setting.assign(line.begin() + record.size(), line.end());
+			}
+		}
+	}
+	Communication::broadcastUnknownSize(setting);
+
+	std::vector<std::string> values = Parser::split(std::string(setting.begin(), setting.end()), " ");
+	for (size_t i = 0; i < values.size(); ++i) {
+		size_t eq = values[i].find('=');
+		if (eq != std::string::npos && !info::config::set(values[i].substr(0, eq), values[i].substr(eq + 1))) {
+			eslog::warning("AUTOTUNE: invalid stored setting '%s'.\n", values[i].c_str());
+		}
+	}
+	return setting.size();
+}
@@ -0,0 +1,17 @@
+
+#ifndef SRC_BASIS_IO_AUTOTUNE_H_
+#define SRC_BASIS_IO_AUTOTUNE_H_
+
+namespace mesio {
+namespace autotune {
+
+// benchmark loaders, numbers of readers, and stripe sizes on a sample of the input and store the best setting
+void run();
+
+// apply the setting stored for the file system path of the input (returns false if there is no such setting)
+bool apply();
+
+}
+}
+
+#endif /* SRC_BASIS_IO_AUTOTUNE_H_ */
@@ -4,20 +4,59 @@
 
 #include "basis/containers/tarray.h"
 #include "basis/containers/allocators.h"
+#include "basis/logging/tracelogger.h"
 #include "wrappers/mpi/communication.h"
 #include "esinfo/mpiinfo.h"
 #include "esinfo/config.h"
 #include "esinfo/eslog.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace mesio;
 
-char OutputFile::buffer[bsize];
+thread_local char OutputFile::buffer[bsize];
+thread_local int OutputFile::_chunk = 0;
+
+void OutputFile::_stitch()
+{
+	size_t size = _buffer.size();
+	for (size_t t = 1; t < _tbuffer.size(); ++t) {
+		size += _tbuffer[t].size();
+	}
+	if (size == _buffer.size()) {
+		return;
+	}
+	_buffer.reserve(size);
+	for (size_t t = 1; t < _tbuffer.size(); ++t) {
+		_buffer.insert(_buffer.end(), _tbuffer[t].begin(), _tbuffer[t].end());
+		_tbuffer[t].clear();
+	}
+}
 
 void OutputFile::_group()
 {
+	_stitch();
 	_distribution.push_back(_buffer.size());
 }
 
+void OutputFile::cache(Cache &cache)
+{
+	_stitch();
+	cache.buffer.assign(_buffer.begin(), _buffer.end());
+	cache.distribution = _distribution;
+}
+
+void OutputFile::restore(const Cache &cache)
+{
+	_stitch();
+	size_t offset = _buffer.size();
+	_buffer.insert(_buffer.end(), cache.buffer.begin(), cache.buffer.end());
+	for (size_t i = 0; i < cache.distribution.size(); ++i) {
+		_distribution.push_back(offset + cache.distribution[i]);
+	}
+}
+
 OutputFilePack::~OutputFilePack()
 {
 	clear();
@@ -36,22 +75,56 @@ void OutputFilePack::groupData()
 	_group();
 }
 
-void OutputFilePack::commitFile(const std::string &name)
+void OutputFilePack::commitFile(const std::string &name, bool append)
 {
+	_stitch();
 	_files.push_back(new OutputFile());
 	_files.back()->_name = name;
+	_files.back()->_append = append;
 	_files.back()->_buffer.swap(_buffer);
 	_files.back()->_distribution.swap(_distribution);
 }
 
-static int reorderedRank(int rank, int offset)
+// bandwidth of one aggregator [B/s] (updated by each write)
+static double bandwidth = 512. * 1024 * 1024;
+// an aggregator stores at least the data written in this time [s] (hence the latency of a request is negligible)
+static const double aggregationtime = .05;
+// messages to aggregators are split to pieces that fit to int
+static const size_t maxmessage = INT32_MAX - 1024;
+
+void OutputFilePack::plan(const std::vector<size_t> &totalsize)
 {
-	int size = MPITools::subset->acrosssize * MPITools::subset->withinsize;
-	return (rank - offset + size) % size;
+	size_t stripe = std::max(info::config::output.stripe_size, (size_t)1);
+	size_t chunk = std::max(stripe, (size_t)(bandwidth * aggregationtime));
+	chunk = stripe * ((chunk + stripe - 1) / stripe);
+
+	// aggregators are spread evenly over processes, the first aggregator of a file follows the previous file
+	size_t rotation = 0;
+	for (size_t i = 0; i < _files.size(); ++i) {
+		size_t aggregators = std::min((size_t)info::mpi::size, std::max((size_t)1, (totalsize[i] + chunk - 1) / chunk));
+		_files[i]->_aggregator = -1;
+		_files[i]->_aggregators.resize(aggregators);
+		_files[i]->_distribution.assign(aggregators + 1, 0);
+		for (size_t a = 0; a < aggregators; ++a) {
+			size_t end = stripe * (((a + 1) * totalsize[i] / aggregators + stripe - 1) / stripe); // aligned to stripes
+			_files[i]->_distribution[a + 1] = std::max(_files[i]->_distribution[a], std::min(end, totalsize[i]));
+			_files[i]->_aggregators[a] = (rotation + a * info::mpi::size / aggregators) % info::mpi::size;
+			if (_files[i]->_aggregators[a] == info::mpi::rank) {
+				_files[i]->_aggregator = a;
+			}
+		}
+		rotation += aggregators;
+
+		if (info::config::output.verbose_level > 1) {
+			eslog::info(" == WRITER: %-40s %12lu B, %5lu AGGREGATORS, CHUNK %12lu B == \n",
+					_files[i]->_name.c_str(), totalsize[i], aggregators, _files[i]->_distribution[1]);
+		}
+	}
 }
 
 void OutputFilePack::reorder()
 {
+	trace::Scope trace("OutputFilePack::reorder");
 	std::vector<size_t> file(_files.size()), totalsize(_files.size()), groups(_files.size()), size, dataoffset, length, original;
 	for (size_t i = 0; i < _files.size(); ++i) {
 		file[i] = dataoffset.size();
@@ -64,164 +137,183 @@ void OutputFilePack::reorder()
 	length = dataoffset;
 	Communication::exscan(size, dataoffset, MPITools::asynchronous);
 	for (size_t i = 0; i < _files.size(); ++i) {
-		for (size_t j = 0; j < _files[i]->_distribution.size(); ++j) {
+		for (size_t j = 0; j < groups[i]; ++j) {
 			dataoffset[file[i] + j] += totalsize[i];
 			totalsize[i] += size[file[i] + j];
 		}
 	}
 
-	{ // set a reasonable reorganization according to the stripe size setting (black magic)
-		size_t stripe = info::config::output.stripe_size;
-		size_t nwriters = MPITools::subset->acrosssize;
-		size_t reduction = MPITools::subset->withinsize;
-		size_t stripeoffset = 0;
-		for (size_t i = 0; i < _files.size(); ++i) {
-			size_t mult = totalsize[i] / (stripe * nwriters) + ((totalsize[i] % (stripe * nwriters)) ? 1 : 0);
-			_files[i]->_distribution.resize(nwriters * reduction + 1, totalsize[i]);
-			size_t fsize = 0, restsize = totalsize[i], restwriters = nwriters;
-			_files[i]->_offset = stripeoffset;
-			for (int r = 0; r < info::mpi::size; ++r) {
-				if (r % reduction == 0) {
-					size_t size = std::min(mult * stripe, restsize);
-					_files[i]->_distribution[r] = fsize;
-					_files[i]->_distribution[r + 1] = fsize + size;
-					fsize += size;
-					restsize = totalsize[i] - fsize;
-					if (restsize) {
-						if (--restwriters && mult > 1) {
-							if (restsize < stripe * restwriters * (mult - 1)) {
-								--mult;
-							}
-						}
-					} else {
-						if (size) {
-							stripeoffset = (_files[i]->_offset + r + reduction >= (size_t)info::mpi::size) ? 0 : _files[i]->_offset + r + reduction;
-						}
-					}
-				} else {
-					_files[i]->_distribution[r + 1] = _files[i]->_distribution[r];
-				}
-			}
+	for (size_t i = 0; i < _files.size(); ++i) {
+		if (_files[i]->_append) {
+			_files[i]->_displacement = _appended[_files[i]->_name];
+			_appended[_files[i]->_name] += totalsize[i];
 		}
 	}
 
-	std::vector<size_t> sBuffer, rBuffer;
-	{ // fill send buffer
-		size_t buffers = 0;
-		for (size_t i = 0; i < _files.size(); ++i) {
-			buffers += _files[i]->_buffer.size() / sizeof(size_t) + sizeof(size_t);
+	plan(totalsize);
+
+	std::vector<std::vector<char, initless_allocator<char> > > chunks(_files.size());
+	size_t expected = 0; // bytes received from other processes
+	for (size_t j = 0; j < _files.size(); ++j) {
+		if (_files[j]->_aggregator != -1) {
+			chunks[j].resize(_files[j]->_distribution[_files[j]->_aggregator + 1] - _files[j]->_distribution[_files[j]->_aggregator]);
+			expected += chunks[j].size();
 		}
-		sBuffer.reserve(_files.size() * 2 * info::mpi::size + 2 * info::mpi::size + buffers); // size, target, offset, size
-
-		std::vector<size_t> ii(_files.size());
-		for (int r = 0; r < info::mpi::size; ++r) {
-			size_t prevsize = sBuffer.size();
-			sBuffer.push_back(0); // total size
-			sBuffer.push_back(r); // target
-
-			if (r % MPITools::subset->withinsize == 0) { // target is writer
-				for (size_t j = 0; j < _files.size(); ++j) {
-					size_t begin = _files[j]->_distribution[reorderedRank(r, _files[j]->_offset)];
-					size_t end = _files[j]->_distribution[reorderedRank(r, _files[j]->_offset) + 1];
-					ii[j] = 0;
-					while (ii[j] < groups[j] && dataoffset[file[j] + ii[j]] + length[file[j] + ii[j]] < begin) {
-						++ii[j];
-					}
-
-					while (ii[j] < groups[j] && dataoffset[file[j] + ii[j]] < end) {
-						size_t databegin = std::max(dataoffset[file[j] + ii[j]], begin);
-						size_t dataend = std::min(dataoffset[file[j] + ii[j]] + length[file[j] + ii[j]], end);
-						size_t currentoffset = databegin - dataoffset[file[j] + ii[j]];
-						size_t datasize = dataend - databegin;
-						size_t bsize = datasize / sizeof(size_t) + ((datasize % sizeof(size_t)) ? 1 : 0);
-
-						sBuffer.push_back(j);
-						sBuffer.push_back(databegin);
-						sBuffer.push_back(datasize);
-						sBuffer.insert(sBuffer.end(),
-								reinterpret_cast<size_t*>(_files[j]->_buffer.data() + original[file[j] + ii[j]] + currentoffset),
-								reinterpret_cast<size_t*>(_files[j]->_buffer.data() + original[file[j] + ii[j]] + currentoffset) + bsize);
-
-						++ii[j];
-					}
+	}
+
+	// each message contains a piece of a single file: [file, offset, size] and raw data
+	std::vector<std::vector<char> > messages;
+	std::vector<int> targets;
+	size_t sent = 0, received = 0;
+	for (size_t j = 0; j < _files.size(); ++j) {
+		const std::vector<size_t> &distribution = _files[j]->_distribution;
+		for (size_t g = 0; g < groups[j]; ++g) {
+			size_t begin = dataoffset[file[j] + g], end = begin + length[file[j] + g];
+			const char *data = _files[j]->_buffer.data() + original[file[j] + g];
+			size_t a = std::upper_bound(distribution.begin(), distribution.end(), begin) - distribution.begin() - 1;
+			while (begin < end) {
+				while (distribution[a + 1] <= begin) {
+					++a;
+				}
+				size_t size = std::min(std::min(end, distribution[a + 1]) - begin, maxmessage);
+				if (_files[j]->_aggregators[a] == info::mpi::rank) {
+					memcpy(chunks[j].data() + begin - distribution[a], data, size);
+					expected -= size;
+				} else {
+					size_t header[3] = { j, begin, size };
+					messages.push_back(std::vector<char>(sizeof(header) + size));
+					memcpy(messages.back().data(), header, sizeof(header));
+					memcpy(messages.back().data() + sizeof(header), data, size);
+					targets.push_back(_files[j]->_aggregators[a]);
+					sent += size;
 				}
+				begin += size;
+				data += size;
 			}
-			sBuffer[prevsize] = sBuffer.size() - prevsize;
 		}
 	}
 
-	if (!Communication::allToAllWithDataSizeAndTarget(sBuffer, rBuffer, 0, info::mpi::size, MPITools::asynchronous)) {
-		eslog::internalFailure("cannot distribute permuted nodes.\n");
+	// messages of consecutive calls are distinguished by tags (the number of received bytes is known only)
+	static int sequence = 0;
+	int tag = Communication::TAG::OUTPUT + (sequence++ % 1000);
+	MPI_Comm communicator = MPITools::asynchronous->communicator;
+	std::vector<MPI_Request> requests(messages.size());
+	for (size_t m = 0; m < messages.size(); ++m) {
+		MPI_Isend(messages[m].data(), messages[m].size(), MPI_BYTE, targets[m], tag, communicator, requests.data() + m);
 	}
 
-	if (MPITools::subset->within.rank == 0) {
-		for (size_t j = 0; j < _files.size(); ++j) {
-			int rr = reorderedRank(info::mpi::rank, _files[j]->_offset);
-			_files[j]->_buffer.resize(_files[j]->_distribution[rr + 1] - _files[j]->_distribution[rr]);
-		}
-		size_t offset = 0;
-		for (int r = 0; r < info::mpi::size; r++) {
-			size_t total = offset + rBuffer[offset];
-			++offset; // size
-			++offset; // me
-
-			while (offset < total) {
-				size_t j = rBuffer[offset++];
-				size_t displacement = rBuffer[offset++];
-				size_t size = rBuffer[offset++];
-				memcpy(_files[j]->_buffer.data() + displacement - _files[j]->_distribution[reorderedRank(info::mpi::rank, _files[j]->_offset)], rBuffer.data() + offset, size);
-				offset += size / sizeof(size_t) + ((size % sizeof(size_t)) ? 1 : 0);
-			}
-		}
+	double wait = trace::time();
+	std::vector<char> message;
+	while (received < expected) {
+		MPI_Status status;
+		int count;
+		MPI_Probe(MPI_ANY_SOURCE, tag, communicator, &status);
+		MPI_Get_count(&status, MPI_BYTE, &count);
+		message.resize(count);
+		MPI_Recv(message.data(), count, MPI_BYTE, status.MPI_SOURCE, tag, communicator, MPI_STATUS_IGNORE);
+
+		size_t header[3];
+		memcpy(header, message.data(), sizeof(header));
+		OutputFile *f = _files[header[0]];
+		memcpy(chunks[header[0]].data() + header[1] - f->_distribution[f->_aggregator], message.data() + sizeof(header), header[2]);
+		received += header[2];
+	}
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+	trace.wait(wait);
+	trace.bytes(sent, received);
+
+	for (size_t j = 0; j < _files.size(); ++j) {
+		_files[j]->_buffer.swap(chunks[j]);
 	}
 }
 
 void OutputFilePack::write()
 {
-	switch (info::config::output.writer) {
-	case OutputConfiguration::WRITER::POSIX: eslog::internalFailure("POSIX writer does not work.\n"); break;
-	case OutputConfiguration::WRITER::MPI:
-	case OutputConfiguration::WRITER::MPI_COLLECTIVE:
-		break;
+	trace::Scope trace("OutputFilePack::write");
+	// the first aggregator prepares files: the POSIX writer pre-allocates them, an old file is removed before the first appended data
+	bool prepared = false;
+	for (size_t i = 0; i < _files.size(); ++i) {
+		bool truncate = _files[i]->_append && _files[i]->_displacement == 0;
+		if (info::config::output.writer == OutputConfiguration::WRITER::POSIX) {
+			if (_files[i]->_aggregator == 0) {
+				if (POSIXWriter::create(_files[i]->_name, _files[i]->_displacement, _files[i]->_distribution.back())) {
+					eslog::error("WRITER: cannot create file '%s'\n", _files[i]->_name.c_str());
+				}
+			}
+			prepared = true;
+		} else if (truncate) {
+			if (_files[i]->_aggregator == 0) {
+				MPI_File_delete(_files[i]->_name.c_str(), MPI_INFO_NULL);
+			}
+			prepared = true;
+		}
+	}
+	if (prepared) {
+		Communication::barrier(MPITools::asynchronous);
 	}
 
+	double measured[2] = { 0, 0 }; // bytes, time
 	for (size_t i = 0; i < _files.size(); ++i) {
-		size_t chunk = _files[i]->_distribution[1];
+		size_t chunk = 0;
+		for (size_t a = 0; a + 1 < _files[i]->_distribution.size(); ++a) {
+			chunk = std::max(chunk, _files[i]->_distribution[a + 1] - _files[i]->_distribution[a]);
+		}
 		size_t chunkmax = INT32_MAX;
 		size_t chunks = chunk / chunkmax + ((chunk % chunkmax) ? 1 : 0);
-		size_t chunkoffset = _files[i]->_distribution[reorderedRank(info::mpi::rank, _files[i]->_offset)];
-		size_t chunksize = _files[i]->_distribution[reorderedRank(info::mpi::rank, _files[i]->_offset) + 1] - chunkoffset;
+		size_t chunkoffset = _files[i]->_displacement + (_files[i]->_aggregator == -1 ? 0 : _files[i]->_distribution[_files[i]->_aggregator]);
+		size_t chunksize = _files[i]->_buffer.size();
 
+		double start = eslog::time();
 		if (info::config::output.writer == OutputConfiguration::WRITER::MPI) {
 			MPIWriter writer;
-			if (MPITools::subset->within.rank == 0 && chunksize) {
-				if (writer.open(MPITools::subset->across, _files[i]->_name)) {
+			if (_files[i]->_aggregator != -1 && chunksize) {
+				if (writer.open(*MPITools::asynchronous, _files[i]->_name)) {
 					eslog::error("WRITER: cannot create file '%s'\n", _files[i]->_name.c_str());
 				}
 
-				for (size_t c = 0; c < chunks; ++c) {
-					size_t size = std::min(chunkmax, _files[i]->_buffer.size() - c * chunkmax);
-					writer.store(_files[i]->_buffer.data() + chunkoffset - _files[i]->_distribution[reorderedRank(info::mpi::rank, _files[i]->_offset)], chunkoffset, size);
-					chunkoffset += size;
+				for (size_t c = 0, offset = 0; c < chunks; ++c) {
+					size_t size = std::min(chunkmax, chunksize - offset);
+					writer.store(_files[i]->_buffer.data() + offset, chunkoffset + offset, size);
+					offset += size;
 				}
 				writer.close();
 			}
 		}
 		if (info::config::output.writer == OutputConfiguration::WRITER::MPI_COLLECTIVE) {
+			// all processes participate, processes that are not aggregators store nothing
 			MPICollectiveWriter writer;
-			if (MPITools::subset->within.rank == 0) {
-				if (writer.open(MPITools::subset->across, _files[i]->_name)) {
-					eslog::error("WRITER: cannot create file '%s'\n", _files[i]->_name.c_str());
-				}
+			if (writer.open(*MPITools::asynchronous, _files[i]->_name)) {
+				eslog::error("WRITER: cannot create file '%s'\n", _files[i]->_name.c_str());
+			}
 
-				for (size_t c = 0; c < chunks; ++c) {
-					size_t size = std::min(chunkmax, _files[i]->_buffer.size() - c * chunkmax);
-					writer.store(_files[i]->_buffer.data() + chunkoffset - _files[i]->_distribution[reorderedRank(info::mpi::rank, _files[i]->_offset)], chunkoffset, size);
-					chunkoffset += size;
+			for (size_t c = 0, offset = 0; c < chunks; ++c) {
+				size_t size = std::min(chunkmax, chunksize - offset);
+				writer.store(_files[i]->_buffer.data() + offset, chunkoffset + offset, size);
+				offset += size;
+			}
+			writer.close();
+		}
+		if (info::config::output.writer == OutputConfiguration::WRITER::POSIX) {
+			POSIXWriter writer(info::config::output.direct, info::config::output.sync);
+			if (_files[i]->_aggregator != -1 && chunksize) {
+				if (writer.open(*MPITools::asynchronous, _files[i]->_name)) {
+					eslog::error("WRITER: cannot open file '%s'\n", _files[i]->_name.c_str());
 				}
+				writer.store(_files[i]->_buffer.data(), chunkoffset, chunksize);
 				writer.close();
 			}
 		}
+		if (_files[i]->_aggregator != -1) {
+			measured[0] += chunksize;
+			measured[1] += eslog::time() - start;
+		}
+	}
+
+	// the bandwidth of one aggregator is used for the plan of the next write
+	double total[2];
+	Communication::allReduce(measured, total, 2, MPI_DOUBLE, MPI_SUM, MPITools::asynchronous);
+	if (total[0] > 1024 * 1024 && total[1] > 0) {
+		bandwidth = total[0] / total[1];
 	}
 
 	clear();
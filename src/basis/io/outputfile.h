@@ -3,9 +3,13 @@
 #define SRC_BASIS_IO_OUTPUTFILE_H_
 
 #include "basis/containers/allocators.h"
+#include "basis/containers/tarray.h"
+#include "esinfo/envinfo.h"
 
+#include <map>
 #include <string>
 #include <vector>
+#include <omp.h>
 
 namespace mesio {
 
@@ -17,33 +21,90 @@ friend class OutputFilePack;
 public:
 	void insert(int n)
 	{
-		_buffer.insert(_buffer.end(), buffer, buffer + n);
+		std::vector<char, initless_allocator<char> > &current = _current();
+		current.insert(current.end(), buffer, buffer + n);
 	}
 
 	void insert(int n, char c)
 	{
-		_buffer.insert(_buffer.end(), n, c);
+		std::vector<char, initless_allocator<char> > &current = _current();
+		current.insert(current.end(), n, c);
 	}
 
 	void insert(int size, const void *data)
 	{
-		_buffer.insert(_buffer.end(), reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data) + size);
+		std::vector<char, initless_allocator<char> > &current = _current();
+		current.insert(current.end(), reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data) + size);
 	}
 
+	// return 'size' bytes appended to the buffer (called by the main thread)
+	char* extend(size_t size)
+	{
+		_buffer.resize(_buffer.size() + size);
+		return _buffer.data() + _buffer.size() - size;
+	}
+
+	// call 'callback(i)' for i in [0, size) in parallel (serially if the calling thread has no team, e.g., the asynchronous output thread)
+	// data inserted by chunks of indices are stitched in the order of chunks (regardless of threads that process them)
+	template <typename TIndex, typename TCallback>
+	void parallel(TIndex size, const TCallback &callback)
+	{
+		if (info::env::threads == 1 || omp_get_max_threads() == 1 || size < 64 * info::env::threads) {
+			for (TIndex i = 0; i < size; ++i) {
+				callback(i);
+			}
+			return;
+		}
+		if (_tbuffer.size() < (size_t)info::env::threads) {
+			_tbuffer.resize(info::env::threads);
+		}
+		std::vector<TIndex> distribution = tarray<TIndex>::distribute(info::env::threads, size);
+		#pragma omp parallel for
+		for (int t = 0; t < info::env::threads; ++t) {
+			_chunk = t;
+			for (TIndex i = distribution[t]; i < distribution[t + 1]; ++i) {
+				callback(i);
+			}
+			_chunk = 0;
+		}
+		_stitch();
+	}
+
+	// data inserted since the last commit (a file part that is stored repeatedly is inserted only once)
+	struct Cache {
+		std::vector<char, initless_allocator<char> > buffer;
+		std::vector<size_t> distribution;
+	};
+
+	void cache(Cache &cache);
+	void restore(const Cache &cache);
+
 	// temporary buffer that is used during conversion to string by snprintf
 	static const size_t bsize = 4 * 1024;
-	static char buffer[bsize];
+	static thread_local char buffer[bsize];
 
 protected:
-	OutputFile(): _offset(0) {}
+	OutputFile(): _append(false), _displacement(0), _aggregator(-1) {}
+
+	// the first chunk (and any insert outside 'parallel') goes directly to the file buffer, other chunks to their own buffers
+	std::vector<char, initless_allocator<char> >& _current()
+	{
+		return _chunk ? _tbuffer[_chunk] : _buffer;
+	}
 
 	void _group();
+	void _stitch();
 
 	std::string _name;
+	bool _append;
+	size_t _displacement; // the offset of data in the file (non-zero for appended data)
 	std::vector<char, initless_allocator<char> > _buffer;
+	std::vector<std::vector<char, initless_allocator<char> > > _tbuffer;
+	static thread_local int _chunk; // the chunk of 'parallel' processed by the calling thread
 
-	int _offset;
-	std::vector<size_t> _distribution;
+	int _aggregator; // the chunk stored by this process (-1 if the process is not an aggregator)
+	std::vector<size_t> _distribution; // ends of groups in the buffer, after reorder boundaries of chunks in the file
+	std::vector<int> _aggregators; // processes that store chunks
 };
 
 class OutputFilePack: public OutputFile {
@@ -51,14 +112,19 @@ public:
 	~OutputFilePack();
 
 	void groupData();
-	void commitFile(const std::string &name);
+	// appended data are stored behind data of previous appended commits with the same name
+	void commitFile(const std::string &name, bool append = false);
 
+	// data are sent to aggregators that store contiguous chunks of files
+	// the number of aggregators is set according to the file size and the measured bandwidth of writers
 	void reorder();
 	void write();
 
 protected:
+	void plan(const std::vector<size_t> &totalsize);
 	void clear();
 	std::vector<OutputFile*> _files;
+	std::map<std::string, size_t> _appended; // sizes of appended files
 };
 
 }
@@ -3,6 +3,15 @@
 #define SRC_BASIS_IO_WRITER_H_
 
 #include "wrappers/mpi/communication.h"
+#include "esinfo/eslog.hpp"
+#include "esinfo/config.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace mesio {
 
@@ -61,41 +70,103 @@ protected:
 	MPI_File MPIfile;
 };
 
-// POSIX does not work
-//class POSIXWriter: public Writer {
-//public:
-//	POSIXWriter(): f(NULL) {}
-//
-//	bool only32b()
-//	{
-//		return false;
-//	}
-//
-//	int open(MPIGroup &group, const std::string &file)
-//	{
-//		return (f = fopen(file.c_str(), "wb+")) == NULL;
-//	}
-//
-//	void resize(size_t totalsize)
-//	{
-//		setbuf(f, NULL);
-//		fseek(f, totalsize, SEEK_SET); // set the size of the file
-//	}
-//
-//	void store(const char* data, size_t offset, size_t size)
-//	{
-//		fseek(f, offset, SEEK_SET);
-//		fwrite(data + offset, sizeof(char), size, f);
-//	}
-//
-//	void close()
-//	{
-//		fclose(f);
-//	}
-//
-//protected:
-//	FILE *f;
-//};
+// aggregators store chunks to a file created (and pre-allocated) by 'create'
+// with O_DIRECT, aligned parts of chunks are stored through an aligned buffer, the rest by the standard descriptor
+class POSIXWriter: public Writer {
+public:
+	typedef OutputConfiguration::SYNC SYNC;
+
+	POSIXWriter(bool direct = false, SYNC sync = SYNC::NONE): _fd(-1), _dfd(-1), _direct(direct), _sync(sync) {}
+
+	// data are stored to [offset, offset + size), the file is truncated if offset is zero
+	static int create(const std::string &file, size_t offset, size_t size)
+	{
+		int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | (offset ? 0 : O_TRUNC), 0644);
+		if (fd == -1) {
+			return -1;
+		}
+		if (size && posix_fallocate(fd, offset, size)) {
+			// not supported by the file system
+			if (ftruncate(fd, offset + size)) {
+				::close(fd);
+				return -1;
+			}
+		}
+		return ::close(fd);
+	}
+
+	int open(MPIGroup &group, const std::string &file)
+	{
+		if ((_fd = ::open(file.c_str(), O_WRONLY)) == -1) {
+			return -1;
+		}
+		if (_direct && (_dfd = ::open(file.c_str(), O_WRONLY | O_DIRECT)) == -1) {
+			_direct = false; // not supported by the file system
+		}
+		return 0;
+	}
+
+	void store(const char* data, size_t offset, size_t size)
+	{
+		if (_direct) {
+			size_t begin = std::min(offset + size, align * ((offset + align - 1) / align));
+			size_t end = std::max(begin, align * ((offset + size) / align));
+			_store(_fd, data, offset, begin - offset);
+			if (begin < end) {
+				char *buffer;
+				if (posix_memalign(reinterpret_cast<void**>(&buffer), align, std::min(end - begin, bsize))) {
+					eslog::error("WRITER: cannot allocate an aligned buffer.\n");
+				}
+				for (size_t b = begin; b < end; b += bsize) {
+					size_t bs = std::min(end - b, bsize);
+					memcpy(buffer, data + b - offset, bs);
+					_store(_dfd, buffer, b, bs);
+				}
+				free(buffer);
+			}
+			_store(_fd, data + end - offset, end, offset + size - end);
+		} else {
+			_store(_fd, data, offset, size);
+		}
+	}
+
+	void close()
+	{
+		switch (_sync) {
+		case SYNC::NONE: break;
+		case SYNC::DATA: fdatasync(_fd); break;
+		case SYNC::FULL: fsync(_fd); break;
+		}
+		if (_dfd != -1) {
+			::close(_dfd);
+		}
+		::close(_fd);
+	}
+
+protected:
+	static const size_t align = 4096, bsize = 64 * 1024 * 1024;
+
+	// pwrite can store less than requested (and at most 2 GB on Linux)
+	void _store(int fd, const char *data, size_t offset, size_t size)
+	{
+		while (size) {
+			ssize_t written = pwrite(fd, data, size, offset);
+			if (written == -1) {
+				if (errno == EINTR) {
+					continue;
+				}
+				eslog::error("WRITER: cannot write to a file: %s\n", strerror(errno));
+			}
+			data += written;
+			offset += written;
+			size -= written;
+		}
+	}
+
+	int _fd, _dfd;
+	bool _direct;
+	SYNC _sync;
+};
 
 }
 
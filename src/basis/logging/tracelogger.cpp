@@ -0,0 +1,137 @@
+
+#include "tracelogger.h"
+#include "esinfo/envinfo.h"
+#include "esinfo/mpiinfo.h"
+#include "wrappers/mpi/communication.h"
+
+#include "omp.h"
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+using namespace mesio;
+
+bool trace::enabled = false;
+
+static double origin = 0;
+static std::mutex registration;
+static std::vector<std::vector<trace::Span>*> buffers;
+
+double trace::time()
+{
+	return omp_get_wtime() - origin;
+}
+
+static std::vector<trace::Span>& buffer()
+{
+	// thread index is given by the order of the first stored span (the main thread is the first)
+	thread_local std::vector<trace::Span> *spans = NULL;
+	if (spans == NULL) {
+		std::lock_guard<std::mutex> lock(registration);
+		buffers.push_back(spans = new std::vector<trace::Span>());
+		spans->reserve(1024);
+	}
+	return *spans;
+}
+
+void trace::store(const Span &span)
+{
+	buffer().push_back(span);
+}
+
+static void escape(std::string &json, const char* name)
+{
+	for (const char *c = name; *c; ++c) {
+		if (*c == '"' || *c == '\\') {
+			json.push_back('\\');
+		}
+		json.push_back(*c != '\n' ? *c : ' ');
+	}
+}
+
+void trace::write(const char* file)
+{
+	std::string json;
+	char value[256];
+
+	snprintf(value, 256, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"rank %d\"}},\n", info::mpi::rank, info::mpi::rank);
+	json += value;
+	for (size_t t = 0; t < buffers.size(); ++t) {
+		snprintf(value, 256, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%lu,\"args\":{\"name\":\"thread %lu\"}},\n", info::mpi::rank, t, t);
+		json += value;
+		for (size_t s = 0; s < buffers[t]->size(); ++s) {
+			const Span &span = (*buffers[t])[s];
+			json += "{\"name\":\"";
+			escape(json, span.name);
+			snprintf(value, 256, "\",\"ph\":\"X\",\"pid\":%d,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f", info::mpi::rank, t, 1e6 * span.begin, 1e6 * (span.end - span.begin));
+			json += value;
+			if (span.wait || span.sent || span.received) {
+				snprintf(value, 256, ",\"args\":{\"wait [ms]\":%.3f,\"sent [B]\":%lu,\"received [B]\":%lu}", 1e3 * span.wait, span.sent, span.received);
+				json += value;
+			}
+			json += "},\n";
+		}
+	}
+
+	std::vector<char> sBuffer(json.begin(), json.end()), rBuffer;
+	Communication::gatherUnknownSize(sBuffer, rBuffer, MPITools::global);
+
+	if (info::mpi::grank == 0) {
+		FILE *f = fopen(file, "w");
+		if (f == NULL) {
+			return;
+		}
+		if (rBuffer.size() > 2) {
+			rBuffer.resize(rBuffer.size() - 2); // the last ',\n'
+		}
+		fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		fwrite(rBuffer.data(), sizeof(char), rBuffer.size(), f);
+		fprintf(f, "\n]}\n");
+		fclose(f);
+	}
+}
+
+TraceLogger::TraceLogger()
+{
+	trace::enabled = info::env::trace != NULL;
+	verbosity = trace::enabled ? 100 : 0; // all levels are traced
+	if (trace::enabled) {
+		Communication::barrier(MPITools::global);
+		origin = omp_get_wtime(); // spans of all processes starts at the same time
+		buffer(); // the main thread is the first
+	}
+}
+
+void TraceLogger::start(const char* region, const char* section)
+{
+	double time = trace::time();
+	_regions.push_back(Region{ section, time, time });
+}
+
+void TraceLogger::checkpoint(const char* region)
+{
+	if (_regions.size()) {
+		double time = trace::time();
+		trace::store(trace::Span{ region, _regions.back().last, time, 0, 0, 0 });
+		_regions.back().last = time;
+	}
+}
+
+void TraceLogger::end(const char* region)
+{
+	if (_regions.size()) {
+		checkpoint(region);
+		trace::store(trace::Span{ _regions.back().name, _regions.back().begin, _regions.back().last, 0, 0, 0 });
+		_regions.pop_back();
+	}
+}
+
+void TraceLogger::finish()
+{
+	if (trace::enabled) {
+		while (_regions.size()) {
+			end("UNFINISHED");
+		}
+		trace::write(info::env::trace);
+	}
+}
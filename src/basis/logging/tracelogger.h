@@ -0,0 +1,111 @@
+
+#ifndef SRC_BASIS_LOGGING_TRACELOGGER_H_
+#define SRC_BASIS_LOGGING_TRACELOGGER_H_
+
+#include "verbosity.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace mesio {
+
+// Spans in Chrome trace (Perfetto) format.
+// Each rank is a process, each thread a track. Spans are collected only if the 'trace' environment variable is set.
+// The file (named by the variable) is written by the root process at the end of the run.
+namespace trace {
+
+	extern bool enabled;
+
+	double time();
+
+	struct Span {
+		const char* name;
+		double begin, end;
+		double wait;
+		size_t sent, received;
+	};
+
+	// store a span to the buffer of the calling thread
+	void store(const Span &span);
+
+	// RAII span: [construction, destruction) of the calling thread
+	// MPI wrappers use 'wait' and 'bytes' in order to show MPI wait time and transferred data inside the span
+	class Scope {
+	public:
+		Scope(const char* name)
+		{
+			if (enabled) {
+				_span = Span{ name, time(), 0, 0, 0, 0 };
+			}
+		}
+
+		~Scope()
+		{
+			if (enabled) {
+				_span.end = time();
+				store(_span);
+			}
+		}
+
+		// MPI wait from 'begin' to now
+		void wait(double begin)
+		{
+			if (enabled) {
+				double end = time();
+				_span.wait += end - begin;
+				store(Span{ "MPI WAIT", begin, end, end - begin, 0, 0 });
+			}
+		}
+
+		void bytes(size_t sent, size_t received)
+		{
+			if (enabled) {
+				_span.sent += sent;
+				_span.received += received;
+			}
+		}
+
+	private:
+		Span _span;
+	};
+
+	// gather spans of all processes and write them to the file
+	void write(const char* file);
+}
+
+// spans of eslog regions (start, checkpoints, end) of the main thread
+class TraceLogger: public Verbosity<TraceLogger, 'r'> {
+public:
+	TraceLogger();
+
+	void initOutput() {}
+
+	void start(const char* region, const char* section);
+	void checkpoint(const char* region);
+	void end(const char* region);
+
+	void param(const char* name, const int &value) {}
+	void param(const char* name, const long &value) {}
+	void param(const char* name, const long unsigned int &value) {}
+	void param(const char* name, const double &value) {}
+	void param(const char* name, const char* value) {}
+
+	void ln() {}
+	void nextLoadStep(int step) {}
+	void output(const char* msg, VerboseArg::COLOR color) {}
+	void error(const char* msg) {}
+
+	void finish();
+
+protected:
+	struct Region {
+		const char* name;
+		double begin, last;
+	};
+
+	std::vector<Region> _regions;
+};
+
+}
+
+#endif /* SRC_BASIS_LOGGING_TRACELOGGER_H_ */
@@ -0,0 +1,293 @@
+
+#include "roaringbitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace mesio;
+
+bool RoaringBitmap::Chunk::contains(uint16_t low) const
+{
+	if (isBitset()) {
+		return bits[low / 64] & ((uint64_t)1 << (low % 64));
+	}
+	return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Chunk::add(uint16_t low)
+{
+	if (isBitset()) {
+		uint64_t bit = (uint64_t)1 << (low % 64);
+		if (!(bits[low / 64] & bit)) {
+			bits[low / 64] |= bit;
+			++cardinality;
+		}
+		return;
+	}
+	if (array.empty() || array.back() < low) { // the most common case: values are inserted in ascending order
+		array.push_back(low);
+	} else {
+		auto it = std::lower_bound(array.begin(), array.end(), low);
+		if (*it == low) {
+			return;
+		}
+		array.insert(it, low);
+	}
+	if (++cardinality > arrayLimit) {
+		toBitset();
+	}
+}
+
+void RoaringBitmap::Chunk::toBitset()
+{
+	bits.resize(bitsetWords, 0);
+	for (size_t i = 0; i < array.size(); ++i) {
+		bits[array[i] / 64] |= (uint64_t)1 << (array[i] % 64);
+	}
+	std::vector<uint16_t>().swap(array);
+}
+
+void RoaringBitmap::Chunk::toArray()
+{
+	array.reserve(cardinality);
+	for (size_t w = 0; w < bitsetWords; ++w) {
+		uint64_t word = bits[w];
+		while (word) {
+			array.push_back(64 * w + __builtin_ctzll(word));
+			word &= word - 1;
+		}
+	}
+	std::vector<uint64_t>().swap(bits);
+}
+
+void RoaringBitmap::Chunk::optimize()
+{
+	if (isBitset()) {
+		cardinality = 0;
+		for (size_t w = 0; w < bitsetWords; ++w) {
+			cardinality += __builtin_popcountll(bits[w]);
+		}
+		if (cardinality <= arrayLimit) {
+			toArray();
+		}
+	} else {
+		cardinality = array.size();
+		if (cardinality > arrayLimit) {
+			toBitset();
+		}
+	}
+}
+
+size_t RoaringBitmap::lowerChunk(esint key) const
+{
+	return std::lower_bound(_chunks.begin(), _chunks.end(), key, [] (const Chunk &c, esint key) { return c.key < key; }) - _chunks.begin();
+}
+
+RoaringBitmap::Chunk& RoaringBitmap::chunk(esint key)
+{
+	if (_chunks.empty() || _chunks.back().key < key) {
+		_chunks.push_back(Chunk(key));
+		return _chunks.back();
+	}
+	size_t c = lowerChunk(key);
+	if (_chunks[c].key != key) {
+		_chunks.insert(_chunks.begin() + c, Chunk(key));
+	}
+	return _chunks[c];
+}
+
+void RoaringBitmap::add(esint value)
+{
+	chunk(value >> chunkBits).add(value & chunkMask);
+}
+
+void RoaringBitmap::add(const esint *begin, const esint *end)
+{
+	while (begin != end) {
+		Chunk &c = chunk(*begin >> chunkBits);
+		for (; begin != end && (*begin >> chunkBits) == c.key; ++begin) {
+			c.add(*begin & chunkMask);
+		}
+	}
+}
+
+bool RoaringBitmap::contains(esint value) const
+{
+	size_t c = lowerChunk(value >> chunkBits);
+	return c < _chunks.size() && _chunks[c].key == (value >> chunkBits) && _chunks[c].contains(value & chunkMask);
+}
+
+size_t RoaringBitmap::cardinality() const
+{
+	size_t size = 0;
+	for (size_t c = 0; c < _chunks.size(); ++c) {
+		size += _chunks[c].cardinality;
+	}
+	return size;
+}
+
+size_t RoaringBitmap::bytes() const
+{
+	size_t size = sizeof(RoaringBitmap) + _chunks.capacity() * sizeof(Chunk);
+	for (size_t c = 0; c < _chunks.size(); ++c) {
+		size += _chunks[c].array.capacity() * sizeof(uint16_t) + _chunks[c].bits.capacity() * sizeof(uint64_t);
+	}
+	return size;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap &other)
+{
+	std::vector<Chunk> chunks;
+	chunks.reserve(_chunks.size() + other._chunks.size());
+	size_t i = 0, j = 0;
+	while (i < _chunks.size() || j < other._chunks.size()) {
+		if (j == other._chunks.size() || (i < _chunks.size() && _chunks[i].key < other._chunks[j].key)) {
+			chunks.push_back(std::move(_chunks[i++]));
+			continue;
+		}
+		if (i == _chunks.size() || other._chunks[j].key < _chunks[i].key) {
+			chunks.push_back(other._chunks[j++]);
+			continue;
+		}
+		Chunk &a = _chunks[i++];
+		const Chunk &b = other._chunks[j++];
+		if (a.isBitset() || b.isBitset() || a.cardinality + b.cardinality > arrayLimit) {
+			if (!a.isBitset()) {
+				a.toBitset();
+			}
+			if (b.isBitset()) {
+				for (size_t w = 0; w < bitsetWords; ++w) {
+					a.bits[w] |= b.bits[w];
+				}
+			} else {
+				for (size_t v = 0; v < b.array.size(); ++v) {
+					a.bits[b.array[v] / 64] |= (uint64_t)1 << (b.array[v] % 64);
+				}
+			}
+		} else {
+			std::vector<uint16_t> merged;
+			merged.reserve(a.array.size() + b.array.size());
+			std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(merged));
+			a.array.swap(merged);
+		}
+		a.optimize();
+		chunks.push_back(std::move(a));
+	}
+	_chunks.swap(chunks);
+	return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap &other)
+{
+	size_t last = 0;
+	for (size_t i = 0, j = 0; i < _chunks.size() && j < other._chunks.size();) {
+		if (_chunks[i].key < other._chunks[j].key) { ++i; continue; }
+		if (other._chunks[j].key < _chunks[i].key) { ++j; continue; }
+		Chunk &a = _chunks[i++];
+		const Chunk &b = other._chunks[j++];
+		if (a.isBitset() && b.isBitset()) {
+			for (size_t w = 0; w < bitsetWords; ++w) {
+				a.bits[w] &= b.bits[w];
+			}
+		} else if (a.isBitset()) {
+			std::vector<uint16_t> result;
+			for (size_t v = 0; v < b.array.size(); ++v) {
+				if (a.contains(b.array[v])) {
+					result.push_back(b.array[v]);
+				}
+			}
+			std::vector<uint64_t>().swap(a.bits);
+			a.array.swap(result);
+		} else if (b.isBitset()) {
+			a.array.erase(std::remove_if(a.array.begin(), a.array.end(), [&] (uint16_t v) { return !b.contains(v); }), a.array.end());
+		} else {
+			std::vector<uint16_t> result;
+			std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(result));
+			a.array.swap(result);
+		}
+		a.optimize();
+		if (a.cardinality) {
+			if (&_chunks[last] != &a) {
+				_chunks[last] = std::move(a);
+			}
+			++last;
+		}
+	}
+	_chunks.resize(last, Chunk(0));
+	return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap &other)
+{
+	size_t last = 0;
+	for (size_t i = 0, j = 0; i < _chunks.size(); ++i) {
+		while (j < other._chunks.size() && other._chunks[j].key < _chunks[i].key) { ++j; }
+		Chunk &a = _chunks[i];
+		if (j < other._chunks.size() && other._chunks[j].key == a.key) {
+			const Chunk &b = other._chunks[j];
+			if (a.isBitset() && b.isBitset()) {
+				for (size_t w = 0; w < bitsetWords; ++w) {
+					a.bits[w] &= ~b.bits[w];
+				}
+			} else if (a.isBitset()) {
+				for (size_t v = 0; v < b.array.size(); ++v) {
+					a.bits[b.array[v] / 64] &= ~((uint64_t)1 << (b.array[v] % 64));
+				}
+			} else {
+				a.array.erase(std::remove_if(a.array.begin(), a.array.end(), [&] (uint16_t v) { return b.contains(v); }), a.array.end());
+			}
+			a.optimize();
+		}
+		if (a.cardinality) {
+			if (last != i) {
+				_chunks[last] = std::move(a);
+			}
+			++last;
+		}
+	}
+	_chunks.resize(last, Chunk(0));
+	return *this;
+}
+
+size_t RoaringBitmap::intersectionCardinality(const RoaringBitmap &a, const RoaringBitmap &b)
+{
+	size_t size = 0;
+	for (size_t i = 0, j = 0; i < a._chunks.size() && j < b._chunks.size();) {
+		if (a._chunks[i].key < b._chunks[j].key) { ++i; continue; }
+		if (b._chunks[j].key < a._chunks[i].key) { ++j; continue; }
+		const Chunk &ca = a._chunks[i++];
+		const Chunk &cb = b._chunks[j++];
+		if (ca.isBitset() && cb.isBitset()) {
+			for (size_t w = 0; w < bitsetWords; ++w) {
+				size += __builtin_popcountll(ca.bits[w] & cb.bits[w]);
+			}
+		} else {
+			const Chunk &sparse = ca.isBitset() ? cb : ca;
+			const Chunk &other = ca.isBitset() ? ca : cb;
+			for (size_t v = 0; v < sparse.array.size(); ++v) {
+				size += other.contains(sparse.array[v]);
+			}
+		}
+	}
+	return size;
+}
+
+RoaringBitmap RoaringBitmap::unite(const std::vector<RoaringBitmap> &bitmaps)
+{
+	RoaringBitmap result;
+	for (size_t i = 0; i < bitmaps.size(); ++i) {
+		result |= bitmaps[i];
+	}
+	return result;
+}
+
+void RoaringBitmap::toVector(std::vector<esint> &values) const
+{
+	values.reserve(values.size() + cardinality());
+	forEach([&] (esint value) { values.push_back(value); });
+}
+
+void RoaringBitmap::toVector(esint begin, esint end, std::vector<esint> &values) const
+{
+	forEach(begin, end, [&] (esint value) { values.push_back(value); });
+}
@@ -0,0 +1,125 @@
+
+#ifndef SRC_BASIS_STRUCTURES_ROARINGBITMAP_H_
+#define SRC_BASIS_STRUCTURES_ROARINGBITMAP_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace mesio {
+
+// Compressed set of non-negative indices (roaring bitmap).
+// Indices are split into chunks of 2^16 values. Sparse chunks are stored as sorted arrays,
+// dense chunks as plain bitsets. Hence, the memory is proportional to the number of set indices
+// instead of the number of all indices times number of sets.
+class RoaringBitmap {
+	enum: size_t {
+		chunkBits = 16,
+		chunkMask = (1 << chunkBits) - 1,
+		bitsetWords = (1 << chunkBits) / 64,
+		arrayLimit = 4096
+	};
+
+	struct Chunk {
+		esint key;
+		size_t cardinality;
+		std::vector<uint16_t> array; // used if cardinality <= arrayLimit
+		std::vector<uint64_t> bits;  // used otherwise
+
+		Chunk(esint key): key(key), cardinality(0) {}
+
+		bool isBitset() const { return bits.size(); }
+		bool contains(uint16_t low) const;
+		void add(uint16_t low);
+		void toBitset();
+		void toArray();
+		void optimize();
+	};
+
+public:
+	RoaringBitmap() {}
+	RoaringBitmap(const esint *begin, const esint *end) { add(begin, end); }
+	RoaringBitmap(const std::vector<esint> &values) { add(values.data(), values.data() + values.size()); }
+
+	void add(esint value);
+	void add(const esint *begin, const esint *end);
+	void clear() { _chunks.clear(); }
+
+	bool contains(esint value) const;
+	bool empty() const { return _chunks.empty(); }
+	size_t cardinality() const;
+	size_t bytes() const;
+
+	// set algebra
+	RoaringBitmap& operator|=(const RoaringBitmap &other);
+	RoaringBitmap& operator&=(const RoaringBitmap &other);
+	RoaringBitmap& operator-=(const RoaringBitmap &other);
+
+	friend RoaringBitmap operator|(RoaringBitmap a, const RoaringBitmap &b) { return a |= b; }
+	friend RoaringBitmap operator&(RoaringBitmap a, const RoaringBitmap &b) { return a &= b; }
+	friend RoaringBitmap operator-(RoaringBitmap a, const RoaringBitmap &b) { return a -= b; }
+
+	static size_t intersectionCardinality(const RoaringBitmap &a, const RoaringBitmap &b);
+	static RoaringBitmap unite(const std::vector<RoaringBitmap> &bitmaps);
+
+	// call 'f(value)' for all values in ascending order
+	template <typename TFunction>
+	void forEach(TFunction f) const
+	{
+		for (size_t c = 0; c < _chunks.size(); ++c) {
+			iterate(_chunks[c], 0, chunkMask + 1, f);
+		}
+	}
+
+	// call 'f(value)' for all values from interval <begin, end) in ascending order
+	template <typename TFunction>
+	void forEach(esint begin, esint end, TFunction f) const
+	{
+		if (end <= begin) {
+			return;
+		}
+		for (size_t c = lowerChunk(begin >> chunkBits); c < _chunks.size() && _chunks[c].key <= ((end - 1) >> chunkBits); ++c) {
+			esint base = _chunks[c].key << chunkBits;
+			size_t lbegin = begin > base ? begin - base : 0;
+			size_t lend = end - base < (esint)chunkMask + 1 ? end - base : chunkMask + 1;
+			iterate(_chunks[c], lbegin, lend, f);
+		}
+	}
+
+	void toVector(std::vector<esint> &values) const;
+	void toVector(esint begin, esint end, std::vector<esint> &values) const;
+
+private:
+	template <typename TFunction>
+	static void iterate(const Chunk &chunk, size_t begin, size_t end, TFunction &f)
+	{
+		esint base = chunk.key << chunkBits;
+		if (chunk.isBitset()) {
+			for (size_t w = begin / 64; w < bitsetWords && 64 * w < end; ++w) {
+				uint64_t word = chunk.bits[w];
+				while (word) {
+					size_t low = 64 * w + __builtin_ctzll(word);
+					word &= word - 1;
+					if (begin <= low && low < end) {
+						f(base + (esint)low);
+					}
+				}
+			}
+		} else {
+			for (size_t i = 0; i < chunk.array.size() && chunk.array[i] < end; ++i) {
+				if (begin <= chunk.array[i]) {
+					f(base + (esint)chunk.array[i]);
+				}
+			}
+		}
+	}
+
+	size_t lowerChunk(esint key) const;
+	Chunk& chunk(esint key);
+
+	std::vector<Chunk> _chunks;
+};
+
+}
+
+#endif /* SRC_BASIS_STRUCTURES_ROARINGBITMAP_H_ */
@@ -58,6 +58,11 @@ struct DecompositionConfiguration {
 
 	bool force_continuity = 0;
 	bool separate_materials = 0, separate_regions = 0, separate_etypes = 0;
+
+	// the dual graph gathered by the sequential (or reduced) decomposer is coarsened to at most this number of vertices per root (0 disables coarsening)
+	size_t coarse_graph_size = 1000000;
+	// the maximal imbalance of partitions refined during projection to finer graphs
+	double refinement_tolerance = 1.05;
 	ParMETISConfiguration parmetis_options;
 	METISConfiguration metis_options;
 	PTScotchConfiguration ptscotch_options;
@@ -65,6 +70,11 @@ struct DecompositionConfiguration {
 	KaHIPConfiguration kahip_options;
 };
 
+struct GeneratorConfiguration {
+	int parts = 1; // parts x parts x parts disjoint cubes
+	int elements = 1; // elements x elements x elements hexahedra in each cube
+};
+
 struct InputTransformationConfiguration {
 
 	enum class TRANSFORMATION {
@@ -90,7 +100,10 @@ struct InputConfiguration {
 		ENSIGHT,
 		VTK_LEGACY,
 		NETGET,
-		NEPER
+		NEPER,
+		STL,
+		GMSH,
+		GENERATOR
 	};
 
 	enum class LOADER {
@@ -112,9 +125,15 @@ struct InputConfiguration {
 
 	LOADER loader = LOADER::POSIX;
 	size_t stripe_size = 1024 * 1024;
+	int readers = 0; // the maximal number of reading processes (0 means all processes)
+	// benchmark loaders, readers, and stripe sizes before loading and store the best setting to the database
+	// (settings stored for the input file system path are applied if the autotuning is not requested)
+	bool autotune = false;
+	std::string autotune_database; // default is $HOME/.mesio.autotune
 	int third_party_scalability_limit = 1024;
 
 	DecompositionConfiguration decomposition;
+	GeneratorConfiguration generator;
 	std::map<std::string, InputTransformationConfiguration> transformations;
 };
 
@@ -2,6 +2,9 @@
 #ifndef SRC_CONFIG_ECF_OUTPUT_H_
 #define SRC_CONFIG_ECF_OUTPUT_H_
 
+#include <string>
+#include <vector>
+
 namespace mesio {
 
 struct OutputConfiguration {
@@ -11,7 +14,8 @@ struct OutputConfiguration {
 		ENSIGHT,
 		XDMF,
 		STL_SURFACE,
-		NETGEN
+		NETGEN,
+		VTK_LEGACY_BINARY
 	};
 
 	enum class WRITER {
@@ -20,6 +24,12 @@ struct OutputConfiguration {
 		POSIX
 	};
 
+	enum class SYNC {
+		NONE,
+		DATA,
+		FULL
+	};
+
 	enum class LOGGER {
 		USER,
 		PARSER
@@ -36,10 +46,18 @@ struct OutputConfiguration {
 
 	FORMAT format = FORMAT::ENSIGHT;
 	MODE mode = MODE::SYNC;
+	size_t steps = 2; // the maximal number of steps stored by the asynchronous output at once
 
 	WRITER writer = WRITER::MPI_COLLECTIVE;
 	size_t stripe_size = 1024 * 1024, stripe_count = 1;
+	bool direct = false; // POSIX writer: O_DIRECT for aligned parts of files
+	SYNC sync = SYNC::NONE; // POSIX writer: fdatasync / fsync of stored files
 	int debug = 0;
+	// debug output is restricted to processes, elements regions, and a box [min x, y, z, max x, y, z] (empty means all)
+	std::vector<int> debug_ranks;
+	std::vector<std::string> debug_regions;
+	std::vector<double> debug_box;
+	bool change_coords = false; // EnSight: coordinates are stored in each step (change_coords_only)
 
 	std::string path = ".";
 };
@@ -1,6 +1,11 @@
 
 #include "config.h"
 
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <map>
+
 namespace mesio {
 namespace info {
 namespace config {
@@ -11,3 +16,207 @@ OutputConfiguration output;
 }
 }
 }
+
+using namespace mesio;
+
+namespace {
+
+struct Parameter {
+	std::function<bool(const std::string &value)> set;
+	std::function<std::string()> get;
+};
+
+std::string strip(const std::string &s)
+{
+	size_t begin = s.find_first_not_of(" \t\r\n"), end = s.find_last_not_of(" \t\r\n");
+	return begin == std::string::npos ? "" : s.substr(begin, end - begin + 1);
+}
+
+bool parse(const std::string &s, std::string &value) { value = s; return true; }
+bool parse(const std::string &s, bool &value)
+{
+	if (s == "1" || s == "TRUE" || s == "true") { value = true; return true; }
+	if (s == "0" || s == "FALSE" || s == "false") { value = false; return true; }
+	return false;
+}
+
+template <typename TType>
+bool parse(const std::string &s, TType &value)
+{
+	std::stringstream ss(s);
+	TType v;
+	ss >> v;
+	if (ss.fail() || !ss.eof()) {
+		return false;
+	}
+	value = v;
+	return true;
+}
+
+std::string print(const std::string &value) { return value; }
+
+template <typename TType>
+std::string print(const TType &value)
+{
+	std::stringstream ss;
+	ss << value;
+	return ss.str();
+}
+
+template <typename TType>
+Parameter value(TType &v)
+{
+	return Parameter{
+		[&v] (const std::string &s) { return parse(s, v); },
+		[&v] () { return print(v); } };
+}
+
+// enums are given by names ordered according to their values
+template <typename TType>
+Parameter option(TType &v, const std::vector<std::string> &names)
+{
+	return Parameter{
+		[&v, names] (const std::string &s) {
+			for (size_t i = 0; i < names.size(); ++i) {
+				if (names[i] == s) {
+					v = static_cast<TType>(i);
+					return true;
+				}
+			}
+			return false;
+		},
+		[&v, names] () { return names[static_cast<size_t>(v)]; } };
+}
+
+// lists are separated by commas
+template <typename TType>
+Parameter list(std::vector<TType> &v)
+{
+	return Parameter{
+		[&v] (const std::string &s) {
+			std::vector<TType> values;
+			std::stringstream ss(s);
+			std::string item;
+			while (std::getline(ss, item, ',')) {
+				values.push_back(TType());
+				if (!parse(strip(item), values.back())) {
+					return false;
+				}
+			}
+			v.swap(values);
+			return true;
+		},
+		[&v] () {
+			std::string s;
+			for (size_t i = 0; i < v.size(); ++i) {
+				s += (i ? "," : "") + print(v[i]);
+			}
+			return s; } };
+}
+
+std::map<std::string, Parameter>& table()
+{
+	static std::map<std::string, Parameter> parameters;
+	if (parameters.empty()) {
+		InputConfiguration &i = info::config::input;
+		DecompositionConfiguration &d = info::config::input.decomposition;
+		OutputConfiguration &o = info::config::output;
+
+		parameters["input.path"] = value(i.path);
+		parameters["input.format"] = option(i.format, { "ANSYS_CDB", "OPENFOAM", "ABAQUS", "XDMF", "ENSIGHT", "VTK_LEGACY", "NETGET", "NEPER", "STL", "GMSH", "GENERATOR" });
+		parameters["input.omit_midpoints"] = value(i.omit_midpoints);
+		parameters["input.insert_midpoints"] = value(i.insert_midpoints);
+		parameters["input.omit_face_sets"] = value(i.omit_face_sets);
+		parameters["input.keep_material_sets"] = value(i.keep_material_sets);
+		parameters["input.duplication_tolerance"] = value(i.duplication_tolerance);
+		parameters["input.loader"] = option(i.loader, { "MPI", "MPI_COLLECTIVE", "POSIX" });
+		parameters["input.stripe_size"] = value(i.stripe_size);
+		parameters["input.readers"] = value(i.readers);
+		parameters["input.autotune"] = value(i.autotune);
+		parameters["input.autotune_database"] = value(i.autotune_database);
+		parameters["input.third_party_scalability_limit"] = value(i.third_party_scalability_limit);
+		parameters["input.generator.parts"] = value(i.generator.parts);
+		parameters["input.generator.elements"] = value(i.generator.elements);
+
+		parameters["input.decomposition.parallel_decomposer"] = option(d.parallel_decomposer, { "NONE", "METIS", "PARMETIS", "PTSCOTCH", "HILBERT_CURVE" });
+		parameters["input.decomposition.sequential_decomposer"] = option(d.sequential_decomposer, { "NONE", "METIS", "SCOTCH", "KAHIP" });
+		parameters["input.decomposition.mesh_duplication"] = value(d.mesh_duplication);
+		parameters["input.decomposition.domains"] = value(d.domains);
+		parameters["input.decomposition.force_continuity"] = value(d.force_continuity);
+		parameters["input.decomposition.separate_materials"] = value(d.separate_materials);
+		parameters["input.decomposition.separate_regions"] = value(d.separate_regions);
+		parameters["input.decomposition.separate_etypes"] = value(d.separate_etypes);
+		parameters["input.decomposition.coarse_graph_size"] = value(d.coarse_graph_size);
+		parameters["input.decomposition.refinement_tolerance"] = value(d.refinement_tolerance);
+		parameters["input.decomposition.parmetis_options.refinement"] = value(d.parmetis_options.refinement);
+		parameters["input.decomposition.parmetis_options.tolerance"] = value(d.parmetis_options.tolerance);
+		parameters["input.decomposition.metis_options.objective_type"] = option(d.metis_options.objective_type, { "VOLUME", "EDGECUT" });
+		parameters["input.decomposition.metis_options.continuous"] = value(d.metis_options.continuous);
+
+		parameters["output.verbose_level"] = value(o.verbose_level);
+		parameters["output.measure_level"] = value(o.measure_level);
+		parameters["output.logger"] = option(o.logger, { "USER", "PARSER" });
+		parameters["output.format"] = option(o.format, { "VTK_LEGACY", "ENSIGHT", "XDMF", "STL_SURFACE", "NETGEN", "VTK_LEGACY_BINARY" });
+		parameters["output.mode"] = option(o.mode, { "SYNC", "PTHREAD" });
+		parameters["output.steps"] = value(o.steps);
+		parameters["output.writer"] = option(o.writer, { "MPI", "MPI_COLLECTIVE", "POSIX" });
+		parameters["output.stripe_size"] = value(o.stripe_size);
+		parameters["output.stripe_count"] = value(o.stripe_count);
+		parameters["output.direct"] = value(o.direct);
+		parameters["output.sync"] = option(o.sync, { "NONE", "DATA", "FULL" });
+		parameters["output.debug"] = value(o.debug);
+		parameters["output.debug_ranks"] = list(o.debug_ranks);
+		parameters["output.debug_regions"] = list(o.debug_regions);
+		parameters["output.debug_box"] = list(o.debug_box);
+		parameters["output.change_coords"] = value(o.change_coords);
+		parameters["output.path"] = value(o.path);
+	}
+	return parameters;
+}
+
+}
+
+bool info::config::set(const std::string &parameter, const std::string &value)
+{
+	auto p = table().find(parameter);
+	return p != table().end() && p->second.set(strip(value));
+}
+
+bool info::config::get(const std::string &parameter, std::string &value)
+{
+	auto p = table().find(parameter);
+	if (p != table().end()) {
+		value = p->second.get();
+		return true;
+	}
+	return false;
+}
+
+std::vector<std::string> info::config::parameters()
+{
+	std::vector<std::string> names;
+	for (auto p = table().begin(); p != table().end(); ++p) {
+		names.push_back(p->first);
+	}
+	return names;
+}
+
+bool info::config::read(const std::string &file, std::vector<std::pair<std::string, std::string> > &values)
+{
+	std::ifstream is(file);
+	if (!is.good()) {
+		return false;
+	}
+	std::string line;
+	while (std::getline(is, line)) {
+		line = strip(line.substr(0, line.find('#')));
+		if (line.size()) {
+			size_t eq = line.find('=');
+			if (eq == std::string::npos) {
+				return false;
+			}
+			values.push_back(std::make_pair(strip(line.substr(0, eq)), strip(line.substr(eq + 1))));
+		}
+	}
+	return true;
+}
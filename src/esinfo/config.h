@@ -5,11 +5,22 @@
 #include "config/input.h"
 #include "config/output.h"
 
+#include <string>
+#include <vector>
+
 namespace mesio {
 namespace info {
 namespace config {
 	extern InputConfiguration input;
 	extern OutputConfiguration output;
+
+	// parameters are addressed by dotted names of configuration fields, e.g., 'input.decomposition.domains'
+	bool set(const std::string &parameter, const std::string &value);
+	bool get(const std::string &parameter, std::string &value);
+	std::vector<std::string> parameters();
+
+	// read 'parameter = value' lines ('#' starts a comment)
+	bool read(const std::string &file, std::vector<std::pair<std::string, std::string> > &values);
 };
 
 }
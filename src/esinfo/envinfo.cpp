@@ -3,9 +3,68 @@
 
 #include <sstream>
 #include <cstdlib>
+#include <cstdio>
+#include <map>
+#include <vector>
 #include <omp.h>
+#include <sched.h>
+#include <dirent.h>
 
 int mesio::info::env::threads = 1;
+int mesio::info::env::hugepages = 0;
+int mesio::info::env::pinning = 0;
+char* mesio::info::env::trace = NULL;
+
+// cores allowed for the process (stored before threads are pinned)
+static std::vector<int> cores;
+
+static void allowedCores()
+{
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed)) {
+		return;
+	}
+	for (int core = 0; core < CPU_SETSIZE; ++core) {
+		if (CPU_ISSET(core, &allowed)) {
+			cores.push_back(core);
+		}
+	}
+}
+
+static void pinThreads()
+{
+	if (cores.empty()) {
+		return;
+	}
+
+	// threads are spread evenly over allowed cores (consecutive threads share a NUMA node)
+	#pragma omp parallel
+	{
+		int t = omp_get_thread_num();
+		cpu_set_t core;
+		CPU_ZERO(&core);
+		CPU_SET(cores[(size_t)t * cores.size() / omp_get_num_threads()], &core);
+		sched_setaffinity(0, sizeof(cpu_set_t), &core);
+	}
+}
+
+static int numaNode(int cpu)
+{
+	std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+	DIR *dir = opendir(path.c_str());
+	if (dir == NULL) {
+		return 0;
+	}
+	int node = 0;
+	for (dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+		if (sscanf(entry->d_name, "node%d", &node) == 1) {
+			break;
+		}
+	}
+	closedir(dir);
+	return node;
+}
 
 void mesio::info::env::set()
 {
@@ -19,8 +78,15 @@ void mesio::info::env::set()
 	};
 
 	getEnv(threads, "threads");
+	getEnv(hugepages, "hugepages");
+	getEnv(pinning, "pinning");
+	trace = getenv("trace");
 
 	omp_set_num_threads(threads);
+	allowedCores();
+	if (pinning) {
+		pinThreads();
+	}
 }
 
 char* mesio::info::env::pwd()
@@ -28,4 +94,41 @@ char* mesio::info::env::pwd()
 	return getenv("PWD");
 }
 
+std::string mesio::info::env::numaPlacement()
+{
+	std::vector<int> cpus(threads);
+	#pragma omp parallel for
+	for (int t = 0; t < threads; t++) {
+		cpus[t] = sched_getcpu();
+	}
+
+	std::map<int, int> nodes;
+	for (int t = 0; t < threads; t++) {
+		++nodes[numaNode(cpus[t])];
+	}
 
+	std::string placement;
+	for (auto node = nodes.begin(); node != nodes.end(); ++node) {
+		placement += (placement.size() ? " " : "") + std::to_string(node->first) + ":" + std::to_string(node->second);
+	}
+	return placement;
+}
+
+int mesio::info::env::freeCore()
+{
+	if (cores.empty()) {
+		return -1;
+	}
+	std::vector<int> used(cores.size(), 0);
+	if (pinning) {
+		for (int t = 0; t < threads; t++) {
+			used[(size_t)t * cores.size() / threads] = 1;
+		}
+	}
+	for (size_t c = cores.size(); c > 0; --c) {
+		if (!used[c - 1]) {
+			return cores[c - 1];
+		}
+	}
+	return cores.back();
+}
@@ -2,14 +2,25 @@
 #ifndef SRC_ESINFO_ENVINFO_H_
 #define SRC_ESINFO_ENVINFO_H_
 
+#include <string>
+
 namespace mesio {
 namespace info {
 namespace env {
 
 	extern int threads;
+	extern int hugepages; // back large arrays by transparent huge pages
+	extern int pinning;   // pin threads to cores allowed for the process
+	extern char* trace;   // file with spans in Chrome trace format (NULL = no tracing)
 
 	void set();
 	char* pwd();
+
+	// NUMA nodes of OpenMP threads in the form 'node:threads' (e.g. '0:32 1:32')
+	std::string numaPlacement();
+
+	// the last core allowed for the process that is not used by pinned OpenMP threads (-1 = unknown)
+	int freeCore();
 }
 }
 }
@@ -101,9 +101,14 @@ void printRunInfo(int *argc, char ***argv)
 	eslog::info(" == COMMAND  %*s == \n", width, cmd.c_str());
 	eslog::info(" == MPI_COMM_WORLD %*d == \n", width - 6, info::mpi::size);
 	eslog::info(" == OMP_NUM_THREADS %*d == \n", width - 7, info::env::threads);
+	eslog::info(" == NUMA NODES [NODE:THREADS] %*s == \n", width - 17, info::env::numaPlacement().c_str());
+	eslog::info(" == THREADS PINNING / HUGE PAGES %*s == \n", width - 20, (std::string(info::env::pinning ? "PINNED" : "OS") + " / " + (info::env::hugepages ? "ON" : "OFF")).c_str());
 	eslog::info(" ==    -   -   -   -   -   -   -   -   -   -   -   -   -   -   -   -   -   -   -   -   -    == \n");
 	eslog::info(" == NUMBER OF LOADERS %*d == \n", width - 9, MPITools::subset->acrosssize);
 	eslog::info(" == NUMBER OF WRITTERS %*d == \n", width - 10, MPITools::subset->acrosssize);
+	std::string loader;
+	info::config::get("input.loader", loader);
+	eslog::info(" == LOADER / STRIPE SIZE %*s == \n", width - 12, (loader + " / " + std::to_string(info::config::input.stripe_size)).c_str());
 	switch (info::config::output.mode) {
 	case OutputConfiguration::MODE::SYNC  : eslog::info(" == STORING MODE %*s == \n", width - 4, "SYNCHRONIZED"); break;
 	case OutputConfiguration::MODE::PTHREAD: eslog::info(" == STORING MODE %*s == \n", width - 4, "SEPARETED P-THREAD"); break;
@@ -5,6 +5,7 @@
 
 #include "basis/containers/serializededata.h"
 #include "basis/structures/kdtree.h"
+#include "basis/structures/roaringbitmap.h"
 #include "wrappers/mpi/communication.h"
 #include "basis/utilities/utils.h"
 #include "basis/utilities/parser.h"
@@ -205,6 +206,7 @@ void Input::balance()
 			info::mpi::size * 4 +
 			_meshData.nIDs.size() * (1 + sizeof(Point) / sizeof(esint)) +
 			_meshData.eIDs.size() * 5 + _meshData.esize.size() + // ID, size, body, material, type
+			(_ndata.size() + _edata.size()) * sizeof(double) / sizeof(esint) +
 			info::mpi::size // enodes size
 			);
 	auto nit = npermutation.begin();
@@ -227,6 +229,9 @@ void Input::balance()
 		for (auto n = nbegin; n != nit; ++n) {
 			sBuffer.insert(sBuffer.end(), reinterpret_cast<esint*>(_meshData.coordinates.data() + *n), reinterpret_cast<esint*>(_meshData.coordinates.data() + *n + 1));
 		}
+		for (auto n = nbegin; n != nit; ++n) {
+			sBuffer.insert(sBuffer.end(), reinterpret_cast<esint*>(_ndata.data() + *n * _ndatasize), reinterpret_cast<esint*>(_ndata.data() + (*n + 1) * _ndatasize));
+		}
 
 		for (auto e = ebegin; e != eit; ++e) {
 			sBuffer.push_back(_meshData.eIDs[*e]);
@@ -249,6 +254,9 @@ void Input::balance()
 		for (auto e = ebegin; e != eit; ++e) {
 			sBuffer.push_back(_meshData.body[*e]);
 		}
+		for (auto e = ebegin; e != eit; ++e) {
+			sBuffer.insert(sBuffer.end(), reinterpret_cast<esint*>(_edata.data() + *e * _edatasize), reinterpret_cast<esint*>(_edata.data() + (*e + 1) * _edatasize));
+		}
 		sBuffer[tsize] = sBuffer.size() - tsize;
 	}
 
@@ -265,6 +273,8 @@ void Input::balance()
 	_meshData.etype.clear();
 	_meshData.material.clear();
 	_meshData.body.clear();
+	_ndata.clear();
+	_edata.clear();
 
 	size_t offset = 0;
 	for (int r = 0; r < info::mpi::size; ++r) {
@@ -277,6 +287,8 @@ void Input::balance()
 		offset += nsize;
 		_meshData.coordinates.insert(_meshData.coordinates.end(), reinterpret_cast<Point*>(rBuffer.data() + offset), reinterpret_cast<Point*>(rBuffer.data() + offset + nsize * sizeof(Point) / sizeof(esint)));
 		offset += nsize * sizeof(Point) / sizeof(esint);
+		_ndata.insert(_ndata.end(), reinterpret_cast<double*>(rBuffer.data() + offset), reinterpret_cast<double*>(rBuffer.data() + offset + nsize * _ndatasize * sizeof(double) / sizeof(esint)));
+		offset += nsize * _ndatasize * sizeof(double) / sizeof(esint);
 
 		_meshData.eIDs.insert(_meshData.eIDs.end(), rBuffer.begin() + offset, rBuffer.begin() + offset + esize);
 		offset += esize;
@@ -291,6 +303,8 @@ void Input::balance()
 		offset += esize;
 		_meshData.body.insert(_meshData.body.end(), rBuffer.begin() + offset, rBuffer.begin() + offset + esize);
 		offset += esize;
+		_edata.insert(_edata.end(), reinterpret_cast<double*>(rBuffer.data() + offset), reinterpret_cast<double*>(rBuffer.data() + offset + esize * _edatasize * sizeof(double) / sizeof(esint)));
+		offset += esize * _edatasize * sizeof(double) / sizeof(esint);
 	}
 
 	sortNodes();
@@ -523,7 +537,9 @@ void Input::sortNodes(bool withElementNodes)
 
 	std::sort(_meshData.nIDs.begin(), _meshData.nIDs.end());
 	utils::permute(_meshData.coordinates, permutation);
-	utils::permute(_nregions, permutation, _nregsize);
+	if (_ndatasize) {
+		utils::permute(_ndata, permutation, _ndatasize);
+	}
 
 	if (_meshData._nranks.size()) {
 		std::vector<esint> npermutation(_meshData._nranks.size());
@@ -596,7 +612,9 @@ void Input::sortElements(const std::vector<esint> &permutation)
 	utils::permute(_meshData.body, permutation);
 	utils::permute(_meshData.etype, permutation);
 	utils::permute(_meshData.material, permutation);
-	utils::permute(_eregions, permutation, _eregsize);
+	if (_edatasize) {
+		utils::permute(_edata, permutation, _edatasize);
+	}
 
 	std::vector<esint> npermutation(_meshData.enodes.size());
 	for (size_t i = 0, index = 0; i < permutation.size(); i++) {
@@ -609,14 +627,8 @@ void Input::sortElements(const std::vector<esint> &permutation)
 }
 
 
-void Input::assignRegions(
-		std::map<std::string, std::vector<esint> > &regions, std::vector<esint> &IDs,
-		std::vector<esint> &distribution,
-		size_t &rsize, std::vector<esint> &rbits)
+void Input::assignRegions(std::map<std::string, std::vector<esint> > &regions, std::vector<esint> &distribution, std::vector<RoaringBitmap> &members)
 {
-	rsize = regions.size() / (8 * sizeof(esint)) + 1;
-	rbits.resize(rsize * IDs.size());
-
 	std::vector<esint> sBuffer, rBuffer;
 	std::vector<std::vector<esint>::const_iterator> rend;
 	for (auto region = regions.begin(); region != regions.end(); ++region) {
@@ -654,27 +666,21 @@ void Input::assignRegions(
 		eslog::internalFailure("assign regions.\n");
 	}
 
+	members.clear();
+	members.resize(regions.size());
 	size_t offset = 0;
 	for (int t = 0; t < info::mpi::size; t++) {
 		++offset; // total size
 		++offset; // target
 
-		size_t r = 0;
-		for (auto region = regions.begin(); region != regions.end(); ++region, ++r) {
-			esint byte = r / (8 * sizeof(esint));
-			esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-
-			if (rBuffer[offset]) {
-				auto id = std::lower_bound(IDs.begin(), IDs.end(), rBuffer[offset + 1]);
-				for (esint i = 0; i < rBuffer[offset]; ++i) {
-					if (rBuffer[offset + 1 + i] < 0) { // end of interval
-						for (esint ii = rBuffer[offset + 1 + i - 1]; ii <= -rBuffer[offset + 1 + i]; ++ii, ++id) {
-							rbits[rsize * (id - IDs.begin()) + byte] |= bit;
-						}
-					} else {
-						while (rBuffer[offset + 1 + i] != *id) { ++id; }
-						rbits[rsize * (id - IDs.begin()) + byte] |= bit;
+		for (size_t r = 0; r < regions.size(); ++r) {
+			for (esint i = 0; i < rBuffer[offset]; ++i) {
+				if (rBuffer[offset + 1 + i] < 0) { // end of interval
+					for (esint id = rBuffer[offset + 1 + i - 1] + 1; id <= -rBuffer[offset + 1 + i]; ++id) {
+						members[r].add(id);
 					}
+				} else {
+					members[r].add(rBuffer[offset + 1 + i]);
 				}
 			}
 			offset += rBuffer[offset] + 1;
@@ -686,22 +692,109 @@ void Input::assignRegions(
 	}
 }
 
-void Input::fillRegions(std::map<std::string, std::vector<esint> > &regions, size_t &rsize, std::vector<esint> &rbits)
+void Input::fillRegions(std::map<std::string, std::vector<esint> > &regions, const std::vector<esint> &IDs, std::vector<RoaringBitmap> &members)
 {
+	// members are IDs, regions are filled by local offsets
+	std::vector<esint> permutation(IDs.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	if (!std::is_sorted(IDs.begin(), IDs.end())) {
+		std::sort(permutation.begin(), permutation.end(), [&] (esint i, esint j) { return IDs[i] < IDs[j]; });
+	}
+
 	size_t r = 0;
 	for (auto region = regions.begin(); region != regions.end(); ++region, ++r) {
-		esint byte = r / (8 * sizeof(esint));
-		esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-
 		region->second.clear();
-		for (size_t i = 0; i < rbits.size() / rsize; ++i) {
-			if (rbits[rsize * i + byte] & bit) {
-				region->second.push_back(i);
-			}
+		auto p = permutation.cbegin();
+		members[r].forEach([&] (esint id) {
+			while (p != permutation.cend() && IDs[*p] < id) { ++p; }
+			while (p != permutation.cend() && IDs[*p] == id) { region->second.push_back(*p++); }
+		});
+		std::sort(region->second.begin(), region->second.end());
+	}
+}
+
+void Input::packRegions(const std::vector<RoaringBitmap> &members, const std::vector<esint> &IDs, std::vector<esint> &buffer)
+{
+	// [regions, (region, size, members of the region from IDs), ...]
+	size_t prevsize = buffer.size();
+	buffer.push_back(0);
+	if (members.empty() || IDs.empty()) {
+		return;
+	}
+	RoaringBitmap send(IDs);
+	for (size_t r = 0; r < members.size(); ++r) {
+		RoaringBitmap rsend = members[r] & send;
+		if (!rsend.empty()) {
+			++buffer[prevsize];
+			buffer.push_back(r);
+			buffer.push_back(rsend.cardinality());
+			rsend.toVector(buffer);
 		}
 	}
 }
 
+size_t Input::unpackRegions(std::vector<RoaringBitmap> &members, const std::vector<esint> &buffer, size_t offset)
+{
+	if (buffer.size() <= offset) {
+		return offset;
+	}
+	esint regions = buffer[offset++];
+	for (esint i = 0; i < regions; ++i) {
+		esint r = buffer[offset], size = buffer[offset + 1];
+		members[r].add(buffer.data() + offset + 2, buffer.data() + offset + 2 + size);
+		offset += 2 + size;
+	}
+	return offset;
+}
+
+void Input::mergeRegions(std::vector<RoaringBitmap> &members, esint id, esint target)
+{
+	for (size_t r = 0; r < members.size(); ++r) {
+		if (members[r].contains(id)) {
+			members[r].add(target);
+		}
+	}
+}
+
+void Input::packData()
+{
+	size_t threads = info::env::threads;
+
+	// values of all fields are interleaved in order to be moved together with nodes (elements)
+	auto pack = [&] (std::map<std::string, MeshData::Field> &fields, size_t size, size_t &datasize, std::vector<double> &data) {
+		datasize = 0;
+		for (auto f = fields.begin(); f != fields.end(); ++f) {
+			if (f->second.values.size() != f->second.dimension * size) {
+				eslog::internalFailure("invalid number of values of field '%s'.\n", f->first.c_str());
+			}
+			datasize += f->second.dimension;
+		}
+		size_t sizes[2] = { datasize, fields.size() }, max[2];
+		Communication::allReduce(sizes, max, 2, MPITools::getType<size_t>().mpitype, MPI_MAX);
+		if (sizes[0] != max[0] || sizes[1] != max[1]) {
+			eslog::internalFailure("processes have different fields.\n");
+		}
+
+		data.resize(datasize * size);
+		std::vector<size_t> distribution = tarray<size_t>::distribute(threads, size);
+		size_t offset = 0;
+		for (auto f = fields.begin(); f != fields.end(); offset += f->second.dimension, ++f) {
+			#pragma omp parallel for
+			for (size_t t = 0; t < threads; t++) {
+				for (size_t i = distribution[t]; i < distribution[t + 1]; ++i) {
+					for (int d = 0; d < f->second.dimension; ++d) {
+						data[datasize * i + offset + d] = f->second.values[f->second.dimension * i + d];
+					}
+				}
+			}
+			std::vector<double>().swap(f->second.values);
+		}
+	};
+
+	pack(_meshData.ndata, _meshData.nIDs.size(), _ndatasize, _ndata);
+	pack(_meshData.edata, _meshData.eIDs.size(), _edatasize, _edata);
+}
+
 void Input::fillNodes()
 {
 	size_t threads = info::env::threads;
@@ -798,6 +891,36 @@ void Input::fillElements()
 	std::iota(info::mesh->elementsRegions.back()->elements->datatarray().begin(), info::mesh->elementsRegions.back()->elements->datatarray().end(), 0);
 }
 
+void Input::fillData()
+{
+	size_t threads = info::env::threads;
+	size_t estart = info::mesh->dimension == 3 ? 0 : 1;
+
+	auto unpack = [&] (NamedData *field, size_t size, size_t datasize, size_t offset, const std::vector<double> &data) {
+		std::vector<size_t> distribution = tarray<size_t>::distribute(threads, size);
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			for (size_t i = distribution[t]; i < distribution[t + 1]; ++i) {
+				for (int d = 0; d < field->dimension; ++d) {
+					field->data[field->dimension * i + d] = data[datasize * i + offset + d];
+				}
+			}
+		}
+	};
+
+	size_t offset = 0;
+	for (auto f = _meshData.ndata.begin(); f != _meshData.ndata.end(); offset += f->second.dimension, ++f) {
+		unpack(info::mesh->nodes->appendData(f->second.dimension, f->second.type, f->first), info::mesh->nodes->size, _ndatasize, offset, _ndata);
+	}
+	offset = 0;
+	for (auto f = _meshData.edata.begin(); f != _meshData.edata.end(); offset += f->second.dimension, ++f) {
+		// only elements with the mesh dimension are stored in the element store
+		unpack(info::mesh->elements->appendData(f->second.dimension, f->second.type, f->first), _etypeDistribution[estart], _edatasize, offset, _edata);
+	}
+	std::vector<double>().swap(_ndata);
+	std::vector<double>().swap(_edata);
+}
+
 void Input::fillNeighbors()
 {
 	std::vector<int> realnranks = _meshData._nranks;
@@ -1037,7 +1160,7 @@ void Input::removeDuplicateElements()
 		}
 	}
 
-	std::vector<std::vector<esint> > sBuffer(info::mesh->neighbors.size()), rBuffer(info::mesh->neighbors.size());
+	std::vector<std::vector<esint> > sBuffer(info::mesh->neighbors.size()), rBuffer(info::mesh->neighbors.size()), sIDs(info::mesh->neighbors.size());
 
 	if (info::mesh->neighbors.size()) { // duplicated elements have to have all nodes held by other rank
 		for (esint e = 0; e < _etypeDistribution[estart]; ++e) {
@@ -1061,13 +1184,20 @@ void Input::removeDuplicateElements()
 					for (esint n = _meshData._edist[e]; n < _meshData._edist[e + 1]; ++n) {
 							sBuffer[roffset].push_back(_meshData.nIDs[_meshData.enodes[n]]);
 					}
-					for (size_t n = 0; n < _eregsize; ++n) {
-						sBuffer[roffset].push_back(_eregions[_eregsize * e + n]);
-					}
+					sBuffer[roffset].push_back(_meshData.eIDs[e]);
 					sBuffer[roffset].push_back(e); // save offset for removing
+					sIDs[roffset].push_back(_meshData.eIDs[e]);
 				}
 			}
 		}
+		for (size_t r = 0; r < sBuffer.size(); ++r) { // regions of sent elements are appended
+			if (sIDs[r].empty()) {
+				continue;
+			}
+			size_t prevsize = sBuffer[r].size();
+			packRegions(_eregions, sIDs[r], sBuffer[r]);
+			sBuffer[r].push_back(sBuffer[r].size() - prevsize);
+		}
 	}
 	if (!Communication::receiveUpperUnknownSize(sBuffer, rBuffer, info::mesh->neighbors)) {
 		eslog::internalFailure("cannot exchange duplicated elements.\n");
@@ -1077,8 +1207,13 @@ void Input::removeDuplicateElements()
 	sBuffer.resize(info::mesh->neighbors.size());
 
 	for (size_t r = 0; r < rBuffer.size(); ++r) {
+		if (rBuffer[r].empty()) {
+			continue;
+		}
+		size_t rsize = rBuffer[r].size() - 1 - rBuffer[r].back();
+		unpackRegions(_eregions, rBuffer[r], rsize);
 		size_t i = 0;
-		while (i < rBuffer[r].size()) {
+		while (i < rsize) {
 			for (esint n = 0; n < rBuffer[r][i]; ++n) {
 				rBuffer[r][i + 1 + n] = std::lower_bound(_meshData.nIDs.begin(), _meshData.nIDs.end(), rBuffer[r][i + 1 + n]) - _meshData.nIDs.begin();
 			}
@@ -1090,13 +1225,11 @@ void Input::removeDuplicateElements()
 			if (eit != permutation.end()) {
 				edata<esint> e(_meshData.enodes.data(), _meshData._edist[*eit], _meshData._edist[*eit + 1]);
 				if (e == other) {
-					for (size_t n = 0; n < _eregsize; ++n) {
-						_eregions[*eit * _eregsize + n] |= rBuffer[r][i + 1 + rBuffer[r][i] + n];
-					}
-					sBuffer[r].push_back(rBuffer[r][i + 1 + rBuffer[r][i] + _eregsize]);
+					mergeRegions(_eregions, rBuffer[r][i + 1 + rBuffer[r][i]], _meshData.eIDs[*eit]);
+					sBuffer[r].push_back(rBuffer[r][i + 1 + rBuffer[r][i] + 1]);
 				}
 			}
-			i += 1 + rBuffer[r][i] + _eregsize + 1;
+			i += 1 + rBuffer[r][i] + 2;
 		}
 	}
 
@@ -1131,21 +1264,13 @@ void Input::removeDuplicateElements()
 			for (esint n = 0; n < _meshData.esize[last]; ++n) {
 				_meshData.enodes[lastn + n] = _meshData.enodes[_meshData._edist[e] + n];
 			}
-			if (_eregions.size()) {
-				for (size_t n = 0; n < _eregsize; ++n) {
-					_eregions[_eregsize * last + n] = _eregions[_eregsize * e + n];
-				}
+			for (size_t n = 0; n < _edatasize; ++n) {
+				_edata[_edatasize * last + n] = _edata[_edatasize * e + n];
 			}
 			lastn += _meshData.esize[last++];
 		} else {
-			if (_eregions.size() && remove->target != -1) {
-				auto tit = std::lower_bound(_meshData.eIDs.begin(), _meshData.eIDs.begin() + last, remove->target);
-				if (tit != _meshData.eIDs.begin() + last && *tit == remove->target) {
-					size_t target = tit - _meshData.eIDs.begin();
-					for (size_t n = 0; n < _eregsize; ++n) {
-						_eregions[_eregsize * target + n] |= _eregions[_eregsize * e + n];
-					}
-				}
+			if (remove->target != -1) {
+				mergeRegions(_eregions, remove->id, remove->target);
 			}
 		}
 	}
@@ -1156,9 +1281,7 @@ void Input::removeDuplicateElements()
 	_meshData.material.resize(last);
 	_meshData.enodes.resize(lastn);
 	_meshData._edist.clear();
-	if (_eregions.size()) {
-		_eregions.resize(_eregsize * last);
-	}
+	_edata.resize(_edatasize * last);
 	for (auto it = _etypeDistribution.begin(); it != _etypeDistribution.end(); ++it) {
 		*it -= _meshData._duplicateElements.size();
 	}
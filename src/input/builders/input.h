@@ -3,6 +3,7 @@
 #define SRC_INPUT_INPUT_H_
 
 #include "input/meshbuilder.h"
+#include "basis/structures/roaringbitmap.h"
 
 #include <cstddef>
 #include <string>
@@ -15,7 +16,7 @@ class Input {
 
 protected:
 	Input(MeshBuilder &meshData)
-	: _meshData(meshData), _eregsize(1), _nregsize(1) {}
+	: _meshData(meshData), _edatasize(0), _ndatasize(0) {}
 
 	void clip();
 
@@ -25,18 +26,22 @@ protected:
 	void balanceElements();
 	void balancePermutedElements();
 
-	void assignRegions(
-			std::map<std::string, std::vector<esint> > &regions, std::vector<esint> &IDs,
-			std::vector<esint> &distribution,
-			size_t &rsize, std::vector<esint> &rbits);
-	void fillRegions(std::map<std::string, std::vector<esint> > &regions, size_t &rsize, std::vector<esint> &rbits);
+	void assignRegions(std::map<std::string, std::vector<esint> > &regions, std::vector<esint> &distribution, std::vector<RoaringBitmap> &members);
+	void fillRegions(std::map<std::string, std::vector<esint> > &regions, const std::vector<esint> &IDs, std::vector<RoaringBitmap> &members);
+
+	static void packRegions(const std::vector<RoaringBitmap> &members, const std::vector<esint> &IDs, std::vector<esint> &buffer);
+	static size_t unpackRegions(std::vector<RoaringBitmap> &members, const std::vector<esint> &buffer, size_t offset = 0);
+	static void mergeRegions(std::vector<RoaringBitmap> &members, esint id, esint target);
 
 	void sortNodes(bool withElementNodes = false);
 	void sortElements();
 	void sortElements(const std::vector<esint> &permutation);
 
+	void packData();
+
 	void fillNodes();
 	void fillElements();
+	void fillData();
 	void fillNeighbors();
 
 	void fillNodeRegions();
@@ -55,8 +60,11 @@ protected:
 	MeshBuilder &_meshData;
 	std::vector<esint> _nDistribution, _eDistribution, _etypeDistribution;
 
-	size_t _eregsize, _nregsize;
-	std::vector<esint> _eregions, _nregions;
+	// members (element or node IDs) of each region in the order of the regions map
+	std::vector<RoaringBitmap> _eregions, _nregions;
+
+	size_t _edatasize, _ndatasize; // the number of fields values per element (node)
+	std::vector<double> _edata, _ndata;
 };
 
 }
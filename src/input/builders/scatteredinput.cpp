@@ -1,5 +1,6 @@
 
 #include "scatteredinput.h"
+#include "basis/containers/arena.h"
 #include "basis/containers/serializededata.h"
 #include "basis/utilities/utils.h"
 #include "wrappers/mpi/communication.h"
@@ -30,11 +31,12 @@ ScatteredInput::ScatteredInput(MeshBuilder &meshData)
 
 	eslog::startln("BUILDER: BUILD SCATTERED MESH", "BUILDER");
 
+	packData();
 	balance();
 	eslog::checkpointln("BUILDER: DATA BALANCED");
 
-	assignRegions(_meshData.eregions, _meshData.eIDs, _eDistribution, _eregsize, _eregions);
-	assignRegions(_meshData.nregions, _meshData.nIDs, _nDistribution, _nregsize, _nregions);
+	assignRegions(_meshData.eregions, _eDistribution, _eregions);
+	assignRegions(_meshData.nregions, _nDistribution, _nregions);
 	eslog::checkpointln("BUILDER: REGION ASSIGNED");
 
 //	reindexRegions();
@@ -80,6 +82,9 @@ ScatteredInput::ScatteredInput(MeshBuilder &meshData)
 	fillElements();
 	eslog::checkpointln("BUILDER: ELEMENTS SORTED");
 
+	fillData();
+	eslog::checkpointln("BUILDER: DATA FILLED");
+
 	if (info::mesh->nodes->elements == NULL) {
 		mesh::linkNodesAndElements(info::mesh->elements, info::mesh->nodes, info::mesh->neighbors);
 	}
@@ -87,8 +92,8 @@ ScatteredInput::ScatteredInput(MeshBuilder &meshData)
 	exchangeBoundary();
 	eslog::checkpointln("BUILDER: BOUNDARY EXCHANGED");
 
-	fillRegions(_meshData.eregions, _eregsize, _eregions);
-	fillRegions(_meshData.nregions, _nregsize, _nregions);
+	fillRegions(_meshData.eregions, _meshData.eIDs, _eregions);
+	fillRegions(_meshData.nregions, _meshData.nIDs, _nregions);
 	fillElementRegions();
 	fillBoundaryRegions();
 	fillNodeRegions();
@@ -236,8 +241,6 @@ void ScatteredInput::assignEBuckets()
 
 void ScatteredInput::clusterize()
 {
-	size_t threads = info::env::threads;
-
 	if (!_meshData._edist.size()) {
 		_meshData._edist = { 0 };
 		_meshData._edist.reserve(_meshData.esize.size() + 1);
@@ -262,46 +265,14 @@ void ScatteredInput::clusterize()
 
 	_bucketsBorders.back() = _sfc.buckets(_sfc.depth());
 
-	_nregsize = _meshData.nregions.size() / (8 * sizeof(esint)) + 1;
-	_eregsize = _meshData.eregions.size() / (8 * sizeof(esint)) + 1;
-
-	_nregions.resize(_nregsize * _meshData.nIDs.size());
-	_eregions.resize(_eregsize * _meshData.eIDs.size());
-
-	size_t r = 0;
-	for (auto nregion = _meshData.nregions.begin(); nregion != _meshData.nregions.end(); ++nregion, ++r) {
-		esint byte = r / (8 * sizeof(esint));
-		esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-
-		std::vector<size_t> rdistribution = tarray<size_t>::distribute(threads, nregion->second.size());
-		#pragma omp parallel for
-		for (size_t t = 0; t < threads; t++) {
-			for (size_t i = rdistribution[t]; i < rdistribution[t + 1]; ++i) {
-				_nregions[_nregsize * nregion->second[i] + byte] |= bit;
-			}
-		}
-	}
-	r = 0;
-	for (auto eregion = _meshData.eregions.begin(); eregion != _meshData.eregions.end(); ++eregion, ++r) {
-		esint byte = r / (8 * sizeof(esint));
-		esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-
-		std::vector<size_t> rdistribution = tarray<size_t>::distribute(threads, eregion->second.size());
-		#pragma omp parallel for
-		for (size_t t = 0; t < threads; t++) {
-			for (size_t i = rdistribution[t]; i < rdistribution[t + 1]; ++i) {
-				_eregions[_eregsize * eregion->second[i] + byte] |= bit;
-			}
-		}
-	}
-
-	std::vector<esint> sBuffer, rBuffer;
+	std::vector<esint> sBuffer, rBuffer, sIDs;
 	sBuffer.reserve(
 			5 * info::mpi::size +
-			// esize, eID, etype, body, material, regions
-			(5 + _eregsize) * _meshData.esize.size() +
+			// esize, eID, etype, body, material
+			5 * _meshData.esize.size() +
 			_meshData.enodes.size() +
-			(1 + _nregsize) * _meshData.nIDs.size() +
+			_meshData.nIDs.size() +
+			(_ndata.size() + _edata.size()) * sizeof(double) / sizeof(esint) +
 			_meshData.coordinates.size() * sizeof(Point) / sizeof(esint));
 
 	size_t prevsize;
@@ -322,20 +293,33 @@ void ScatteredInput::clusterize()
 			sBuffer.push_back(_meshData.etype[*e]);
 			sBuffer.push_back(_meshData.body[*e]);
 			sBuffer.push_back(_meshData.material[*e]);
-			sBuffer.insert(sBuffer.end(), _eregions.begin() + *e * _eregsize, _eregions.begin() + (*e + 1) * _eregsize);
+			sBuffer.insert(sBuffer.end(), reinterpret_cast<const esint*>(_edata.data() + *e * _edatasize), reinterpret_cast<const esint*>(_edata.data() + (*e + 1) * _edatasize));
 			sBuffer.insert(sBuffer.end(), _meshData.enodes.begin() + _meshData._edist[*e], _meshData.enodes.begin() + _meshData._edist[*e + 1]);
 			sBuffer[prevsize + 3] += _meshData._edist[*e + 1] - _meshData._edist[*e];
 		}
 		sBuffer[prevsize + 2] = e - ebegin;
-		ebegin = e;
 
 		auto n = nbegin;
 		for ( ; n != npermutation.end() && _nBuckets[*n] < _bucketsBorders[r + 1]; ++n) {
 			sBuffer.push_back(_meshData.nIDs[*n]);
 			sBuffer.insert(sBuffer.end(), reinterpret_cast<const esint*>(_meshData.coordinates.data() + *n), reinterpret_cast<const esint*>(_meshData.coordinates.data() + *n + 1));
-			sBuffer.insert(sBuffer.end(), _nregions.begin() + *n * _nregsize, _nregions.begin() + (*n + 1) * _nregsize);
+			sBuffer.insert(sBuffer.end(), reinterpret_cast<const esint*>(_ndata.data() + *n * _ndatasize), reinterpret_cast<const esint*>(_ndata.data() + (*n + 1) * _ndatasize));
 		}
 		sBuffer[prevsize + 4] = n - nbegin;
+
+		sIDs.clear();
+		for (auto it = ebegin; it != e; ++it) {
+			sIDs.push_back(_meshData.eIDs[*it]);
+		}
+		std::sort(sIDs.begin(), sIDs.end());
+		packRegions(_eregions, sIDs, sBuffer);
+		sIDs.clear();
+		for (auto it = nbegin; it != n; ++it) {
+			sIDs.push_back(_meshData.nIDs[*it]);
+		}
+		std::sort(sIDs.begin(), sIDs.end());
+		packRegions(_nregions, sIDs, sBuffer);
+		ebegin = e;
 		nbegin = n;
 
 		sBuffer[prevsize] = sBuffer.size() - prevsize;
@@ -352,11 +336,17 @@ void ScatteredInput::clusterize()
 	_meshData.material.clear();
 	_meshData.enodes.clear();
 	_meshData._edist.clear();
-	_eregions.clear();
+	_edata.clear();
+	for (size_t r = 0; r < _eregions.size(); ++r) {
+		_eregions[r].clear();
+	}
 
 	_meshData.nIDs.swap(_nIDs); // keep for later usage in linkup phase
 	_meshData.coordinates.clear();
-	_nregions.clear();
+	_ndata.clear();
+	for (size_t r = 0; r < _nregions.size(); ++r) {
+		_nregions[r].clear();
+	}
 
 	size_t offset = 0;
 	Point point;
@@ -373,8 +363,9 @@ void ScatteredInput::clusterize()
 			_meshData.etype.push_back(rBuffer[offset++]);
 			_meshData.body.push_back(rBuffer[offset++]);
 			_meshData.material.push_back(rBuffer[offset++]);
-			_eregions.insert(_eregions.end(), rBuffer.begin() + offset, rBuffer.begin() + offset + _eregsize);
-			offset += _eregsize;
+			_edata.resize(_edata.size() + _edatasize);
+			memcpy(_edata.data() + _edata.size() - _edatasize, rBuffer.data() + offset, _edatasize * sizeof(double));
+			offset += _edatasize * sizeof(double) / sizeof(esint);
 			_meshData.enodes.insert(_meshData.enodes.end(), rBuffer.begin() + offset, rBuffer.begin() + offset + _meshData.esize.back());
 			offset += _meshData.esize.back();
 		}
@@ -384,9 +375,12 @@ void ScatteredInput::clusterize()
 			memcpy(reinterpret_cast<void*>(&point), rBuffer.data() + offset, sizeof(Point));
 			_meshData.coordinates.push_back(point);
 			offset += sizeof(Point) / sizeof(esint);
-			_nregions.insert(_nregions.end(), rBuffer.begin() + offset, rBuffer.begin() + offset + _nregsize);
-			offset += _nregsize;
+			_ndata.resize(_ndata.size() + _ndatasize);
+			memcpy(_ndata.data() + _ndata.size() - _ndatasize, rBuffer.data() + offset, _ndatasize * sizeof(double));
+			offset += _ndatasize * sizeof(double) / sizeof(esint);
 		}
+		offset = unpackRegions(_eregions, rBuffer, offset);
+		offset = unpackRegions(_nregions, rBuffer, offset);
 	}
 
 //	if (!_meshData.eIDs.size()) {
@@ -494,9 +488,20 @@ void ScatteredInput::mergeDuplicatedNodes()
 		toneighs[t].swap(tneighs);
 	}
 
-	std::vector<esint> offsets, ids, regions;
+	std::vector<esint> offsets, ids;
 	std::vector<Point> coordinates;
-	std::vector<std::vector<esint> > sBuffer(_sfcNeighbors.size()), rBuffer(_sfcNeighbors.size());
+	std::vector<double> values;
+	std::vector<std::vector<esint> > sBuffer(_sfcNeighbors.size()), rBuffer(_sfcNeighbors.size()), sIDs(_sfcNeighbors.size());
+	for (size_t t = 0; t < threads; t++) {
+		for (size_t i = 0; i < toneighs[t].size(); ++i) {
+			size_t ni = std::lower_bound(_sfcNeighbors.begin(), _sfcNeighbors.end(), toneighs[t][i].first) - _sfcNeighbors.begin();
+			sIDs[ni].push_back(_meshData.nIDs[toneighs[t][i].second]);
+		}
+	}
+	for (size_t n = 0; n < _sfcNeighbors.size(); ++n) { // regions of sent nodes precede nodes
+		std::sort(sIDs[n].begin(), sIDs[n].end());
+		packRegions(_nregions, sIDs[n], sBuffer[n]);
+	}
 	for (size_t t = 0; t < threads; t++) {
 		for (size_t i = 0; i < toneighs[t].size(); ++i) {
 			size_t ni = std::lower_bound(_sfcNeighbors.begin(), _sfcNeighbors.end(), toneighs[t][i].first) - _sfcNeighbors.begin();
@@ -505,17 +510,13 @@ void ScatteredInput::mergeDuplicatedNodes()
 			offsets.push_back(node);
 			ids.push_back(_meshData.nIDs[node]);
 			coordinates.push_back(_meshData.coordinates[node]);
-			for (size_t r = 0; r < _nregsize; ++r) {
-				regions.push_back(_nregions[_nregsize * node + r]);
-			}
+			values.insert(values.end(), _ndata.begin() + _ndatasize * node, _ndata.begin() + _ndatasize * (node + 1));
 
 			sBuffer[ni].push_back(_meshData.nIDs[node]);
 			esint *begin = reinterpret_cast<esint*>(_meshData.coordinates.data() + node);
 			esint *end = reinterpret_cast<esint*>(_meshData.coordinates.data() + node + 1);
 			sBuffer[ni].insert(sBuffer[ni].end(), begin, end);
-			for (size_t r = 0; r < _nregsize; ++r) {
-				sBuffer[ni].push_back(_nregions[_nregsize * node + r]);
-			}
+			sBuffer[ni].insert(sBuffer[ni].end(), reinterpret_cast<const esint*>(_ndata.data() + _ndatasize * node), reinterpret_cast<const esint*>(_ndata.data() + _ndatasize * (node + 1)));
 		}
 	}
 
@@ -526,15 +527,15 @@ void ScatteredInput::mergeDuplicatedNodes()
 	std::vector<esint> noffset;
 	noffset.push_back(ids.size());
 	for (size_t n = 0; n < _sfcNeighbors.size(); ++n) {
-		for (size_t i = 0; i < rBuffer[n].size(); ) {
+		for (size_t i = unpackRegions(_nregions, rBuffer[n]); i < rBuffer[n].size(); ) {
 			ids.push_back(rBuffer[n][i++]);
 			Point p;
 			memcpy(&p, reinterpret_cast<const Point*>(rBuffer[n].data() + i), sizeof(Point));
 			coordinates.push_back(p);
 			i += sizeof(p) / sizeof(esint);
-			for (size_t r = 0; r < _nregsize; ++r) {
-				regions.push_back(rBuffer[n][i++]);
-			}
+			values.resize(values.size() + _ndatasize);
+			memcpy(values.data() + values.size() - _ndatasize, rBuffer[n].data() + i, _ndatasize * sizeof(double));
+			i += _ndatasize * sizeof(double) / sizeof(esint);
 		}
 		noffset.push_back(ids.size());
 	}
@@ -555,15 +556,15 @@ void ScatteredInput::mergeDuplicatedNodes()
 			if (toerase.size() <= e || n != toerase[e]) {
 				_meshData.nIDs[last] = _meshData.nIDs[n];
 				_meshData.coordinates[last] = _meshData.coordinates[n];
-				for (size_t r = 0; r < _nregsize; ++r) {
-					_nregions[last * _nregsize + r] = _nregions[n * _nregsize + r];
+				for (size_t d = 0; d < _ndatasize; ++d) {
+					_ndata[last * _ndatasize + d] = _ndata[n * _ndatasize + d];
 				}
 				++last;
 			} else {
 				++e;
 			}
 		}
-		_nregions.resize(_nregsize * (_meshData.nIDs.size() - toerase.size()));
+		_ndata.resize(_ndatasize * (_meshData.nIDs.size() - toerase.size()));
 		_meshData.coordinates.resize(_meshData.nIDs.size() - toerase.size());
 		_meshData.nIDs.resize(_meshData.nIDs.size() - toerase.size());
 	}
@@ -571,15 +572,15 @@ void ScatteredInput::mergeDuplicatedNodes()
 	std::vector<std::pair<esint, esint> > buckets;
 	if (toinsert.size()) {
 		utils::sortAndRemoveDuplicates(toinsert);
-		_nregions.resize(_nregsize * (_meshData.nIDs.size() + toinsert.size()));
+		_ndata.resize(_ndatasize * (_meshData.nIDs.size() + toinsert.size()));
 		_meshData.coordinates.resize(_meshData.nIDs.size() + toinsert.size());
 		_meshData.nIDs.resize(_meshData.nIDs.size() + toinsert.size());
 		for (size_t i = _meshData.nIDs.size() - toinsert.size(), j = 0; j < toinsert.size(); ++i, ++j) {
 			_meshData.nIDs[i] = ids[toinsert[j]];
 			_meshData.coordinates[i] = coordinates[toinsert[j]];
 			buckets.push_back(std::make_pair(_meshData.nIDs[i], _sfc.getBucket(_meshData.coordinates[i])));
-			for (size_t r = 0; r < _nregsize; ++r) {
-				_nregions[i * _nregsize + r] = regions[toinsert[j] * _nregsize + r];
+			for (size_t d = 0; d < _ndatasize; ++d) {
+				_ndata[i * _ndatasize + d] = values[toinsert[j] * _ndatasize + d];
 			}
 		}
 	}
@@ -603,14 +604,10 @@ void ScatteredInput::mergeDuplicatedNodes()
 	// there can be more optimal solution, but this keep the rest of the code unchanged
 	searchDuplicateNodes();
 	for (auto dup = _meshData._duplicateNodes.begin(); dup != _meshData._duplicateNodes.end(); ++dup) {
-		for (size_t i = 0; i < _nregsize; i++) {
-			_nregions[_nregsize * dup->toffset + i] |= _nregions[_nregsize * dup->idoffset + i];
-		}
+		mergeRegions(_nregions, dup->id, dup->target);
 	}
 	for (auto dup = _meshData._duplicateNodes.begin(); dup != _meshData._duplicateNodes.end(); ++dup) {
-		for (size_t i = 0; i < _nregsize; i++) {
-			_nregions[_nregsize * dup->idoffset + i] |= _nregions[_nregsize * dup->toffset + i];
-		}
+		mergeRegions(_nregions, dup->target, dup->id);
 	}
 }
 
@@ -627,6 +624,7 @@ void ScatteredInput::linkup()
 //	VTKLegacyDebugInfo::spaceFillingCurve(_sfc, _bucketsBorders);
 
 	eslog::startln("LINKUP: CONNECTING CLUSTERS", "LINKUP");
+	Arena::Scope arena;
 
 	// 2. Exchange elements having only one node on here
 
@@ -637,6 +635,7 @@ void ScatteredInput::linkup()
 	// send, found, received
 	std::vector<std::vector<esint> > sNodes(_sfcNeighbors.size()), fNodes(_sfcNeighbors.size()), fRegions(_sfcNeighbors.size()), rNodes(_sfcNeighbors.size()), rRegions(_sfcNeighbors.size());
 	std::vector<std::vector<Point> > fCoords(_sfcNeighbors.size()), rCoors(_sfcNeighbors.size());
+	std::vector<std::vector<double> > fData(_sfcNeighbors.size()), rData(_sfcNeighbors.size());
 
 	size_t enodesize = 0;
 	size_t estart = info::mesh->dimension == 3 ? 0 : 1;
@@ -675,10 +674,11 @@ void ScatteredInput::linkup()
 			}
 			if (node != _meshData.nIDs.end() && *node == rNodes[t][n]) {
 				fNodes[t].push_back(*node);
-				fRegions[t].insert(fRegions[t].end(), _nregions.begin() + _nregsize * (node - _meshData.nIDs.begin()), _nregions.begin() + _nregsize * (node - _meshData.nIDs.begin() + 1));
 				fCoords[t].push_back(_meshData.coordinates[node - _meshData.nIDs.begin()]);
+				fData[t].insert(fData[t].end(), _ndata.begin() + _ndatasize * (node - _meshData.nIDs.begin()), _ndata.begin() + _ndatasize * (node - _meshData.nIDs.begin() + 1));
 			}
 		}
+		packRegions(_nregions, fNodes[t], fRegions[t]);
 	}
 
 	eslog::checkpointln("LINKUP: NODES REQUESTS PROCESSED");
@@ -689,9 +689,15 @@ void ScatteredInput::linkup()
 	if (!Communication::exchangeUnknownSize(fRegions, rRegions, _sfcNeighbors)) {
 		eslog::internalFailure("return requested node regions.\n");
 	}
+	for (size_t t = 0; t < _sfcNeighbors.size(); t++) {
+		unpackRegions(_nregions, rRegions[t]);
+	}
 	if (!Communication::exchangeUnknownSize(fCoords, rCoors, _sfcNeighbors)) {
 		eslog::internalFailure("return requested coordinates.\n");
 	}
+	if (!Communication::exchangeUnknownSize(fData, rData, _sfcNeighbors)) {
+		eslog::internalFailure("return requested node fields.\n");
+	}
 	eslog::checkpointln("LINKUP: REQUESTED NODES RETURNED");
 
 	// 3.1 Check if all nodes are found
@@ -711,6 +717,7 @@ void ScatteredInput::linkup()
 	// unknown
 	std::vector<std::vector<esint> > uNodes, uRegions, fIDs, uIDs;
 	std::vector<std::vector<Point> > uCoords;
+	std::vector<std::vector<double> > uData;
 
 	if (sNodes.size() && nodeSize != sNodes.front().size()) {
 		std::vector<esint> found, unknown(sNodes.front().size() - nodeSize);
@@ -801,25 +808,34 @@ void ScatteredInput::linkup()
 	fCoords.resize(oSources.size());
 	fRegions.clear();
 	fRegions.resize(oSources.size());
+	fData.clear();
+	fData.resize(oSources.size());
 	for (size_t t = 0; t < oSources.size(); t++) {
 		for (size_t n = 0; n < uNodes[t].size(); n++) {
 			auto node = std::lower_bound(_meshData.nIDs.begin(), _meshData.nIDs.end(), uNodes[t][n]);
 			if (node != _meshData.nIDs.end() && *node == uNodes[t][n]) {
 				fCoords[t].push_back(_meshData.coordinates[node - _meshData.nIDs.begin()]);
-				fRegions[t].insert(fRegions[t].end(), _nregions.begin() + _nregsize * (node - _meshData.nIDs.begin()), _nregions.begin() + _nregsize * (node - _meshData.nIDs.begin() + 1));
+				fData[t].insert(fData[t].end(), _ndata.begin() + _ndatasize * (node - _meshData.nIDs.begin()), _ndata.begin() + _ndatasize * (node - _meshData.nIDs.begin() + 1));
 			} else {
 				eslog::internalFailure("something wrong happen during link-up phase.\n");
 			}
 		}
+		packRegions(_nregions, uNodes[t], fRegions[t]);
 	}
 	eslog::checkpointln("LINKUP: MISSING NODES COMPUTED");
 
 	if (!Communication::sendVariousTargets(fRegions, uRegions, oSources)) {
 		eslog::internalFailure("return requested unknown node regions.\n");
 	}
+	for (size_t t = 0; t < uRegions.size(); t++) {
+		unpackRegions(_nregions, uRegions[t]);
+	}
 	if (!Communication::sendVariousTargets(fCoords, uCoords, oSources)) {
 		eslog::internalFailure("return requested unknown coordinates.\n");
 	}
+	if (!Communication::sendVariousTargets(fData, uData, oSources)) {
+		eslog::internalFailure("return requested unknown node fields.\n");
+	}
 	eslog::checkpointln("LINKUP: MISSING NODES RETURNED");
 
 	// insert new neighbors to neighbors computed from SFC
@@ -828,8 +844,8 @@ void ScatteredInput::linkup()
 		size_t offset = it - _sfcNeighbors.begin();
 		_sfcNeighbors.insert(it, oTargets[i]);
 		rNodes.insert(rNodes.begin() + offset, sNodes[i]);
-		rRegions.insert(rRegions.begin() + offset, uRegions[i]);
 		rCoors.insert(rCoors.begin() + offset, uCoords[i]);
+		rData.insert(rData.begin() + offset, uData[i]);
 		fNodes.insert(fNodes.begin() + offset, std::vector<esint>());
 	}
 
@@ -841,8 +857,8 @@ void ScatteredInput::linkup()
 		} else {
 			_sfcNeighbors.insert(it, oSources[i]);
 			rNodes.insert(rNodes.begin() + offset, std::vector<esint>());
-			rRegions.insert(rRegions.begin() + offset, std::vector<esint>());
 			rCoors.insert(rCoors.begin() + offset, std::vector<Point>());
+			rData.insert(rData.begin() + offset, std::vector<double>());
 			fNodes.insert(fNodes.begin() + offset, uNodes[i]);
 		}
 	}
@@ -851,6 +867,7 @@ void ScatteredInput::linkup()
 
 	// exchange duplicates nodes and remove them
 	if (_meshData.removeDuplicates) {
+		// the number of duplicates is not known in advance -> growing buffers use the common allocator
 		std::vector<std::vector<esint> > fDuplicates(_sfcNeighbors.size()), rDuplicates(_sfcNeighbors.size());
 		std::vector<esint> dpermutation(_meshData._duplicateNodes.size());
 		std::iota(dpermutation.begin(), dpermutation.end(), 0);
@@ -994,15 +1011,15 @@ void ScatteredInput::linkup()
 					++duplicate;
 				}
 				if (duplicate == _meshData._duplicateNodes.end() || duplicate->id != _meshData.nIDs[n]) {
-					for (size_t r = 0; r < _nregsize; ++r) {
-						_nregions[final * _nregsize + r] = _nregions[n * _nregsize + r];
+					for (size_t d = 0; d < _ndatasize; ++d) {
+						_ndata[final * _ndatasize + d] = _ndata[n * _ndatasize + d];
 					}
 					_meshData.nIDs[final] = _meshData.nIDs[n];
 					_meshData.coordinates[final] = _meshData.coordinates[n];
 					++final;
 				}
 			}
-			_nregions.resize(_nregsize * final);
+			_ndata.resize(_ndatasize * final);
 			_meshData.nIDs.resize(final);
 			_meshData.coordinates.resize(final);
 		}
@@ -1020,39 +1037,40 @@ void ScatteredInput::linkup()
 							// only erase
 							rNodes[r].erase(rNodes[r].begin() + n);
 							rCoors[r].erase(rCoors[r].begin() + n);
-							rRegions[r].erase(rRegions[r].begin() + n * _nregsize, rRegions[r].begin() + n * _nregsize + _nregsize);
+							rData[r].erase(rData[r].begin() + n * _ndatasize, rData[r].begin() + n * _ndatasize + _ndatasize);
 							--n;
 						} else {
 							// move before other (id that is larger than target)
 							Point coo = rCoors[r][n];
-							std::vector<esint> reg(rRegions[r].begin() + n * _nregsize, rRegions[r].begin() + n * _nregsize + _nregsize);
+							mergeRegions(_nregions, duplicate->id, duplicate->target);
+							std::vector<double> values(rData[r].begin() + n * _ndatasize, rData[r].begin() + n * _ndatasize + _ndatasize);
 							size_t upper = other - rNodes[r].begin();
 							if (n < upper) {
 								for (size_t i = n; i + 1 < upper; ++i) {
 									rNodes[r][i] = rNodes[r][i + 1];
 									rCoors[r][i] = rCoors[r][i + 1];
-									for (size_t j = 0; j < _nregsize; ++j) {
-										rRegions[r][_nregsize * i + j] = rRegions[r][_nregsize * (i + 1) + j];
+									for (size_t j = 0; j < _ndatasize; ++j) {
+										rData[r][_ndatasize * i + j] = rData[r][_ndatasize * (i + 1) + j];
 									}
 								}
 								rNodes[r][upper - 1] = duplicate->target;
 								rCoors[r][upper - 1] = coo;
-								for (size_t j = 0; j < _nregsize; ++j) {
-									rRegions[r][_nregsize * (upper - 1) + j] = reg[j];
+								for (size_t j = 0; j < _ndatasize; ++j) {
+									rData[r][_ndatasize * (upper - 1) + j] = values[j];
 								}
 								--n;
 							} else {
 								for (size_t i = n; i > upper; --i) {
 									rNodes[r][i] = rNodes[r][i - 1];
 									rCoors[r][i] =  rCoors[r][i - 1];
-									for (size_t j = 0; j < _nregsize; ++j) {
-										rRegions[r][_nregsize * i + j] = rRegions[r][_nregsize * (i - 1) + j];
+									for (size_t j = 0; j < _ndatasize; ++j) {
+										rData[r][_ndatasize * i + j] = rData[r][_ndatasize * (i - 1) + j];
 									}
 								}
 								rNodes[r][upper] = duplicate->target;
 								rCoors[r][upper] = coo;
-								for (size_t j = 0; j < _nregsize; ++j) {
-									rRegions[r][_nregsize * (upper) + j] = reg[j];
+								for (size_t j = 0; j < _ndatasize; ++j) {
+									rData[r][_ndatasize * (upper) + j] = values[j];
 								}
 							}
 						}
@@ -1069,7 +1087,7 @@ void ScatteredInput::linkup()
 	std::sort(_sfcNeighbors.begin(), _sfcNeighbors.end());
 
 	// 5. Compute nodes neighbors
-	std::vector<std::vector<esint> > sRanks(_sfcNeighbors.size()), rRanks(_sfcNeighbors.size());
+	std::vector<arenavector<esint> > sRanks(_sfcNeighbors.size()), rRanks(_sfcNeighbors.size());
 
 	size_t rankindex;
 	std::vector<std::vector<esint> > nodeRequests(_sfcNeighbors.size());
@@ -1083,27 +1101,40 @@ void ScatteredInput::linkup()
 	}
 	std::vector<esint> ranks, ranksOffset;
 	std::vector<std::vector<esint>::const_iterator> rPointer(nodeRequests.size());
-	for (size_t r = 0; r < nodeRequests.size(); r++) {
-		rPointer[r] = nodeRequests[r].begin();
-	}
-	for (size_t n = 0; n < _meshData.nIDs.size(); ++n) {
-		ranks.clear();
-		ranksOffset.clear();
+	std::vector<size_t> sSize(nodeRequests.size());
+	// arena buffers cannot grow -> the first walk computes their exact sizes, the second fills them
+	auto walk = [&] (bool fill) {
 		for (size_t r = 0; r < nodeRequests.size(); r++) {
-			while (rPointer[r] != nodeRequests[r].end() && *rPointer[r] < _meshData.nIDs[n]) {
-				++rPointer[r];
+			rPointer[r] = nodeRequests[r].begin();
+		}
+		for (size_t n = 0; n < _meshData.nIDs.size(); ++n) {
+			ranks.clear();
+			ranksOffset.clear();
+			for (size_t r = 0; r < nodeRequests.size(); r++) {
+				while (rPointer[r] != nodeRequests[r].end() && *rPointer[r] < _meshData.nIDs[n]) {
+					++rPointer[r];
+				}
+				if (rPointer[r] != nodeRequests[r].end() && *rPointer[r] == _meshData.nIDs[n]) {
+					ranksOffset.push_back(r);
+					ranks.push_back(_sfcNeighbors[r]);
+					++rPointer[r];
+				}
 			}
-			if (rPointer[r] != nodeRequests[r].end() && *rPointer[r] == _meshData.nIDs[n]) {
-				ranksOffset.push_back(r);
-				ranks.push_back(_sfcNeighbors[r]);
-				++rPointer[r];
+			for (size_t r = 0; r < ranks.size(); r++) {
+				if (fill) {
+					sRanks[ranksOffset[r]].push_back(ranksOffset.size());
+					sRanks[ranksOffset[r]].insert(sRanks[ranksOffset[r]].end(), ranks.begin(), ranks.end());
+				} else {
+					sSize[ranksOffset[r]] += 1 + ranks.size();
+				}
 			}
 		}
-		for (size_t r = 0; r < ranks.size(); r++) {
-			sRanks[ranksOffset[r]].push_back(ranksOffset.size());
-			sRanks[ranksOffset[r]].insert(sRanks[ranksOffset[r]].end(), ranks.begin(), ranks.end());
-		}
+	};
+	walk(false);
+	for (size_t r = 0; r < sRanks.size(); r++) {
+		sRanks[r].reserve(sSize[r]);
 	}
+	walk(true);
 
 	nodeRequests[rankindex].swap(enodes);
 
@@ -1119,8 +1150,8 @@ void ScatteredInput::linkup()
 		if (_meshData.nIDs[id] == enodes[node]) {
 			_meshData.nIDs[unique] = _meshData.nIDs[id];
 			_meshData.coordinates[unique] = _meshData.coordinates[id];
-			for (size_t i = 0; i < _nregsize; i++) {
-				_nregions[_nregsize * unique + i] = _nregions[_nregsize * id + i];
+			for (size_t i = 0; i < _ndatasize; i++) {
+				_ndata[_ndatasize * unique + i] = _ndata[_ndatasize * id + i];
 			}
 			++unique;
 		}
@@ -1128,7 +1159,7 @@ void ScatteredInput::linkup()
 
 	_meshData.nIDs.resize(unique);
 	_meshData.coordinates.resize(unique);
-	_nregions.resize(_nregsize * unique);
+	_ndata.resize(_ndatasize * unique);
 
 	eslog::checkpointln("LINKUP: NODES RANK MAP COMPUTED");
 
@@ -1140,24 +1171,13 @@ void ScatteredInput::linkup()
 	for (size_t t = 0, i = 0; t < _sfcNeighbors.size(); t++) {
 		if (_sfcNeighbors[t] != info::mpi::rank) {
 			_meshData.nIDs.insert(_meshData.nIDs.end(), rNodes[i].begin(), rNodes[i].end());
-			_nregions.insert(_nregions.end(), rRegions[i].begin(), rRegions[i].end());
+			_ndata.insert(_ndata.end(), rData[i].begin(), rData[i].end());
 			_meshData.coordinates.insert(_meshData.coordinates.end(), rCoors[i].begin(), rCoors[i].end());
 			++i;
 		}
 	}
 
-	size_t r = 0;
-	for (auto nregion = _meshData.nregions.begin(); nregion != _meshData.nregions.end(); ++nregion, ++r) {
-		esint byte = r / (8 * sizeof(esint));
-		esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-
-		nregion->second.clear();
-		for (size_t i = 0; i < _meshData.nIDs.size(); ++i) {
-			if (_nregions[_nregsize * i + byte] & bit) {
-				nregion->second.push_back(i);
-			}
-		}
-	}
+	fillRegions(_meshData.nregions, _meshData.nIDs, _nregions);
 
 	_meshData._nrankdist.push_back(0);
 	for (size_t n = 0; n < rRanks[rankindex].size(); n += rRanks[rankindex][n] + 1) {
@@ -1173,7 +1193,9 @@ void ScatteredInput::linkup()
 		}
 	}
 
-	eslog::endln("LINKUP: LINKED UP");
+	eslog::end("LINKUP: LINKED UP");
+	eslog::param("arena[MB]", Arena::highWaterMark() / 1024. / 1024.);
+	eslog::ln();
 }
 
 void ScatteredInput::exchangeBoundary()
@@ -1505,18 +1527,30 @@ void ScatteredInput::exchangeBoundary()
 	utils::sortAndRemoveDuplicates(etargets[0]);
 
 	std::vector<int> sRanks;
-	std::vector<std::vector<esint> > sBoundary, rBoundary;
+	std::vector<std::vector<esint> > sBoundary, rBoundary, sIDs;
 
 	for (size_t e = 0; e < etargets[0].size(); ++e) {
-		esint eindex = etargets[0][e].second + _etypeDistribution[estart];
 		if (!sRanks.size() || sRanks.back() != etargets[0][e].first) {
 			sRanks.push_back(etargets[0][e].first);
-			sBoundary.push_back({});
+			sIDs.push_back({});
+		}
+		sIDs.back().push_back(_meshData.eIDs[etargets[0][e].second + _etypeDistribution[estart]]);
+	}
+	sBoundary.resize(sRanks.size());
+	for (size_t r = 0; r < sRanks.size(); ++r) { // regions of sent elements precede elements
+		std::sort(sIDs[r].begin(), sIDs[r].end());
+		packRegions(_eregions, sIDs[r], sBoundary[r]);
+	}
+
+	for (size_t e = 0, r = 0; e < etargets[0].size(); ++e) {
+		esint eindex = etargets[0][e].second + _etypeDistribution[estart];
+		if (sRanks[r] != etargets[0][e].first) {
+			++r;
 		}
-		sBoundary.back().push_back(_meshData.esize[eindex]);
-		sBoundary.back().push_back(_meshData.etype[eindex]);
-		sBoundary.back().insert(sBoundary.back().end(), _eregions.begin() + eindex * _eregsize, _eregions.begin() + (eindex + 1) * _eregsize);
-		sBoundary.back().insert(sBoundary.back().end(), _meshData.enodes.begin() + edist[etargets[0][e].second], _meshData.enodes.begin() + edist[etargets[0][e].second + 1]);
+		sBoundary[r].push_back(_meshData.esize[eindex]);
+		sBoundary[r].push_back(_meshData.eIDs[eindex]);
+		sBoundary[r].push_back(_meshData.etype[eindex]);
+		sBoundary[r].insert(sBoundary[r].end(), _meshData.enodes.begin() + edist[etargets[0][e].second], _meshData.enodes.begin() + edist[etargets[0][e].second + 1]);
 	}
 
 	eslog::checkpointln("BOUNDARY: PARENT ELEMENTS FOUND");
@@ -1526,19 +1560,16 @@ void ScatteredInput::exchangeBoundary()
 	}
 	eslog::checkpointln("BOUNDARY: BOUNDARY EXCHANGED");
 
-	for (size_t r = 1; r < rBoundary.size(); r++) {
-		rBoundary[0].insert(rBoundary[0].end(), rBoundary[r].begin(), rBoundary[r].end());
-	}
-
 	size_t newsize = 0;
-	for (size_t i = 0; rBoundary.size() && i < rBoundary[0].size(); ++newsize) {
-		_meshData.esize.push_back(rBoundary[0][i++]);
-		edist.push_back(edist.back() + _meshData.esize.back());
-		_meshData.etype.push_back(rBoundary[0][i++]);
-		_eregions.insert(_eregions.end(), rBoundary[0].begin() + i, rBoundary[0].begin() + i + _eregsize);
-		i += _eregsize;
-		_meshData.enodes.insert(_meshData.enodes.end(), rBoundary[0].begin() + i, rBoundary[0].begin() + i + _meshData.esize.back());
-		i += _meshData.esize.back();
+	for (size_t r = 0; r < rBoundary.size(); r++) {
+		for (size_t i = unpackRegions(_eregions, rBoundary[r]); i < rBoundary[r].size(); ++newsize) {
+			_meshData.esize.push_back(rBoundary[r][i++]);
+			edist.push_back(edist.back() + _meshData.esize.back());
+			_meshData.eIDs.push_back(rBoundary[r][i++]);
+			_meshData.etype.push_back(rBoundary[r][i++]);
+			_meshData.enodes.insert(_meshData.enodes.end(), rBoundary[r].begin() + i, rBoundary[r].begin() + i + _meshData.esize.back());
+			i += _meshData.esize.back();
+		}
 	}
 
 	emembership.resize(emembership.size() + newsize, -1);
@@ -1572,7 +1603,7 @@ void ScatteredInput::exchangeBoundary()
 		}
 	}
 
-	std::vector<esint> esize, etype, enodes, ereg;
+	std::vector<esint> esize, eIDs, etype, enodes;
 
 	for (int i = estart; i < 2; i++) {
 		size_t bindex = 0;
@@ -1582,8 +1613,8 @@ void ScatteredInput::exchangeBoundary()
 					enodes.push_back(_meshData.enodes[n]);
 				}
 				esize.push_back(_meshData.esize[e]);
+				eIDs.push_back(_meshData.eIDs[e]);
 				etype.push_back(_meshData.etype[e]);
-				ereg.insert(ereg.end(), _eregions.begin() + _eregsize * e, _eregions.begin() + _eregsize * (e + 1));
 			}
 		}
 
@@ -1593,21 +1624,21 @@ void ScatteredInput::exchangeBoundary()
 					enodes.push_back(_meshData.enodes[n]);
 				}
 				esize.push_back(_meshData.esize[e]);
+				eIDs.push_back(_meshData.eIDs[e]);
 				etype.push_back(_meshData.etype[e]);
-				ereg.insert(ereg.end(), _eregions.begin() + _eregsize * e, _eregions.begin() + _eregsize * (e + 1));
 			}
 		}
 	}
 
 	_meshData.esize.resize(_etypeDistribution[estart]);
+	_meshData.eIDs.resize(_etypeDistribution[estart]);
 	_meshData.etype.resize(_etypeDistribution[estart]);
 	_meshData.enodes.resize(edist.front());
-	_eregions.resize(_etypeDistribution[estart] * _eregsize);
 
 	_meshData.esize.insert(_meshData.esize.end(), esize.begin(), esize.end());
+	_meshData.eIDs.insert(_meshData.eIDs.end(), eIDs.begin(), eIDs.end());
 	_meshData.etype.insert(_meshData.etype.end(), etype.begin(), etype.end());
 	_meshData.enodes.insert(_meshData.enodes.end(), enodes.begin(), enodes.end());
-	_eregions.insert(_eregions.end(), ereg.begin(), ereg.end());
 
 	_etypeDistribution.clear();
 	for (int type = static_cast<int>(Element::TYPE::VOLUME); type > static_cast<int>(Element::TYPE::POINT); --type) {
@@ -19,6 +19,8 @@ SequentialInput::SequentialInput(MeshBuilder &mesh)
 {
 	eslog::startln("BUILDER: BUILD SEQUENTIAL MESH", "BUILDER");
 
+	packData();
+
 	if (_meshData.removeDuplicates) {
 		searchDuplicateNodes();
 		coupleDuplicateNodes();
@@ -92,6 +94,9 @@ SequentialInput::SequentialInput(MeshBuilder &mesh)
 	fillElements();
 	eslog::checkpointln("BUILDER: ELEMENTS FILLED");
 
+	fillData();
+	eslog::checkpointln("BUILDER: DATA FILLED");
+
 	fillElementRegions();
 	fillBoundaryRegions();
 	fillNodeRegions();
@@ -112,7 +117,9 @@ void SequentialInput::removeDanglingNodes()
 	std::vector<Point> coordinates;
 	std::vector<esint> nIDs, ndist, noffset(usedNodes.back() + 1);
 	std::vector<int> nranks;
+	std::vector<double> ndata;
 	coordinates.reserve(_meshData.nIDs.size());
+	ndata.reserve(_ndata.size());
 	nIDs.reserve(_meshData.nIDs.size());
 	ndist.reserve(_meshData.nIDs.size() + 1);
 	nranks.reserve(_meshData._nranks.size());
@@ -123,6 +130,7 @@ void SequentialInput::removeDanglingNodes()
 			noffset[usedNodes[i]] = i;
 			coordinates.push_back(_meshData.coordinates[n]);
 			nIDs.push_back(_meshData.nIDs[n]);
+			ndata.insert(ndata.end(), _ndata.begin() + n * _ndatasize, _ndata.begin() + (n + 1) * _ndatasize);
 			if (_meshData._nranks.size()) {
 				nranks.insert(nranks.end(), _meshData._nranks.begin() + _meshData._nrankdist[n], _meshData._nranks.begin() + _meshData._nrankdist[n + 1]);
 				ndist.push_back(nranks.size());
@@ -139,6 +147,7 @@ void SequentialInput::removeDanglingNodes()
 
 	_meshData.nIDs.swap(nIDs);
 	_meshData.coordinates.swap(coordinates);
+	_ndata.swap(ndata);
 	if (_meshData._nranks.size()) {
 		_meshData._nrankdist.swap(ndist);
 		_meshData._nranks.swap(nranks);
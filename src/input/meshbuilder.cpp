@@ -177,6 +177,12 @@ void MeshBuilder::duplicate(Geometry &source, int instance)
 	_duplicate(enodes, source.enodes.first, source.enodes.second, instance * source.nids);
 	_duplicate(body, source.elements.first, source.elements.second, 0);
 	_duplicate(material, source.elements.first, source.elements.second, 0);
+	for (auto f = ndata.begin(); f != ndata.end(); ++f) {
+		_duplicate(f->second.values, f->second.dimension * source.nodes.first, f->second.dimension * source.nodes.second, 0);
+	}
+	for (auto f = edata.begin(); f != edata.end(); ++f) {
+		_duplicate(f->second.values, f->second.dimension * source.elements.first, f->second.dimension * source.elements.second, 0);
+	}
 
 	auto reg = nregions.begin();
 	for (size_t r = 0; r < nregions.size(); ++r, ++reg) {
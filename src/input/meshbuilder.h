@@ -3,6 +3,7 @@
 #define SRC_INPUT_MESHDATA_H_
 
 #include "basis/containers/point.h"
+#include "mesh/store/nameddata.h"
 
 #include <vector>
 #include <string>
@@ -23,6 +24,12 @@ struct MeshData {
 		GENERATED,
 	};
 
+	struct Field { // values of a field stored in the order of nIDs (eIDs)
+		int dimension = 1;
+		NamedData::DataType type = NamedData::DataType::SCALAR;
+		std::vector<double> values;
+	};
+
 	MeshData(TYPE type = TYPE::GENERAL): type(type) {}
 
 	TYPE type;
@@ -41,6 +48,9 @@ struct MeshData {
 	std::map<std::string, std::vector<esint> > eregions; // elements regions <name, list of IDs>
 	std::map<std::string, std::vector<esint> > nregions; // nodes regions <name, list of IDs>
 
+	std::map<std::string, Field> ndata; // nodes fields <name, values>
+	std::map<std::string, Field> edata; // elements fields <name, values>
+
 	std::map<std::string, Point > orientation;
 };
 
@@ -10,17 +10,23 @@
 #include "parser/material.h"
 #include "parser/elemat.h"
 #include "parser/nset.h"
+#include "parser/scope.h"
+#include "parser/parser.h"
 
 #include "basis/containers/tarray.h"
+#include "basis/utilities/parser.h"
 #include "wrappers/mpi/communication.h"
+#include "input/parsers/distributedscanner.h"
 #include "config/input.h"
 
 #include "esinfo/envinfo.h"
 #include "esinfo/mpiinfo.h"
 #include "esinfo/eslog.hpp"
 
-#include "parser/parser.h"
-// msg remove this
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <functional>
 
 using namespace mesio;
 
@@ -36,18 +42,6 @@ void AbaqusLoader::load()
 	eslog::param("database", _configuration.path.c_str());
 	eslog::ln();
 
-	_pfile.commitFiles({ _configuration.path });
-	_pfile.prepare();
-	eslog::checkpointln("ABAQUS: READING PREPARED");
-
-	_pfile.read();
-	eslog::checkpointln("ABAQUS: DATA READ");
-
-	_pfile.next();
-	AbaqusParser::offset = _pfile.distribution[info::mpi::rank];
-	AbaqusParser::begin = _pfile.begin;
-	AbaqusParser::end = _pfile.end;
-
 	scan();
 	eslog::checkpointln("ABAQUS: DATA SCANNED");
 
@@ -58,188 +52,348 @@ void AbaqusLoader::load()
 	eslog::endln("ABAQUS: DATA PARSED");
 }
 
-void AbaqusLoader::scan()
+// set the parser to a given file
+static void setfile(InputFile *file, size_t index)
 {
-	size_t threads = info::env::threads;
-
-	std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, _pfile.end - _pfile.begin);
-	std::vector<std::vector<NList> > tNLists(threads);
-	std::vector<std::vector<EList> > tELists(threads);
-	std::vector<std::vector<BlockFinish> > tBlockFinishs(threads);
-	std::vector<std::vector<Eset> > tEsets(threads);
-	std::vector<std::vector<Nset> > tNsets(threads);
-	std::vector<std::vector<SSection> > tSSections(threads);
-	std::vector<std::vector<AbaqusMaterial> > tMaterials(threads);
-
-	#pragma omp parallel for
-	for (size_t t = 0; t < threads; t++) {
-		const char* tbegin = _pfile.begin + tdistribution[t];
-		if (t && *(tbegin - 1) != '\n') {
-			while (tbegin < _pfile.end && *tbegin++ != '\n'); // start at new line
-		}
-
-		while (tbegin < _pfile.begin + tdistribution[t + 1]) {
-			
+	AbaqusParser::current = index;
+	AbaqusParser::offset = file->distribution[info::mpi::rank];
+	AbaqusParser::begin = file->begin;
+	AbaqusParser::end = file->end;
+}
 
-			if (memcmp(tbegin, BlockFinish::asterik, BlockFinish::nSize) == 0  &&
-				memcmp(tbegin , BlockFinish::comment, BlockFinish::ncSize) != 0) {
+// included files are relative to the including file
+static std::string resolve(const std::string &including, const std::string &input)
+{
+	size_t slash = including.find_last_of('/');
+	if (input.front() == '/' || slash == std::string::npos) {
+		return input;
+	}
+	return including.substr(0, slash + 1) + input;
+}
 
-				tBlockFinishs[t].push_back(BlockFinish().parse(tbegin ));
-			}
+template<typename T>
+static void setends(std::vector<T> &t, std::vector<BlockFinish> &ends, InputFilePack &pfile)
+{
+	std::sort(t.begin(), t.end(), [] (const T &a, const T &b) { return a.file < b.file || (a.file == b.file && a.header < b.header); });
+	for (size_t i = 0; i < t.size(); i++) {
+		t[i].fillDistribution(ends, pfile.files[t[i].file]->distribution);
+	}
+}
 
-			if (memcmp(tbegin, NList::upper, NList::size) == 0) {
-				tNLists[t].push_back(NList().parse(tbegin));
-			}
-			if (memcmp(tbegin, NList::lower, NList::size) == 0) {
-				tNLists[t].push_back(NList().parse(tbegin));
-			}
-			if (memcmp(tbegin, NList::sentence, NList::size) == 0) {
-				tNLists[t].push_back(NList().parse(tbegin));
+void AbaqusLoader::scan()
+{
+	// included files are found during scanning, hence files are read in rounds until all includes are loaded
+	std::vector<std::string> paths = { _configuration.path };
+	while (paths.size()) {
+		InputFilePack pack(_pfile.minchunk, _pfile.overlap);
+		pack.commitFiles(paths);
+		pack.prepare();
+		eslog::checkpointln("ABAQUS: READING PREPARED");
+
+		pack.read();
+		eslog::checkpointln("ABAQUS: DATA READ");
+
+		std::vector<NList> NLists;
+		std::vector<EList> ELists;
+		std::vector<BlockFinish> blockFinishs;
+		std::vector<Eset> Esets;
+		std::vector<Nset> Nsets;
+		std::vector<SSection> SSections;
+		std::vector<AbaqusMaterial> Materials;
+		std::vector<Scope> Scopes;
+
+		DistributedScanner parser;
+		parser.add("*", [&] (const char *c) {
+			if (c[1] == '*') { // comment
+				return;
 			}
+			const char *k = c + 1;
+			while (*k != ',' && *k != '\n' && *k != '\r' && *k != '\0') { ++k; }
+			std::string keyword = Parser::uppercase(Parser::strip(std::string(c + 1, k)));
+
+			blockFinishs.push_back(BlockFinish().parse(c));
+			if (keyword == "NODE")          { NLists.push_back(NList().parse(c)); }
+			if (keyword == "ELEMENT")       { ELists.push_back(EList().parse(c)); }
+			if (keyword == "NSET")          { Nsets.push_back(Nset().parse(c)); }
+			if (keyword == "ELSET")         { Esets.push_back(Eset().parse(c)); }
+			if (keyword == "SOLID SECTION") { SSections.push_back(SSection().parse(c)); }
+			if (keyword == "MATERIAL")      { Materials.push_back(AbaqusMaterial().parse(c)); }
+			if (keyword == "PART")          { Scopes.push_back(Scope().parse(c, Scope::Type::PART)); }
+			if (keyword == "END PART")      { Scopes.push_back(Scope().parse(c, Scope::Type::END_PART)); }
+			if (keyword == "ASSEMBLY")      { Scopes.push_back(Scope().parse(c, Scope::Type::ASSEMBLY)); }
+			if (keyword == "END ASSEMBLY")  { Scopes.push_back(Scope().parse(c, Scope::Type::END_ASSEMBLY)); }
+			if (keyword == "INSTANCE")      { Scopes.push_back(Scope().parse(c, Scope::Type::INSTANCE)); }
+			if (keyword == "END INSTANCE")  { Scopes.push_back(Scope().parse(c, Scope::Type::END_INSTANCE)); }
+			if (keyword == "INCLUDE")       { Scopes.push_back(Scope().parse(c, Scope::Type::INCLUDE)); }
+		});
+
+		// 0: empty data, 1: the last line is complete, 2: the last line continues on the next process
+		std::vector<char> status(pack.files.size()), statuses(info::mpi::size * pack.files.size());
+		for (size_t f = 0; f < pack.files.size(); ++f) {
+			DistributedScanner::align(*pack.files[f], "\n");
+			setfile(pack.files[f], _pfile.size() + f);
+			parser.scanlines(*pack.files[f]);
+
+			const char *c = pack.files[f]->end;
+			while (c > pack.files[f]->begin && isspace(*(c - 1))) { --c; }
+			status[f] = c == pack.files[f]->begin ? 0 : (*(c - 1) == ',' ? 2 : 1);
+		}
+		parser.synchronize(blockFinishs, NLists, ELists, Esets, Nsets, SSections, Materials, Scopes);
+		Communication::allGather(status.data(), statuses.data(), status.size(), MPI_CHAR);
+		for (size_t f = 0; f < pack.files.size(); ++f) {
+			int r = info::mpi::rank - 1;
+			while (r >= 0 && statuses[r * pack.files.size() + f] == 0) { --r; }
+			_continued.push_back(r >= 0 && statuses[r * pack.files.size() + f] == 2);
+		}
 
-			if (memcmp(tbegin, Eset::upper, Eset::size) == 0) {
-				tEsets[t].push_back(Eset().parse(tbegin));
-			}
-			if (memcmp(tbegin, Eset::lower, Eset::size) == 0) {
-				tEsets[t].push_back(Eset().parse(tbegin));
-			}
-			if (memcmp(tbegin, Eset::sentence, Eset::size) == 0) {
-				tEsets[t].push_back(Eset().parse(tbegin));
+		for (size_t f = 0; f < pack.files.size(); ++f) {
+			_pfile.commitFiles(pack.paths[f], *pack.files[f]);
+		}
+		pack.files.clear(); // files are owned by '_pfile'
+
+		paths.clear();
+		for (size_t i = 0; i < Scopes.size(); ++i) {
+			if (Scopes[i].type == Scope::Type::INCLUDE) {
+				std::string path = resolve(_pfile.paths[Scopes[i].file], Scopes[i].INPUT);
+				if (std::find(_pfile.paths.begin(), _pfile.paths.end(), path) == _pfile.paths.end() && std::find(paths.begin(), paths.end(), path) == paths.end()) {
+					paths.push_back(path);
+				}
 			}
+		}
 
-			if (memcmp(tbegin, EList::upper, EList::size) == 0) {
-				tELists[t].push_back(EList().parse(tbegin));
-			}
-			if (memcmp(tbegin, EList::lower, EList::size) == 0) {
-				tELists[t].push_back(EList().parse(tbegin));
-			}
-			if (memcmp(tbegin, EList::sentence, EList::size) == 0) {
-				tELists[t].push_back(EList().parse(tbegin));
-			}
+		_NLists.insert(_NLists.end(), NLists.begin(), NLists.end());
+		_ELists.insert(_ELists.end(), ELists.begin(), ELists.end());
+		_blockFinishs.insert(_blockFinishs.end(), blockFinishs.begin(), blockFinishs.end());
+		_Esets.insert(_Esets.end(), Esets.begin(), Esets.end());
+		_Nsets.insert(_Nsets.end(), Nsets.begin(), Nsets.end());
+		_SSections.insert(_SSections.end(), SSections.begin(), SSections.end());
+		_Materials.insert(_Materials.end(), Materials.begin(), Materials.end());
+		_Scopes.insert(_Scopes.end(), Scopes.begin(), Scopes.end());
+	}
 
-			if (memcmp(tbegin, SSection::upper, SSection::size) == 0) {
-				tSSections[t].push_back(SSection().parse(tbegin));
-			}
-			if (memcmp(tbegin, SSection::lower, SSection::size) == 0) {
-				tSSections[t].push_back(SSection().parse(tbegin));
-			}
-			if (memcmp(tbegin, SSection::sentence, SSection::size) == 0) {
-				tSSections[t].push_back(SSection().parse(tbegin));
-			}
+	std::sort(_blockFinishs.begin(), _blockFinishs.end(), [] (const BlockFinish &a, const BlockFinish &b) { return a.file < b.file || (a.file == b.file && a.first < b.first); });
+	setends(_NLists, _blockFinishs, _pfile);
+	setends(_ELists, _blockFinishs, _pfile);
+	setends(_Esets, _blockFinishs, _pfile);
+	setends(_Nsets, _blockFinishs, _pfile);
+	setends(_Scopes, _blockFinishs, _pfile);
+}
 
-			if (memcmp(tbegin, AbaqusMaterial::upper, AbaqusMaterial::size) == 0) {
-				tMaterials[t].push_back(AbaqusMaterial().parse(tbegin));
-			}
-			if (memcmp(tbegin, AbaqusMaterial::lower, AbaqusMaterial::size) == 0) {
-				tMaterials[t].push_back(AbaqusMaterial().parse(tbegin));
-			}
-			if (memcmp(tbegin, AbaqusMaterial::sentence, AbaqusMaterial::size) == 0) {
-				tMaterials[t].push_back(AbaqusMaterial().parse(tbegin));
-			}
+void AbaqusLoader::parse()
+{
+	// assign blocks to parts in the order given by included files
+	struct Event { size_t header; AbaqusParser *block; const Scope *scope; };
+	std::vector<std::vector<Event> > events(_pfile.size());
+	for (size_t i = 0; i < _NLists.size(); i++) { events[_NLists[i].file].push_back(Event{ _NLists[i].header, &_NLists[i], NULL }); }
+	for (size_t i = 0; i < _ELists.size(); i++) { events[_ELists[i].file].push_back(Event{ _ELists[i].header, &_ELists[i], NULL }); }
+	for (size_t i = 0; i < _Esets.size(); i++) { events[_Esets[i].file].push_back(Event{ _Esets[i].header, &_Esets[i], NULL }); }
+	for (size_t i = 0; i < _Nsets.size(); i++) { events[_Nsets[i].file].push_back(Event{ _Nsets[i].header, &_Nsets[i], NULL }); }
+	for (size_t i = 0; i < _Scopes.size(); i++) { events[_Scopes[i].file].push_back(Event{ _Scopes[i].header, &_Scopes[i], &_Scopes[i] }); }
+	for (size_t f = 0; f < events.size(); ++f) {
+		std::sort(events[f].begin(), events[f].end(), [] (const Event &a, const Event &b) { return a.header < b.header; });
+	}
 
-			if (memcmp(tbegin, Nset::upper, Nset::size) == 0) {
-				tNsets[t].push_back(Nset().parse(tbegin));
-			}
-			if (memcmp(tbegin, Nset::lower, Nset::size) == 0) {
-				tNsets[t].push_back(Nset().parse(tbegin));
+	std::vector<std::string> parts;
+	std::vector<const Scope*> instances;
+	std::vector<size_t> stack;
+	int part = -1;
+	std::function<void(size_t)> walk = [&] (size_t file) {
+		if (std::find(stack.begin(), stack.end(), file) != stack.end()) {
+			eslog::globalerror("ABAQUS parser: recursive *INCLUDE of '%s'.\n", _pfile.paths[file].c_str());
+		}
+		stack.push_back(file);
+		for (size_t e = 0; e < events[file].size(); ++e) {
+			if (events[file][e].scope) {
+				const Scope *scope = events[file][e].scope;
+				switch (scope->type) {
+				case Scope::Type::PART: part = parts.size(); parts.push_back(scope->NAME); break;
+				case Scope::Type::END_PART: part = -1; break;
+				case Scope::Type::INSTANCE: instances.push_back(scope); break;
+				case Scope::Type::INCLUDE:
+					walk(std::find(_pfile.paths.begin(), _pfile.paths.end(), resolve(_pfile.paths[file], scope->INPUT)) - _pfile.paths.begin());
+					break;
+				default: break;
+				}
+			} else {
+				events[file][e].block->part = part;
 			}
-			if (memcmp(tbegin, Nset::sentence, Nset::size) == 0) {
-				tNsets[t].push_back(Nset().parse(tbegin));
+		}
+		stack.pop_back();
+	};
+	walk(0);
+
+	auto find = [] (const std::vector<std::string> &names, const char *name) {
+		for (size_t i = 0; i < names.size(); ++i) {
+			if (StringCompare::caseInsensitiveEq(names[i], name)) {
+				return (int)i;
 			}
-
-			while (tbegin < _pfile.end && *tbegin++ != '\n');
 		}
-	}
-	for (size_t t = 0; t < threads; t++) {
-		_NLists.insert(_NLists.end(), tNLists[t].begin(), tNLists[t].end());
-		_blockFinishs.insert(_blockFinishs.end(), tBlockFinishs[t].begin(), tBlockFinishs[t].end());
-		_ELists.insert(_ELists.end(), tELists[t].begin(), tELists[t].end());
-		_Esets.insert(_Esets.end(), tEsets[t].begin(), tEsets[t].end());
-		_SSections.insert(_SSections.end(), tSSections[t].begin(), tSSections[t].end());
-		_Materials.insert(_Materials.end(), tMaterials[t].begin() ,tMaterials[t].end());
-		_Nsets.insert(_Nsets.end(), tNsets[t].begin() ,tNsets[t].end());
+		return -1;
+	};
+	std::vector<std::string> instanceNames;
+	std::vector<int> instanceParts;
+	for (size_t i = 0; i < instances.size(); ++i) {
+		instanceNames.push_back(instances[i]->NAME);
+		instanceParts.push_back(find(parts, instances[i]->PART));
+		if (instanceParts.back() == -1) {
+			eslog::globalerror("ABAQUS parser: instance '%s' of unknown part '%s'.\n", instances[i]->NAME, instances[i]->PART);
+		}
 	}
 
-	if (!Communication::allGatherUnknownSize(_blockFinishs)) {
-		eslog::internalFailure("exchange ABAQUS block ends.\n");
-	}
+	// nodes and elements of parts are stored separately and copied for each instance
+	std::vector<MeshData> pmesh(parts.size());
+	auto target = [&] (int part) -> MeshData& { return part == -1 ? *this : pmesh[part]; };
 
 	for (size_t i = 0; i < _NLists.size(); i++) {
-		_NLists[i].fillDistribution(_blockFinishs, _pfile.distribution);
+		setfile(_pfile.files[_NLists[i].file], _NLists[i].file);
+		MeshData &mesh = target(_NLists[i].part);
+		size_t nbegin = mesh.nIDs.size();
+		if (!_NLists[i].readData(mesh.nIDs, mesh.coordinates, 1)) {
+			eslog::globalerror("ABAQUS parser: something wrong happens while read NList.\n");
+		}
+		if (_NLists[i].NSET[0]) {
+			mesh.nregions[_NLists[i].NSET].insert(mesh.nregions[_NLists[i].NSET].end(), mesh.nIDs.begin() + nbegin, mesh.nIDs.end());
+		}
 	}
 
 	for (size_t i = 0; i < _ELists.size(); i++) {
-		_ELists[i].fillDistribution(_blockFinishs, _pfile.distribution);
-	}
-
-	for (size_t i = 0; i < _Esets.size(); i++) {
-		_Esets[i].fillDistribution(_blockFinishs, _pfile.distribution);
-	}
-
-	for (size_t i = 0; i < _Nsets.size(); i++) {
-		_Nsets[i].fillDistribution(_blockFinishs, _pfile.distribution);
+		setfile(_pfile.files[_ELists[i].file], _ELists[i].file);
+		MeshData &mesh = target(_ELists[i].part);
+		size_t ebegin = mesh.eIDs.size();
+		if (!_ELists[i].readData(mesh, _continued[_ELists[i].file])) {
+			eslog::globalerror("ABAQUS parser: something wrong happens while read EList.\n");
+		}
+		if (_ELists[i].ELSET[0]) {
+			mesh.eregions[_ELists[i].ELSET].insert(mesh.eregions[_ELists[i].ELSET].end(), mesh.eIDs.begin() + ebegin, mesh.eIDs.end());
+		}
 	}
 
-	if (!Communication::allGatherUnknownSize(_NLists)) {
-		eslog::internalFailure("exchange ABAQUS NLists.\n");
+	// instances are numbered after the model nodes and elements: [model, instance 0, instance 1, ...]
+	std::vector<esint> maxID(2 * (parts.size() + 1));
+	for (size_t p = 0; p <= parts.size(); ++p) {
+		MeshData &mesh = target((int)p - 1);
+		for (size_t n = 0; n < mesh.nIDs.size(); ++n) {
+			maxID[2 * p + 0] = std::max(maxID[2 * p + 0], mesh.nIDs[n]);
+		}
+		for (size_t e = 0; e < mesh.eIDs.size(); ++e) {
+			maxID[2 * p + 1] = std::max(maxID[2 * p + 1], mesh.eIDs[e]);
+		}
 	}
-
-	if (!Communication::allGatherUnknownSize(_ELists)) {
-		eslog::internalFailure("exchange ABAQUS ELists.\n");
+	Communication::allReduce(maxID, Communication::OP::MAX);
+	std::vector<esint> noffset(instances.size()), eoffset(instances.size());
+	for (size_t i = 0, nsum = maxID[0], esum = maxID[1]; i < instances.size(); ++i) {
+		noffset[i] = nsum;
+		eoffset[i] = esum;
+		nsum += maxID[2 * (instanceParts[i] + 1) + 0];
+		esum += maxID[2 * (instanceParts[i] + 1) + 1];
 	}
 
-	if (!Communication::allGatherUnknownSize(_Esets)) {
-		eslog::internalFailure("exchange ABAQUS ESets.\n");
-	}
-
-	if (!Communication::allGatherUnknownSize(_Nsets)) {
-		eslog::internalFailure("exchange ABAQUS NSets.\n");
-	}
+	auto append = [] (std::vector<esint> &region, const std::vector<esint> &ids, esint offset) {
+		size_t size = region.size();
+		region.resize(size + ids.size());
+		for (size_t i = 0; i < ids.size(); ++i) {
+			region[size + i] = ids[i] + offset;
+		}
+	};
 
-	// fix distribution if EBlocks are across more processes and elements data have more lines
-	for (size_t i = 0; i < _ELists.size(); i++) {
-		_ELists[i].fixOffsets(_pfile.distribution);
-		if (_pfile.begin != AbaqusParser::begin) {
-			_pfile.distribution[info::mpi::rank] += _pfile.begin - AbaqusParser::begin;
+	// part sets are qualified by the instance name, assembly sets are shifted by the offset of the referenced instance
+	for (size_t i = 0; i < _Nsets.size(); i++) {
+		setfile(_pfile.files[_Nsets[i].file], _Nsets[i].file);
+		std::vector<esint> ids;
+		if (!_Nsets[i].readData(ids)) {
+			eslog::globalerror("ABAQUS parser: something wrong happens while read NSets.\n");
 		}
-		if (_pfile.end != AbaqusParser::end) {
-			_pfile.distribution[info::mpi::rank + 1] += _pfile.end - AbaqusParser::end;
+		esint offset = 0;
+		if (_Nsets[i].part == -1 && _Nsets[i].INSTANCE[0]) {
+			int instance = find(instanceNames, _Nsets[i].INSTANCE);
+			if (instance == -1) {
+				eslog::globalerror("ABAQUS parser: node set '%s' of unknown instance '%s'.\n", _Nsets[i].NAME, _Nsets[i].INSTANCE);
+			}
+			offset = noffset[instance];
 		}
-		_pfile.begin = AbaqusParser::begin;
-		_pfile.end = AbaqusParser::end;
+		append(target(_Nsets[i].part).nregions[_Nsets[i].NAME], ids, offset);
 	}
-}
-
-
-void AbaqusLoader::parse()
-{
-	//_Elemats[0].create_dict(_SSections,_Materials);
 
-	for (size_t i = 0; i < 1;i++){   //_NLists.size(); i++) {
-		if (!_NLists[i].readData(nIDs, coordinates, 1)) {
-			eslog::error("ABAQUS parser: something wrong happens while read NList.\n");
+	for (size_t i = 0; i < _Esets.size(); i++) {
+		setfile(_pfile.files[_Esets[i].file], _Esets[i].file);
+		std::vector<esint> ids;
+		if (!_Esets[i].readData(ids)) {
+			eslog::globalerror("ABAQUS parser: something wrong happens while read ESets.\n");
+		}
+		esint offset = 0;
+		if (_Esets[i].part == -1 && _Esets[i].INSTANCE[0]) {
+			int instance = find(instanceNames, _Esets[i].INSTANCE);
+			if (instance == -1) {
+				eslog::globalerror("ABAQUS parser: element set '%s' of unknown instance '%s'.\n", _Esets[i].NAME, _Esets[i].INSTANCE);
+			}
+			offset = eoffset[instance];
 		}
+		append(target(_Esets[i].part).eregions[_Esets[i].NAME], ids, offset);
 	}
 
-	for (size_t i = 0; i < _ELists.size(); i++) {
-		if (!_ELists[i].readData(*this)) {
-			eslog::error("ABAQUS parser: something wrong happens while read EList.\n");
+	// each process instantiates its own part of the parts data
+	size_t threads = info::env::threads;
+	for (size_t i = 0; i < instances.size(); ++i) {
+		const Scope *instance = instances[i];
+		const MeshData &mesh = pmesh[instanceParts[i]];
+
+		Point translation(instance->translation[0], instance->translation[1], instance->translation[2]);
+		Point origin(instance->rotation[0], instance->rotation[1], instance->rotation[2]);
+		Point axis = Point(instance->rotation[3], instance->rotation[4], instance->rotation[5]) - origin;
+		double angle = instance->rotation[6] * M_PI / 180;
+		bool rotate = angle != 0 && axis.length() > 0;
+		if (rotate) {
+			axis.normalize();
+		}
+		double cos = std::cos(angle), sin = std::sin(angle);
+
+		size_t nbegin = nIDs.size(), ebegin = eIDs.size(), enbegin = enodes.size();
+		nIDs.resize(nbegin + mesh.nIDs.size());
+		coordinates.resize(nbegin + mesh.coordinates.size());
+		eIDs.resize(ebegin + mesh.eIDs.size());
+		enodes.resize(enbegin + mesh.enodes.size());
+		esize.insert(esize.end(), mesh.esize.begin(), mesh.esize.end());
+		etype.insert(etype.end(), mesh.etype.begin(), mesh.etype.end());
+
+		std::vector<size_t> ndistribution = tarray<size_t>::distribute(threads, mesh.nIDs.size());
+		std::vector<size_t> edistribution = tarray<size_t>::distribute(threads, mesh.eIDs.size());
+		std::vector<size_t> endistribution = tarray<size_t>::distribute(threads, mesh.enodes.size());
+
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			for (size_t n = ndistribution[t]; n < ndistribution[t + 1]; ++n) {
+				nIDs[nbegin + n] = mesh.nIDs[n] + noffset[i];
+				Point p = mesh.coordinates[n] + translation;
+				if (rotate) {
+					p -= origin;
+					p.rodrigues(axis, cos, sin);
+					p += origin;
+				}
+				coordinates[nbegin + n] = p;
+			}
+			for (size_t e = edistribution[t]; e < edistribution[t + 1]; ++e) {
+				eIDs[ebegin + e] = mesh.eIDs[e] + eoffset[i];
+			}
+			for (size_t n = endistribution[t]; n < endistribution[t + 1]; ++n) {
+				enodes[enbegin + n] = mesh.enodes[n] + noffset[i];
+			}
 		}
-	}
 
-	for (size_t i = 0; i < _Esets.size(); i++) {
-		if (!_Esets[i].readData(eregions[_Esets[i].NAME])) {
-			eslog::error("ABAQUS parser: something wrong happens while read ESets.\n");
+		eregions[instanceNames[i]].insert(eregions[instanceNames[i]].end(), eIDs.begin() + ebegin, eIDs.end());
+		for (auto region = mesh.eregions.begin(); region != mesh.eregions.end(); ++region) {
+			append(eregions[instanceNames[i] + "." + region->first], region->second, eoffset[i]);
+		}
+		for (auto region = mesh.nregions.begin(); region != mesh.nregions.end(); ++region) {
+			append(nregions[instanceNames[i] + "." + region->first], region->second, noffset[i]);
 		}
 	}
 
-	for (size_t i = 0; i < _Nsets.size(); i++) {
-		if (!_Nsets[i].readData(nregions[_Nsets[i].NAME])) {
-			eslog::error("ABAQUS parser: something wrong happens while read NSets.\n");
-		}
+	for (auto region = eregions.begin(); region != eregions.end(); ++region) {
+		std::sort(region->second.begin(), region->second.end());
 	}
-//	for (size_t i = 0; i < 1; i++) {
-//		//ESINFO(ERROR) << "Workbench parser: something wrong happens while read EBLOCK.";
-//	}
+	for (auto region = nregions.begin(); region != nregions.end(); ++region) {
+		std::sort(region->second.begin(), region->second.end());
+	}
+	body.resize(etype.size());
+	material.resize(etype.size());
 }
-
@@ -24,6 +24,7 @@ struct BlockFinish;
 struct SSection;
 struct AbaqusMaterial;
 struct Elemat;
+struct Scope;
 
 class AbaqusLoader: public MeshBuilder {
 public:
@@ -44,7 +45,9 @@ protected:
 	std::vector<AbaqusMaterial> _Materials;
 	std::vector<Elemat> _Elemats;
 	std::vector<Nset> _Nsets;
-	InputFilePack _pfile;
+	std::vector<Scope> _Scopes;
+	std::vector<int> _continued; // the process data of a file start inside a multi-line element
+	InputFilePack _pfile; // the input file and all included files
 };
 
 }
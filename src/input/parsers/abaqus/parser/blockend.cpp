@@ -44,8 +44,7 @@ BlockFinish::BlockFinish()
 
 BlockFinish& BlockFinish::parse(const char* begin)
 {
-	while (*(--begin) != '\n');
-	AbaqusParser::fillIndices(begin + 1, begin + 1);
+	AbaqusParser::fillIndices(begin, begin); // keywords are always found at the line start
 	return *this;
 }
 
@@ -3,335 +3,159 @@
 
 #include "basis/containers/tarray.h"
 #include "basis/utilities/parser.h"
-#include "wrappers/mpi/communication.h"
 #include "esinfo/mpiinfo.h"
 #include "esinfo/envinfo.h"
+#include "esinfo/eslog.hpp"
 #include "mesh/element.h"
-#include "input/parsers/abaqus/abaqus.h"
+#include "input/meshbuilder.h"
+
+#include <cstdlib>
+#include <cstring>
 
 using namespace mesio;
 
-size_t EList::size = 8;
-const char* EList::upper = "*ELEMENT";
-const char* EList::lower = "*element";
-const char* EList::sentence = "*Element";
+// Abaqus node orderings of supported elements are the same as in MESIO
+static struct { const char *prefix; Element::CODE code; esint nodes; } etypes[] = {
+		{ "C3D4"  , Element::CODE::TETRA4   ,  4 },
+		{ "C3D5"  , Element::CODE::PYRAMID5 ,  5 },
+		{ "C3D6"  , Element::CODE::PRISMA6  ,  6 },
+		{ "C3D8"  , Element::CODE::HEXA8    ,  8 },
+		{ "C3D10" , Element::CODE::TETRA10  , 10 },
+		{ "C3D15" , Element::CODE::PRISMA15 , 15 },
+		{ "C3D20" , Element::CODE::HEXA20   , 20 },
+		{ "CPS3"  , Element::CODE::TRIANGLE3,  3 },
+		{ "CPE3"  , Element::CODE::TRIANGLE3,  3 },
+		{ "CAX3"  , Element::CODE::TRIANGLE3,  3 },
+		{ "S3"    , Element::CODE::TRIANGLE3,  3 },
+		{ "CPS4"  , Element::CODE::SQUARE4  ,  4 },
+		{ "CPE4"  , Element::CODE::SQUARE4  ,  4 },
+		{ "CAX4"  , Element::CODE::SQUARE4  ,  4 },
+		{ "S4"    , Element::CODE::SQUARE4  ,  4 },
+		{ "CPS6"  , Element::CODE::TRIANGLE6,  6 },
+		{ "CPE6"  , Element::CODE::TRIANGLE6,  6 },
+		{ "CAX6"  , Element::CODE::TRIANGLE6,  6 },
+		{ "CPS8"  , Element::CODE::SQUARE8  ,  8 },
+		{ "CPE8"  , Element::CODE::SQUARE8  ,  8 },
+		{ "CAX8"  , Element::CODE::SQUARE8  ,  8 },
+		{ "S8"    , Element::CODE::SQUARE8  ,  8 },
+		{ "B21"   , Element::CODE::LINE2    ,  2 },
+		{ "B31"   , Element::CODE::LINE2    ,  2 },
+		{ "T2D2"  , Element::CODE::LINE2    ,  2 },
+		{ "T3D2"  , Element::CODE::LINE2    ,  2 },
+		{ "B22"   , Element::CODE::LINE3    ,  3 },
+		{ "B32"   , Element::CODE::LINE3    ,  3 },
+		{ "T2D3"  , Element::CODE::LINE3    ,  3 },
+		{ "T3D3"  , Element::CODE::LINE3    ,  3 },
+};
 
 EList::EList()
-: NUM_NODES(-1), Solkey(0), NDMAX(-1), NDSEL(-1),
-  lineSize(0), elementSize(0), lineEndSize(-1),
-  indexSize(-1), indexLength(-1), valueSize(-1), valueLength(-1),
-  NUM_NODES_LINE1(0),NUM_NODE_LINE2(0)
+: code((int)Element::CODE::NOT_SUPPORTED), NUM_NODES(0)
 {
 	memset(TYPE, '\0', MAX_NAME_SIZE);
+	memset(ELSET, '\0', MAX_NAME_SIZE);
 }
 
 EList& EList::parse(const char* begin)
 {
 	std::string commandLine = Parser::getLine(begin);
-	lineEndSize = (*(commandLine.end() - 2) == '\r') ? 2 : 1;
-
-	const char* linebegin = begin ;
-	if (*(linebegin ) != '\n') {
-		while (*linebegin++ != '\n'); // start at new line
-	}
-
-	std::string elementLine = Parser::getLine(linebegin);
-	std::vector<std::string> elementData = Parser::split(elementLine, ",");
 
-	if (*(linebegin ) != '\n') {
-		while (*linebegin++ != '\n') {
-			lineSize +=1;  // start at new line
+	copy(TYPE, Parser::uppercase(parameter(commandLine, "TYPE")));
+	copy(ELSET, parameter(commandLine, "ELSET"));
+	for (size_t i = 0; i < sizeof(etypes) / sizeof(etypes[0]); ++i) {
+		if (strncmp(TYPE, etypes[i].prefix, strlen(etypes[i].prefix)) == 0) {
+			code = (int)etypes[i].code;
+			NUM_NODES = etypes[i].nodes;
+			break;
 		}
 	}
-
-	std::vector<std::string> command = Parser::split(commandLine, ",", false);
-	std::vector<std::string> ele_type = Parser::split(command[1], "=", false);
-	ele_type[1] = Parser::strip(ele_type[1]);
-	memcpy(TYPE,ele_type[1].data(),ele_type[1].size());
-
-	//std::istringstream iss(TYPE);
-	if (strcmp(TYPE, "C3D20R") == 0 ){
-		NUM_NODES = 20;
-	}
-
-	indexSize = 1;
-	indexLength = elementData[0].size()+1;
-	valueSize = elementData.size()-1;
-	valueLength = elementData[1].size()+1;
-
-	if ( atol(elementData.back().data()) == 0) {
-		valueSize = valueSize -1;
-	}
-
-	NUM_NODES_LINE1 = (lineSize - indexLength) / valueLength;
-	if (NUM_NODES_LINE1 < NUM_NODES){
-		NUM_NODE_LINE2 = NUM_NODES - NUM_NODES_LINE1;
+	if (NUM_NODES == 0) {
+		eslog::error("ABAQUS parser: not supported element type '%s'.\n", TYPE);
 	}
 
-	elementSize = lineSize + 1;
-	lineSize = lineSize + 1;
 	AbaqusParser::fillIndices(begin, begin + commandLine.size());
 	return *this;
 }
 
-
-void EList::fixOffsets(std::vector<size_t> &dataOffsets)
+// the line continues on the next line (the last value is followed by ',')
+static bool continues(const char *line)
 {
-	esint nodes;
-	if (fRank == info::mpi::rank) {
-		nodes = NUM_NODES;
-	}
-	Communication::broadcast(&nodes, sizeof(esint), MPI_BYTE, fRank);
-
-	int size1 = lineSize; // first line
-	int size2 = 0;
-	if (NUM_NODE_LINE2 != 0) {
-		size2 = NUM_NODE_LINE2 * valueLength -1 + lineEndSize + indexLength;
-	}
-
-	if (fRank != lRank && NUM_NODE_LINE2 != 0) {
-		for (int rank = fRank + 1; rank <= lRank; rank++) {
-			if ((dataOffsets[rank] - first) % (size1 + size2) != 0) {
-				dataOffsets[rank] += size2;
-				if (rank - 1 == info::mpi::rank) {
-					end += size2;
-				}
-				if (rank == info::mpi::rank) {
-					begin += size2;
-					offset += size2;
-				}
-			}
+	char last = '\0';
+	for (; *line != '\n' && *line != '\0'; ++line) {
+		if (*line != ' ' && *line != '\t' && *line != '\r') {
+			last = *line;
 		}
 	}
-
-	if (NUM_NODE_LINE2 == 0) {
-		//valueSize = valueSize - 8 + nodes;
-		//lineSize = valueSize * valueLength + lineEndSize;
-		Communication::broadcast(&valueSize, sizeof(esint), MPI_BYTE, fRank);
-		Communication::broadcast(&lineSize, sizeof(esint), MPI_BYTE, fRank);
-		size1 = elementSize = lineSize;
-	}
-	if (NDSEL == -1) {
-		NDSEL = (first - last) / (size1 + size2);
-	}
-	elementSize = size1 + size2;
+	return last == ',';
 }
 
-bool EList::readData(MeshBuilder &mesh)
-{
-		return solid( mesh);
-}
-
-bool EList::solid(MeshBuilder &mesh)
+bool EList::readData(MeshData &mesh, bool continued)
 {
 	size_t threads = info::env::threads;
 
 	const char *first = getFirst(), *last = getLast();
+	std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, last - first);
+	std::vector<std::vector<esint> > tIDs(threads), tnodes(threads);
+	std::vector<int> terror(threads, 0);
 
-	std::vector<std::vector<esint> > tesize(threads), tnodes(threads), tIDs(threads);
-	std::vector<std::vector<int> > ttype(threads), tet(threads), tbody(threads), tmat(threads);
-	size_t size = (last - first) / elementSize;
-//	if (  element_dict[TYPE].compare("D1LINE_2NODES")==0     ) {
-	if (strcmp(TYPE, "B32") == 0 ) {
-		std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, size);
-
-		#pragma omp parallel for
-		for (size_t t = 0; t < threads; t++) {
-			std::vector<esint> esize, nodes, IDs;
-			std::vector<int> type, ansystype, body, mat;
-			for (auto element = first + elementSize * tdistribution[t]; element < first + elementSize * tdistribution[t + 1];) {
-				esize.push_back(3);
-				type.push_back(0);
-				type.back() = (esint)Element::CODE::LINE3;
-				std::string element_line = Parser::getLine(element);
-				std::vector<std::string> element_data = Parser::split(element_line, ",");
-				IDs.push_back(atol(element_data[0].data()));
-				for (size_t ii = 1; ii < element_data.size(); ii++){
-					nodes.push_back(atol(element_data[ii].data()));
-				}
-				//element += elementSize;
-				if (*(element ) != '\n') {  while (*element++ != '\n');  }  //element += lineEndSize;
+	#pragma omp parallel for
+	for (size_t t = 0; t < threads; t++) {
+		std::vector<esint> IDs, nodes;
+		const char *data = first + tdistribution[t], *end = first + tdistribution[t + 1];
+		bool skip = fRank != info::mpi::rank && continued;
+		if (tdistribution[t]) {
+			if (*(data - 1) != '\n') {
+				nextLine(data, end); // start at new line
 			}
-			tIDs[t].swap(IDs);
-			tesize[t].swap(esize);
-			tnodes[t].swap(nodes);
-			ttype[t].swap(type);
+			const char *previous = data - 1;
+			while (previous > first && *(previous - 1) != '\n') { --previous; }
+			skip = previous >= first && continues(previous);
+		}
+		while (skip && data < end) { // the rest of an element parsed by the previous thread
+			skip = continues(data);
+			nextLine(data, end);
 		}
-	}
-	
-	if (strcmp(TYPE, "C3D8R") == 0 ) {
-//	else if (  element_dict[TYPE].compare("D3SOLID_8NODES")==0     ) {
-		std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, size);
 
-		#pragma omp parallel for
-		for (size_t t = 0; t < threads; t++) {
-			std::vector<esint> esize, nodes, IDs;
-			std::vector<int> type, ansystype, body, mat;
-			for (auto element = first + elementSize * tdistribution[t]; element < first + elementSize * tdistribution[t + 1];) {
-				esize.push_back(8);
-				type.push_back(0);
-				type.back() = (esint)Element::CODE::HEXA8;
-				std::string element_line = Parser::getLine(element);
-				std::vector<std::string> element_data = Parser::split(element_line, ",");
-				IDs.push_back(atol(element_data[0].data()));
-				for (size_t ii  =1; ii < element_data.size(); ii++){
-					nodes.push_back(atol(element_data[ii].data()));
+		while (data < end) {
+			const char *c = data;
+			char *next;
+			if (value(c)) {
+				esint id = strtol(c, &next, 10);
+				if (next != c) { // skip comments and empty lines
+					c = next;
+					IDs.push_back(id);
+					for (esint n = 0; n < NUM_NODES; ++n, c = next) {
+						while (!value(c) && *c != '\0') { // continuation line
+							while (*c == '\r' || *c == '\n') { ++c; }
+						}
+						nodes.push_back(strtol(c, &next, 10));
+						if (next == c) {
+							terror[t] = 1;
+							break;
+						}
+					}
+					if (terror[t]) {
+						break;
+					}
+					data = c;
 				}
-				if (*(element ) != '\n') {  while (*element++ != '\n');  } // start at new line
-
 			}
-			tIDs[t].swap(IDs);
-			tesize[t].swap(esize);
-			tnodes[t].swap(nodes);
-			ttype[t].swap(type);
+			nextLine(data, end);
 		}
-	}
-
-	if (strcmp(TYPE, "C3D10") == 0 ){
-//	else if(  element_dict [TYPE].compare("D3SOLID_10NODES")==0     ) {
-		std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, size);
-
-		#pragma omp parallel for
-		for (size_t t = 0; t < threads; t++) {
-			std::vector<esint> esize, nodes, IDs;
-			std::vector<int> type, ansystype, body, mat;
-			for (auto element = first + elementSize * tdistribution[t]; element < first + elementSize * tdistribution[t + 1];) {
-				esize.push_back(10);
-				type.push_back(0);
-				type.back() = (esint)Element::CODE::TETRA10;
-				std::string element_line = Parser::getLine(element);
-				std::vector<std::string> element_data = Parser::split(element_line, ",");
-				IDs.push_back(atol(element_data[0].data()));
-				for (size_t ii = 1; ii < element_data.size(); ii++){
-					nodes.push_back(atol(element_data[ii].data()));
-				}
-				if (*(element ) != '\n') {  while (*element++ != '\n');  } // start at new line
-
-			}  //for auto
 		tIDs[t].swap(IDs);
-		tesize[t].swap(esize);
 		tnodes[t].swap(nodes);
-		ttype[t].swap(type);
-		}
 	}
 
-	if (strcmp(TYPE, "C3D20R") == 0 ){
-//	else if(  element_dict [TYPE].compare("D3SOLID_10NODES")==0     ) {
-		std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, size);
-
-		#pragma omp parallel for
-		for (size_t t = 0; t < threads; t++) {
-			std::vector<esint> esize, nodes, IDs;
-			std::vector<int> type, ansystype, body, mat;
-			for (auto element = first + elementSize * tdistribution[t]; element < first + elementSize * tdistribution[t + 1];) {
-				esize.push_back(20);
-				type.push_back(0);
-				type.back() = (esint)Element::CODE::HEXA20;
-				std::string element_line = Parser::getLine(element);
-				std::vector<std::string> element_data = Parser::split(element_line, ",");
-				IDs.push_back(atol(element_data[0].data()));
-				for (size_t ii = 1; ii < element_data.size() - 1; ii++){
-					nodes.push_back(atol(element_data[ii].data()));
-				}
-				if (*(element ) != '\n') {  while (*element++ != '\n');  } // start at new line
-
-				element_line = Parser::getLine(element);
-				element_data = Parser::split(element_line, ",");
-				for (size_t ii = 0; ii < element_data.size(); ii++){
-					nodes.push_back(atol(element_data[ii].data()));
-				}
-				if (*(element ) != '\n') {  while (*element++ != '\n');  } // start at new line
-
-
-			}  //for auto
-		tIDs[t].swap(IDs);
-		tesize[t].swap(esize);
-		tnodes[t].swap(nodes);
-		ttype[t].swap(type);
+	for (size_t t = 0; t < threads; t++) {
+		if (terror[t]) {
+			return false;
 		}
 	}
 
-
-/*
-	size_t size = (last - first) / elementSize;
-
-	std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, size);
-
-
-	std::vector<std::vector<esint> > tesize(threads), tnodes(threads), tIDs(threads);
-	std::vector<std::vector<int> > ttype(threads), tet(threads), tbody(threads), tmat(threads);
-
-	std::string element_line1 = Parser::getLine(first);
-
-    #pragma omp parallel for
-	for (size_t t = 0; t < threads; t++) {
-		std::vector<esint> esize, nodes, IDs;
-			std::vector<int> type, body, mat;
-		    if (strcmp(TYPE, "B32") == 0 ){
-				for (auto element = first + elementSize * tdistribution[t]; element < first + elementSize * tdistribution[t + 1];) {
-					esize.push_back(3);
-					type.push_back(0);
-					type.back() = (esint)Element::CODE::LINE3;
-					std::string element_line = Parser::getLine(element);
-					std::vector<std::string> element_data = Parser::split(element_line, ",");
-					IDs.push_back(atol(element_data[0].data()));
-                    for (int ii=1; ii<element_data.size();ii++){
-                    	nodes.push_back(atol(element_data[ii].data()));
-                    }
-                    element += elementSize;
-					element += lineEndSize;
-				 }  //for auto
-              } // if e type
-		      if (strcmp(TYPE, "C3D8R") == 0 ){
-				for (auto element = first + elementSize * tdistribution[t]; element < first + elementSize * tdistribution[t + 1];) {
-					esize.push_back(8);
-					type.push_back(0);
-					type.back() = (esint)Element::CODE::HEXA8;
-					std::string element_line = Parser::getLine(element);
-					std::vector<std::string> element_data = Parser::split(element_line, ",");
-					IDs.push_back(atol(element_data[0].data()));
-					for (int ii=1; ii<element_data.size();ii++){
-						nodes.push_back(atol(element_data[ii].data()));
-					}
-					//element += elementSize;
-                                        if (*(element ) != '\n') {
-                                                                while (*element++ != '\n'); // start at new line
-                                                        }
-					 }  //for auto
-		      }// if e type C3D8R
-
-		      if (strcmp(TYPE, "C3D10") == 0 ){
-				for (auto element = first + elementSize * tdistribution[t]; element < first + elementSize * tdistribution[t + 1];) {
-					esize.push_back(8);
-					type.push_back(0);
-					type.back() = (esint)Element::CODE::TETRA10;
-					std::string element_line = Parser::getLine(element);
-					std::vector<std::string> element_data = Parser::split(element_line, ",");
-					IDs.push_back(atol(element_data[0].data()));
-					for (int ii=1; ii<element_data.size();ii++){
-						nodes.push_back(atol(element_data[ii].data()));
-					}
-					//element += elementSize;
-                                        if (*(element ) != '\n') {
-                                                                while (*element++ != '\n'); // start at new line
-                                                        }
-					}  //for auto
-			  }// if e type C3D8R
-        tIDs[t].swap(IDs);
-		tesize[t].swap(esize);
-		tnodes[t].swap(nodes);
-		ttype[t].swap(type);
-	} // for threads */
 	for (size_t t = 0; t < threads; t++) {
 		mesh.eIDs.insert(mesh.eIDs.end(), tIDs[t].begin(), tIDs[t].end());
-		mesh.esize.insert(mesh.esize.end(), tesize[t].begin(), tesize[t].end());
 		mesh.enodes.insert(mesh.enodes.end(), tnodes[t].begin(), tnodes[t].end());
-		mesh.etype.insert(mesh.etype.end(), ttype[t].begin(), ttype[t].end());
 	}
-	mesh.body.resize(mesh.etype.size());
-	mesh.material.resize(mesh.etype.size());
+	mesh.esize.resize(mesh.eIDs.size(), NUM_NODES);
+	mesh.etype.resize(mesh.eIDs.size(), code);
 	return true;
 }
-
-
-
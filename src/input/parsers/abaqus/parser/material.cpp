@@ -42,8 +42,10 @@ AbaqusMaterial& AbaqusMaterial::parse(const char* begin)
 		}
 		std::string propertyLine = Parser::getLine(linebegin);
 		std::vector<std::string> property = Parser::split(propertyLine, ",", false);
-		youngs_modulus = atof(property[0].data());
-		poisson_ratio = atof(property[1].data());
+		if (property.size() > 1) {
+			youngs_modulus = atof(property[0].data());
+			poisson_ratio = atof(property[1].data());
+		}
 	}
 
 	return *this;
@@ -6,24 +6,16 @@
 
 namespace mesio {
 
+// *NSET, NSET=name[, INSTANCE=name][, GENERATE]
 struct Nset: public AbaqusParser {
-	static size_t size;
-	static const char* upper;
-	static const char* lower;
-	static const char* sentence;
 	char NAME[MAX_NAME_SIZE];
-
-	esint NUMFIELD, Solkey, NDMAX, NDSEL;
-
-	esint lineSize, lineEndSize;
-	esint indexSize, indexLength, valueSize, valueLength;
+	char INSTANCE[MAX_NAME_SIZE];
+	bool GENERATE;
 
 	Nset();
 	Nset& parse(const char* begin);
 
 	bool readData(std::vector<esint> &indices);
-
-
 };
 
 }
@@ -2,20 +2,60 @@
 #include "parser.h"
 #include "blockend.h"
 
+#include "basis/containers/tarray.h"
 #include "esinfo/envinfo.h"
 #include "esinfo/mpiinfo.h"
+#include "basis/utilities/parser.h"
 
 #include <iostream>
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 using namespace mesio;
 
 size_t AbaqusParser::offset = 0;
 const char* AbaqusParser::begin = NULL;
 const char* AbaqusParser::end = NULL;
+size_t AbaqusParser::current = 0;
+
+std::string AbaqusParser::parameter(const std::string &command, const char* name)
+{
+	std::vector<std::string> parameters = Parser::split(command, ",", false);
+	for (size_t i = 1; i < parameters.size(); i++) {
+		std::vector<std::string> value = Parser::split(parameters[i], "=", false);
+		if (value.size() == 2 && StringCompare::caseInsensitiveEq(Parser::strip(value[0]), name)) {
+			std::string v = Parser::strip(value[1]);
+			if (v.size() > 1 && v.front() == '"' && v.back() == '"') {
+				v = v.substr(1, v.size() - 2);
+			}
+			return v;
+		}
+	}
+	return std::string();
+}
+
+bool AbaqusParser::option(const std::string &command, const char* name)
+{
+	std::vector<std::string> parameters = Parser::split(command, ",", false);
+	for (size_t i = 1; i < parameters.size(); i++) {
+		if (StringCompare::caseInsensitiveEq(Parser::strip(parameters[i]), name)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool AbaqusParser::copy(char *target, const std::string &value, size_t size)
+{
+	memset(target, '\0', size);
+	memcpy(target, value.data(), std::min(value.size(), size - 1));
+	return value.size() < size;
+}
 
 void AbaqusParser::fillIndices(const char* header, const char* data)
 {
+	this->file = current;
 	this->header = offset + header - begin;
 	this->first = offset + data - begin;
 }
@@ -53,7 +93,8 @@ const char* AbaqusParser::getLast() const
 void AbaqusParser::fillDistribution(std::vector<BlockFinish> &blocksFinishs, std::vector<size_t> &distribution)
 {
 	if (last == (size_t)-1) {
-		last = std::lower_bound(blocksFinishs.begin(), blocksFinishs.end(), first, [] (BlockFinish &b, size_t first) { return b.first < first; })->first;
+		auto next = std::lower_bound(blocksFinishs.begin(), blocksFinishs.end(), *this, [] (const BlockFinish &b, const AbaqusParser &p) { return b.file < p.file || (b.file == p.file && b.first < p.first); });
+		last = (next != blocksFinishs.end() && next->file == file) ? next->first : distribution.back();
 	}
 
 	fRank = std::lower_bound(distribution.begin(), distribution.end(), first + 1) - distribution.begin() - 1;
@@ -70,6 +111,59 @@ std::string AbaqusParser::command() const
 	return cmd;
 }
 
+bool AbaqusParser::readIndices(std::vector<esint> &indices, bool generate) const
+{
+	size_t threads = info::env::threads;
+
+	const char *first = getFirst(), *last = getLast();
+	std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, last - first);
+	std::vector<std::vector<esint> > tindices(threads);
+
+	#pragma omp parallel for
+	for (size_t t = 0; t < threads; t++) {
+		std::vector<esint> tind;
+		const char *data = first + tdistribution[t], *end = first + tdistribution[t + 1];
+		if (tdistribution[t] && *(data - 1) != '\n') {
+			nextLine(data, end); // start at new line
+		}
+		while (data < end) {
+			const char *c = data;
+			char *next;
+			if (generate) {
+				esint range[3] = { 0, 0, 1 }, n = 0;
+				for (; n < 3 && value(c); ++n, c = next) {
+					range[n] = strtol(c, &next, 10);
+					if (next == c) {
+						break;
+					}
+				}
+				if (n >= 2 && range[2] > 0) {
+					for (esint i = range[0]; i <= range[1]; i += range[2]) {
+						tind.push_back(i);
+					}
+				}
+			} else {
+				while (value(c)) {
+					esint index = strtol(c, &next, 10);
+					if (next != c) {
+						tind.push_back(index);
+						c = next;
+					} else {
+						while (*c != ',' && *c != '\n' && *c != '\r' && *c != '\0') { ++c; }
+					}
+				}
+			}
+			nextLine(data, end);
+		}
+		tindices[t].swap(tind);
+	}
+
+	for (size_t t = 0; t < threads; t++) {
+		indices.insert(indices.end(), tindices[t].begin(), tindices[t].end());
+	}
+	return true;
+}
+
 void AbaqusParser::print(const char* data)
 {
 	std::cout << first << "(" << fRank << ") -> " << last << "(" << lRank << ")\n";
@@ -10,6 +10,7 @@
 #define MAX_COMMAND_SIZE 150 // upper bound on command size
 #define MAX_LINE_SIZE 512 // upper bound on line size
 #define MAX_LINE_STEP 4   // sometimes we need to red more lines to get full information
+#define MAX_PATH_SIZE 256 // upper bound on included file path
 
 namespace mesio {
 
@@ -19,14 +20,39 @@ struct AbaqusParser {
 	static size_t offset;
 	static const char* begin;
 	static const char* end;
+	static size_t current; // index of the currently processed file
 
+	size_t file;
 	size_t header;
 	size_t first, last;
 	int fRank, lRank;
+	int part; // index of the part that contains the block (-1 for the model or the assembly)
 
 	AbaqusParser()
-	: header(-1),
-	  first(-1), last(-1), fRank(-1), lRank(-1) {}
+	: file(current), header(-1),
+	  first(-1), last(-1), fRank(-1), lRank(-1), part(-1) {}
+
+	// value of the keyword parameter 'name=value' (an empty string if the parameter is not set)
+	static std::string parameter(const std::string &command, const char* name);
+	// the keyword has the option 'name' without a value
+	static bool option(const std::string &command, const char* name);
+	// copy the value to a fixed size buffer (false if the value does not fit)
+	static bool copy(char *target, const std::string &value, size_t size = MAX_NAME_SIZE);
+
+	// move to the next value on the line (false at the end of the line)
+	static bool value(const char* &c)
+	{
+		while (*c == ' ' || *c == '\t') { ++c; }
+		if (*c == ',') { ++c; }
+		while (*c == ' ' || *c == '\t') { ++c; }
+		return *c != '\n' && *c != '\r' && *c != '\0';
+	}
+
+	// move to the start of the next line
+	static void nextLine(const char* &c, const char* end)
+	{
+		while (c < end && *c++ != '\n');
+	}
 
 	void fillIndices(const char* header, const char* data);
 	void fillIndices(const char* header, const char* first, const char* last);
@@ -38,6 +64,10 @@ struct AbaqusParser {
 	std::string command() const;
 
 	void print(const char* data);
+
+protected:
+	// integers of set lines, or ranges 'first, last[, step]' of generated sets (names of other sets are skipped)
+	bool readIndices(std::vector<esint> &indices, bool generate) const;
 };
 }
 
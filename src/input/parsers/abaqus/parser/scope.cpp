@@ -0,0 +1,55 @@
+
+#include "scope.h"
+
+#include "basis/utilities/parser.h"
+#include "esinfo/eslog.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace mesio;
+
+Scope::Scope()
+: type(Type::PART)
+{
+	memset(NAME, '\0', MAX_NAME_SIZE);
+	memset(PART, '\0', MAX_NAME_SIZE);
+	memset(INPUT, '\0', MAX_PATH_SIZE);
+	memset(translation, 0, sizeof(translation));
+	memset(rotation, 0, sizeof(rotation));
+}
+
+Scope& Scope::parse(const char* begin, Type type)
+{
+	this->type = type;
+	std::string commandLine = Parser::getLine(begin);
+
+	copy(NAME, parameter(commandLine, "NAME"));
+	copy(PART, parameter(commandLine, "PART"));
+	if (type == Type::INCLUDE) {
+		if (!copy(INPUT, parameter(commandLine, "INPUT"), MAX_PATH_SIZE)) {
+			eslog::error("ABAQUS parser: too long path of the included file '%s'.\n", Parser::strip(commandLine).c_str());
+		}
+		if (INPUT[0] == '\0') {
+			eslog::error("ABAQUS parser: *INCLUDE without INPUT parameter.\n");
+		}
+	}
+
+	const char *data = begin + commandLine.size();
+	if (type == Type::INSTANCE) {
+		// the translation is applied first, then the rotation about the axis a -> b
+		double *values[2] = { translation, rotation };
+		int sizes[2] = { 3, 7 };
+		for (int line = 0; line < 2 && *data != '*' && *data != '\0'; ++line) {
+			const char *c = data;
+			for (int v = 0; v < sizes[line] && value(c); ++v) {
+				char *next;
+				values[line][v] = strtod(c, &next);
+				c = next;
+			}
+			data += Parser::getLine(data).size();
+		}
+	}
+	AbaqusParser::fillIndices(begin, data);
+	return *this;
+}
@@ -0,0 +1,36 @@
+
+#ifndef SRC_INPUT_ABAQUS_PARSER_SCOPE_H_
+#define SRC_INPUT_ABAQUS_PARSER_SCOPE_H_
+
+#include "parser.h"
+
+namespace mesio {
+
+// keywords that structure the input: parts, the assembly, instances and included files
+struct Scope: public AbaqusParser {
+	enum class Type: int {
+		PART,
+		END_PART,
+		ASSEMBLY,
+		END_ASSEMBLY,
+		INSTANCE,
+		END_INSTANCE,
+		INCLUDE
+	};
+
+	Type type;
+	char NAME[MAX_NAME_SIZE];
+	char PART[MAX_NAME_SIZE];
+	char INPUT[MAX_PATH_SIZE];
+
+	// instance data lines: translation 'x, y, z' and rotation 'ax, ay, az, bx, by, bz, angle'
+	double translation[3];
+	double rotation[7];
+
+	Scope();
+	Scope& parse(const char* begin, Type type);
+};
+
+}
+
+#endif /* SRC_INPUT_ABAQUS_PARSER_SCOPE_H_ */
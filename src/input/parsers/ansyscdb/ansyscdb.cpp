@@ -73,6 +73,8 @@ void AnsysCDBLoader::scan()
 	parser.add("ET,", [&] (const char *c) { _ET.push_back(ET().parse(c)); });
 	parser.add("esel,", [&] (const char *c) { _ESel.push_back(ESel().parse(c)); });
 	parser.add("ESEL,", [&] (const char *c) { _ESel.push_back(ESel().parse(c)); });
+	parser.add("nsel,", [&] (const char *c) { _NSel.push_back(NSel().parse(c)); });
+	parser.add("NSEL,", [&] (const char *c) { _NSel.push_back(NSel().parse(c)); });
 	parser.add("cm,", [&] (const char *c) { _CM.push_back(CM().parse(c)); });
 	parser.add("CM,", [&] (const char *c) { _CM.push_back(CM().parse(c)); });
 
@@ -80,7 +82,7 @@ void AnsysCDBLoader::scan()
 	parser.addEnd(" -1", [&] (const char *c) { _blockEnds.push_back(BlockEnd().parse(c)); });
 
 	parser.scanlines(_file);
-	parser.synchronize(_blockEnds, _NBlocks, _EBlocks, _CMBlocks, _ET, _ESel, _CM);
+	parser.synchronize(_blockEnds, _NBlocks, _EBlocks, _CMBlocks, _ET, _ESel, _NSel, _CM);
 
 	setends(_NBlocks, _blockEnds, _file.distribution);
 	setends(_EBlocks, _blockEnds, _file.distribution);
@@ -137,7 +139,25 @@ void AnsysCDBLoader::parse()
 		}
 	}
 
-	for (size_t i = 0; i < _CM.size(); i++) {
-		_CM[i].addRegion(*this, _ESel, eregions, _NSel, nregions);
+	// selection commands are applied in the order of the file, everything is selected at the beginning
+	std::vector<char> eselected(eIDs.size(), 1), nselected(nIDs.size(), 1);
+	std::vector<Point> centers;
+	for (size_t i = 0; i < _ESel.size(); i++) {
+		if (_ESel[i].item == ESel::Item::CENT) {
+			ESel::computeCenters(*this, centers);
+			break;
+		}
+	}
+	for (size_t e = 0, n = 0, c = 0; e < _ESel.size() || n < _NSel.size() || c < _CM.size();) {
+		size_t eoffset = e < _ESel.size() ? _ESel[e].first : (size_t)-1;
+		size_t noffset = n < _NSel.size() ? _NSel[n].first : (size_t)-1;
+		size_t coffset = c < _CM.size() ? _CM[c].first : (size_t)-1;
+		if (eoffset <= noffset && eoffset <= coffset) {
+			_ESel[e++].apply(*this, _ET, centers, eselected);
+		} else if (noffset <= coffset) {
+			_NSel[n++].apply(*this, nselected);
+		} else {
+			_CM[c++].addRegion(*this, eselected, eregions, nselected, nregions);
+		}
 	}
 }
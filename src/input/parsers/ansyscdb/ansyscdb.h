@@ -22,7 +22,7 @@ struct CM;
 struct BlockEnd;
 
 struct AnsysCDBData: public MeshBuilder {
-	std::vector<int> et;
+	std::vector<int> et, real, section; // elements Ansys types, real constants, and sections
 };
 
 class AnsysCDBLoader: public AnsysCDBData {
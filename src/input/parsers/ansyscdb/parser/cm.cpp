@@ -1,9 +1,6 @@
 
 #include "cm.h"
 
-#include "esel.h"
-#include "nsel.h"
-
 #include "input/parsers/ansyscdb/ansyscdb.h"
 
 #include "basis/containers/tarray.h"
@@ -14,7 +11,6 @@
 #include "esinfo/eslog.hpp"
 
 #include <cstring>
-#include <functional>
 #include <algorithm>
 
 using namespace mesio;
@@ -53,7 +49,6 @@ CM& CM::parse(const char* begin)
 		}
 		if (StringCompare::caseInsensitiveEq("NODE", command[2])) {
 			entity = Entity::NODES;
-			eslog::error("MESIO Workbench parser error: implement cm, Entity='%s'\n", command[2].c_str());
 		}
 	case 2:
 		memcpy(name, command[1].data(), command[1].size() < MAX_NAME_SIZE ? command[1].size() : MAX_NAME_SIZE);
@@ -66,133 +61,35 @@ CM& CM::parse(const char* begin)
 	return *this;
 }
 
-bool CM::addRegion(
+void CM::addRegion(
 		const AnsysCDBData &mesh,
-		const std::vector<ESel> &esel, std::map<std::string, std::vector<esint> > &eregions,
-		const std::vector<NSel> &nsel, std::map<std::string, std::vector<esint> > &nregions)
+		const std::vector<char> &eselected, std::map<std::string, std::vector<esint> > &eregions,
+		const std::vector<char> &nselected, std::map<std::string, std::vector<esint> > &nregions) const
 {
-	switch (entity) {
-	case Entity::ELEMENTS:
-		return addElementRegion(mesh, esel, eregions);
-	case Entity::NODES:
-		return addNodeRegion(nsel, nregions);
-	default:
-		return false;
-	}
-}
-
-bool CM::addElementRegion(const AnsysCDBData &mesh, const std::vector<ESel> &esel, std::map<std::string, std::vector<esint> > &eregions)
-{
-	// clear relevant set means all elements
-	std::vector<ESel> relevant;
-	for (size_t i = 0; i < esel.size() && esel[i].first < first; i++) {
-		switch (esel[i].type) {
-		case ESel::Type::S:
-		case ESel::Type::NONE:
-			relevant.clear();
-			relevant.push_back(esel[i]);
-			break;
-		case ESel::Type::A:
-			if (relevant.size() == 1 && relevant[0].type == ESel::Type::NONE) {
-				relevant.clear();
-			}
-			relevant.push_back(esel[i]);
-			break;
-		case ESel::Type::ALL:
-			relevant.clear();
-			break;
-		default:
-			if (fRank == info::mpi::rank) {
-				eslog::error("MESIO Workbench parser error: not implemented type of esel command '%s'\n", esel[i].command().c_str());
-			}
-		}
-	}
-
-	if (relevant.size() == 0) {
-		return true;
-	}
+	auto store = [] (const std::vector<esint> &ids, const std::vector<char> &selected, std::vector<esint> &data) {
+		size_t threads = info::env::threads;
+		std::vector<size_t> distribution = tarray<size_t>::distribute(threads, selected.size());
+		std::vector<std::vector<esint> > tdata(threads);
 
-	size_t threads = info::env::threads;
-	std::vector<esint> edistribution = tarray<esint>::distribute(threads, mesh.esize.size());
-	std::vector<std::vector<esint> > eid(threads);
-
-	auto checkElements = [&] (std::function<void(size_t, esint)> chck) {
 		#pragma omp parallel for
 		for (size_t t = 0; t < threads; t++) {
-			for (esint e = edistribution[t]; e < edistribution[t + 1]; ++e) {
-				chck(t, e);
-			}
-		}
-	};
-
-	std::vector<esint> &data = eregions[name];
-	for (size_t i = 0; i < relevant.size(); i++) {
-		switch (relevant[i].item) {
-
-		case ESel::Item::TYPE:
-			if (relevant[i].VMIN == relevant[i].VMAX) {
-				checkElements([&] (size_t t, esint e) {
-					if (mesh.et[e] == relevant[i].VMIN) {
-						eid[t].push_back(mesh.eIDs[e]);
-					}
-				});
-				break;
-			}
-			if (relevant[i].VINC == 1) {
-				checkElements([&] (size_t t, esint e) {
-					if (relevant[i].VMIN <= mesh.et[e] && mesh.et[e] <= relevant[i].VMAX) {
-						eid[t].push_back(mesh.eIDs[e]);
-					}
-				});
-				break;
-			}
-			checkElements([&] (size_t t, esint e) {
-				if (relevant[i].VMIN <= mesh.et[e] && mesh.et[e] <= relevant[i].VMAX && (mesh.et[e] - relevant[i].VMIN) % relevant[i].VINC == 0) {
-					eid[t].push_back(mesh.eIDs[e]);
+			for (size_t i = distribution[t]; i < distribution[t + 1]; ++i) {
+				if (selected[i]) {
+					tdata[t].push_back(ids[i]);
 				}
-			});
-			break;
-
-		case ESel::Item::MAT:
-			if (relevant[i].VMIN == relevant[i].VMAX) {
-				checkElements([&] (size_t t, esint e) {
-					if (mesh.material[e] == relevant[i].VMIN) {
-						eid[t].push_back(mesh.eIDs[e]);
-					}
-				});
-				break;
 			}
-			if (relevant[i].VINC == 1) {
-				checkElements([&] (size_t t, esint e) {
-					if (relevant[i].VMIN <= mesh.material[e] && mesh.material[e] <= relevant[i].VMAX) {
-						eid[t].push_back(mesh.eIDs[e]);
-					}
-				});
-				break;
-			}
-			checkElements([&] (size_t t, esint e) {
-				if (relevant[i].VMIN <= mesh.material[e] && mesh.material[e] <= relevant[i].VMAX && (mesh.material[e] - relevant[i].VMIN) % relevant[i].VINC == 0) {
-					eid[t].push_back(mesh.eIDs[e]);
-				}
-			});
-			break;
+		}
 
-		default:
-			if (fRank == info::mpi::rank) {
-				eslog::error("MESIO Workbench parser error: not implemented type of esel command '%s'\n", esel[i].command().c_str());
-			}
+		data.clear();
+		for (size_t t = 0; t < threads; t++) {
+			data.insert(data.end(), tdata[t].begin(), tdata[t].end());
 		}
-	}
+		utils::sortAndRemoveDuplicates(data);
+	};
 
-	for (size_t t = 0; t < threads; t++) {
-		data.insert(data.end(), eid[t].begin(), eid[t].end());
+	switch (entity) {
+	case Entity::ELEMENTS: store(mesh.eIDs, eselected, eregions[name]); break;
+	case Entity::NODES: store(mesh.nIDs, nselected, nregions[name]); break;
+	default: break;
 	}
-	utils::sortAndRemoveDuplicates(data);
-
-	return true;
-}
-
-bool CM::addNodeRegion(const std::vector<NSel> &nsel, std::map<std::string, std::vector<esint> > &nregions)
-{
-	return false;
 }
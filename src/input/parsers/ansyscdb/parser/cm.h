@@ -8,12 +8,7 @@
 
 namespace mesio {
 
-struct ESel;
 struct AnsysCDBData;
-struct MeshERegion;
-
-struct NSel;
-struct MeshNRegion;
 
 struct CM: public WorkbenchParser {
 	enum class Entity: int {
@@ -31,14 +26,11 @@ struct CM: public WorkbenchParser {
 	CM();
 	CM& parse(const char* begin);
 
-	bool addRegion(
+	// store the current selection of elements (nodes) as a region
+	void addRegion(
 			const AnsysCDBData &mesh,
-			const std::vector<ESel> &esel, std::map<std::string, std::vector<esint> > &eregions,
-			const std::vector<NSel> &nsel, std::map<std::string, std::vector<esint> > &nregions);
-
-protected:
-	bool addElementRegion(const AnsysCDBData &mesh, const std::vector<ESel> &esel, std::map<std::string, std::vector<esint> > &eregions);
-	bool addNodeRegion(const std::vector<NSel> &nsel, std::map<std::string, std::vector<esint> > &nregions);
+			const std::vector<char> &eselected, std::map<std::string, std::vector<esint> > &eregions,
+			const std::vector<char> &nselected, std::map<std::string, std::vector<esint> > &nregions) const;
 };
 
 }
@@ -1,6 +1,7 @@
 
 #include "eblock.h"
 #include "et.h"
+#include "fixedwidth.h"
 #include "basis/containers/tarray.h"
 #include "basis/utilities/parser.h"
 #include "wrappers/mpi/communication.h"
@@ -77,7 +78,7 @@ bool EBlock::solid(const std::vector<ET> &et, AnsysCDBData &mesh)
 	std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, last - first);
 
 	std::vector<std::vector<esint> > tesize(threads), tnodes(threads), tIDs(threads);
-	std::vector<std::vector<int> > ttype(threads), tet(threads), tbody(threads), tmat(threads);
+	std::vector<std::vector<int> > ttype(threads), tet(threads), tbody(threads), tmat(threads), treal(threads), tsec(threads);
 
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
@@ -85,7 +86,7 @@ bool EBlock::solid(const std::vector<ET> &et, AnsysCDBData &mesh)
 		std::vector<esint> nindices(20);
 
 		std::vector<esint> esize, nodes, IDs;
-		std::vector<int> type, ansystype, body, mat;
+		std::vector<int> type, ansystype, body, mat, real, sec;
 
 		auto data = first + tdistribution[t];
 		if (tdistribution[t] && *(data - 1) != '\n') {
@@ -123,29 +124,60 @@ bool EBlock::solid(const std::vector<ET> &et, AnsysCDBData &mesh)
 			return atol(value.data());
 		};
 
+		// material, etype, real constant, section ID, element coordinate system, birth / death,
+		// solid model reference number, element shape flag, number of nodes, not used, element ID, nodes
+		long columns[19];
+		auto decode = [&] (const char *c, long *values, int count) { // fixed-width columns in place, false if the line deviates from the format
+			for (int i = 0; i < count; ++i, c += valueLength) {
+				if (!FixedWidth::integer(c, valueLength, values[i])) {
+					return false;
+				}
+			}
+			return c[lineEndSize - 1] == '\n' && (lineEndSize == 1 || c[0] == '\r');
+		};
+
 		while (data < first + tdistribution[t + 1]) {
+			int nnodes;
+			if (
+					FixedWidth::integer(data + 8 * valueLength, valueLength, columns[8]) &&
+					0 <= columns[8] && columns[8] <= 20 &&
+					decode(data, columns, 11 + std::min(8L, columns[8]))) {
+
+				nnodes = columns[8];
+				data += (11 + std::min(8, nnodes)) * valueLength + lineEndSize;
+			} else {
+				for (int i = 0; i < 11; i++) {
+					columns[i] = parse();
+				}
+				nnodes = columns[8];
+				for (int i = 0; i < 8 && i < nnodes; i++) {
+					columns[11 + i] = parse();
+				}
+				data += lineEndSize;
+			}
+
 			body.push_back(0);
-			mat.push_back(parse() - 1); // material
-			ansystype.push_back(parse() - 1); // etype
+			mat.push_back(columns[0] - 1); // material
+			real.push_back(columns[2]); // real constant
+			sec.push_back(columns[3]); // section ID
+			ansystype.push_back(columns[1] - 1); // etype
 			type.push_back(0);
-			skip(); // real constant
-			skip(); // section ID
-			skip(); // element coordinate system
-			skip(); // birth / death
-			skip(); // solid model reference number
-			skip(); // element shape flag
-			int nnodes = parse(); // number of nodes
-			skip(); // not used
-			IDs.push_back(parse() - 1); // element ID
-
+			IDs.push_back(columns[10] - 1); // element ID
 			for (int i = 0; i < 8 && i < nnodes; i++) {
-				nindices[i] = parse() - 1;
+				nindices[i] = columns[11 + i] - 1;
 			}
-			data += lineEndSize;
 
 			auto readNextNodes = [&] () {
-				for (int i = 0; i < nnodes - 8; i++) {
-					nindices[i + 8] = parse() - 1;
+				int next = std::max(0, nnodes - 8);
+				if (decode(data, columns, next)) {
+					data += next * valueLength;
+				} else {
+					for (int i = 0; i < next; i++) {
+						columns[i] = parse();
+					}
+				}
+				for (int i = 0; i < next; i++) {
+					nindices[i + 8] = columns[i] - 1;
 				}
 				data += lineEndSize;
 			};
@@ -273,6 +305,8 @@ bool EBlock::solid(const std::vector<ET> &et, AnsysCDBData &mesh)
 		tet[t].swap(ansystype);
 		tbody[t].swap(body);
 		tmat[t].swap(mat);
+		treal[t].swap(real);
+		tsec[t].swap(sec);
 	}
 
 	for (size_t t = 0; t < threads; t++) {
@@ -283,6 +317,8 @@ bool EBlock::solid(const std::vector<ET> &et, AnsysCDBData &mesh)
 		mesh.et.insert(mesh.et.end(), tet[t].begin(), tet[t].end());
 		mesh.body.insert(mesh.body.end(), tbody[t].begin(), tbody[t].end());
 		mesh.material.insert(mesh.material.end(), tmat[t].begin(), tmat[t].end());
+		mesh.real.insert(mesh.real.end(), treal[t].begin(), treal[t].end());
+		mesh.section.insert(mesh.section.end(), tsec[t].begin(), tsec[t].end());
 	}
 	return true;
 }
@@ -295,7 +331,7 @@ bool EBlock::boundary(const std::vector<ET> &et, AnsysCDBData &mesh)
 	std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, last - first);
 
 	std::vector<std::vector<esint> > tesize(threads), tnodes(threads), tIDs(threads);
-	std::vector<std::vector<int> > ttype(threads), tet(threads), tbody(threads), tmat(threads);
+	std::vector<std::vector<int> > ttype(threads), tet(threads), tbody(threads), tmat(threads), treal(threads), tsec(threads);
 
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
@@ -303,7 +339,7 @@ bool EBlock::boundary(const std::vector<ET> &et, AnsysCDBData &mesh)
 		std::vector<esint> nindices(20);
 
 		std::vector<esint> esize, nodes, IDs;
-		std::vector<int> type, ansystype, body, mat;
+		std::vector<int> type, ansystype, body, mat, real, sec;
 
 		auto data = first + tdistribution[t];
 		if (tdistribution[t] && *(data - 1) != '\n') {
@@ -320,21 +356,46 @@ bool EBlock::boundary(const std::vector<ET> &et, AnsysCDBData &mesh)
 			return atol(value.data());
 		};
 
+		// element ID, section ID, real constant, material, element coordinate system, nodes
+		long columns[25];
+		auto decode = [&] () { // fixed-width columns in place up to the line end, -1 if the line deviates from the format
+			const char *c = data;
+			int count = 0;
+			for (; count < 25 && *c != '\r' && *c != '\n'; ++count, c += valueLength) {
+				if (!FixedWidth::integer(c, valueLength, columns[count])) {
+					return -1;
+				}
+			}
+			if (count < 5 || c[lineEndSize - 1] != '\n' || (lineEndSize == 2 && c[0] != '\r')) {
+				return -1;
+			}
+			data = c;
+			return count - 5;
+		};
+
 		while (data < first + tdistribution[t + 1]) {
-			IDs.push_back(parse(data) - 1); // element ID
+			int enodes = decode();
+			if (enodes == -1) {
+				for (int i = 0; i < 5; i++) {
+					columns[i] = parse(data);
+				}
+				enodes = 0;
+				while (*data != '\r' && *data != '\n') {
+					columns[5 + enodes++] = parse(data);
+				}
+			}
+			data += lineEndSize;
+
+			IDs.push_back(columns[0] - 1); // element ID
 			body.push_back(0);
 			type.push_back(0);
 			ansystype.push_back(-1);
-			skip(data); // section ID
-			skip(data); // real constant
-			mat.push_back(parse(data) - 1); // material
-			skip(data); // element coordinate system
-
-			int enodes = 0;
-			while (*data != '\r' && *data != '\n') {
-				nindices[enodes++] = parse(data) - 1;
+			mat.push_back(columns[3] - 1); // material
+			real.push_back(columns[2]); // real constant
+			sec.push_back(columns[1]); // section ID
+			for (int i = 0; i < enodes; i++) {
+				nindices[i] = columns[5 + i] - 1;
 			}
-			data += lineEndSize;
 
 			if (enodes == 2) { // line2
 				esize.push_back(2);
@@ -381,6 +442,8 @@ bool EBlock::boundary(const std::vector<ET> &et, AnsysCDBData &mesh)
 		tet[t].swap(ansystype);
 		tbody[t].swap(body);
 		tmat[t].swap(mat);
+		treal[t].swap(real);
+		tsec[t].swap(sec);
 	}
 
 	for (size_t t = 0; t < threads; t++) {
@@ -391,6 +454,8 @@ bool EBlock::boundary(const std::vector<ET> &et, AnsysCDBData &mesh)
 		mesh.et.insert(mesh.et.end(), tet[t].begin(), tet[t].end());
 		mesh.body.insert(mesh.body.end(), tbody[t].begin(), tbody[t].end());
 		mesh.material.insert(mesh.material.end(), tmat[t].begin(), tmat[t].end());
+		mesh.real.insert(mesh.real.end(), treal[t].begin(), treal[t].end());
+		mesh.section.insert(mesh.section.end(), tsec[t].begin(), tsec[t].end());
 	}
 
 	return true;
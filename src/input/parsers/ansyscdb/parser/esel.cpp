@@ -1,162 +1,168 @@
 
 #include "esel.h"
+#include "et.h"
 
 #include "basis/utilities/parser.h"
+#include "basis/utilities/utils.h"
+#include "esinfo/mpiinfo.h"
 #include "esinfo/eslog.hpp"
+#include "input/parsers/ansyscdb/ansyscdb.h"
+#include "wrappers/mpi/communication.h"
+
+#include <algorithm>
+#include <numeric>
 
 using namespace mesio;
 
 ESel::ESel()
-: type(Type::UNKNOWN), item(Item::UNKNOWN), comp(Comp::UNKNOWN),
-  VMIN(0), VMAX(0), VINC(1),
-  KABS(false)
+: item(Item::UNKNOWN)
 {
 
 }
 
 ESel& ESel::parse(const char* begin)
 {
-	std::string commandLine = Parser::removecomments(Parser::getLine(begin), "!");
-	std::vector<std::string> command = Parser::split(Parser::strip(commandLine), ",", false);
-
-	switch (command.size()) {
-	case 8:
-		KABS = std::stoi(command[7]);
-	case 7:
-		if (command[6].size()) {
-			VINC = std::stoi(command[6]);
-		}
-	case 6:
-		if (command[5].size()) {
-			size_t end;
-			VMAX = std::stoi(command[5], &end) - 1;
-			if (end != command[5].size()) {
-				eslog::error("MESIO Workbench parser error: implement esel, VMAX='%s'\n", command[5].c_str());
-			}
-		}
-	case 5:
-		if (command[4].size()) {
-			size_t end;
-			VMIN = std::stoi(command[4], &end) - 1;
-			if (end != command[4].size()) {
-				eslog::error("MESIO Workbench parser error: implement esel, VMIN='%s'\n", command[4].c_str());
-			}
-		}
-		if (command.size() < 6 || command[5].size() == 0) {
-			VMAX = VMIN;
-		}
-	case 4:
-		if (command[3].size()) {
-			eslog::error("MESIO Workbench parser error: implement esel, Comp='%s'\n", command[3].c_str());
-		}
-	case 3:
-		if (StringCompare::caseInsensitiveEq("ELEM", command[2])) {
-			item = Item::ELEM;
-		}
-		if (StringCompare::caseInsensitiveEq("ADJ", command[2])) {
-			item = Item::ADJ;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("CENT", command[2])) {
-			item = Item::CENT;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("TYPE", command[2])) {
-			item = Item::TYPE;
-		}
-		if (StringCompare::caseInsensitiveEq("ENAME", command[2])) {
-			item = Item::ENAME;
-			eslog::error("MESIO Workbench parser error: not implemented esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("MAT", command[2])) {
-			item = Item::MAT;
-		}
-		if (StringCompare::caseInsensitiveEq("REAL", command[2])) {
-			item = Item::REAL;
-		}
-		if (StringCompare::caseInsensitiveEq("ESYS", command[2])) {
-			item = Item::ESYS;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("PART", command[2])) {
-			item = Item::PART;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("LIVE", command[2])) {
-			item = Item::LIVE;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("LAYER", command[2])) {
-			item = Item::LAYER;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("SEC", command[2])) {
-			item = Item::SEC;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("STRA", command[2])) {
-			item = Item::STRA;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("SFE", command[2])) {
-			item = Item::SFE;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("BFE", command[2])) {
-			item = Item::BFE;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("PATH", command[2])) {
-			item = Item::PATH;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("ETAB", command[2])) {
-			item = Item::ETAB;
-			eslog::error("MESIO Workbench parser error: implement esel, Item='%s'\n", command[2].c_str());
-		}
-	case 2:
-		if (StringCompare::caseInsensitiveEq("S", command[1])) {
-			type = Type::S;
-		}
-		if (StringCompare::caseInsensitiveEq("R", command[1])) {
-			type = Type::R;
-			eslog::error("MESIO Workbench parser error: implement esel, Type='%s'\n", command[1].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("A", command[1])) {
-			type = Type::A;
-		}
-		if (StringCompare::caseInsensitiveEq("U", command[1])) {
-			type = Type::U;
-			eslog::error("MESIO Workbench parser error: implement esel, Type='%s'\n", command[1].c_str());
-		}
-		if (StringCompare::caseInsensitiveEq("ALL", command[1])) {
-			type = Type::ALL;
-		}
-		if (StringCompare::caseInsensitiveEq("NONE", command[1])) {
-			type = Type::NONE;
-		}
-		if (StringCompare::caseInsensitiveEq("INVE", command[1])) {
-			type = Type::INVE;
-			eslog::error("MESIO Workbench parser error: implement esel, Type='%s'\n", command[1].c_str());
+	std::string name = Selection::parse(begin, "esel");
+	if (type != Type::S && type != Type::R && type != Type::A && type != Type::U) {
+		return *this;
+	}
+
+	item = Item::ELEM;
+	if (StringCompare::caseInsensitiveEq("ADJ", name)) { item = Item::ADJ; }
+	if (StringCompare::caseInsensitiveEq("CENT", name)) { item = Item::CENT; }
+	if (StringCompare::caseInsensitiveEq("TYPE", name)) { item = Item::TYPE; }
+	if (StringCompare::caseInsensitiveEq("ENAME", name)) { item = Item::ENAME; }
+	if (StringCompare::caseInsensitiveEq("MAT", name)) { item = Item::MAT; }
+	if (StringCompare::caseInsensitiveEq("REAL", name)) { item = Item::REAL; }
+	if (StringCompare::caseInsensitiveEq("ESYS", name)) { item = Item::ESYS; }
+	if (StringCompare::caseInsensitiveEq("PART", name)) { item = Item::PART; }
+	if (StringCompare::caseInsensitiveEq("LIVE", name)) { item = Item::LIVE; }
+	if (StringCompare::caseInsensitiveEq("LAYER", name)) { item = Item::LAYER; }
+	if (StringCompare::caseInsensitiveEq("SEC", name)) { item = Item::SEC; }
+	if (StringCompare::caseInsensitiveEq("STRA", name)) { item = Item::STRA; }
+	if (StringCompare::caseInsensitiveEq("SFE", name)) { item = Item::SFE; }
+	if (StringCompare::caseInsensitiveEq("BFE", name)) { item = Item::BFE; }
+	if (StringCompare::caseInsensitiveEq("PATH", name)) { item = Item::PATH; }
+	if (StringCompare::caseInsensitiveEq("ETAB", name)) { item = Item::ETAB; }
+	if (name.size() && !StringCompare::caseInsensitiveEq("ELEM", name) && item == Item::ELEM) {
+		item = Item::UNKNOWN;
+	}
+
+	switch (item) {
+	case Item::ELEM:
+	case Item::TYPE:
+	case Item::ENAME:
+	case Item::MAT:
+	case Item::REAL:
+	case Item::SEC:
+		if (comp != Comp::NONE) {
+			eslog::error("MESIO Workbench parser error: not supported esel, Item='%s' has no component\n", name.c_str());
 		}
-		if (StringCompare::caseInsensitiveEq("STAT", command[1])) {
-			type = Type::STAT;
-			eslog::error("MESIO Workbench parser error: implement esel, Type='%s'\n", command[1].c_str());
+		break;
+	case Item::CENT:
+		if (comp == Comp::NONE) {
+			eslog::error("MESIO Workbench parser error: esel, Item='CENT' requires component X, Y, or Z\n");
 		}
 		break;
 	default:
-		eslog::error("MESIO Workbench parser error: unknown format of '%s'\n", commandLine.c_str());
+		eslog::error("MESIO Workbench parser error: not supported esel, Item='%s'\n", name.c_str());
 	}
+	return *this;
+}
 
-	if (type == Type::UNKNOWN) {
-		eslog::error("MESIO Workbench parser error: implement esel, Type='%s'\n", command[1].c_str());
-	}
-	if (comp != Comp::UNKNOWN) {
-		eslog::error("MESIO Workbench parser error: implement esel, Comp='%s'\n", command[3].c_str());
+void ESel::apply(const AnsysCDBData &mesh, const std::vector<ET> &et, const std::vector<Point> &centers, std::vector<char> &selected) const
+{
+	if (type != Type::S && type != Type::R && type != Type::A && type != Type::U) {
+		select(selected, [] (size_t e) { return false; });
+		return;
 	}
 
-	WorkbenchParser::fillIndices(begin, begin, begin);
-	return *this;
+	// all values are compared in 1-based Ansys numbering
+	switch (item) {
+	case Item::ELEM:  select(selected, [&] (size_t e) { return integer(mesh.eIDs[e] + 1); }); break;
+	case Item::TYPE:  select(selected, [&] (size_t e) { return integer(mesh.et[e] + 1); }); break;
+	case Item::MAT:   select(selected, [&] (size_t e) { return integer(mesh.material[e] + 1); }); break;
+	case Item::REAL:  select(selected, [&] (size_t e) { return integer(mesh.real[e]); }); break;
+	case Item::SEC:   select(selected, [&] (size_t e) { return integer(mesh.section[e]); }); break;
+	case Item::ENAME: select(selected, [&] (size_t e) { return 0 <= mesh.et[e] && mesh.et[e] < (int)et.size() && integer(et[mesh.et[e]].type); }); break;
+	case Item::CENT:  select(selected, [&] (size_t e) { return real(centers[e][(int)comp - (int)Comp::X]); }); break;
+	default: break;
+	}
 }
 
+void ESel::computeCenters(const AnsysCDBData &mesh, std::vector<Point> &centers)
+{
+	// nodes are sent to buckets according to their IDs, elements ask buckets for coordinates of their nodes
+	esint maxID = 0, gmaxID;
+	for (size_t n = 0; n < mesh.nIDs.size(); ++n) {
+		maxID = std::max(maxID, mesh.nIDs[n]);
+	}
+	Communication::allReduce(&maxID, &gmaxID, 1, MPITools::getType<esint>().mpitype, MPI_MAX);
+	auto bucket = [&] (esint id) {
+		return (int)(std::min((size_t)std::max(id, (esint)0), (size_t)gmaxID) * info::mpi::size / ((size_t)gmaxID + 1));
+	};
+
+	auto exchange = [] (const std::vector<int> &ssize, std::vector<int> &rsize) {
+		rsize.resize(info::mpi::size);
+		MPI_Alltoall(ssize.data(), 1, MPI_INT, rsize.data(), 1, MPI_INT, info::mpi::comm);
+		return std::accumulate(rsize.begin(), rsize.end(), (size_t)0);
+	};
 
+	std::vector<int> ssize(info::mpi::size), rsize;
+	std::vector<esint> permutation(mesh.nIDs.size()), sids(mesh.nIDs.size()), bids;
+	std::vector<Point> scoords(mesh.nIDs.size()), bcoords;
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::sort(permutation.begin(), permutation.end(), [&] (esint i, esint j) { return mesh.nIDs[i] < mesh.nIDs[j]; });
+	for (size_t n = 0; n < permutation.size(); ++n) {
+		sids[n] = mesh.nIDs[permutation[n]];
+		scoords[n] = mesh.coordinates[permutation[n]];
+		++ssize[bucket(sids[n])];
+	}
+	bids.resize(exchange(ssize, rsize));
+	bcoords.resize(bids.size());
+	if (!Communication::allToAllV(sids, bids, ssize, rsize) || !Communication::allToAllV(scoords, bcoords, ssize, rsize)) {
+		eslog::internalFailure("cannot exchange nodes coordinates.\n");
+	}
+
+	// buckets are sorted and answer requests
+	permutation.resize(bids.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::sort(permutation.begin(), permutation.end(), [&] (esint i, esint j) { return bids[i] < bids[j]; });
+
+	std::vector<esint> requests = mesh.enodes, brequests;
+	utils::sortAndRemoveDuplicates(requests);
+	std::fill(ssize.begin(), ssize.end(), 0);
+	for (size_t n = 0; n < requests.size(); ++n) {
+		++ssize[bucket(requests[n])];
+	}
+	brequests.resize(exchange(ssize, rsize));
+	if (!Communication::allToAllV(requests, brequests, ssize, rsize)) {
+		eslog::internalFailure("cannot exchange nodes requests.\n");
+	}
+
+	std::vector<Point> banswers(brequests.size()), answers(requests.size());
+	#pragma omp parallel for
+	for (size_t n = 0; n < brequests.size(); ++n) {
+		auto it = std::lower_bound(permutation.begin(), permutation.end(), brequests[n], [&] (esint i, esint id) { return bids[i] < id; });
+		if (it != permutation.end() && bids[*it] == brequests[n]) {
+			banswers[n] = bcoords[*it];
+		}
+	}
+	if (!Communication::allToAllV(banswers, answers, rsize, ssize)) {
+		eslog::internalFailure("cannot exchange nodes coordinates.\n");
+	}
+
+	std::vector<esint> eoffset(mesh.esize.size() + 1);
+	for (size_t e = 0; e < mesh.esize.size(); ++e) {
+		eoffset[e + 1] = eoffset[e] + mesh.esize[e];
+	}
+	centers.resize(mesh.esize.size());
+	#pragma omp parallel for
+	for (size_t e = 0; e < mesh.esize.size(); ++e) {
+		Point center;
+		for (esint n = eoffset[e]; n < eoffset[e + 1]; ++n) {
+			center += answers[std::lower_bound(requests.begin(), requests.end(), mesh.enodes[n]) - requests.begin()];
+		}
+		centers[e] = center / std::max(mesh.esize[e], (esint)1);
+	}
+}
@@ -2,23 +2,15 @@
 #ifndef SRC_INPUT_WORKBENCH_PARSER_ESEL_H_
 #define SRC_INPUT_WORKBENCH_PARSER_ESEL_H_
 
-#include "parser.h"
+#include "selection.h"
+#include "basis/containers/point.h"
 
 namespace mesio {
 
-struct ESel: public WorkbenchParser {
-	enum class Type: int {
-		UNKNOWN,
-		S,
-		R,
-		A,
-		U,
-		ALL,
-		NONE,
-		INVE,
-		STAT
-	};
+struct AnsysCDBData;
+struct ET;
 
+struct ESel: public Selection {
 	enum class Item: int {
 		UNKNOWN,
 		ELEM,
@@ -40,18 +32,16 @@ struct ESel: public WorkbenchParser {
 		ETAB
 	};
 
-	enum class Comp: int {
-		UNKNOWN
-	};
-
-	Type type;
 	Item item;
-	Comp comp;
-	esint VMIN, VMAX, VINC;
-	bool KABS;
 
 	ESel();
 	ESel& parse(const char* begin);
+
+	// update selected elements (in the order of mesh.eIDs)
+	void apply(const AnsysCDBData &mesh, const std::vector<ET> &et, const std::vector<Point> &centers, std::vector<char> &selected) const;
+
+	// centers of local elements (nodes coordinates are gathered from other processes)
+	static void computeCenters(const AnsysCDBData &mesh, std::vector<Point> &centers);
 };
 
 }
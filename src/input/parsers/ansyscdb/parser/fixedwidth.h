@@ -0,0 +1,115 @@
+
+#ifndef SRC_INPUT_WORKBENCH_PARSER_FIXEDWIDTH_H_
+#define SRC_INPUT_WORKBENCH_PARSER_FIXEDWIDTH_H_
+
+#include "basis/utilities/inline.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace mesio {
+
+// in-place decoding of fixed-width Fortran columns (e.g. '(3i9,6e21.13e3)')
+// methods return false if a field does not match the format (the caller falls back to atol / atof)
+struct FixedWidth {
+
+	// eight digits at once (SWAR), the first character is the most significant digit
+	static ALWAYS_INLINE bool digits8(const char *c, uint64_t &value)
+	{
+		uint64_t v;
+		memcpy(&v, c, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		v = __builtin_bswap64(v);
+#endif
+		if (((v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL) {
+			return false;
+		}
+		v -= 0x3030303030303030ULL;
+		v = (v * 10) + (v >> 8);
+		v = (((v & 0x000000FF000000FFULL) * 0x000F424000000064ULL) + (((v >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+		value = (uint32_t)v;
+		return true;
+	}
+
+	// digits up to the end of the field or the first non-digit character
+	static ALWAYS_INLINE int digits(const char* &c, const char *end, uint64_t &value)
+	{
+		const char *begin = c;
+		uint64_t d8;
+		while (end - c >= 8 && digits8(c, d8)) {
+			value = 100000000 * value + d8;
+			c += 8;
+		}
+		for (unsigned d; c < end && (d = *c - '0') < 10; ++c) {
+			value = 10 * value + d;
+		}
+		return c - begin;
+	}
+
+	// right-aligned integer 'iw': leading blanks, optional sign, digits
+	static ALWAYS_INLINE bool integer(const char *c, int width, long &value)
+	{
+		const char *end = c + width;
+		while (c < end && *c == ' ') { ++c; }
+		bool negative = c < end && *c == '-';
+		if (c < end && (*c == '-' || *c == '+')) { ++c; }
+
+		uint64_t v = 0;
+		int n = digits(c, end, v);
+		if (n == 0 || n > 18 || c != end) {
+			return false;
+		}
+		value = negative ? -(long)v : (long)v;
+		return true;
+	}
+
+	// real number 'ew.d[ee]': leading blanks, optional sign, mantissa with a decimal point, optional exponent
+	// only values that are exactly representable by a single multiplication / division are accepted (the result equals strtod)
+	static ALWAYS_INLINE bool real(const char *c, int width, double &value)
+	{
+		static const double pow10[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+				1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		const char *end = c + width;
+		while (c < end && *c == ' ') { ++c; }
+		bool negative = c < end && *c == '-';
+		if (c < end && (*c == '-' || *c == '+')) { ++c; }
+
+		uint64_t mantissa = 0;
+		int n = digits(c, end, mantissa), exponent = 0;
+		if (c < end && *c == '.') {
+			++c;
+			int fraction = digits(c, end, mantissa);
+			n += fraction;
+			exponent -= fraction;
+		}
+		if (n == 0 || n > 19) {
+			return false;
+		}
+		if (c < end && (*c == 'E' || *c == 'e' || *c == 'D' || *c == 'd')) {
+			++c;
+			bool enegative = c < end && *c == '-';
+			if (c < end && (*c == '-' || *c == '+')) { ++c; }
+			uint64_t e = 0;
+			int en = digits(c, end, e);
+			if (en == 0 || en > 4) {
+				return false;
+			}
+			exponent += enegative ? -(int)e : (int)e;
+		}
+		while (c < end && *c == ' ') { ++c; }
+		if (c != end || mantissa > (1ULL << 53) || exponent < -22 || 22 < exponent) {
+			return false;
+		}
+		value = exponent < 0 ? mantissa / pow10[-exponent] : mantissa * pow10[exponent];
+		if (negative) {
+			value = -value;
+		}
+		return true;
+	}
+};
+
+}
+
+#endif /* SRC_INPUT_WORKBENCH_PARSER_FIXEDWIDTH_H_ */
@@ -1,5 +1,6 @@
 
 #include "nblock.h"
+#include "fixedwidth.h"
 
 #include "basis/containers/point.h"
 #include "basis/containers/tarray.h"
@@ -106,7 +107,32 @@ bool NBlock::readData(AnsysCDBData &mesh)
 			return .0;
 		};
 
+		auto decode = [&] () { // the whole line in place, false if the line deviates from the format
+			const char *c = data;
+			long id;
+			double x[3] = { 0, 0, 0 };
+			if (!FixedWidth::integer(c, indexLength, id)) {
+				return false;
+			}
+			c += indexSize * indexLength;
+			for (int v = 0; v < valueSize && *c != '\r' && *c != '\n'; ++v, c += valueLength) {
+				if (v < 3 && !FixedWidth::real(c, valueLength, x[v])) {
+					return false;
+				}
+			}
+			if (c[lineEndSize - 1] != '\n' || (lineEndSize == 2 && c[0] != '\r')) {
+				return false;
+			}
+			ids.push_back(id - 1);
+			coords.push_back(Point(x[0], x[1], x[2]));
+			data = c + lineEndSize;
+			return true;
+		};
+
 		while (data < first + tdistribution[t + 1]) {
+			if (decode()) {
+				continue;
+			}
 			ids.push_back(getindex());
 			data += (indexSize - 1) * indexLength; // skip solid and line indices
 			double x = getvalue();
@@ -1,7 +1,66 @@
 
 #include "nsel.h"
 
+#include "basis/utilities/parser.h"
+#include "esinfo/eslog.hpp"
+#include "input/parsers/ansyscdb/ansyscdb.h"
+
 using namespace mesio;
 
+NSel::NSel()
+: item(Item::UNKNOWN)
+{
+
+}
+
+NSel& NSel::parse(const char* begin)
+{
+	std::string name = Selection::parse(begin, "nsel");
+	if (type != Type::S && type != Type::R && type != Type::A && type != Type::U) {
+		return *this;
+	}
+
+	item = Item::NODE;
+	if (StringCompare::caseInsensitiveEq("EXT", name)) { item = Item::EXT; }
+	if (StringCompare::caseInsensitiveEq("LOC", name)) { item = Item::LOC; }
+	if (StringCompare::caseInsensitiveEq("ANG", name)) { item = Item::ANG; }
+	if (StringCompare::caseInsensitiveEq("M", name)) { item = Item::M; }
+	if (StringCompare::caseInsensitiveEq("CP", name)) { item = Item::CP; }
+	if (StringCompare::caseInsensitiveEq("CE", name)) { item = Item::CE; }
+	if (StringCompare::caseInsensitiveEq("D", name)) { item = Item::D; }
+	if (StringCompare::caseInsensitiveEq("F", name)) { item = Item::F; }
+	if (StringCompare::caseInsensitiveEq("BF", name)) { item = Item::BF; }
+	if (name.size() && !StringCompare::caseInsensitiveEq("NODE", name) && item == Item::NODE) {
+		item = Item::UNKNOWN;
+	}
+
+	switch (item) {
+	case Item::NODE:
+		if (comp != Comp::NONE) {
+			eslog::error("MESIO Workbench parser error: not supported nsel, Item='%s' has no component\n", name.c_str());
+		}
+		break;
+	case Item::LOC:
+		if (comp == Comp::NONE) {
+			eslog::error("MESIO Workbench parser error: nsel, Item='LOC' requires component X, Y, or Z\n");
+		}
+		break;
+	default:
+		eslog::error("MESIO Workbench parser error: not supported nsel, Item='%s'\n", name.c_str());
+	}
+	return *this;
+}
 
+void NSel::apply(const AnsysCDBData &mesh, std::vector<char> &selected) const
+{
+	if (type != Type::S && type != Type::R && type != Type::A && type != Type::U) {
+		select(selected, [] (size_t n) { return false; });
+		return;
+	}
 
+	switch (item) {
+	case Item::NODE: select(selected, [&] (size_t n) { return integer(mesh.nIDs[n] + 1); }); break;
+	case Item::LOC:  select(selected, [&] (size_t n) { return real(mesh.coordinates[n][(int)comp - (int)Comp::X]); }); break;
+	default: break;
+	}
+}
@@ -2,14 +2,34 @@
 #ifndef SRC_INPUT_WORKBENCH_PARSER_NSEL_H_
 #define SRC_INPUT_WORKBENCH_PARSER_NSEL_H_
 
-#include "parser.h"
+#include "selection.h"
 
 namespace mesio {
 
-// TODO: implement me
-
-struct NSel: public WorkbenchParser {
-
+struct AnsysCDBData;
+
+struct NSel: public Selection {
+	enum class Item: int {
+		UNKNOWN,
+		NODE,
+		EXT,
+		LOC,
+		ANG,
+		M,
+		CP,
+		CE,
+		D,
+		F,
+		BF
+	};
+
+	Item item;
+
+	NSel();
+	NSel& parse(const char* begin);
+
+	// update selected nodes (in the order of mesh.nIDs)
+	void apply(const AnsysCDBData &mesh, std::vector<char> &selected) const;
 };
 
 }
@@ -0,0 +1,103 @@
+
+#include "selection.h"
+
+#include "basis/utilities/parser.h"
+#include "esinfo/eslog.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace mesio;
+
+Selection::Selection()
+: type(Type::UNKNOWN), comp(Comp::NONE),
+  VMIN(0), VMAX(0), VINC(1),
+  KABS(false)
+{
+
+}
+
+std::string Selection::parse(const char* begin, const char* name)
+{
+	std::string commandLine = Parser::removecomments(Parser::getLine(begin), "!");
+	std::vector<std::string> command = Parser::split(Parser::strip(commandLine), ",", false);
+	for (size_t i = 0; i < command.size(); i++) {
+		command[i] = Parser::strip(command[i]);
+	}
+
+	auto value = [&] (const std::string &parameter, double &target) {
+		char *end;
+		target = strtod(parameter.c_str(), &end);
+		if (*end != '\0') {
+			eslog::error("MESIO Workbench parser error: not supported value '%s' of %s '%s'\n", parameter.c_str(), name, commandLine.c_str());
+		}
+	};
+
+	if (command.size() < 2 || 8 < command.size()) {
+		eslog::error("MESIO Workbench parser error: unknown format of '%s'\n", commandLine.c_str());
+	}
+
+	if (StringCompare::caseInsensitiveEq("S", command[1])) { type = Type::S; }
+	if (StringCompare::caseInsensitiveEq("R", command[1])) { type = Type::R; }
+	if (StringCompare::caseInsensitiveEq("A", command[1])) { type = Type::A; }
+	if (StringCompare::caseInsensitiveEq("U", command[1])) { type = Type::U; }
+	if (StringCompare::caseInsensitiveEq("ALL", command[1])) { type = Type::ALL; }
+	if (StringCompare::caseInsensitiveEq("NONE", command[1])) { type = Type::NONE; }
+	if (StringCompare::caseInsensitiveEq("INVE", command[1])) { type = Type::INVE; }
+	if (StringCompare::caseInsensitiveEq("STAT", command[1])) { type = Type::STAT; }
+	if (type == Type::UNKNOWN) {
+		eslog::error("MESIO Workbench parser error: not supported %s, Type='%s'\n", name, command[1].c_str());
+	}
+
+	WorkbenchParser::fillIndices(begin, begin, begin);
+
+	if (type != Type::S && type != Type::R && type != Type::A && type != Type::U) {
+		return std::string();
+	}
+
+	if (command.size() > 3 && command[3].size()) {
+		if (StringCompare::caseInsensitiveEq("X", command[3])) { comp = Comp::X; }
+		if (StringCompare::caseInsensitiveEq("Y", command[3])) { comp = Comp::Y; }
+		if (StringCompare::caseInsensitiveEq("Z", command[3])) { comp = Comp::Z; }
+		if (comp == Comp::NONE) {
+			eslog::error("MESIO Workbench parser error: not supported %s, Comp='%s'\n", name, command[3].c_str());
+		}
+	}
+	if (command.size() > 4 && command[4].size()) {
+		value(command[4], VMIN);
+	}
+	VMAX = VMIN;
+	if (command.size() > 5 && command[5].size()) {
+		value(command[5], VMAX);
+	}
+	if (command.size() > 6 && command[6].size()) {
+		double inc;
+		value(command[6], inc);
+		VINC = std::max((esint)1, (esint)std::fabs(inc));
+	}
+	if (command.size() > 7 && command[7].size()) {
+		KABS = std::atoi(command[7].c_str());
+	}
+	if (command.size() > 2) {
+		return command[2];
+	}
+	return std::string();
+}
+
+bool Selection::integer(esint value) const
+{
+	if (KABS) {
+		value = std::abs(value);
+	}
+	return VMIN <= value && value <= VMAX && (value - (esint)VMIN) % VINC == 0;
+}
+
+bool Selection::real(double value) const
+{
+	if (KABS) {
+		value = std::fabs(value);
+	}
+	double tolerance = VMIN == VMAX ? (VMIN != 0 ? 0.005 * std::fabs(VMIN) : 1e-6) : 1e-8 * (VMAX - VMIN);
+	return VMIN - tolerance <= value && value <= VMAX + tolerance;
+}
@@ -0,0 +1,77 @@
+
+#ifndef SRC_INPUT_WORKBENCH_PARSER_SELECTION_H_
+#define SRC_INPUT_WORKBENCH_PARSER_SELECTION_H_
+
+#include "parser.h"
+#include "basis/containers/tarray.h"
+#include "esinfo/envinfo.h"
+
+#include <string>
+#include <vector>
+
+namespace mesio {
+
+// common part of ESEL and NSEL: 'command, Type, Item, Comp, VMIN, VMAX, VINC, KABS'
+struct Selection: public WorkbenchParser {
+	enum class Type: int {
+		UNKNOWN,
+		S,
+		R,
+		A,
+		U,
+		ALL,
+		NONE,
+		INVE,
+		STAT
+	};
+
+	enum class Comp: int {
+		NONE,
+		X,
+		Y,
+		Z
+	};
+
+	Type type;
+	Comp comp;
+	double VMIN, VMAX;
+	esint VINC;
+	bool KABS;
+
+	Selection();
+
+protected:
+	// parse the command and return its item (an empty string if there is no item)
+	std::string parse(const char* begin, const char* name);
+
+	bool integer(esint value) const;
+	bool real(double value) const;
+
+	// combine the current selection with entities that match the item
+	template <typename TMatch>
+	void select(std::vector<char> &selected, TMatch match) const
+	{
+		size_t threads = info::env::threads;
+		std::vector<size_t> distribution = tarray<size_t>::distribute(threads, selected.size());
+
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			for (size_t i = distribution[t]; i < distribution[t + 1]; ++i) {
+				switch (type) {
+				case Type::S: selected[i] = match(i); break;
+				case Type::R: selected[i] = selected[i] && match(i); break;
+				case Type::A: selected[i] = selected[i] || match(i); break;
+				case Type::U: selected[i] = selected[i] && !match(i); break;
+				case Type::ALL: selected[i] = 1; break;
+				case Type::NONE: selected[i] = 0; break;
+				case Type::INVE: selected[i] = !selected[i]; break;
+				default: break;
+				}
+			}
+		}
+	}
+};
+
+}
+
+#endif /* SRC_INPUT_WORKBENCH_PARSER_SELECTION_H_ */
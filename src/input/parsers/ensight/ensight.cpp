@@ -2,6 +2,7 @@
 #include "ensight.h"
 #include "parser/casefile.h"
 #include "parser/geometry.h"
+#include "parser/variables.h"
 
 #include "config/input.h"
 #include "esinfo/eslog.h"
@@ -38,8 +39,12 @@ void EnsightLoader::load()
 	eslog::checkpointln("ENSIGHT PARSER: GEOMETRY SCANNED");
 
 	geometry.parse(*this);
+	eslog::checkpointln("ENSIGHT PARSER: GEOMETRY PARSED");
+
+	EnsightVariables variables(casefile, geometry);
+	variables.parse(*this);
 	removeDuplicates = true;
 	body.resize(etype.size());
 	material.resize(etype.size());
-	eslog::endln("ENSIGHT PARSER: GEOMETRY PARSED");
+	eslog::endln("ENSIGHT PARSER: VARIABLES PARSED");
 }
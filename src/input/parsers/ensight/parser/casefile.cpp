@@ -1,5 +1,6 @@
 
 #include "casefile.h"
+#include "basis/utilities/parser.h"
 #include "basis/utilities/sysutils.h"
 #include "esinfo/eslog.hpp"
 #include "basis/io/inputfile.h"
@@ -17,10 +18,13 @@ EnsightCasefile::EnsightCasefile(const std::string &path)
 
 void EnsightCasefile::parse()
 {
-	// currently read only geometry
+	// geometry and variables of the first time step
 	Metadata casefile;
 	casefile.read(path);
 
+	std::vector<std::vector<std::string> > vlines;
+	int start = 0; // filename start number
+
 	const char* current = casefile.begin;
 	while (current < casefile.end) {
 		while (current < casefile.end && *current++ != '\n'); // start at new line
@@ -30,9 +34,58 @@ void EnsightCasefile::parse()
 			const char* begin = current;
 			while (*current != '\n') { ++current; };
 			geometry = std::string(begin, current);
-			break;
+		}
+		if (memcmp(current, "scalar per ", 11) == 0 || memcmp(current, "vector per ", 11) == 0 || memcmp(current, "tensor ", 7) == 0) {
+			const char* begin = current;
+			while (current < casefile.end && *current != '\n') { ++current; };
+			std::string line = Parser::strip(std::string(begin, current));
+			size_t colon = line.find(':');
+			if (colon != std::string::npos) {
+				std::vector<std::string> values = Parser::split(Parser::strip(line.substr(colon + 1)), " \t");
+				values.insert(values.begin(), line.substr(0, colon));
+				vlines.push_back(values);
+			}
+		}
+		if (memcmp(current, "filename start number:", 22) == 0) {
+			start = strtol(current + 22, NULL, 10);
 		}
 	}
 
 	geometry = utils::getFileDirectory(path) + "/" + geometry;
+
+	for (size_t i = 0; i < vlines.size(); ++i) {
+		// type: [ts] [fs] description filename
+		if (vlines[i].size() < 3) {
+			eslog::error("EnSight Gold parser: invalid variable '%s'.\n", vlines[i].front().c_str());
+		}
+		Variable variable;
+		variable.source = StringCompare::caseSensitiveSuffix(vlines[i].front(), "per element") ? Variable::Source::ELEMENTS : Variable::Source::NODES;
+		variable.dimension = 0;
+		if (StringCompare::caseSensitiveSuffix(vlines[i].front(), "per node") || StringCompare::caseSensitiveSuffix(vlines[i].front(), "per element")) {
+			if (StringCompare::caseSensitivePreffix("scalar", vlines[i].front())) { variable.dimension = 1; }
+			if (StringCompare::caseSensitivePreffix("vector", vlines[i].front())) { variable.dimension = 3; }
+			if (StringCompare::caseSensitivePreffix("tensor symm", vlines[i].front())) { variable.dimension = 6; }
+			if (StringCompare::caseSensitivePreffix("tensor asym", vlines[i].front())) { variable.dimension = 9; }
+		}
+		if (variable.dimension == 0) {
+			eslog::warning("EnSight Gold parser: variable '%s' of type '%s' is skipped.\n", vlines[i][vlines[i].size() - 2].c_str(), vlines[i].front().c_str());
+			continue;
+		}
+		variable.name = vlines[i][vlines[i].size() - 2];
+		variable.path = vlines[i].back();
+
+		// the first step of transient variables
+		size_t wildcard = variable.path.find('*');
+		if (wildcard != std::string::npos) {
+			size_t size = variable.path.find_first_not_of('*', wildcard);
+			size = (size == std::string::npos ? variable.path.size() : size) - wildcard;
+			std::string number = std::to_string(start);
+			if (number.size() < size) {
+				number.insert(0, size - number.size(), '0');
+			}
+			variable.path.replace(wildcard, size, number);
+		}
+		variable.path = utils::getFileDirectory(path) + "/" + variable.path;
+		variables.push_back(variable);
+	}
 }
@@ -13,6 +13,17 @@ public:
 		Ensight_Gold
 	};
 
+	struct Variable {
+		enum class Source {
+			NODES,
+			ELEMENTS
+		};
+
+		Source source;
+		int dimension; // 1 (scalar), 3 (vector), 6 (tensor symm), 9 (tensor asym)
+		std::string name, path; // the path to the first step
+	};
+
 	EnsightCasefile(const std::string &path);
 
 	void parse();
@@ -20,7 +31,7 @@ public:
 	std::string path;
 	Type type;
 	std::string geometry;
-	std::vector<std::string> variables;
+	std::vector<Variable> variables;
 	std::vector<double> times;
 };
 
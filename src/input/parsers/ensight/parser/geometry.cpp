@@ -1,11 +1,18 @@
 
 #include "geometry.h"
+#include "basis/containers/tarray.h"
 #include "wrappers/mpi/communication.h"
+#include "esinfo/envinfo.h"
 #include "esinfo/eslog.h"
 #include "mesh/element.h"
 #include "input/meshbuilder.h"
 #include "input/parsers/distributedscanner.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <numeric>
 
 using namespace mesio;
@@ -38,6 +45,13 @@ void EnsightGeometry::parse(MeshBuilder &mesh)
 
 void EnsightGeometry::header()
 {
+	auto ids = [] (const char *c, IDs &ids) {
+		if (DistributedScanner::check(c, "off")) { ids = IDs::OFF; }
+		if (DistributedScanner::check(c, "given")) { ids = IDs::GIVEN; }
+		if (DistributedScanner::check(c, "assign")) { ids = IDs::ASSIGN; }
+		if (DistributedScanner::check(c, "ignore")) { ids = IDs::INGNORE; }
+	};
+
 	// root always has header
 	if (info::mpi::rank == 0) {
 		if (memcmp(_geofile.begin, "C Binary", 8) == 0) {
@@ -45,19 +59,25 @@ void EnsightGeometry::header()
 
 			size_t ndesc = 240, edesc = 320;
 			if (DistributedScanner::check(_geofile.begin + ndesc, "node id ")) {
-				if (DistributedScanner::check(_geofile.begin + ndesc + 8, "off")) { _header.nodeIDs = IDs::OFF; }
-				if (DistributedScanner::check(_geofile.begin + ndesc + 8, "given")) { _header.nodeIDs = IDs::GIVEN; }
-				if (DistributedScanner::check(_geofile.begin + ndesc + 8, "assign")) { _header.nodeIDs = IDs::ASSIGN; }
-				if (DistributedScanner::check(_geofile.begin + ndesc + 8, "ignore")) { _header.nodeIDs = IDs::INGNORE; }
+				ids(_geofile.begin + ndesc + 8, _header.nodeIDs);
 			}
 			if (DistributedScanner::check(_geofile.begin + edesc, "element id ")) {
-				if (DistributedScanner::check(_geofile.begin + edesc + 11, "off")) { _header.elementIDs = IDs::OFF; }
-				if (DistributedScanner::check(_geofile.begin + edesc + 11, "given")) { _header.elementIDs = IDs::GIVEN; }
-				if (DistributedScanner::check(_geofile.begin + edesc + 11, "assign")) { _header.elementIDs = IDs::ASSIGN; }
-				if (DistributedScanner::check(_geofile.begin + edesc + 11, "ignore")) { _header.elementIDs = IDs::INGNORE; }
+				ids(_geofile.begin + edesc + 11, _header.elementIDs);
 			}
 		} else {
 			_header.format = Format::ASCII;
+
+			// two description lines, 'node id <type>', 'element id <type>'
+			const char *c = _geofile.begin;
+			for (int line = 0; line < 4 && c < _geofile.hardend; ++line) {
+				if (line == 2 && DistributedScanner::check(c, "node id ")) {
+					ids(c + 8, _header.nodeIDs);
+				}
+				if (line == 3 && DistributedScanner::check(c, "element id ")) {
+					ids(c + 11, _header.elementIDs);
+				}
+				while (c < _geofile.hardend && *c++ != '\n');
+			}
 		}
 	}
 
@@ -123,6 +143,154 @@ void EnsightGeometry::scanBinary()
 	parser.synchronize(_parts, _coordinates, _elements);
 }
 
+// the number of nodes and the code of elements in the order of EnsightGeometry::Elements::Type
+static const int esizes[] = {
+	1,
+	2, 3,
+	3, 6, 4, 8,
+	4, 10, 5, 13, 6, 15, 8, 20,
+	0, 0 // not supported
+};
+
+static const Element::CODE codes[] = {
+	Element::CODE::POINT1,
+	Element::CODE::LINE2, Element::CODE::LINE3,
+	Element::CODE::TRIANGLE3, Element::CODE::TRIANGLE6, Element::CODE::SQUARE4, Element::CODE::SQUARE8,
+	Element::CODE::TETRA4, Element::CODE::TETRA10, Element::CODE::PYRAMID5, Element::CODE::PYRAMID13, Element::CODE::PRISMA6, Element::CODE::PRISMA15, Element::CODE::HEXA8, Element::CODE::HEXA20,
+	Element::CODE::SIZE, Element::CODE::SIZE // not supported
+};
+
+static std::string partname(const std::vector<char> &parts, size_t p)
+{
+	auto begin = parts.begin() + p * 80;
+	auto end = parts.begin() + p * 80;
+	while (*end != 0) { ++end; }
+	return std::string(begin, end);
+}
+
+void EnsightGeometry::pushCoordinates(MeshBuilder &mesh, size_t part, std::vector<float> &coordinates, size_t cbegin, size_t cend, int firstrank, int lastrank, esint cidoffset)
+{
+	std::vector<size_t> cdistribution = tarray<size_t>::distribute(lastrank - firstrank + 1, _coordinates[part].nn);
+	if (firstrank != lastrank) { // group data: x y z; x y z; x y z; ...
+		std::vector<int> sBuffer, rBuffer;
+		for (int r = firstrank; r <= lastrank; ++r) {
+			size_t prevsize = sBuffer.size();
+			sBuffer.push_back(0); // total size
+			sBuffer.push_back(r); // target
+			sBuffer.push_back(info::mpi::rank); // source
+			sBuffer.push_back(0); // x size
+			sBuffer.push_back(0); // y size
+			sBuffer.push_back(0); // z size
+
+			for (int d = 0; d < 3; ++d) {
+				size_t rbegin = std::max(d * _coordinates[part].nn + cdistribution[r - firstrank], cbegin);
+				size_t rend   = std::min(d * _coordinates[part].nn + cdistribution[r - firstrank + 1], cend);
+				if (rend < rbegin) {
+					rend = rbegin;
+				}
+				sBuffer[prevsize + 3 + d] = rend - rbegin;
+				if (rbegin != rend) {
+					sBuffer.insert(sBuffer.end(), reinterpret_cast<const int*>(coordinates.data() + rbegin - cbegin), reinterpret_cast<const int*>(coordinates.data() + rend - cbegin));
+				}
+			}
+			sBuffer[prevsize] = sBuffer.size() - prevsize;
+		}
+
+		if (!Communication::allToAllWithDataSizeAndTarget(sBuffer, rBuffer, firstrank, lastrank + 1)) {
+			eslog::error("Ensight Gold parser: cannot exchange coordinate data.\n");
+		}
+
+		coordinates.resize(3 * (cdistribution[info::mpi::rank - firstrank + 1] - cdistribution[info::mpi::rank - firstrank]));
+		std::vector<int> alloffsets(3 * (lastrank - firstrank + 1)); // we have to keep data order
+		size_t offset = 0;
+		for (int r = firstrank; r <= lastrank; ++r) {
+			++offset; // totalsize
+			++offset; // target (always me)
+			int source = rBuffer[offset++] - firstrank;
+			for (int d = 0; d < 3; ++d) {
+				alloffsets[3 * source + d] = rBuffer[offset++];
+			}
+			for (int d = 0; d < 3; ++d) {
+				offset += alloffsets[3 * source + d];
+			}
+		}
+		for (int d = 0; d < 3; ++d) {
+			int sum = d * (cdistribution[info::mpi::rank - firstrank + 1] - cdistribution[info::mpi::rank - firstrank]);
+			for (int r = 0; r <= lastrank - firstrank; ++r) {
+				int tmp = alloffsets[3 * r + d];
+				alloffsets[3 * r + d] = sum;
+				sum += tmp;
+			}
+		}
+		offset = 0;
+		for (int r = firstrank; r <= lastrank; ++r) {
+			++offset; // totalsize
+			++offset; // target (always me)
+			int source = rBuffer[offset++] - firstrank;
+			int xyzsize[3] = { rBuffer[offset++], rBuffer[offset++], rBuffer[offset++] };
+			for (int d = 0; d < 3; ++d) {
+				if (xyzsize[d]) {
+					memcpy(coordinates.data() + alloffsets[3 * source + d], rBuffer.data() + offset, sizeof(float) * xyzsize[d]);
+					offset += xyzsize[d] * (sizeof(float) / sizeof(int));
+				}
+			}
+		}
+	}
+
+	int ncoordinates = coordinates.size() / 3;
+	_nranges.back() = Range(part, cdistribution[info::mpi::rank - firstrank], ncoordinates, mesh.coordinates.size());
+	mesh.coordinates.reserve(mesh.coordinates.size() + ncoordinates);
+	for (int c = 0; c < ncoordinates; ++c) {
+		mesh.coordinates.push_back(Point(coordinates[ncoordinates * 0 + c], coordinates[ncoordinates * 1 + c], coordinates[ncoordinates * 2 + c]));
+	}
+	mesh.nIDs.resize(mesh.coordinates.size());
+	std::iota(mesh.nIDs.end() - ncoordinates, mesh.nIDs.end(), cidoffset + cdistribution[info::mpi::rank - firstrank]);
+}
+
+int EnsightGeometry::pushElements(MeshBuilder &mesh, size_t part, size_t block, const std::string &name, std::vector<int> &elements, size_t first, esint cidoffset)
+{
+	int esize = esizes[(int)_elements[block].type];
+	Element::CODE code = codes[(int)_elements[block].type];
+
+	_eranges.push_back(Range(part, 0, 0, mesh.etype.size())); // point elements are not parsed to elements
+	if (code == Element::CODE::POINT1) {
+		for (size_t n = 0; n < elements.size(); ++n) {
+			elements[n] += cidoffset - 1;
+		}
+		mesh.nregions[name].assign(elements.begin(), elements.end());
+		return 0;
+	}
+	if (esize == 0 || elements.empty()) {
+		return 0;
+	}
+
+	int nelements = elements.size() / esize;
+	_eranges.back() = Range(part, first, nelements, mesh.etype.size());
+	mesh.etype.resize(mesh.etype.size() + nelements, (int)code);
+	mesh.esize.resize(mesh.esize.size() + nelements, esize);
+	mesh.enodes.reserve(mesh.enodes.size() + elements.size());
+	for (size_t n = 0; n < elements.size(); ++n) {
+		mesh.enodes.push_back(elements[n] + cidoffset - 1);
+	}
+	return nelements;
+}
+
+void EnsightGeometry::numbering(MeshBuilder &mesh, const std::vector<std::string> &names, std::vector<esint> &nelements)
+{
+	mesh.eIDs.resize(mesh.etype.size());
+
+	std::vector<esint> sum, offset = nelements;
+	Communication::exscan(sum, offset);
+	for (size_t i = 0, prevsize = 0, eidoffset = 0; i < names.size(); ++i) {
+		if (sum[i]) { // non-node region
+			std::iota(mesh.eIDs.begin() + prevsize, mesh.eIDs.begin() + prevsize + nelements[i], offset[i] + eidoffset);
+			mesh.eregions[names[i]] = std::vector<esint>(mesh.eIDs.begin() + prevsize, mesh.eIDs.begin() + prevsize + nelements[i]);
+			prevsize += nelements[i];
+			eidoffset += sum[i];
+		}
+	}
+}
+
 void EnsightGeometry::parseBinary(MeshBuilder &mesh)
 {
 	// skip ids: currently we always generate them
@@ -143,26 +311,18 @@ void EnsightGeometry::parseBinary(MeshBuilder &mesh)
 		}
 	};
 
-	struct eoffsetinfo {
-		std::string name;
-		int offset;
-		int size;
-		int totalsize;
-	};
-
-	std::vector<eoffsetinfo> einfo;
 	size_t parts = _parts.size() / 80;
+	std::vector<std::string> names;
+	std::vector<esint> nelements;
 	esint cidoffset = 0;
 
 	for (size_t p = 0, i = 0; p < parts; ++p) {
-		auto begin = _parts.begin() + p * 80;
-		auto end = _parts.begin() + p * 80;
-		while (*end != 0) { ++end; }
-		std::string name = std::string(begin, end);
+		names.push_back(partname(_parts, p));
 
 		int firstrank = std::lower_bound(_geofile.distribution.begin(), _geofile.distribution.end(), _coordinates[p].offset) - _geofile.distribution.begin() - 1;
 		int lastrank = std::lower_bound(_geofile.distribution.begin(), _geofile.distribution.end(), _coordinates[p].offset + 3 * sizeof(float) * _coordinates[p].nn) - _geofile.distribution.begin() - 1;
 
+		_nranges.push_back(Range(p, 0, 0, mesh.coordinates.size()));
 		size_t cbegin = std::max(_coordinates[p].offset, _geofile.distribution[info::mpi::rank]);
 		size_t cend = std::min(_coordinates[p].offset + 3 * sizeof(float) * _coordinates[p].nn, _geofile.distribution[info::mpi::rank + 1]);
 		if (cbegin < cend) {
@@ -171,170 +331,213 @@ void EnsightGeometry::parseBinary(MeshBuilder &mesh)
 			round(cend, _coordinates[p].offset, sizeof(float));
 			std::vector<float> coordinates((cend - cbegin) / sizeof(float));
 			memcpy(coordinates.data(), _geofile.begin + cbegin - _geofile.distribution[info::mpi::rank], cend - cbegin);
-
-			std::vector<size_t> cdistribution = tarray<size_t>::distribute(lastrank - firstrank + 1, _coordinates[p].nn);
-			if (firstrank != lastrank) { // group data: x y z; x y z; x y z; ...
-				cbegin = (cbegin - _coordinates[p].offset) / sizeof(float); // from char to float offset
-				cend   = (cend   - _coordinates[p].offset) / sizeof(float); // from char to float offset
-				std::vector<int> sBuffer, rBuffer;
-				for (int r = firstrank; r <= lastrank; ++r) {
-					size_t prevsize = sBuffer.size();
-					sBuffer.push_back(0); // total size
-					sBuffer.push_back(r); // target
-					sBuffer.push_back(info::mpi::rank); // source
-					sBuffer.push_back(0); // x size
-					sBuffer.push_back(0); // y size
-					sBuffer.push_back(0); // z size
-
-					for (int d = 0; d < 3; ++d) {
-						size_t rbegin = std::max(d * _coordinates[p].nn + cdistribution[r - firstrank], cbegin);
-						size_t rend   = std::min(d * _coordinates[p].nn + cdistribution[r - firstrank + 1], cend);
-						if (rend < rbegin) {
-							rend = rbegin;
-						}
-						sBuffer[prevsize + 3 + d] = rend - rbegin;
-						if (rbegin != rend) {
-							sBuffer.insert(sBuffer.end(), reinterpret_cast<const int*>(coordinates.data() + rbegin - cbegin), reinterpret_cast<const int*>(coordinates.data() + rend - cbegin));
-						}
-					}
-					sBuffer[prevsize] = sBuffer.size() - prevsize;
-				}
-
-				if (!Communication::allToAllWithDataSizeAndTarget(sBuffer, rBuffer, firstrank, lastrank + 1)) {
-					eslog::error("Ensight Gold parser: cannot exchange coordinate data.\n");
-				}
-
-				coordinates.resize(3 * (cdistribution[info::mpi::rank - firstrank + 1] - cdistribution[info::mpi::rank - firstrank]));
-				std::vector<int> alloffsets(3 * (lastrank - firstrank + 1)); // we have to keep data order
-				size_t offset = 0;
-				for (int r = firstrank; r <= lastrank; ++r) {
-					++offset; // totalsize
-					++offset; // target (always me)
-					int source = rBuffer[offset++] - firstrank;
-					for (int d = 0; d < 3; ++d) {
-						alloffsets[3 * source + d] = rBuffer[offset++];
-					}
-					for (int d = 0; d < 3; ++d) {
-						offset += alloffsets[3 * source + d];
-					}
-				}
-				for (int d = 0; d < 3; ++d) {
-					int sum = d * (cdistribution[info::mpi::rank - firstrank + 1] - cdistribution[info::mpi::rank - firstrank]);
-					for (int r = 0; r <= lastrank - firstrank; ++r) {
-						int tmp = alloffsets[3 * r + d];
-						alloffsets[3 * r + d] = sum;
-						sum += tmp;
-					}
-				}
-				offset = 0;
-				for (int r = firstrank; r <= lastrank; ++r) {
-					++offset; // totalsize
-					++offset; // target (always me)
-					int source = rBuffer[offset++] - firstrank;
-					int xyzsize[3] = { rBuffer[offset++], rBuffer[offset++], rBuffer[offset++] };
-					for (int d = 0; d < 3; ++d) {
-						if (xyzsize[d]) {
-							memcpy(coordinates.data() + alloffsets[3 * source + d], rBuffer.data() + offset, sizeof(float) * xyzsize[d]);
-							offset += xyzsize[d] * (sizeof(float) / sizeof(int));
-						}
-					}
-				}
-			}
-
-			int ncoordinates = coordinates.size() / 3;
-			mesh.coordinates.reserve(mesh.coordinates.size() + ncoordinates);
-			for (int c = 0; c < ncoordinates; ++c) {
-				mesh.coordinates.push_back(Point(coordinates[ncoordinates * 0 + c], coordinates[ncoordinates * 1 + c], coordinates[ncoordinates * 2 + c]));
-			}
-			mesh.nIDs.resize(mesh.coordinates.size());
-			std::iota(mesh.nIDs.end() - ncoordinates, mesh.nIDs.end(), cidoffset + cdistribution[info::mpi::rank - firstrank]);
+			pushCoordinates(mesh, p, coordinates, (cbegin - _coordinates[p].offset) / sizeof(float), (cend - _coordinates[p].offset) / sizeof(float), firstrank, lastrank, cidoffset);
 		}
 
-		int ntotalelements = 0;
+		nelements.push_back(0);
 		for (; i < _elements.size() && (p + 1 == parts || _elements[i].offset < _coordinates[p + 1].offset); ++i) {
-			int esize; Element::CODE code;
-			switch (_elements[i].type) {
-			case Elements::Type::POINT    : esize =  1; code = Element::CODE::POINT1   ; break;
-			case Elements::Type::BAR2     : esize =  2; code = Element::CODE::LINE2    ; break;
-			case Elements::Type::BAR3     : esize =  3; code = Element::CODE::LINE3    ; break;
-			case Elements::Type::TRIA3    : esize =  3; code = Element::CODE::TRIANGLE3; break;
-			case Elements::Type::TRIA6    : esize =  6; code = Element::CODE::TRIANGLE6; break;
-			case Elements::Type::QUAD4    : esize =  4; code = Element::CODE::SQUARE4  ; break;
-			case Elements::Type::QUAD8    : esize =  8; code = Element::CODE::SQUARE8  ; break;
-			case Elements::Type::TETRA4   : esize =  4; code = Element::CODE::TETRA4   ; break;
-			case Elements::Type::TETRA10  : esize = 10; code = Element::CODE::TETRA10  ; break;
-			case Elements::Type::PYRAMID5 : esize =  5; code = Element::CODE::PYRAMID5 ; break;
-			case Elements::Type::PYRAMID13: esize = 13; code = Element::CODE::PYRAMID13; break;
-			case Elements::Type::PENTA6   : esize =  6; code = Element::CODE::PRISMA6  ; break;
-			case Elements::Type::PENTA15  : esize = 15; code = Element::CODE::PRISMA15 ; break;
-			case Elements::Type::HEXA8    : esize =  8; code = Element::CODE::HEXA8    ; break;
-			case Elements::Type::HEXA20   : esize = 20; code = Element::CODE::HEXA20   ; break;
-			case Elements::Type::NSIDED   : esize =  0; code = Element::CODE::SIZE     ; break; // not supported
-			case Elements::Type::NFACED   : esize =  0; code = Element::CODE::SIZE     ; break; // not supported
-			default: esize = 0; code = Element::CODE::SIZE;
-			}
-
+			int esize = esizes[(int)_elements[i].type];
 			size_t ebegin = std::max(_elements[i].offset, _geofile.distribution[info::mpi::rank]);
 			size_t eend = std::min(_elements[i].offset + esize * sizeof(int) * _elements[i].ne, _geofile.distribution[info::mpi::rank + 1]);
+			std::vector<int> elements;
+			size_t first = 0;
 			if (ebegin < eend) {
 				round(ebegin, _elements[i].offset, esize * sizeof(int));
 				round(eend, _elements[i].offset, esize * sizeof(int));
-				std::vector<int> elements((eend - ebegin) / sizeof(int));
+				elements.resize((eend - ebegin) / sizeof(int));
 				memcpy(elements.data(), _geofile.begin + ebegin - _geofile.distribution[info::mpi::rank], eend - ebegin);
-
-				int nelements = (eend - ebegin) / (sizeof(int) * esize);
-				if (code != Element::CODE::POINT1) {
-					ntotalelements += nelements;
-					mesh.etype.resize(mesh.etype.size() + nelements, (int)code);
-					mesh.esize.resize(mesh.esize.size() + nelements, esize);
-					mesh.enodes.reserve(mesh.enodes.size() + elements.size());
-					for (size_t n = 0; n < elements.size(); ++n) {
-						mesh.enodes.push_back(elements[n] + cidoffset - 1);
-					}
-				} else {
-					for (size_t n = 0; n < elements.size(); ++n) {
-						elements[n] += cidoffset - 1;
-					}
-					mesh.nregions[name].assign(elements.begin(), elements.end());
-				}
-			} else {
-				if (code == Element::CODE::POINT1) {
-					mesh.nregions[name] = {};
-				}
+				first = (ebegin - _elements[i].offset) / (sizeof(int) * esize);
 			}
+			nelements.back() += pushElements(mesh, p, i, names.back(), elements, first, cidoffset);
 		}
-		einfo.push_back(eoffsetinfo{.name=name, .offset=ntotalelements, .size=ntotalelements, .totalsize=0});
 		cidoffset += _coordinates[p].nn;
 	}
 
-	mesh.eIDs.resize(mesh.etype.size());
-
-	std::vector<esint> sum, offset;
-	for (size_t i = 0; i < einfo.size(); ++i) {
-		offset.push_back(einfo[i].offset);
-	}
-	sum.resize(offset.size());
-	Communication::exscan(sum, offset);
-	for (size_t i = 0; i < einfo.size(); ++i) {
-		einfo[i].offset = offset[i];
-		einfo[i].totalsize = sum[i];
-	}
-	for (size_t i = 0, prevsize = 0, eidoffset = 0; i < einfo.size(); ++i) {
-		if (einfo[i].totalsize) { // non-node region
-			std::iota(mesh.eIDs.begin() + prevsize, mesh.eIDs.begin() + prevsize + einfo[i].size, einfo[i].offset + eidoffset);
-			mesh.eregions[einfo[i].name] = std::vector<esint>(mesh.eIDs.begin() + prevsize, mesh.eIDs.begin() + prevsize + einfo[i].size);
-			prevsize += einfo[i].size;
-			eidoffset += einfo[i].totalsize;
-		}
-	}
+	numbering(mesh, names, nelements);
 }
 
 void EnsightGeometry::scanASCII()
 {
-	eslog::error("EnSight Gold parser: not implemented scanning of ASCII format.\n");
+	DistributedScanner::align(_geofile, "\n");
+
+	DistributedScanner parser;
+
+	// keywords fill whole lines (descriptions of parts are arbitrary)
+	auto keyword = [] (const char *c, size_t size) {
+		for (c += size; *c == ' ' || *c == '\t' || *c == '\r'; ++c);
+		return *c == '\n' || *c == '\0';
+	};
+	auto nextline = [] (const char *c) {
+		while (*c != '\n' && *c != '\0') { ++c; }
+		return *c == '\n' ? c + 1 : c;
+	};
+	auto offset = [&] (const char *c) -> size_t {
+		return _geofile.distribution[info::mpi::rank] + (c - _geofile.begin);
+	};
+
+	// part, number, description
+	auto addpart = [&] (const char *c) {
+		if (keyword(c, 4)) {
+			_keywords.push_back(offset(c));
+			const char *desc = nextline(nextline(c)), *end = nextline(desc);
+			while (desc < end && isspace(*(end - 1))) { --end; }
+			size_t size = _parts.size();
+			_parts.resize(size + 80, 0);
+			memcpy(_parts.data() + size, desc, std::min(end - desc, (std::ptrdiff_t)79));
+		}
+	};
+
+	// keyword, the number of items, (ids), values
+	auto addcoordinates = [&] (const char *c) {
+		if (keyword(c, 11)) {
+			_keywords.push_back(offset(c));
+			const char *nn = nextline(c);
+			_coordinates.push_back(Coordinates(offset(nextline(nn)), strtol(nn, NULL, 10)));
+		}
+	};
+
+	auto addelement = [&] (const char *c, const char *key, Elements::Type type) {
+		if (keyword(c, strlen(key))) {
+			_keywords.push_back(offset(c));
+			const char *ne = nextline(c);
+			_elements.push_back(Elements(type, offset(nextline(ne)), strtol(ne, NULL, 10)));
+		}
+	};
+
+	parser.add("part"       , [&] (const char *c) { addpart(c); });
+	parser.add("coordinates", [&] (const char *c) { addcoordinates(c); });
+
+	parser.add("point"      , [&] (const char *c) { addelement(c, "point"    , Elements::Type::POINT); });
+	parser.add("bar2"       , [&] (const char *c) { addelement(c, "bar2"     , Elements::Type::BAR2); });
+	parser.add("bar3"       , [&] (const char *c) { addelement(c, "bar3"     , Elements::Type::BAR3); });
+	parser.add("tria3"      , [&] (const char *c) { addelement(c, "tria3"    , Elements::Type::TRIA3); });
+	parser.add("tria6"      , [&] (const char *c) { addelement(c, "tria6"    , Elements::Type::TRIA6); });
+	parser.add("quad4"      , [&] (const char *c) { addelement(c, "quad4"    , Elements::Type::QUAD4); });
+	parser.add("quad8"      , [&] (const char *c) { addelement(c, "quad8"    , Elements::Type::QUAD8); });
+	parser.add("tetra4"     , [&] (const char *c) { addelement(c, "tetra4"   , Elements::Type::TETRA4); });
+	parser.add("tetra10"    , [&] (const char *c) { addelement(c, "tetra10"  , Elements::Type::TETRA10); });
+	parser.add("pyramid5"   , [&] (const char *c) { addelement(c, "pyramid5" , Elements::Type::PYRAMID5); });
+	parser.add("pyramid13"  , [&] (const char *c) { addelement(c, "pyramid13", Elements::Type::PYRAMID13); });
+	parser.add("penta6"     , [&] (const char *c) { addelement(c, "penta6"   , Elements::Type::PENTA6); });
+	parser.add("penta15"    , [&] (const char *c) { addelement(c, "penta15"  , Elements::Type::PENTA15); });
+	parser.add("hexa8"      , [&] (const char *c) { addelement(c, "hexa8"    , Elements::Type::HEXA8); });
+	parser.add("hexa20"     , [&] (const char *c) { addelement(c, "hexa20"   , Elements::Type::HEXA20); });
+
+	parser.add("nsided"     , [&] (const char *c) { if (keyword(c, 6)) { eslog::error("Ensight parser error: MESIO does not support nsided elements.\n"); } });
+	parser.add("nfaced"     , [&] (const char *c) { if (keyword(c, 6)) { eslog::error("Ensight parser error: MESIO does not support nfaced elements.\n"); } });
+
+	parser.scanlines(_geofile);
+	parser.synchronize(_parts, _coordinates, _elements, _keywords);
 }
 
 void EnsightGeometry::parseASCII(MeshBuilder &mesh)
 {
-	eslog::error("EnSight Gold parser: not implemented parsing of ASCII format.\n");
+	// blocks of values (coordinates of parts followed by element blocks) end at the next keyword
+	size_t threads = info::env::threads, blocks = _coordinates.size() + _elements.size();
+	std::vector<size_t> bbegin, bend;
+	for (size_t i = 0; i < _coordinates.size(); ++i) {
+		bbegin.push_back(_coordinates[i].offset);
+	}
+	for (size_t i = 0; i < _elements.size(); ++i) {
+		bbegin.push_back(_elements[i].offset);
+	}
+	for (size_t b = 0; b < blocks; ++b) {
+		auto next = std::lower_bound(_keywords.begin(), _keywords.end(), bbegin[b]);
+		bend.push_back(next == _keywords.end() ? _geofile.distribution.back() : *next);
+	}
+
+	// each value (or element) is on a separate line, hence the line index within a block identifies the value
+	size_t rbegin = _geofile.distribution[info::mpi::rank], rend = _geofile.distribution[info::mpi::rank + 1];
+	std::vector<std::vector<const char*> > tbegin(blocks, std::vector<const char*>(threads + 1, _geofile.begin));
+	std::vector<std::vector<esint> > tlines(blocks, std::vector<esint>(threads + 1, 0));
+	std::vector<esint> lines(blocks), first(blocks), total;
+	for (size_t b = 0; b < blocks; ++b) {
+		size_t lbegin = std::max(bbegin[b], rbegin), lend = std::min(bend[b], rend);
+		if (lbegin < lend) {
+			const char *begin = _geofile.begin + lbegin - rbegin, *end = _geofile.begin + lend - rbegin;
+			std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, lend - lbegin);
+			for (size_t t = 0; t <= threads; ++t) {
+				const char *c = begin + tdistribution[t];
+				if (t && t < threads && *(c - 1) != '\n') {
+					while (c < end && *c++ != '\n'); // start at new line
+				}
+				tbegin[b][t] = std::max(c, tbegin[b][t ? t - 1 : 0]);
+			}
+
+			#pragma omp parallel for
+			for (size_t t = 0; t < threads; t++) {
+				if (tbegin[b][t] < tbegin[b][t + 1]) {
+					tlines[b][t + 1] = 1 + std::count(tbegin[b][t], tbegin[b][t + 1] - 1, '\n');
+				}
+			}
+			for (size_t t = 0; t < threads; t++) {
+				tlines[b][t + 1] += tlines[b][t];
+			}
+			first[b] = lines[b] = tlines[b][threads];
+		}
+	}
+	Communication::exscan(total, first);
+
+	// parse lines [skip, skip + size) of the block
+	auto parse = [&] (size_t b, size_t skip, size_t size, std::function<void(const char *c, size_t line)> store) {
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			size_t line = first[b] + tlines[b][t];
+			for (const char *c = tbegin[b][t]; c < tbegin[b][t + 1]; ++line) {
+				if (skip <= line && line < skip + size) {
+					store(c, line - skip);
+				}
+				while (c < tbegin[b][t + 1] && *c++ != '\n');
+			}
+		}
+	};
+	auto clamp = [] (size_t value, size_t skip, size_t size) {
+		return std::min(std::max(value, skip), skip + size) - skip;
+	};
+
+	size_t parts = _parts.size() / 80;
+	std::vector<std::string> names;
+	std::vector<esint> nelements;
+	esint cidoffset = 0;
+	bool nids = _header.nodeIDs == IDs::GIVEN || _header.nodeIDs == IDs::INGNORE;
+	bool eids = _header.elementIDs == IDs::GIVEN || _header.elementIDs == IDs::INGNORE;
+
+	for (size_t p = 0, i = 0; p < parts; ++p) {
+		names.push_back(partname(_parts, p));
+
+		_nranges.push_back(Range(p, 0, 0, mesh.coordinates.size()));
+		if (_coordinates[p].nn && bbegin[p] < bend[p]) {
+			int firstrank = std::upper_bound(_geofile.distribution.begin(), _geofile.distribution.end(), bbegin[p]) - _geofile.distribution.begin() - 1;
+			int lastrank = std::upper_bound(_geofile.distribution.begin(), _geofile.distribution.end(), bend[p] - 1) - _geofile.distribution.begin() - 1;
+			if (firstrank <= info::mpi::rank && info::mpi::rank <= lastrank) {
+				// ids are skipped: currently we always generate them
+				size_t skip = nids ? _coordinates[p].nn : 0, size = 3 * _coordinates[p].nn;
+				size_t cbegin = clamp(first[p], skip, size), cend = clamp(first[p] + lines[p], skip, size);
+				std::vector<float> coordinates(cend - cbegin);
+				parse(p, skip + cbegin, cend - cbegin, [&] (const char *c, size_t value) {
+					coordinates[value] = strtod(c, NULL);
+				});
+				pushCoordinates(mesh, p, coordinates, cbegin, cend, firstrank, lastrank, cidoffset);
+			}
+		}
+
+		nelements.push_back(0);
+		for (; i < _elements.size() && (p + 1 == parts || _elements[i].offset < _coordinates[p + 1].offset); ++i) {
+			size_t b = _coordinates.size() + i;
+			int esize = esizes[(int)_elements[i].type];
+			size_t skip = eids ? _elements[i].ne : 0, size = _elements[i].ne;
+			size_t ebegin = clamp(first[b], skip, size), eend = clamp(first[b] + lines[b], skip, size);
+			std::vector<int> elements(esize * (eend - ebegin));
+			parse(b, skip + ebegin, eend - ebegin, [&] (const char *c, size_t element) {
+				char *next;
+				for (int n = 0; n < esize; ++n, c = next) {
+					elements[esize * element + n] = strtol(c, &next, 10);
+				}
+			});
+			nelements.back() += pushElements(mesh, p, i, names.back(), elements, ebegin, cidoffset);
+		}
+		cidoffset += _coordinates[p].nn;
+	}
+
+	numbering(mesh, names, nelements);
 }
@@ -12,6 +12,8 @@ namespace mesio {
 struct MeshBuilder;
 
 class EnsightGeometry {
+	friend class EnsightVariables;
+
 	enum class Format {
 		BINARY,
 		ASCII,
@@ -55,6 +57,15 @@ class EnsightGeometry {
 		int ne;
 	};
 
+	// items of a part (coordinates) or an element block parsed by this process
+	struct Range {
+		Range(): part(0), begin(0), size(0), local(0) {}
+		Range(size_t part, size_t begin, size_t size, size_t local): part(part), begin(begin), size(size), local(local) {}
+
+		size_t part, begin, size;
+		size_t local; // the offset in the mesh
+	};
+
 public:
 	EnsightGeometry(InputFilePack &geofile);
 
@@ -68,12 +79,21 @@ protected:
 	void parseBinary(MeshBuilder &mesh);
 	void parseASCII(MeshBuilder &mesh);
 
+	// values 'x x x ...; y y y ...; z z z ...' in [cbegin, cend) are grouped to points on processes firstrank..lastrank
+	void pushCoordinates(MeshBuilder &mesh, size_t part, std::vector<float> &coordinates, size_t cbegin, size_t cend, int firstrank, int lastrank, esint cidoffset);
+	// nodes of elements [first, first + elements.size() / esize) of the block, returns the number of added elements
+	int pushElements(MeshBuilder &mesh, size_t part, size_t block, const std::string &name, std::vector<int> &elements, size_t first, esint cidoffset);
+	// elements are numbered continuously per parts
+	void numbering(MeshBuilder &mesh, const std::vector<std::string> &names, std::vector<esint> &nelements);
+
 	InputFilePack &_geofile;
 
 	Header _header;
 	std::vector<char> _parts;
 	std::vector<Coordinates> _coordinates;
 	std::vector<Elements> _elements;
+	std::vector<size_t> _keywords; // ASCII: offsets of all keywords (ends of blocks)
+	std::vector<Range> _nranges, _eranges;
 };
 }
 
@@ -0,0 +1,155 @@
+
+#include "variables.h"
+#include "casefile.h"
+#include "geometry.h"
+#include "basis/io/loader.h"
+#include "wrappers/mpi/communication.h"
+#include "esinfo/eslog.hpp"
+#include "esinfo/mpiinfo.h"
+#include "input/meshbuilder.h"
+
+#include <cstring>
+
+using namespace mesio;
+
+// the order of EnsightGeometry::Elements::Type
+static const char* etypes[] = {
+	"point",
+	"bar2", "bar3",
+	"tria3", "tria6", "quad4", "quad8",
+	"tetra4", "tetra10", "pyramid5", "pyramid13", "penta6", "penta15", "hexa8", "hexa20",
+	"nsided", "nfaced"
+};
+
+// positions of EnSight components in the mesh data
+static const int symm[6] = { 0, 1, 2, 3, 5, 4 }; // 11 22 33 12 13 23
+static const int asym[9] = { 0, 3, 5, 6, 1, 4, 8, 7, 2 }; // 11 12 13 21 22 23 31 32 33
+
+EnsightVariables::EnsightVariables(const EnsightCasefile &casefile, const EnsightGeometry &geometry)
+: _casefile(casefile), _geometry(geometry)
+{
+
+}
+
+void EnsightVariables::parse(MeshBuilder &mesh)
+{
+	if (_geometry._header.format == EnsightGeometry::Format::ASCII) {
+		if (_casefile.variables.size()) {
+			eslog::warning("EnSight Gold parser: variables of ASCII geometry are not supported (skipped).\n");
+		}
+		return;
+	}
+
+	for (auto variable = _casefile.variables.begin(); variable != _casefile.variables.end(); ++variable) {
+		bool nodes = variable->source == EnsightCasefile::Variable::Source::NODES;
+		const std::vector<EnsightGeometry::Range> &ranges = nodes ? _geometry._nranges : _geometry._eranges;
+
+		// the root walks through headers and finds offsets of values of parts (per node) or element blocks (per element)
+		std::vector<size_t> offsets(nodes ? _geometry._coordinates.size() : _geometry._elements.size(), (size_t)-1);
+		if (info::mpi::rank == 0) {
+			MPILoader loader;
+			if (loader.open(MPITools::subset->across, variable->path)) {
+				eslog::error("EnSight Gold parser: cannot open variable file '%s'.\n", variable->path.c_str());
+			}
+			size_t fsize = loader.size(), offset = 0;
+			char header[80 + sizeof(int)];
+			auto read = [&] (size_t size) {
+				if (offset + size <= fsize) {
+					loader.read(header, offset, size);
+					return true;
+				}
+				return false;
+			};
+			auto is = [&] (const char *key) {
+				size_t size = strlen(key);
+				if (memcmp(header, key, size) != 0) {
+					return false;
+				}
+				for (size_t i = size; i < 80 && header[i] != '\0'; ++i) {
+					if (header[i] != ' ') {
+						return false; // e.g., 'coordinates partial'
+					}
+				}
+				return true;
+			};
+
+			if (read(80) && is("C Binary")) {
+				offset += 80;
+			}
+			if (read(80) && is("BEGIN TIME STEP")) {
+				offset += 80;
+			}
+			offset += 80; // description
+			bool valid = true;
+			while (valid && read(80 + sizeof(int)) && is("part")) {
+				int part;
+				memcpy(&part, header + 80, sizeof(int));
+				if (part < 1 || (size_t)part > _geometry._coordinates.size()) {
+					eslog::error("EnSight Gold parser: invalid part '%d' in variable file '%s'.\n", part, variable->path.c_str());
+				}
+				offset += 80 + sizeof(int);
+				if (nodes) {
+					if ((valid = read(80) && is("coordinates"))) {
+						offsets[part - 1] = offset + 80;
+						offset += 80 + variable->dimension * _geometry._coordinates[part - 1].nn * sizeof(float);
+					}
+				} else {
+					while (read(80)) {
+						size_t block = 0;
+						while (block < ranges.size() && (ranges[block].part + 1 != (size_t)part || offsets[block] != (size_t)-1 || !is(etypes[(int)_geometry._elements[block].type]))) {
+							++block;
+						}
+						if (block == ranges.size()) {
+							break;
+						}
+						offsets[block] = offset + 80;
+						offset += 80 + variable->dimension * _geometry._elements[block].ne * sizeof(float);
+					}
+				}
+			}
+			if (offset < fsize && !(read(80) && is("END TIME STEP"))) {
+				eslog::warning("EnSight Gold parser: undefined and partial values are not supported (variable '%s' is set to zero).\n", variable->name.c_str());
+			}
+			loader.close();
+		}
+		Communication::broadcast(offsets.data(), offsets.size(), MPITools::getType<size_t>().mpitype, 0);
+
+		MeshData::Field &field = (nodes ? mesh.ndata : mesh.edata)[variable->name];
+		field.dimension = variable->dimension;
+		switch (variable->dimension) {
+		case 1: field.type = NamedData::DataType::SCALAR; break;
+		case 3: field.type = NamedData::DataType::VECTOR; break;
+		case 6: field.type = NamedData::DataType::TENSOR_ASYM; break;
+		case 9: field.type = NamedData::DataType::TENSOR_SYMM; break;
+		}
+		field.values.assign(variable->dimension * (nodes ? mesh.coordinates.size() : mesh.etype.size()), 0);
+
+		// each process reads values of its items (components are stored one after another)
+		MPILoader loader;
+		bool opened = false;
+		std::vector<float> values;
+		for (size_t r = 0; r < ranges.size(); ++r) {
+			if (ranges[r].size == 0 || offsets[r] == (size_t)-1) {
+				continue;
+			}
+			if (!opened) {
+				if (loader.open(MPITools::subset->across, variable->path)) {
+					eslog::error("EnSight Gold parser: cannot open variable file '%s'.\n", variable->path.c_str());
+				}
+				opened = true;
+			}
+			size_t total = nodes ? _geometry._coordinates[r].nn : _geometry._elements[r].ne;
+			values.resize(ranges[r].size);
+			for (int d = 0; d < variable->dimension; ++d) {
+				loader.read(reinterpret_cast<char*>(values.data()), offsets[r] + (d * total + ranges[r].begin) * sizeof(float), values.size() * sizeof(float));
+				int position = variable->dimension == 6 ? symm[d] : variable->dimension == 9 ? asym[d] : d;
+				for (size_t i = 0; i < values.size(); ++i) {
+					field.values[(ranges[r].local + i) * variable->dimension + position] = values[i];
+				}
+			}
+		}
+		if (opened) {
+			loader.close();
+		}
+	}
+}
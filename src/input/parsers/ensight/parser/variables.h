@@ -0,0 +1,23 @@
+
+#ifndef SRC_INPUT_FORMATS_ENSIGHT_PARSER_VARIABLES_H_
+#define SRC_INPUT_FORMATS_ENSIGHT_PARSER_VARIABLES_H_
+
+namespace mesio {
+
+struct MeshBuilder;
+class EnsightCasefile;
+class EnsightGeometry;
+
+class EnsightVariables {
+public:
+	EnsightVariables(const EnsightCasefile &casefile, const EnsightGeometry &geometry);
+
+	void parse(MeshBuilder &mesh);
+
+protected:
+	const EnsightCasefile &_casefile;
+	const EnsightGeometry &_geometry;
+};
+}
+
+#endif /* SRC_INPUT_FORMATS_ENSIGHT_PARSER_VARIABLES_H_ */
@@ -0,0 +1,81 @@
+
+#include "generator.h"
+#include "config/input.h"
+#include "esinfo/eslog.h"
+#include "esinfo/envinfo.h"
+#include "esinfo/mpiinfo.h"
+#include "basis/containers/tarray.h"
+#include "mesh/element.h"
+
+#include <numeric>
+
+using namespace mesio;
+
+PartsGenerator::PartsGenerator(const InputConfiguration &configuration)
+: _configuration(configuration)
+{
+
+}
+
+void PartsGenerator::load()
+{
+	eslog::startln("GENERATOR: STARTED", "GENERATOR");
+
+	esint parts = _configuration.generator.parts, k = _configuration.generator.elements;
+	if (parts < 1 || k < 1) {
+		eslog::globalerror("GENERATOR: the number of parts and elements per part has to be positive.\n");
+	}
+	esint nparts = parts * parts * parts, npp = (k + 1) * (k + 1) * (k + 1), epp = k * k * k;
+
+	// each process generates a continuous interval of nodes and elements (as it is read from a file)
+	esint nbegin = (esint)((double)nparts * npp * info::mpi::rank / info::mpi::size);
+	esint nend = (esint)((double)nparts * npp * (info::mpi::rank + 1) / info::mpi::size);
+	esint ebegin = (esint)((double)nparts * epp * info::mpi::rank / info::mpi::size);
+	esint eend = (esint)((double)nparts * epp * (info::mpi::rank + 1) / info::mpi::size);
+
+	int threads = info::env::threads;
+	nIDs.resize(nend - nbegin);
+	coordinates.resize(nend - nbegin);
+	std::vector<esint> ndistribution = tarray<esint>::distribute(threads, nend - nbegin);
+
+	// parts are separated by a gap of the element size
+	#pragma omp parallel for
+	for (int t = 0; t < threads; t++) {
+		for (esint n = ndistribution[t]; n < ndistribution[t + 1]; ++n) {
+			esint id = nbegin + n, p = id / npp, i = id % npp;
+			nIDs[n] = id;
+			coordinates[n].x = (p % parts) * (k + 1) + i % (k + 1);
+			coordinates[n].y = (p / parts % parts) * (k + 1) + i / (k + 1) % (k + 1);
+			coordinates[n].z = (p / parts / parts) * (k + 1) + i / (k + 1) / (k + 1);
+		}
+	}
+	eslog::checkpointln("GENERATOR: NODES GENERATED");
+
+	eIDs.resize(eend - ebegin);
+	std::iota(eIDs.begin(), eIDs.end(), ebegin);
+	esize.resize(eend - ebegin, 8);
+	etype.resize(eend - ebegin, (int)Element::CODE::HEXA8);
+	enodes.resize(8 * (eend - ebegin));
+	std::vector<esint> edistribution = tarray<esint>::distribute(threads, eend - ebegin);
+
+	#pragma omp parallel for
+	for (int t = 0; t < threads; t++) {
+		for (esint e = edistribution[t]; e < edistribution[t + 1]; ++e) {
+			esint id = ebegin + e, p = id / epp, i = id % epp;
+			esint x = i % k, y = i / k % k, z = i / k / k;
+			esint n0 = p * npp + (z * (k + 1) + y) * (k + 1) + x;
+			esint *nodes = enodes.data() + 8 * e;
+			nodes[0] = n0;
+			nodes[1] = n0 + 1;
+			nodes[2] = n0 + (k + 1) + 1;
+			nodes[3] = n0 + (k + 1);
+			nodes[4] = n0 + (k + 1) * (k + 1);
+			nodes[5] = n0 + (k + 1) * (k + 1) + 1;
+			nodes[6] = n0 + (k + 1) * (k + 1) + (k + 1) + 1;
+			nodes[7] = n0 + (k + 1) * (k + 1) + (k + 1);
+		}
+	}
+	body.resize(etype.size());
+	material.resize(etype.size());
+	eslog::endln("GENERATOR: ELEMENTS GENERATED");
+}
@@ -0,0 +1,23 @@
+
+#ifndef SRC_INPUT_PARSERS_GENERATOR_GENERATOR_H_
+#define SRC_INPUT_PARSERS_GENERATOR_GENERATOR_H_
+
+#include "input/meshbuilder.h"
+
+namespace mesio {
+
+class InputConfiguration;
+
+// synthetic mesh composed of parts x parts x parts disjoint cubes (bodies) of elements^3 hexahedra
+class PartsGenerator: public MeshBuilder {
+public:
+	PartsGenerator(const InputConfiguration &configuration);
+	void load();
+
+protected:
+	const InputConfiguration &_configuration;
+};
+
+}
+
+#endif /* SRC_INPUT_PARSERS_GENERATOR_GENERATOR_H_ */
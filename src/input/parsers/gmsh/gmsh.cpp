@@ -0,0 +1,77 @@
+
+#include "gmsh.h"
+#include "parser/msh.parser.h"
+#include "config/input.h"
+#include "basis/utilities/sysutils.h"
+#include "wrappers/mpi/communication.h"
+#include "esinfo/mpiinfo.h"
+#include "esinfo/eslog.hpp"
+
+#include <algorithm>
+
+using namespace mesio;
+
+GmshLoader::GmshLoader(const InputConfiguration &configuration)
+: _configuration(configuration)
+{
+
+}
+
+// a partitioned mesh is stored to files 'mesh_1.msh', 'mesh_2.msh', ... if the path 'mesh.msh' does not exist
+static std::vector<std::string> files(const std::string &path)
+{
+	std::vector<char> names;
+	if (info::mpi::rank == 0) {
+		std::vector<std::string> paths;
+		if (utils::exists(path)) {
+			paths.push_back(path);
+		} else {
+			size_t dot = path.find_last_of('.'), slash = path.find_last_of('/');
+			std::string stem = path.substr(0, dot), suffix = path.substr(dot);
+			if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+				stem = path, suffix = ".msh";
+			}
+			for (int part = 1; utils::exists(stem + "_" + std::to_string(part) + suffix); ++part) {
+				paths.push_back(stem + "_" + std::to_string(part) + suffix);
+			}
+		}
+		for (size_t i = 0; i < paths.size(); ++i) {
+			names.insert(names.end(), paths[i].begin(), paths[i].end());
+			names.push_back('\0');
+		}
+	}
+	Communication::broadcastUnknownSize(names);
+
+	std::vector<std::string> paths;
+	for (auto c = names.begin(); c != names.end(); ++c) {
+		auto end = std::find(c, names.end(), '\0');
+		paths.push_back(std::string(c, end));
+		c = end;
+	}
+	return paths;
+}
+
+void GmshLoader::load()
+{
+	eslog::startln("GMSH PARSER: STARTED", "GMSH PARSER");
+
+	std::vector<std::string> paths = files(_configuration.path);
+	if (paths.empty()) {
+		eslog::globalerror("GMSH PARSER: neither '%s' nor its partitions '<name>_<part>.msh' exist.\n", _configuration.path.c_str());
+	}
+
+	// each partition is read by different readers if there are more readers than partitions
+	InputFilePack meshfile;
+	meshfile.commitFiles(paths);
+	meshfile.prepare();
+	eslog::checkpointln("GMSH PARSER: MESH READER PREPARED");
+
+	meshfile.read();
+	eslog::checkpointln("GMSH PARSER: MESH READ");
+
+	GmshMesh mesh(meshfile);
+	mesh.parse(*this);
+	body.resize(etype.size());
+	material.resize(etype.size());
+	eslog::endln("GMSH PARSER: GEOMETRY PARSED");
+}
@@ -0,0 +1,22 @@
+
+#ifndef SRC_INPUT_PARSERS_GMSH_GMSH_H_
+#define SRC_INPUT_PARSERS_GMSH_GMSH_H_
+
+#include "input/meshbuilder.h"
+
+namespace mesio {
+
+class InputConfiguration;
+
+class GmshLoader: public MeshBuilder {
+public:
+	GmshLoader(const InputConfiguration &configuration);
+	void load();
+
+protected:
+	const InputConfiguration &_configuration;
+};
+
+}
+
+#endif /* SRC_INPUT_PARSERS_GMSH_GMSH_H_ */
@@ -0,0 +1,921 @@
+
+#include "msh.parser.h"
+#include "basis/containers/tarray.h"
+#include "wrappers/mpi/communication.h"
+#include "esinfo/envinfo.h"
+#include "esinfo/mpiinfo.h"
+#include "esinfo/eslog.hpp"
+#include "mesh/element.h"
+#include "input/meshbuilder.h"
+#include "input/parsers/distributedscanner.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+using namespace mesio;
+
+static const char* sections[] = { "PhysicalNames", "Entities", "PartitionedEntities", "Nodes", "Elements" };
+
+// Gmsh element types: the number of nodes, the dimension, the code, and the order of nodes in MESIO (Element::CODE::SIZE if not supported)
+struct GmshElement {
+	int nodes, dim;
+	Element::CODE code;
+	const int *order;
+};
+
+static const int tetra10[]   = { 0, 1, 2, 3, 4, 5, 6, 7, 9, 8 };
+static const int pyramid13[] = { 0, 1, 2, 3, 4, 5, 8, 10, 6, 7, 9, 11, 12 };
+static const int prisma15[]  = { 0, 1, 2, 3, 4, 5, 6, 9, 7, 12, 14, 13, 8, 10, 11 };
+static const int hexa20[]    = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 11, 13, 9, 16, 18, 19, 17, 10, 12, 14, 15 };
+
+static const GmshElement types[] = {
+	{  0, -1, Element::CODE::SIZE     , NULL },
+	{  2,  1, Element::CODE::LINE2    , NULL },
+	{  3,  2, Element::CODE::TRIANGLE3, NULL },
+	{  4,  2, Element::CODE::SQUARE4  , NULL },
+	{  4,  3, Element::CODE::TETRA4   , NULL },
+	{  8,  3, Element::CODE::HEXA8    , NULL },
+	{  6,  3, Element::CODE::PRISMA6  , NULL },
+	{  5,  3, Element::CODE::PYRAMID5 , NULL },
+	{  3,  1, Element::CODE::LINE3    , NULL },
+	{  6,  2, Element::CODE::TRIANGLE6, NULL },
+	{  9,  2, Element::CODE::SIZE     , NULL }, // SQUARE9
+	{ 10,  3, Element::CODE::TETRA10  , tetra10 },
+	{ 27,  3, Element::CODE::SIZE     , NULL }, // HEXA27
+	{ 18,  3, Element::CODE::SIZE     , NULL }, // PRISMA18
+	{ 14,  3, Element::CODE::SIZE     , NULL }, // PYRAMID14
+	{  1,  0, Element::CODE::POINT1   , NULL },
+	{  8,  2, Element::CODE::SQUARE8  , NULL },
+	{ 20,  3, Element::CODE::HEXA20   , hexa20 },
+	{ 15,  3, Element::CODE::PRISMA15 , prisma15 },
+	{ 13,  3, Element::CODE::PYRAMID13, pyramid13 },
+};
+
+static bool supported(int type)
+{
+	return 0 < type && type < (int)(sizeof(types) / sizeof(GmshElement));
+}
+
+// values of small sections are read one by one
+struct Stream {
+	const char *c, *end;
+	bool binary, valid;
+
+	Stream(const std::vector<char> &data, bool binary): c(data.data()), end(data.data() + data.size()), binary(binary), valid(true) {}
+
+	template <typename TType>
+	TType get()
+	{
+		TType value = 0;
+		if (c + sizeof(TType) <= end) {
+			memcpy(&value, c, sizeof(TType));
+		} else {
+			valid = false;
+		}
+		c += sizeof(TType);
+		return value;
+	}
+
+	size_t size()
+	{
+		if (binary) {
+			return get<size_t>();
+		}
+		char *next;
+		size_t value = strtoull(c, &next, 10);
+		valid &= next != c;
+		c = next;
+		return value;
+	}
+
+	int integer()
+	{
+		if (binary) {
+			return get<int>();
+		}
+		char *next;
+		int value = strtol(c, &next, 10);
+		valid &= next != c;
+		c = next;
+		return value;
+	}
+
+	double real()
+	{
+		if (binary) {
+			return get<double>();
+		}
+		char *next;
+		double value = strtod(c, &next);
+		valid &= next != c;
+		c = next;
+		return value;
+	}
+};
+
+GmshMesh::GmshMesh(InputFilePack &meshfile)
+: _meshfile(meshfile)
+{
+
+}
+
+void GmshMesh::parse(MeshBuilder &mesh)
+{
+	format();
+	for (size_t f = 0; f < _meshfile.files.size(); ++f) {
+		if (!_format[f].binary) {
+			DistributedScanner::align(*_meshfile.files[f], "\n");
+		}
+	}
+	scan();
+	eslog::checkpointln("GMSH PARSER: SECTIONS SCANNED");
+
+	entities();
+	eslog::checkpointln("GMSH PARSER: ENTITIES PARSED");
+
+	blocksASCII();
+	blocksBinary();
+	eslog::checkpointln("GMSH PARSER: BLOCKS FOUND");
+
+	nodes(mesh);
+	eslog::checkpointln("GMSH PARSER: NODES PARSED");
+
+	elements(mesh);
+	eslog::checkpointln("GMSH PARSER: ELEMENTS PARSED");
+}
+
+void GmshMesh::format()
+{
+	// '$MeshFormat', 'version file-type data-size', binary files continue with 'int 1' to check endianness
+	for (size_t f = 0; f < _meshfile.files.size(); ++f) {
+		InputFile *file = _meshfile.files[f];
+		if (file->distribution[info::mpi::rank] == 0 && file->distribution[info::mpi::rank + 1] != 0) {
+			Format format{ (int)f, -1, 0, 0 };
+			const char *c = file->begin;
+			if (DistributedScanner::check(c, "$MeshFormat")) {
+				while (c < file->hardend && *c++ != '\n');
+				char *next;
+				format.version = strtod(c, &next);
+				format.binary = strtol(next, &next, 10);
+				format.size = strtol(next, &next, 10);
+				for (c = next; c < file->hardend && *c++ != '\n';);
+				int one = 0;
+				if (format.binary == 1 && c + sizeof(int) <= file->hardend) {
+					memcpy(&one, c, sizeof(int));
+				}
+				if (format.binary == 1 && one != 1) {
+					format.binary = -1;
+				}
+			}
+			_format.push_back(format);
+		}
+	}
+	Communication::allGatherUnknownSize(_format);
+	std::sort(_format.begin(), _format.end(), [] (const Format &f1, const Format &f2) { return f1.file < f2.file; });
+
+	if (_format.size() != _meshfile.files.size()) {
+		eslog::globalerror("GMSH PARSER: cannot read the mesh format of all files.\n");
+	}
+	for (size_t f = 0; f < _format.size(); ++f) {
+		if (_format[f].version < 4.1 - 1e-6 || 5 <= _format[f].version || _format[f].binary < 0 || 1 < _format[f].binary) {
+			eslog::globalerror("GMSH PARSER: '%s' is not MSH 4.1 file (MSH 2 files written by Neper are read by the NEPER parser).\n", _meshfile.paths[f].c_str());
+		}
+		if (_format[f].binary && _format[f].size != sizeof(size_t)) {
+			eslog::globalerror("GMSH PARSER: '%s' has not supported data size %d.\n", _meshfile.paths[f].c_str(), _format[f].size);
+		}
+	}
+}
+
+void GmshMesh::scan()
+{
+	std::vector<Keyword> keywords;
+	size_t current = 0;
+
+	// keywords fill whole lines (binary data can contain anything)
+	auto add = [&] (const char *c, int section, int open, size_t size) {
+		InputFile *file = _meshfile.files[current];
+		const char *end = c + size;
+		if (*end == '\r') {
+			++end;
+		}
+		if (*end == '\n' && (c == file->begin || *(c - 1) == '\n')) {
+			size_t offset = file->distribution[info::mpi::rank] + ((open ? end + 1 : c) - file->begin);
+			keywords.push_back(Keyword{ (int)current, section, open, offset });
+		}
+	};
+
+	DistributedScanner scanner;
+	for (int s = 0; s < SECTIONS; ++s) {
+		std::string open = std::string("$") + sections[s], close = std::string("$End") + sections[s];
+		scanner.add(open.c_str() , [&, s, open] (const char *c) { add(c, s, 1, open.size()); });
+		scanner.add(close.c_str(), [&, s, close] (const char *c) { add(c, s, 0, close.size()); });
+	}
+	for (current = 0; current < _meshfile.files.size(); ++current) {
+		if (_format[current].binary) {
+			scanner.scan(*_meshfile.files[current]);
+		} else {
+			scanner.scanlines(*_meshfile.files[current]);
+		}
+	}
+	scanner.synchronize(keywords);
+
+	std::sort(keywords.begin(), keywords.end(), [] (const Keyword &k1, const Keyword &k2) {
+		return k1.file == k2.file ? k1.offset < k2.offset : k1.file < k2.file;
+	});
+	_sections.resize(_meshfile.files.size());
+	for (size_t f = 0; f < _sections.size(); ++f) {
+		std::fill(_sections[f].begin, _sections[f].begin + SECTIONS, (size_t)-1);
+		std::fill(_sections[f].end, _sections[f].end + SECTIONS, (size_t)-1);
+	}
+	for (size_t k = 0; k < keywords.size(); ++k) {
+		Sections &s = _sections[keywords[k].file];
+		if (keywords[k].open && s.begin[keywords[k].section] == (size_t)-1) {
+			s.begin[keywords[k].section] = keywords[k].offset;
+		}
+		if (!keywords[k].open && s.begin[keywords[k].section] != (size_t)-1 && s.end[keywords[k].section] == (size_t)-1) {
+			s.end[keywords[k].section] = keywords[k].offset;
+		}
+	}
+	for (size_t f = 0; f < _sections.size(); ++f) {
+		for (int s = 0; s < SECTIONS; ++s) {
+			if ((_sections[f].begin[s] == (size_t)-1) != (_sections[f].end[s] == (size_t)-1)) {
+				eslog::globalerror("GMSH PARSER: section '%s' is not closed in '%s'.\n", sections[s], _meshfile.paths[f].c_str());
+			}
+		}
+		if (_sections[f].begin[NODES] == (size_t)-1 || _sections[f].begin[ELEMENTS] == (size_t)-1) {
+			eslog::globalerror("GMSH PARSER: '%s' has no nodes or elements.\n", _meshfile.paths[f].c_str());
+		}
+	}
+}
+
+void GmshMesh::entities()
+{
+	struct Piece {
+		int file, section;
+		size_t offset, size;
+	};
+
+	// small sections are gathered on all processes
+	std::vector<char> pieces;
+	for (size_t f = 0; f < _meshfile.files.size(); ++f) {
+		const InputFile *file = _meshfile.files[f];
+		for (int s = PHYSICAL_NAMES; s <= PARTITIONED_ENTITIES; ++s) {
+			size_t begin = std::max(_sections[f].begin[s], file->distribution[info::mpi::rank]);
+			size_t end = std::min(_sections[f].end[s], file->distribution[info::mpi::rank + 1]);
+			if (_sections[f].begin[s] != (size_t)-1 && begin < end) {
+				Piece piece{ (int)f, s, begin - _sections[f].begin[s], end - begin };
+				pieces.insert(pieces.end(), reinterpret_cast<const char*>(&piece), reinterpret_cast<const char*>(&piece) + sizeof(Piece));
+				pieces.insert(pieces.end(), file->begin + begin - file->distribution[info::mpi::rank], file->begin + end - file->distribution[info::mpi::rank]);
+			}
+		}
+	}
+	Communication::allGatherUnknownSize(pieces);
+
+	std::vector<std::vector<std::vector<char> > > data(_meshfile.files.size(), std::vector<std::vector<char> >(PARTITIONED_ENTITIES + 1));
+	for (size_t f = 0; f < _meshfile.files.size(); ++f) {
+		for (int s = PHYSICAL_NAMES; s <= PARTITIONED_ENTITIES; ++s) {
+			if (_sections[f].begin[s] != (size_t)-1) {
+				data[f][s].resize(_sections[f].end[s] - _sections[f].begin[s] + 1, '\0');
+			}
+		}
+	}
+	for (size_t p = 0; p < pieces.size(); ) {
+		Piece piece;
+		memcpy(&piece, pieces.data() + p, sizeof(Piece));
+		p += sizeof(Piece);
+		memcpy(data[piece.file][piece.section].data() + piece.offset, pieces.data() + p, piece.size);
+		p += piece.size;
+	}
+
+	// 'n', 'dim tag "name"' x n (always ASCII)
+	for (size_t f = 0; f < _meshfile.files.size(); ++f) {
+		if (data[f][PHYSICAL_NAMES].size()) {
+			const char *c = data[f][PHYSICAL_NAMES].data();
+			char *next;
+			for (long n = strtol(c, &next, 10); n > 0; --n) {
+				int dim = strtol(next, &next, 10);
+				int tag = strtol(next, &next, 10);
+				const char *begin = strchr(next, '"'), *end = begin ? strchr(begin + 1, '"') : NULL;
+				if (end == NULL) {
+					eslog::globalerror("GMSH PARSER: invalid physical names in '%s'.\n", _meshfile.paths[f].c_str());
+				}
+				_names[std::make_pair(dim, tag)] = std::string(begin + 1, std::min(end, begin + GMSH_MAX_NAME_SIZE));
+				next = const_cast<char*>(end + 1);
+			}
+		}
+	}
+
+	// entities of partitioned meshes have own tags, physical tags are copied from the parent entities
+	_physical.resize(_meshfile.files.size());
+	for (size_t f = 0; f < _meshfile.files.size(); ++f) {
+		for (int s = ENTITIES; s <= PARTITIONED_ENTITIES; ++s) {
+			if (data[f][s].empty()) {
+				continue;
+			}
+			Stream stream(data[f][s], _format[f].binary);
+			if (s == PARTITIONED_ENTITIES) {
+				stream.size(); // numPartitions
+				for (size_t ghosts = stream.size(); ghosts; --ghosts) {
+					stream.integer(); // ghostEntityTag
+					stream.integer(); // partition
+				}
+			}
+			size_t count[4] = { stream.size(), stream.size(), stream.size(), stream.size() };
+			for (int dim = 0; dim < 4 && stream.valid; ++dim) {
+				for (size_t e = 0; e < count[dim] && stream.valid; ++e) {
+					int tag = stream.integer();
+					if (s == PARTITIONED_ENTITIES) {
+						stream.integer(); // parentDim
+						stream.integer(); // parentTag
+						for (size_t partitions = stream.size(); partitions; --partitions) {
+							stream.integer();
+						}
+					}
+					for (int i = 0; i < (dim ? 6 : 3); ++i) { // point or bounding box
+						stream.real();
+					}
+					std::vector<int> &physical = _physical[f][std::make_pair(dim, tag)];
+					physical.clear();
+					for (size_t tags = stream.size(); tags && stream.valid; --tags) {
+						physical.push_back(std::abs(stream.integer()));
+					}
+					if (dim) {
+						for (size_t bounding = stream.size(); bounding && stream.valid; --bounding) {
+							stream.integer();
+						}
+					}
+				}
+			}
+			if (!stream.valid) {
+				eslog::globalerror("GMSH PARSER: invalid section '%s' in '%s'.\n", sections[s], _meshfile.paths[f].c_str());
+			}
+		}
+	}
+}
+
+std::string GmshMesh::name(int dim, int tag)
+{
+	auto it = _names.find(std::make_pair(dim, tag));
+	if (it != _names.end()) {
+		return it->second;
+	}
+	return "PHYSICAL_" + std::to_string(dim) + "D_" + std::to_string(tag);
+}
+
+void GmshMesh::blocksASCII()
+{
+	struct Candidate {
+		int file, section;
+		size_t line, value[4];
+	};
+
+	// a line with four integers (without signs)
+	auto header = [] (const char *c, size_t *value) {
+		char *next;
+		for (int i = 0; i < 4; ++i, c = next) {
+			while (*c == ' ' || *c == '\t') { ++c; }
+			if (*c < '0' || '9' < *c) {
+				return false;
+			}
+			value[i] = strtoull(c, &next, 10);
+		}
+		while (*c == ' ' || *c == '\t' || *c == '\r') { ++c; }
+		return *c == '\n';
+	};
+
+	// lines are counted per process in order to get the line index of each record
+	size_t threads = info::env::threads, files = _meshfile.files.size();
+	std::vector<Candidate> candidates;
+	std::vector<size_t> first(2 * files), total;
+	std::vector<std::vector<std::vector<Candidate> > > tcandidates(2 * files, std::vector<std::vector<Candidate> >(threads));
+	_lines.resize(files, std::vector<Lines>(2));
+	for (size_t f = 0; f < files; ++f) {
+		const InputFile *file = _meshfile.files[f];
+		for (int s = NODES; s <= ELEMENTS; ++s) {
+			Lines &lines = _lines[f][s - NODES];
+			lines.tbegin.assign(threads + 1, file->begin);
+			lines.tlines.assign(threads + 1, 0);
+			size_t rbegin = file->distribution[info::mpi::rank], rend = file->distribution[info::mpi::rank + 1];
+			size_t lbegin = std::max(_sections[f].begin[s], rbegin), lend = std::min(_sections[f].end[s], rend);
+			if (_format[f].binary || lend <= lbegin) {
+				continue;
+			}
+			const char *begin = file->begin + lbegin - rbegin, *end = file->begin + lend - rbegin;
+			std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, lend - lbegin);
+			for (size_t t = 0; t <= threads; ++t) {
+				const char *c = begin + tdistribution[t];
+				if (t && t < threads && *(c - 1) != '\n') {
+					while (c < end && *c++ != '\n'); // start at new line
+				}
+				lines.tbegin[t] = std::max(c, lines.tbegin[t ? t - 1 : 0]);
+			}
+
+			#pragma omp parallel for
+			for (size_t t = 0; t < threads; t++) {
+				size_t line = 0;
+				Candidate candidate{ (int)f, s, 0, { 0, 0, 0, 0 } };
+				for (const char *c = lines.tbegin[t]; c < lines.tbegin[t + 1]; ++line) {
+					if (header(c, candidate.value)) {
+						candidate.line = line;
+						tcandidates[2 * f + s - NODES][t].push_back(candidate);
+					}
+					while (c < lines.tbegin[t + 1] && *c++ != '\n');
+				}
+				lines.tlines[t + 1] = line;
+			}
+			for (size_t t = 0; t < threads; t++) {
+				lines.tlines[t + 1] += lines.tlines[t];
+			}
+			first[2 * f + s - NODES] = lines.tlines[threads];
+		}
+	}
+	Communication::exscan(total, first);
+
+	// the first line is the summary, block headers start with the entity dimension
+	for (size_t f = 0; f < files; ++f) {
+		for (int s = NODES; s <= ELEMENTS; ++s) {
+			_lines[f][s - NODES].first = first[2 * f + s - NODES];
+			for (size_t t = 0; t < threads; t++) {
+				for (size_t i = 0; i < tcandidates[2 * f + s - NODES][t].size(); ++i) {
+					Candidate &candidate = tcandidates[2 * f + s - NODES][t][i];
+					candidate.line += first[2 * f + s - NODES] + _lines[f][s - NODES].tlines[t];
+					if (candidate.line == 0 || candidate.value[0] <= 3) {
+						candidates.push_back(candidate);
+					}
+				}
+			}
+		}
+	}
+	Communication::allGatherUnknownSize(candidates);
+	std::sort(candidates.begin(), candidates.end(), [] (const Candidate &c1, const Candidate &c2) {
+		if (c1.file != c2.file) { return c1.file < c2.file; }
+		if (c1.section != c2.section) { return c1.section < c2.section; }
+		return c1.line < c2.line;
+	});
+
+	// go through headers: nodes have lines with tags and lines with coordinates, elements have one line per element
+	for (size_t f = 0; f < files; ++f) {
+		for (int s = NODES; s <= ELEMENTS && !_format[f].binary; ++s) {
+			auto find = [&] (size_t line) {
+				auto it = std::lower_bound(candidates.begin(), candidates.end(), Candidate{ (int)f, s, line, { 0, 0, 0, 0 } }, [] (const Candidate &c1, const Candidate &c2) {
+					if (c1.file != c2.file) { return c1.file < c2.file; }
+					if (c1.section != c2.section) { return c1.section < c2.section; }
+					return c1.line < c2.line;
+				});
+				if (it == candidates.end() || it->file != (int)f || it->section != s || it->line != line) {
+					eslog::globalerror("GMSH PARSER: invalid section '%s' in '%s'.\n", sections[s], _meshfile.paths[f].c_str());
+				}
+				return it->value;
+			};
+
+			const size_t *summary = find(0);
+			_summary.push_back(Summary{ (int)f, s, summary[0], summary[1], summary[2], summary[3] });
+			for (size_t b = 0, line = 1; b < _summary.back().blocks; ++b) {
+				const size_t *value = find(line);
+				if (s == ELEMENTS && !supported(value[2])) {
+					eslog::globalerror("GMSH PARSER: not supported element type %lu in '%s'.\n", value[2], _meshfile.paths[f].c_str());
+				}
+				_blocks.push_back(Block{ (int)f, s, (int)value[0], (int)value[1], (int)value[2], line + 1, value[3] });
+				line += 1 + (s == NODES ? 2 : 1) * value[3];
+			}
+		}
+	}
+}
+
+void GmshMesh::blocksBinary()
+{
+	// headers are at offsets given by the previous headers, hence processes go through their headers in rounds
+	std::vector<std::pair<int, int> > chains;
+	std::vector<size_t> state, previous; // next header, the number of parsed headers (including the summary), the number of headers
+	for (size_t f = 0; f < _meshfile.files.size(); ++f) {
+		for (int s = NODES; s <= ELEMENTS && _format[f].binary; ++s) {
+			chains.push_back(std::make_pair(f, s));
+			state.insert(state.end(), { _sections[f].begin[s], 0, 0 });
+		}
+	}
+
+	std::vector<Summary> summary;
+	std::vector<Block> blocks;
+	auto done = [&] () {
+		for (size_t c = 0; c < chains.size(); ++c) {
+			if (state[3 * c + 2] == 0 || state[3 * c + 1] != state[3 * c + 2]) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	while (!done()) {
+		previous = state;
+		for (size_t c = 0; c < chains.size(); ++c) {
+			int f = chains[c].first, s = chains[c].second;
+			const InputFile *file = _meshfile.files[f];
+			size_t rbegin = file->distribution[info::mpi::rank], rend = file->distribution[info::mpi::rank + 1];
+			size_t &next = state[3 * c], &parsed = state[3 * c + 1], &headers = state[3 * c + 2];
+			while ((headers == 0 || parsed < headers) && next < _sections[f].end[s] && rbegin <= next && next < rend) {
+				const char *p = file->begin + next - rbegin;
+				if (headers == 0) {
+					size_t value[4];
+					memcpy(value, p, 4 * sizeof(size_t));
+					summary.push_back(Summary{ f, s, value[0], value[1], value[2], value[3] });
+					next += 4 * sizeof(size_t);
+					headers = value[0] + 1;
+					parsed = 1;
+				} else {
+					int value[3]; size_t size, record;
+					memcpy(value, p, 3 * sizeof(int));
+					memcpy(&size, p + 3 * sizeof(int), sizeof(size_t));
+					if (s == NODES) {
+						record = sizeof(size_t) + sizeof(double) * (3 + (value[2] ? value[0] : 0)); // tag, coordinates, parametric coordinates
+					} else {
+						if (!supported(value[2])) {
+							eslog::error("GMSH PARSER: not supported element type %d in '%s'.\n", value[2], _meshfile.paths[f].c_str());
+						}
+						record = sizeof(size_t) * (1 + types[value[2]].nodes);
+					}
+					next += 3 * sizeof(int) + sizeof(size_t);
+					blocks.push_back(Block{ f, s, value[0], value[1], value[2], next, size });
+					next += size * record;
+					++parsed;
+				}
+			}
+		}
+		Communication::allReduce(state.data(), NULL, state.size(), MPITools::getType<size_t>().mpitype, MPI_MAX);
+		for (size_t c = 0; c < chains.size() && state == previous; ++c) {
+			if (state[3 * c + 2] == 0 || state[3 * c + 1] != state[3 * c + 2]) {
+				eslog::globalerror("GMSH PARSER: invalid section '%s' in '%s'.\n", sections[chains[c].second], _meshfile.paths[chains[c].first].c_str());
+			}
+		}
+	}
+	Communication::allGatherUnknownSize(summary);
+	Communication::allGatherUnknownSize(blocks);
+	_summary.insert(_summary.end(), summary.begin(), summary.end());
+	_blocks.insert(_blocks.end(), blocks.begin(), blocks.end());
+
+	std::sort(_summary.begin(), _summary.end(), [] (const Summary &s1, const Summary &s2) {
+		return s1.file == s2.file ? s1.section < s2.section : s1.file < s2.file;
+	});
+	std::sort(_blocks.begin(), _blocks.end(), [] (const Block &b1, const Block &b2) {
+		if (b1.file != b2.file) { return b1.file < b2.file; }
+		if (b1.section != b2.section) { return b1.section < b2.section; }
+		return b1.position < b2.position;
+	});
+}
+
+std::vector<GmshMesh::Segment> GmshMesh::segments(int section, bool coordinates)
+{
+	std::vector<Segment> segments;
+	for (size_t b = 0; b < _blocks.size(); ++b) {
+		const Block &block = _blocks[b];
+		if (block.section != section) {
+			continue;
+		}
+		const InputFile *file = _meshfile.files[block.file];
+		size_t position = block.position, step = 1, begin, end;
+		if (_format[block.file].binary) {
+			if (section == NODES) {
+				step = coordinates ? sizeof(double) * (3 + (block.type ? block.dim : 0)) : sizeof(size_t);
+				position += coordinates ? block.size * sizeof(size_t) : 0;
+			} else {
+				step = sizeof(size_t) * (1 + types[block.type].nodes);
+			}
+			begin = file->distribution[info::mpi::rank];
+			end = file->distribution[info::mpi::rank + 1];
+		} else {
+			position += coordinates ? block.size : 0;
+			begin = _lines[block.file][section - NODES].first;
+			end = begin + _lines[block.file][section - NODES].tlines.back();
+		}
+		// records starting in [begin, end)
+		auto index = [&] (size_t offset) {
+			return offset <= position ? 0 : std::min(block.size, (offset - position + step - 1) / step);
+		};
+		size_t first = index(begin), last = index(end);
+		if (first < last) {
+			segments.push_back(Segment{ b, first, last - first, position + first * step, step });
+		}
+	}
+	return segments;
+}
+
+void GmshMesh::records(const std::vector<Segment> &segments, std::function<void(size_t segment, size_t record, const char *c)> parse)
+{
+	size_t threads = info::env::threads;
+
+	// binary records have fixed size
+	for (size_t s = 0; s < segments.size(); ++s) {
+		const Block &block = _blocks[segments[s].block];
+		if (_format[block.file].binary) {
+			const InputFile *file = _meshfile.files[block.file];
+			const char *begin = file->begin + segments[s].position - file->distribution[info::mpi::rank];
+			std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, segments[s].size);
+
+			#pragma omp parallel for
+			for (size_t t = 0; t < threads; t++) {
+				for (size_t r = tdistribution[t]; r < tdistribution[t + 1]; ++r) {
+					parse(s, r, begin + r * segments[s].step);
+				}
+			}
+		}
+	}
+
+	// ASCII records are lines (segments of a section are sorted)
+	for (size_t s = 0; s < segments.size(); ) {
+		const Block &block = _blocks[segments[s].block];
+		size_t last = s;
+		while (last < segments.size() && _blocks[segments[last].block].file == block.file && _blocks[segments[last].block].section == block.section) {
+			++last;
+		}
+		if (!_format[block.file].binary) {
+			const Lines &lines = _lines[block.file][block.section - NODES];
+
+			#pragma omp parallel for
+			for (size_t t = 0; t < threads; t++) {
+				size_t line = lines.first + lines.tlines[t], segment = s;
+				for (const char *c = lines.tbegin[t]; c < lines.tbegin[t + 1]; ++line) {
+					while (segment < last && segments[segment].position + segments[segment].size <= line) {
+						++segment;
+					}
+					if (segment < last && segments[segment].position <= line) {
+						parse(segment, line - segments[segment].position, c);
+					}
+					while (c < lines.tbegin[t + 1] && *c++ != '\n');
+				}
+			}
+		}
+		s = last;
+	}
+}
+
+void GmshMesh::nodes(MeshBuilder &mesh)
+{
+	std::vector<Segment> tags = segments(NODES, false), coordinates = segments(NODES, true);
+	std::vector<size_t> toffset(tags.size() + 1), coffset(coordinates.size() + 1);
+	for (size_t s = 0; s < tags.size(); ++s) {
+		toffset[s + 1] = toffset[s] + tags[s].size;
+	}
+	for (size_t s = 0; s < coordinates.size(); ++s) {
+		coffset[s + 1] = coffset[s] + coordinates[s].size;
+	}
+
+	std::vector<esint> ids(toffset.back());
+	std::vector<Point> points(coffset.back());
+	records(tags, [&] (size_t s, size_t record, const char *c) {
+		if (_format[_blocks[tags[s].block].file].binary) {
+			size_t id;
+			memcpy(&id, c, sizeof(size_t));
+			ids[toffset[s] + record] = id;
+		} else {
+			ids[toffset[s] + record] = strtol(c, NULL, 10);
+		}
+	});
+	records(coordinates, [&] (size_t s, size_t record, const char *c) {
+		Point &point = points[coffset[s] + record];
+		if (_format[_blocks[coordinates[s].block].file].binary) {
+			memcpy(&point.x, c + 0 * sizeof(double), sizeof(double));
+			memcpy(&point.y, c + 1 * sizeof(double), sizeof(double));
+			memcpy(&point.z, c + 2 * sizeof(double), sizeof(double));
+		} else {
+			char *next;
+			point.x = strtod(c, &next);
+			point.y = strtod(next, &next);
+			point.z = strtod(next, &next);
+		}
+	});
+
+	// tags and coordinates of a node can be parsed by different processes, hence nodes are paired according to the global position
+	std::vector<size_t> boffset(_blocks.size());
+	size_t total = 0;
+	for (size_t b = 0; b < _blocks.size(); ++b) {
+		if (_blocks[b].section == NODES) {
+			boffset[b] = total;
+			total += _blocks[b].size;
+		}
+	}
+	std::vector<size_t> distribution = tarray<size_t>::distribute(info::mpi::size, total);
+
+	std::vector<esint> sBuffer, rBuffer;
+	for (int r = 0; r < info::mpi::size; ++r) {
+		size_t prevsize = sBuffer.size();
+		sBuffer.push_back(0); // total size
+		sBuffer.push_back(r); // target
+		sBuffer.push_back(0); // ids
+		sBuffer.push_back(0); // coordinates
+
+		for (size_t s = 0; s < tags.size(); ++s) {
+			size_t position = boffset[tags[s].block] + tags[s].first;
+			size_t begin = std::max(position, distribution[r]), end = std::min(position + tags[s].size, distribution[r + 1]);
+			for (size_t n = begin; n < end; ++n) {
+				sBuffer.push_back(n - distribution[r]);
+				sBuffer.push_back(ids[toffset[s] + n - position]);
+			}
+			sBuffer[prevsize + 2] += std::max(begin, end) - begin;
+		}
+		for (size_t s = 0; s < coordinates.size(); ++s) {
+			size_t position = boffset[coordinates[s].block] + coordinates[s].first;
+			size_t begin = std::max(position, distribution[r]), end = std::min(position + coordinates[s].size, distribution[r + 1]);
+			for (size_t n = begin; n < end; ++n) {
+				sBuffer.push_back(n - distribution[r]);
+				sBuffer.insert(sBuffer.end(), reinterpret_cast<const esint*>(points.data() + coffset[s] + n - position), reinterpret_cast<const esint*>(points.data() + coffset[s] + n - position + 1));
+			}
+			sBuffer[prevsize + 3] += std::max(begin, end) - begin;
+		}
+		sBuffer[prevsize] = sBuffer.size() - prevsize;
+	}
+
+	if (!Communication::allToAllWithDataSizeAndTarget(sBuffer, rBuffer)) {
+		eslog::internalFailure("exchange Gmsh nodes.\n");
+	}
+
+	mesh.nIDs.resize(distribution[info::mpi::rank + 1] - distribution[info::mpi::rank]);
+	mesh.coordinates.resize(distribution[info::mpi::rank + 1] - distribution[info::mpi::rank]);
+	for (size_t offset = 0; offset < rBuffer.size(); ) {
+		++offset; // total size
+		++offset; // target
+		esint nids = rBuffer[offset++];
+		esint ncoordinates = rBuffer[offset++];
+		for (esint n = 0; n < nids; ++n, offset += 2) {
+			mesh.nIDs[rBuffer[offset]] = rBuffer[offset + 1];
+		}
+		for (esint n = 0; n < ncoordinates; ++n, offset += 1 + sizeof(Point) / sizeof(esint)) {
+			mesh.coordinates[rBuffer[offset]] = *reinterpret_cast<const Point*>(rBuffer.data() + offset + 1);
+		}
+	}
+
+	if (_meshfile.files.size() == 1) {
+		return;
+	}
+
+	// nodes on interfaces of partitions are stored in more files, hence they are deduplicated by processes given by IDs
+	size_t maxID = 0;
+	for (size_t s = 0; s < _summary.size(); ++s) {
+		if (_summary[s].section == NODES) {
+			maxID = std::max(maxID, _summary[s].max);
+		}
+	}
+	std::vector<size_t> idistribution = tarray<size_t>::distribute(info::mpi::size, maxID + 1);
+	std::vector<esint> permutation(mesh.nIDs.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::sort(permutation.begin(), permutation.end(), [&] (esint i, esint j) { return mesh.nIDs[i] < mesh.nIDs[j]; });
+
+	sBuffer.clear();
+	rBuffer.clear();
+	auto it = permutation.begin();
+	for (int r = 0; r < info::mpi::size; ++r) {
+		size_t prevsize = sBuffer.size();
+		sBuffer.push_back(0); // total size
+		sBuffer.push_back(r); // target
+		sBuffer.push_back(0); // nodes
+		for (; it != permutation.end() && (size_t)mesh.nIDs[*it] < idistribution[r + 1]; ++it) {
+			sBuffer.push_back(mesh.nIDs[*it]);
+			sBuffer.insert(sBuffer.end(), reinterpret_cast<const esint*>(mesh.coordinates.data() + *it), reinterpret_cast<const esint*>(mesh.coordinates.data() + *it + 1));
+			++sBuffer[prevsize + 2];
+		}
+		sBuffer[prevsize] = sBuffer.size() - prevsize;
+	}
+
+	if (!Communication::allToAllWithDataSizeAndTarget(sBuffer, rBuffer)) {
+		eslog::internalFailure("exchange duplicated Gmsh nodes.\n");
+	}
+
+	std::vector<esint> nIDs;
+	std::vector<Point> nCoordinates;
+	for (size_t offset = 0; offset < rBuffer.size(); ) {
+		++offset; // total size
+		++offset; // target
+		esint nodes = rBuffer[offset++];
+		for (esint n = 0; n < nodes; ++n, offset += 1 + sizeof(Point) / sizeof(esint)) {
+			nIDs.push_back(rBuffer[offset]);
+			nCoordinates.push_back(*reinterpret_cast<const Point*>(rBuffer.data() + offset + 1));
+		}
+	}
+	permutation.resize(nIDs.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::sort(permutation.begin(), permutation.end(), [&] (esint i, esint j) { return nIDs[i] < nIDs[j]; });
+	mesh.nIDs.clear();
+	mesh.coordinates.clear();
+	for (size_t i = 0; i < permutation.size(); ++i) {
+		if (i == 0 || nIDs[permutation[i]] != nIDs[permutation[i - 1]]) {
+			mesh.nIDs.push_back(nIDs[permutation[i]]);
+			mesh.coordinates.push_back(nCoordinates[permutation[i]]);
+		}
+	}
+}
+
+void GmshMesh::elements(MeshBuilder &mesh)
+{
+	// elements of the highest dimension are stored, lower dimensional elements only define regions of nodes
+	int maxdim = 0;
+	for (size_t b = 0; b < _blocks.size(); ++b) {
+		if (_blocks[b].section == ELEMENTS && _blocks[b].size) {
+			maxdim = std::max(maxdim, types[_blocks[b].type].dim);
+		}
+	}
+	for (size_t b = 0; b < _blocks.size(); ++b) {
+		if (_blocks[b].section == ELEMENTS && types[_blocks[b].type].dim == maxdim && types[_blocks[b].type].code == Element::CODE::SIZE) {
+			eslog::globalerror("GMSH PARSER: not supported element type %d in '%s'.\n", _blocks[b].type, _meshfile.paths[_blocks[b].file].c_str());
+		}
+	}
+
+	auto physical = [&] (const Block &block) -> const std::vector<int>& {
+		static const std::vector<int> empty;
+		auto tags = _physical[block.file].find(std::make_pair(types[block.type].dim, block.tag));
+		return tags == _physical[block.file].end() ? empty : tags->second;
+	};
+
+	std::vector<Segment> segments = this->segments(ELEMENTS, false);
+	segments.erase(std::remove_if(segments.begin(), segments.end(), [&] (const Segment &segment) {
+		const Block &block = _blocks[segment.block];
+		return types[block.type].dim != maxdim && physical(block).empty();
+	}), segments.end());
+
+	std::vector<size_t> eoffset(segments.size()), noffset(segments.size());
+	size_t elements = 0, enodes = 0, bnodes = 0;
+	for (size_t s = 0; s < segments.size(); ++s) {
+		const GmshElement &type = types[_blocks[segments[s].block].type];
+		if (type.dim == maxdim) {
+			eoffset[s] = elements;
+			noffset[s] = enodes;
+			elements += segments[s].size;
+			enodes += segments[s].size * type.nodes;
+		} else {
+			noffset[s] = bnodes;
+			bnodes += segments[s].size * type.nodes;
+		}
+	}
+
+	mesh.eIDs.resize(elements);
+	mesh.etype.resize(elements);
+	mesh.esize.resize(elements);
+	mesh.enodes.resize(enodes);
+	std::vector<esint> boundary(bnodes);
+	records(segments, [&] (size_t s, size_t record, const char *c) {
+		const Block &block = _blocks[segments[s].block];
+		const GmshElement &type = types[block.type];
+		esint values[28];
+		if (_format[block.file].binary) {
+			for (int n = 0; n <= type.nodes; ++n) {
+				size_t value;
+				memcpy(&value, c + n * sizeof(size_t), sizeof(size_t));
+				values[n] = value;
+			}
+		} else {
+			char *next;
+			for (int n = 0; n <= type.nodes; ++n, c = next) {
+				values[n] = strtol(c, &next, 10);
+			}
+		}
+		if (type.dim == maxdim) {
+			size_t e = eoffset[s] + record;
+			mesh.eIDs[e] = values[0];
+			mesh.etype[e] = (int)type.code;
+			mesh.esize[e] = type.nodes;
+			for (int n = 0; n < type.nodes; ++n) {
+				mesh.enodes[noffset[s] + record * type.nodes + n] = values[1 + (type.order ? type.order[n] : n)];
+			}
+		} else {
+			for (int n = 0; n < type.nodes; ++n) {
+				boundary[noffset[s] + record * type.nodes + n] = values[1 + n];
+			}
+		}
+	});
+
+	// regions are created on all processes
+	for (size_t f = 0; f < _physical.size(); ++f) {
+		for (auto entity = _physical[f].begin(); entity != _physical[f].end(); ++entity) {
+			for (size_t t = 0; t < entity->second.size(); ++t) {
+				if (entity->first.first == maxdim) {
+					mesh.eregions[name(entity->first.first, entity->second[t])];
+				}
+				if (entity->first.first < maxdim) {
+					mesh.nregions[name(entity->first.first, entity->second[t])];
+				}
+			}
+		}
+	}
+	for (size_t s = 0; s < segments.size(); ++s) {
+		const Block &block = _blocks[segments[s].block];
+		const GmshElement &type = types[block.type];
+		const std::vector<int> &tags = physical(block);
+		for (size_t t = 0; t < tags.size(); ++t) {
+			if (type.dim == maxdim) {
+				std::vector<esint> &region = mesh.eregions[name(type.dim, tags[t])];
+				region.insert(region.end(), mesh.eIDs.begin() + eoffset[s], mesh.eIDs.begin() + eoffset[s] + segments[s].size);
+			} else {
+				std::vector<esint> &region = mesh.nregions[name(type.dim, tags[t])];
+				region.insert(region.end(), boundary.begin() + noffset[s], boundary.begin() + noffset[s] + segments[s].size * type.nodes);
+			}
+		}
+	}
+	for (auto region = mesh.eregions.begin(); region != mesh.eregions.end(); ++region) {
+		if (!std::is_sorted(region->second.begin(), region->second.end())) {
+			std::sort(region->second.begin(), region->second.end());
+		}
+	}
+	for (auto region = mesh.nregions.begin(); region != mesh.nregions.end(); ++region) {
+		std::sort(region->second.begin(), region->second.end());
+		region->second.erase(std::unique(region->second.begin(), region->second.end()), region->second.end());
+	}
+}
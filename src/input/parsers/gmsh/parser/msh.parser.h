@@ -0,0 +1,99 @@
+
+#ifndef SRC_INPUT_PARSERS_GMSH_PARSER_MSH_PARSER_H_
+#define SRC_INPUT_PARSERS_GMSH_PARSER_MSH_PARSER_H_
+
+#include "basis/io/inputfile.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#define GMSH_MAX_NAME_SIZE 128
+
+namespace mesio {
+
+struct MeshBuilder;
+
+// Gmsh MSH 4.1 (ASCII or binary), a partitioned mesh can be stored in more files
+class GmshMesh {
+	enum Section: int {
+		PHYSICAL_NAMES,
+		ENTITIES,
+		PARTITIONED_ENTITIES,
+		NODES,
+		ELEMENTS,
+		SECTIONS
+	};
+
+	struct Format {
+		int file, binary, size;
+		double version;
+	};
+
+	// begin of section data (open) or begin of the closing keyword
+	struct Keyword {
+		int file, section, open;
+		size_t offset;
+	};
+
+	struct Sections {
+		size_t begin[SECTIONS], end[SECTIONS];
+	};
+
+	// 'numEntityBlocks numItems minTag maxTag' of nodes or elements
+	struct Summary {
+		int file, section;
+		size_t blocks, items, min, max;
+	};
+
+	// ASCII: the line of the first record, binary: the offset of the first record
+	struct Block {
+		int file, section, dim, tag, type; // type of elements or 'parametric' of nodes
+		size_t position, size;
+	};
+
+	// ASCII: lines of the section stored on this process split to threads
+	struct Lines {
+		std::vector<const char*> tbegin;
+		std::vector<size_t> tlines;
+		size_t first;
+	};
+
+	// records [first, first + size) of a block stored on this process
+	struct Segment {
+		size_t block, first, size;
+		size_t position, step; // position of the first record and the distance between records
+	};
+
+public:
+	GmshMesh(InputFilePack &meshfile);
+
+	void parse(MeshBuilder &mesh);
+
+protected:
+	void format();
+	void scan();
+	void entities();
+	void blocksASCII();
+	void blocksBinary();
+	void nodes(MeshBuilder &mesh);
+	void elements(MeshBuilder &mesh);
+
+	std::vector<Segment> segments(int section, bool coordinates);
+	void records(const std::vector<Segment> &segments, std::function<void(size_t segment, size_t record, const char *c)> parse);
+	std::string name(int dim, int tag);
+
+	InputFilePack &_meshfile;
+	std::vector<Format> _format;
+	std::vector<Sections> _sections;
+	std::vector<std::vector<Lines> > _lines;
+	std::vector<std::map<std::pair<int, int>, std::vector<int> > > _physical; // (dim, entity) -> physical tags
+	std::map<std::pair<int, int>, std::string> _names; // (dim, physical tag) -> name
+	std::vector<Summary> _summary;
+	std::vector<Block> _blocks;
+};
+
+}
+
+#endif /* SRC_INPUT_PARSERS_GMSH_PARSER_MSH_PARSER_H_ */
@@ -6,6 +6,27 @@
 
 using namespace mesio;
 
+// transfers of lower processes (in) are applied before transfers of higher processes (inout)
+static void compose(void *in, void *inout, int *len, MPI_Datatype *datatype)
+{
+	for (int i = 0; i < *len; ++i) {
+		const MixedElementsParser::Transfer *lower = static_cast<MixedElementsParser::Transfer*>(in) + i;
+		MixedElementsParser::Transfer *upper = static_cast<MixedElementsParser::Transfer*>(inout) + i;
+		MixedElementsParser::Transfer result;
+		for (int e = 0; e < MixedElementsParser::maxentry; ++e) {
+			esint x = lower->exit[e];
+			if (x < 0 || upper->exit[x] < 0) {
+				result.exit[e] = -1;
+				result.count[e] = 0;
+			} else {
+				result.exit[e] = upper->exit[x];
+				result.count[e] = lower->count[e] + upper->count[x];
+			}
+		}
+		*upper = result;
+	}
+}
+
 void MixedElementsParser::add(esint *data, size_t size)
 {
 	_elements.push_back(ElementData{data, size});
@@ -13,87 +34,124 @@ void MixedElementsParser::add(esint *data, size_t size)
 
 void MixedElementsParser::parse(std::function<esint(size_t, esint)> enodes)
 {
-	std::vector<int> check(_elements.size(), info::mpi::size), me(_elements.size()), last(_elements.size());
-	std::vector<esint> esize(_elements.size()), lmissing(_elements.size()), dummy(_elements.size());
+	std::vector<int> check(_elements.size(), info::mpi::size);
+	std::vector<esint> esize(_elements.size());
 	first.resize(_elements.size());
 	missing.resize(_elements.size());
 	invalid.resize(_elements.size());
 	nelements.resize(_elements.size());
+	offset.assign(_elements.size(), 0);
 
+	std::vector<Transfer> local(_elements.size()), prefix(_elements.size());
 	for (size_t i = 0; i < _elements.size(); ++i) {
-		recognize(i, esize[i], first[i], missing[i], enodes);
+		transfer(i, local[i], enodes);
 	}
 
-	offset = esize;
-	Communication::exscan(dummy, offset);
-	Communication::receiveLower(missing, lmissing);
+	// the entry offset of each process is given by the composition of transfers of all lower processes
+	MPI_Datatype type;
+	MPI_Op op;
+	MPI_Type_contiguous(sizeof(Transfer), MPI_BYTE, &type);
+	MPI_Type_commit(&type);
+	MPI_Op_create(compose, false, &op);
+	MPI_Exscan(local.data(), prefix.data(), _elements.size(), type, op, info::mpi::comm);
+	MPI_Op_free(&op);
+	MPI_Type_free(&type);
+
 	for (size_t i = 0; i < _elements.size(); ++i) {
-		if (first[i] != lmissing[i]) {
-			check[i] = info::mpi::rank;
+		esint entry = 0;
+		if (info::mpi::rank) {
+			entry = prefix[i].exit[0];
+			offset[i] = prefix[i].count[0];
+		}
+		if (entry < 0 || local[i].exit[entry] < 0) {
+			eslog::error("Mixed elements parser: cannot recognize cells descriptions.\n");
 		}
-		if (_elements[i].size) {
-			me[i] = info::mpi::rank;
+		first[i] = entry;
+		missing[i] = local[i].exit[entry];
+		esize[i] = local[i].count[entry];
+
+		// the first valid entry is the local guess (it is wrong in really rare cases)
+		int guess = 0;
+		while (guess < maxentry && local[i].exit[guess] < 0) {
+			++guess;
+		}
+		if (_elements[i].size && guess != entry) {
+			check[i] = info::mpi::rank;
 		}
 	}
 	Communication::allReduce(check.data(), invalid.data(), _elements.size(), MPI_INT, MPI_MIN);
-	Communication::allReduce(me.data(), last.data(), _elements.size(), MPI_INT, MPI_MAX);
 
-	fix(lmissing, esize, last, enodes);
 	for (size_t i = 0; i < _elements.size(); ++i) {
 		nelements[i] = offset[i] + esize[i];
 	}
 	Communication::broadcast(nelements.data(), nelements.size(), MPITools::getType<esint>().mpitype, info::mpi::size - 1);
 }
 
-void MixedElementsParser::recognize(size_t index, esint &esize, esint &coffset, esint &missing, std::function<esint(size_t, esint)> enodes)
+void MixedElementsParser::transfer(size_t index, Transfer &transfer, std::function<esint(size_t, esint)> &enodes)
 {
-	auto tryrecognize = [&] (size_t i) {
-		esize = 0;
-		esint n = 1;
-		while (n && i < _elements[index].size) {
-			if ((n = enodes(index, _elements[index].data[i]))) {
-				i += 1 + n;
-				++esize;
-			}
-		}
-		return i;
+	// all entries are parsed at once, entries that reach the same position share the rest of parsing
+	struct Cursor {
+		size_t position;
+		esint count;
+		std::vector<int> entries;
 	};
 
-	// try to recognize the first cell type description
-	for (; coffset < 30 && (size_t)coffset < _elements[index].size; ++coffset) {
-		size_t lastrecognized = tryrecognize(coffset);
-		if (_elements[index].size <= lastrecognized) {
-			missing = lastrecognized - _elements[index].size;
-			break;
-		}
+	const esint *data = _elements[index].data;
+	size_t size = _elements[index].size;
+
+	std::vector<Cursor> cursors;
+	std::vector<esint> delta(maxentry); // the number of elements parsed before merging with the cursor
+	for (int e = 0; e < maxentry; ++e) {
+		cursors.push_back(Cursor{ (size_t)e, 0, { e } });
 	}
-}
 
-void MixedElementsParser::fix(std::vector<esint> &lmissing, std::vector<esint> &esize, std::vector<int> &last, std::function<esint(size_t, esint)> enodes)
-{
-	for (size_t i = 0; i < invalid.size(); ++i) {
-		if (invalid[i] != info::mpi::size) {
-			if (info::mpi::rank <= last[i]) {
-				// fix the first cell type description position
-				if (invalid[i] < info::mpi::rank) {
-					MPI_Recv(&lmissing[i], 1, MPITools::getType(lmissing[i]).mpitype, info::mpi::rank - 1, 0, info::mpi::comm, MPI_STATUS_IGNORE);
-					MPI_Recv(&offset[i], 1, MPITools::getType(offset[i]).mpitype, info::mpi::rank - 1, 0, info::mpi::comm, MPI_STATUS_IGNORE);
+	auto finish = [&] (size_t c, bool valid) {
+		esint exit = valid && cursors[c].position - size < (size_t)maxentry ? cursors[c].position - size : -1;
+		for (size_t i = 0; i < cursors[c].entries.size(); ++i) {
+			transfer.exit[cursors[c].entries[i]] = exit;
+			transfer.count[cursors[c].entries[i]] = exit < 0 ? 0 : cursors[c].count + delta[cursors[c].entries[i]];
+		}
+		cursors.erase(cursors.begin() + c);
+	};
+
+	while (cursors.size()) {
+		size_t c = 0;
+		for (size_t i = 1; i < cursors.size(); ++i) {
+			if (cursors[i].position < cursors[c].position) {
+				c = i;
+			}
+		}
+		for (size_t i = cursors.size(); i-- > 0;) {
+			if (i != c && cursors[i].position == cursors[c].position) {
+				for (size_t j = 0; j < cursors[i].entries.size(); ++j) {
+					delta[cursors[i].entries[j]] += cursors[i].count - cursors[c].count;
 				}
-				if (invalid[i] <= info::mpi::rank) {
-					esint _esize = offset[i] + esize[i];
-					if (first[i] != lmissing[i]) {
-						first[i] = lmissing[i];
-						recognize(i, _esize, first[i], missing[i], enodes);
-						_esize += offset[i];
-					}
-
-					if (info::mpi::rank < last[i]) {
-						// in the case of [invalid == info::mpi::rank] it initiates the synchronization
-						MPI_Send(&missing[i], 1, MPITools::getType(missing[i]).mpitype, info::mpi::rank + 1, 0, info::mpi::comm);
-						MPI_Send(&_esize, 1, MPITools::getType(_esize).mpitype, info::mpi::rank + 1, 0, info::mpi::comm);
-					}
+				cursors[c].entries.insert(cursors[c].entries.end(), cursors[i].entries.begin(), cursors[i].entries.end());
+				cursors.erase(cursors.begin() + i);
+				if (i < c) {
+					--c;
 				}
 			}
 		}
+
+		Cursor &cursor = cursors[c];
+		if (cursors.size() == 1) { // all valid entries are merged
+			esint n = 1;
+			while (cursor.position < size && (n = enodes(index, data[cursor.position]))) {
+				cursor.position += 1 + n;
+				++cursor.count;
+			}
+		}
+		if (size <= cursor.position) {
+			finish(c, true);
+			continue;
+		}
+		esint n = enodes(index, data[cursor.position]);
+		if (n == 0) {
+			finish(c, false);
+		} else {
+			cursor.position += 1 + n;
+			++cursor.count;
+		}
 	}
 }
@@ -17,14 +17,22 @@ public:
 		size_t size;
 	};
 
+	// an upper bound on the size of a cell description (type and nodes)
+	static const int maxentry = 32;
+
+	// for each entry offset (the number of values belonging to the previous process):
+	// the exit offset (the number of values behind the end of data, -1 for invalid entries) and the number of elements
+	struct Transfer {
+		esint exit[maxentry], count[maxentry];
+	};
+
 	void add(esint *data, size_t size);
 	void parse(std::function<esint(size_t, esint)> enodes);
 
 	std::vector<int> invalid;
 	std::vector<esint> first, missing, offset, nelements;
 protected:
-	void recognize(size_t index, esint &esize, esint &coffset, esint &missing, std::function<esint(size_t, esint)> enodes);
-	void fix(std::vector<esint> &lmissing, std::vector<esint> &esize, std::vector<int> &last, std::function<esint(size_t, esint)> enodes);
+	void transfer(size_t index, Transfer &transfer, std::function<esint(size_t, esint)> &enodes);
 
 	std::vector<ElementData> _elements;
 };
@@ -0,0 +1,130 @@
+
+#include "stlsurface.h"
+#include "wrappers/mpi/communication.h"
+#include "basis/containers/tarray.h"
+#include "esinfo/envinfo.h"
+#include "esinfo/mpiinfo.h"
+#include "esinfo/eslog.h"
+#include "mesh/element.h"
+#include "input/meshbuilder.h"
+
+#include <cstring>
+#include <numeric>
+
+using namespace mesio;
+
+// binary format: 80 bytes header, 4 bytes the number of triangles, 50 bytes per triangle (normal, 3 vertices, attribute)
+static const size_t headersize = 84, recordsize = 50;
+
+STLSurface::STLSurface(InputFilePack &meshfile)
+: _meshfile(meshfile)
+{
+
+}
+
+static void fill(MeshBuilder &mesh, esint offset)
+{
+	esint triangles = mesh.coordinates.size() / 3;
+	mesh.nIDs.resize(mesh.coordinates.size());
+	std::iota(mesh.nIDs.begin(), mesh.nIDs.end(), 3 * offset);
+	mesh.enodes = mesh.nIDs;
+	mesh.esize.resize(triangles, 3);
+	mesh.etype.resize(triangles, (int)Element::CODE::TRIANGLE3);
+	mesh.eIDs.resize(triangles);
+	std::iota(mesh.eIDs.begin(), mesh.eIDs.end(), offset);
+}
+
+void STLSurface::parse(MeshBuilder &mesh)
+{
+	size_t header[2] = { 0, 0 }; // binary, triangles
+	if (info::mpi::rank == 0) {
+		size_t fsize = _meshfile.distribution.back();
+		if (fsize >= headersize) {
+			unsigned int triangles;
+			memcpy(&triangles, _meshfile.begin + headersize - sizeof(unsigned int), sizeof(unsigned int));
+			if (headersize + recordsize * triangles == fsize) {
+				header[0] = 1;
+				header[1] = triangles;
+			}
+		}
+	}
+	Communication::broadcast(header, 2, MPITools::getType<size_t>().mpitype, 0);
+
+	if (header[0]) {
+		parseBinary(mesh, header[1]);
+	} else {
+		parseASCII(mesh);
+	}
+}
+
+void STLSurface::parseBinary(MeshBuilder &mesh, size_t triangles)
+{
+	// the process parses records that start in its part of the file (the rest of the last one is in overlap)
+	size_t begin = std::max(_meshfile.distribution[info::mpi::rank], headersize);
+	size_t end = std::min(_meshfile.distribution[info::mpi::rank + 1], headersize + recordsize * triangles);
+	size_t first = (begin - headersize + recordsize - 1) / recordsize;
+	size_t last = end > headersize ? (end - headersize + recordsize - 1) / recordsize : 0;
+	if (last < first) {
+		last = first;
+	}
+
+	mesh.coordinates.resize(3 * (last - first));
+	std::vector<size_t> tdistribution = tarray<size_t>::distribute(info::env::threads, last - first);
+
+	#pragma omp parallel for
+	for (int t = 0; t < info::env::threads; t++) {
+		for (size_t i = tdistribution[t]; i < tdistribution[t + 1]; ++i) {
+			const char *record = _meshfile.begin + headersize + recordsize * (first + i) - _meshfile.distribution[info::mpi::rank];
+			float vertices[9];
+			memcpy(vertices, record + 3 * sizeof(float), 9 * sizeof(float)); // skip normal
+			for (int v = 0; v < 3; ++v) {
+				mesh.coordinates[3 * i + v] = Point(vertices[3 * v + 0], vertices[3 * v + 1], vertices[3 * v + 2]);
+			}
+		}
+	}
+
+	fill(mesh, first);
+}
+
+void STLSurface::parseASCII(MeshBuilder &mesh)
+{
+	// a triangle is parsed by the thread where its 'facet normal' starts (the rest can be in overlap)
+	int threads = info::env::threads;
+	std::vector<size_t> tdistribution = tarray<size_t>::distribute(threads, _meshfile.end - _meshfile.begin);
+	std::vector<std::vector<Point> > tcoordinates(threads);
+
+	#pragma omp parallel for
+	for (int t = 0; t < threads; t++) {
+		std::vector<Point> coordinates;
+		const char *c = _meshfile.begin + tdistribution[t], *end = _meshfile.begin + tdistribution[t + 1];
+		char *cc;
+		while ((c = (const char*)memchr(c, 'f', end - c)) != NULL) {
+			if (c + 12 <= _meshfile.hardend && memcmp(c, "facet normal", 12) == 0) {
+				for (int v = 0; v < 3; ++v) {
+					while (c + 6 <= _meshfile.hardend && memcmp(c, "vertex", 6) != 0) { ++c; }
+					if (c + 6 > _meshfile.hardend) {
+						eslog::error("STL parser: incomplete facet.\n");
+					}
+					coordinates.push_back(Point{});
+					coordinates.back().x = strtod(c + 6, &cc);
+					coordinates.back().y = strtod(cc, &cc);
+					coordinates.back().z = strtod(cc, &cc);
+					c = cc;
+				}
+				if (c >= end) {
+					break;
+				}
+			} else {
+				++c;
+			}
+		}
+		tcoordinates[t].swap(coordinates);
+	}
+
+	for (int t = 0; t < threads; t++) {
+		mesh.coordinates.insert(mesh.coordinates.end(), tcoordinates[t].begin(), tcoordinates[t].end());
+	}
+	esint offset = mesh.coordinates.size() / 3;
+	Communication::exscan(offset);
+	fill(mesh, offset);
+}
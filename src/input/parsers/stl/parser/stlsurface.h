@@ -0,0 +1,29 @@
+
+#ifndef SRC_INPUT_PARSERS_STL_PARSER_STLSURFACE_H_
+#define SRC_INPUT_PARSERS_STL_PARSER_STLSURFACE_H_
+
+#include "basis/io/inputfile.h"
+
+namespace mesio {
+
+struct MeshBuilder;
+
+// Both ASCII and binary STL files are supported.
+// Each process parses triangles that start in its part of the file.
+// Vertices are not shared: the builder merges duplicated nodes afterwards.
+class STLSurface {
+
+public:
+	STLSurface(InputFilePack &meshfile);
+
+	void parse(MeshBuilder &mesh);
+
+protected:
+	void parseASCII(MeshBuilder &mesh);
+	void parseBinary(MeshBuilder &mesh, size_t triangles);
+
+	InputFilePack &_meshfile;
+};
+}
+
+#endif /* SRC_INPUT_PARSERS_STL_PARSER_STLSURFACE_H_ */
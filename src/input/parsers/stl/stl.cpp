@@ -0,0 +1,39 @@
+
+#include "stl.h"
+#include "parser/stlsurface.h"
+#include "config/input.h"
+#include "esinfo/eslog.h"
+#include "esinfo/meshinfo.h"
+#include "mesh/mesh.h"
+#include "input/meshbuilder.h"
+
+using namespace mesio;
+
+STLLoader::STLLoader(const InputConfiguration &configuration)
+: _configuration(configuration)
+{
+
+}
+
+void STLLoader::load()
+{
+	eslog::startln("STL PARSER: STARTED", "STL PARSER");
+
+	InputFilePack meshfile;
+	meshfile.commitFiles({ _configuration.path });
+	meshfile.prepare();
+	eslog::checkpointln("STL PARSER: MESH READER PREPARED");
+
+	meshfile.read();
+	eslog::checkpointln("STL PARSER: MESH READ");
+
+	meshfile.next();
+
+	STLSurface surface(meshfile);
+	surface.parse(*this);
+	removeDuplicates = true; // each triangle has its own vertices
+	info::mesh->dimension = 2; // triangles are elements of the surface mesh
+	body.resize(etype.size());
+	material.resize(etype.size());
+	eslog::endln("STL PARSER: GEOMETRY PARSED");
+}
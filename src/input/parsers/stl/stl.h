@@ -0,0 +1,22 @@
+
+#ifndef SRC_INPUT_PARSERS_STL_STL_H_
+#define SRC_INPUT_PARSERS_STL_STL_H_
+
+#include "input/meshbuilder.h"
+
+namespace mesio {
+
+class InputConfiguration;
+
+class STLLoader: public MeshBuilder {
+public:
+	STLLoader(const InputConfiguration &configuration);
+	void load();
+
+protected:
+	const InputConfiguration &_configuration;
+};
+
+}
+
+#endif /* SRC_INPUT_PARSERS_STL_STL_H_ */
@@ -12,6 +12,7 @@
 #include "input/parsers/asciiparser.h"
 #include "input/parsers/mixedelementsparser.h"
 
+#include <cstring>
 #include <numeric>
 
 using namespace mesio;
@@ -147,8 +148,56 @@ VTKLegacyGeometry::CellTypes::CellTypes(InputFilePack &pack, const char *c)
 VTKLegacyGeometry::Data::Data(InputFilePack &pack, DataSource source, const char *c)
 : Keyword(pack, c), source(source)
 {
-	// TODO: finish implementation
-	begin = offset + (source == DataSource::CELLS ? 9 : 10);
+	char *next;
+	const char *_c = c;
+	n = strtol(c + (source == DataSource::CELLS ? 9 : 10), &next, 0);
+	c = next;
+	while (*c++ != '\n');
+	begin = offset + (c - _c);
+}
+
+VTKLegacyGeometry::Attribute::Attribute(InputFilePack &pack, AttributeType type, const char *c)
+: Keyword(pack, c), type(type), datatype(Datatype::UNKNOWN), dimension(0)
+{
+	const char *_c = c;
+	switch (type) {
+	case AttributeType::SCALARS: dimension = 1; break;
+	case AttributeType::VECTORS: dimension = 3; break;
+	case AttributeType::TENSORS: dimension = 9; break;
+	case AttributeType::TENSORS6: dimension = 6; break;
+	}
+	if (type == AttributeType::TENSORS && c[7] == '6') {
+		this->type = AttributeType::TENSORS6;
+		dimension = 6;
+	}
+	c += ASCIIParser::keyend(c); // keyword
+	while (ASCIIParser::isempty(c)) ++c;
+	int length = ASCIIParser::keyend(c);
+	memset(name, '\0', VTK_MAX_NAME_SIZE);
+	memcpy(name, c, std::min(length, VTK_MAX_NAME_SIZE - 1));
+	c += length; // name
+	while (ASCIIParser::isempty(c)) ++c;
+	if (StringCompare::caseInsensitiveEq(std::string(c, c + 5), "float")) {
+		datatype = Datatype::FLOAT;
+	}
+	if (StringCompare::caseInsensitiveEq(std::string(c, c + 6), "double")) {
+		datatype = Datatype::DOUBLE;
+	}
+	if (StringCompare::caseInsensitiveEq(std::string(c, c + 3), "int") && ASCIIParser::isempty(c + 3)) {
+		datatype = Datatype::INT;
+	}
+	c += ASCIIParser::keyend(c); // datatype
+	if (type == AttributeType::SCALARS) {
+		while (*c == ' ' || *c == '\t') ++c;
+		if ('0' <= *c && *c <= '9') {
+			dimension = strtol(c, NULL, 10); // numComp
+		}
+	}
+	while (*c++ != '\n');
+	if (type == AttributeType::SCALARS && StringCompare::caseInsensitiveEq(std::string(c, c + 12), "LOOKUP_TABLE")) {
+		while (*c++ != '\n');
+	}
+	begin = offset + (c - _c);
 }
 
 VTKLegacyGeometry::VTKLegacyGeometry(InputFilePack &pack)
@@ -209,6 +258,12 @@ void VTKLegacyGeometry::scan()
 	scanner.add({ "cell_types", "CELL_TYPES" }, [&] (const char *c) { _cellTypes.push_back({_pack, c}); }, [&] (const char *c) { return 2 * CellTypes(_pack, c).ne; });
 	scanner.add({ "point_data", "POINT_DATA" }, [&] (const char *c) { _pointData.push_back({_pack, DataSource::POINTS, c}); });
 	scanner.add({ "cell_data", "CELL_DATA" }, [&] (const char *c) { _cellData.push_back({_pack, DataSource::CELLS, c}); });
+	scanner.add({ "scalars", "SCALARS" }, [&] (const char *c) { _attributes.push_back({_pack, AttributeType::SCALARS, c}); });
+	scanner.add({ "vectors", "VECTORS", "normals", "NORMALS" }, [&] (const char *c) { _attributes.push_back({_pack, AttributeType::VECTORS, c}); });
+	scanner.add({ "tensors", "TENSORS" }, [&] (const char *c) { _attributes.push_back({_pack, AttributeType::TENSORS, c}); });
+	// other keywords are only needed to get the ends of attributes (skip the whole keyword to not match 'SCALARS' in 'COLOR_SCALARS')
+	scanner.add({ "lookup_table", "LOOKUP_TABLE" }, [&] (const char *c) { _lookupTables.push_back({_pack, c}); }, [] (const char *c) { return ASCIIParser::keyend(c); });
+	scanner.add({ "field", "FIELD", "color_scalars", "COLOR_SCALARS", "texture_coordinates", "TEXTURE_COORDINATES" }, [&] (const char *c) { _skipped.push_back({_pack, c}); }, [] (const char *c) { return ASCIIParser::keyend(c); });
 
 	while (_pack.next()) {
 		if (_header[_pack.fileindex].format == Format::ASCII) {
@@ -220,19 +275,19 @@ void VTKLegacyGeometry::scan()
 		}
 	}
 
-	scanner.synchronize(_points, _cells, _cellTypes, _pointData, _cellData);
+	scanner.synchronize(_points, _cells, _cellTypes, _pointData, _cellData, _attributes, _lookupTables, _skipped);
 
 	std::sort(_points.begin(), _points.end(), [] (Points &p1, Points &p2) { return p1.fileindex < p2.fileindex; });
 	std::sort(_cells.begin(), _cells.end(), [] (Cells &c1, Cells &c2) { return c1.fileindex < c2.fileindex; });
 	std::sort(_cellTypes.begin(), _cellTypes.end(), [] (CellTypes &t1, CellTypes &t2) { return t1.fileindex < t2.fileindex; });
 
 	std::vector<std::vector<size_t> > offsets(_pack.size());
-	addoffset(offsets, _points, _cells, _cellTypes, _pointData, _cellData);
+	addoffset(offsets, _points, _cells, _cellTypes, _pointData, _cellData, _attributes, _lookupTables, _skipped);
 	for (size_t i = 0; i < offsets.size(); ++i) {
 		offsets[i].push_back(_pack.files[i]->distribution.back());
 		std::sort(offsets[i].begin(), offsets[i].end());
 	}
-	setend(offsets, _points, _cells, _cellTypes, _pointData, _cellData);
+	setend(offsets, _points, _cells, _cellTypes, _pointData, _cellData, _attributes);
 }
 
 template <typename T>
@@ -261,6 +316,8 @@ void static read(const InputFilePack &_pack, VTKLegacyGeometry::Keyword &keyword
 
 	round(begin, keyword.begin, align);
 	round(end, keyword.begin, align);
+	// binary data are followed by the new line before the next keyword
+	end = std::min(end, keyword.end - (keyword.end - keyword.begin) % align);
 	if (begin < end) {
 		std::vector<Input, initless_allocator<Input> > data((end - begin) / sizeof(Input));
 		memcpy(data.data(), _pack.begin + begin - _pack.distribution[info::mpi::rank], end - begin);
@@ -383,11 +440,13 @@ void VTKLegacyGeometry::parse(MeshBuilder &mesh, const std::vector<std::string>
 	mesh.eIDs.reserve(esum / 2);
 	mesh.enodes.reserve(esum / 2);
 
+	std::vector<size_t> nodes(_pack.size()), elements(_pack.size());
 	size_t nidoffset = 0, eidoffset = 0;
 	while (_pack.next()) {
 		{ // fill coordinates
 			size_t pbegin = (3 - (npoints[_pack.fileindex] % 3)) % 3;
 			size_t csize = (points[_pack.fileindex].size() - pbegin) / 3;
+			nodes[_pack.fileindex] = csize;
 			size_t noffset = (npoints[_pack.fileindex] + pbegin) / 3;
 			for (size_t i = 0; i < csize; ++i) {
 				mesh.nIDs.push_back(nidoffset + i + noffset);
@@ -414,6 +473,7 @@ void VTKLegacyGeometry::parse(MeshBuilder &mesh, const std::vector<std::string>
 			}
 
 			if (maxdim[_pack.fileindex]) {
+				elements[_pack.fileindex] = ids.size();
 				mesh.eregions[names[_pack.fileindex]] = ids;
 				mesh.eIDs.insert(mesh.eIDs.end(), ids.begin(), ids.end());
 			} else {
@@ -423,6 +483,123 @@ void VTKLegacyGeometry::parse(MeshBuilder &mesh, const std::vector<std::string>
 		nidoffset += _points[_pack.fileindex].nn;
 		eidoffset += _cells[_pack.fileindex].ne;
 	}
+
+	parseData(mesh, nodes, elements, maxdim);
 }
 
+void VTKLegacyGeometry::parseData(MeshBuilder &mesh, const std::vector<size_t> &nodes, const std::vector<size_t> &elements, const std::vector<int> &maxdim)
+{
+	if (_skipped.size()) {
+		eslog::warning("VTK Legacy parser: FIELD, COLOR_SCALARS, and TEXTURE_COORDINATES attributes are skipped.\n");
+	}
+	if (_attributes.empty()) {
+		return;
+	}
+
+	auto order = [] (const Keyword &k1, const Keyword &k2) { return k1.fileindex == k2.fileindex ? k1.offset < k2.offset : k1.fileindex < k2.fileindex; };
+	std::sort(_attributes.begin(), _attributes.end(), order);
+
+	// an attribute belongs to the closest preceding POINT_DATA or CELL_DATA
+	std::vector<const Data*> sections(_attributes.size(), nullptr);
+	auto closest = [&] (size_t a, const std::vector<Data> &data) {
+		for (size_t i = 0; i < data.size(); ++i) {
+			if (data[i].fileindex == _attributes[a].fileindex && data[i].offset < _attributes[a].offset) {
+				if (sections[a] == nullptr || sections[a]->offset < data[i].offset) {
+					sections[a] = &data[i];
+				}
+			}
+		}
+	};
+	for (size_t a = 0; a < _attributes.size(); ++a) {
+		closest(a, _pointData);
+		closest(a, _cellData);
+		if (sections[a] == nullptr) {
+			eslog::error("VTK Legacy parser: attribute '%s' is not a part of POINT_DATA or CELL_DATA.\n", _attributes[a].name);
+		}
+	}
+
+	std::vector<size_t> noffset(_pack.size() + 1), eoffset(_pack.size() + 1);
+	for (size_t i = 0; i < _pack.size(); ++i) {
+		noffset[i + 1] = noffset[i] + nodes[i];
+		eoffset[i + 1] = eoffset[i] + elements[i];
+	}
 
+	const int tensor[9] = { 0, 4, 8, 1, 5, 2, 3, 7, 6 }; // VTK stores tensors row-major
+	size_t a = 0;
+	while (_pack.next()) {
+		for (; a < _attributes.size() && _attributes[a].fileindex == _pack.fileindex; ++a) {
+			const Attribute &attribute = _attributes[a];
+			const Data &data = *sections[a];
+			if (data.source == DataSource::CELLS && maxdim[_pack.fileindex] == 0) {
+				continue; // points are not included into elements
+			}
+			if (data.n != (data.source == DataSource::POINTS ? _points[_pack.fileindex].nn : _cells[_pack.fileindex].ne)) {
+				eslog::error("VTK Legacy parser: invalid size of %s in file '%s'.\n", data.source == DataSource::POINTS ? "POINT_DATA" : "CELL_DATA", _pack.paths[_pack.fileindex].c_str());
+			}
+
+			std::vector<double> values;
+			size_t total = data.n * attribute.dimension;
+			if (_header[_pack.fileindex].format == Format::ASCII) {
+				ASCIIParser::parse(values, _pack, attribute.begin, attribute.end);
+			}
+			if (_header[_pack.fileindex].format == Format::BINARY) {
+				Attribute range = attribute;
+				switch (attribute.datatype) {
+				case Datatype::FLOAT:
+					range.end = std::min(attribute.end, attribute.begin + total * sizeof(float));
+					read<float, double>(_pack, range, values, sizeof(float));
+					break;
+				case Datatype::DOUBLE:
+					range.end = std::min(attribute.end, attribute.begin + total * sizeof(double));
+					read<double, double>(_pack, range, values, sizeof(double));
+					break;
+				case Datatype::INT:
+					range.end = std::min(attribute.end, attribute.begin + total * sizeof(int));
+					read<int, double>(_pack, range, values, sizeof(int));
+					break;
+				case Datatype::UNKNOWN:
+					eslog::error("VTK Legacy parser: unsupported data type of attribute '%s'.\n", attribute.name);
+				}
+			}
+
+			// values are read according to the file distribution, the mesh has them according to the parsed points (cells)
+			size_t local = data.source == DataSource::POINTS ? nodes[_pack.fileindex] : elements[_pack.fileindex];
+			std::vector<size_t> current = Communication::getDistribution<size_t>(values.size());
+			std::vector<size_t> target = Communication::getDistribution<size_t>(local * attribute.dimension);
+			if (current.back() != total || target.back() != total) {
+				eslog::error("VTK Legacy parser: attribute '%s' in file '%s' has %lu values instead of %lu.\n", attribute.name, _pack.paths[_pack.fileindex].c_str(), current.back(), total);
+			}
+			if (!Communication::balance(values, current, target)) {
+				eslog::internalFailure("cannot balance attribute '%s'.\n", attribute.name);
+			}
+
+			std::map<std::string, MeshData::Field> &fields = data.source == DataSource::POINTS ? mesh.ndata : mesh.edata;
+			const std::vector<size_t> &offset = data.source == DataSource::POINTS ? noffset : eoffset;
+			auto field = fields.find(attribute.name);
+			if (field == fields.end()) {
+				field = fields.insert(std::make_pair(std::string(attribute.name), MeshData::Field())).first;
+				field->second.dimension = attribute.dimension;
+				switch (attribute.type) {
+				case AttributeType::SCALARS: field->second.type = attribute.dimension == 1 ? NamedData::DataType::SCALAR : NamedData::DataType::NUMBERED; break;
+				case AttributeType::VECTORS: field->second.type = NamedData::DataType::VECTOR; break;
+				case AttributeType::TENSORS: field->second.type = NamedData::DataType::TENSOR_SYMM; break;
+				case AttributeType::TENSORS6: field->second.type = NamedData::DataType::TENSOR_ASYM; break;
+				}
+				field->second.values.resize(offset.back() * attribute.dimension, 0); // files without the attribute have zeros
+			}
+			if (field->second.dimension != attribute.dimension) {
+				eslog::error("VTK Legacy parser: attribute '%s' has various dimensions in input files.\n", attribute.name);
+			}
+			double *fvalues = field->second.values.data() + offset[_pack.fileindex] * attribute.dimension;
+			if (attribute.type == AttributeType::TENSORS) {
+				for (size_t i = 0; i < local; ++i) {
+					for (int d = 0; d < 9; ++d) {
+						fvalues[9 * i + d] = values[9 * i + tensor[d]];
+					}
+				}
+			} else {
+				std::copy(values.begin(), values.end(), fvalues);
+			}
+		}
+	}
+}
@@ -7,6 +7,8 @@
 #include <string>
 #include <vector>
 
+#define VTK_MAX_NAME_SIZE 80
+
 namespace mesio {
 
 struct MeshBuilder;
@@ -32,7 +34,15 @@ public:
 	enum class Datatype {
 		UNKNOWN,
 		FLOAT,
-		DOUBLE
+		DOUBLE,
+		INT
+	};
+
+	enum class AttributeType {
+		SCALARS,
+		VECTORS,
+		TENSORS,
+		TENSORS6
 	};
 
 	// empty constructors are only for unpacking
@@ -77,11 +87,23 @@ public:
 
 	struct Data: public Keyword {
 		DataSource source;
+		size_t n;
 
-		Data(): source(DataSource::POINTS) {}
+		Data(): source(DataSource::POINTS), n(0) {}
 		Data(InputFilePack &pack, DataSource source, const char *c);
 	};
 
+	// SCALARS, VECTORS, NORMALS, and TENSORS of POINT_DATA or CELL_DATA
+	struct Attribute: public Keyword {
+		AttributeType type;
+		Datatype datatype;
+		int dimension;
+		char name[VTK_MAX_NAME_SIZE];
+
+		Attribute(): type(AttributeType::SCALARS), datatype(Datatype::UNKNOWN), dimension(0) { name[0] = '\0'; }
+		Attribute(InputFilePack &pack, AttributeType type, const char *c);
+	};
+
 	VTKLegacyGeometry(InputFilePack &pack);
 
 	void scan();
@@ -90,6 +112,7 @@ public:
 protected:
 	void parseBinary(MeshBuilder &mesh, const std::vector<std::string> &names);
 	void parseASCII(MeshBuilder &mesh, const std::vector<std::string> &names);
+	void parseData(MeshBuilder &mesh, const std::vector<size_t> &nodes, const std::vector<size_t> &elements, const std::vector<int> &maxdim);
 
 	InputFilePack &_pack;
 
@@ -98,6 +121,8 @@ protected:
 	std::vector<Cells> _cells;
 	std::vector<CellTypes> _cellTypes;
 	std::vector<Data> _pointData, _cellData;
+	std::vector<Attribute> _attributes;
+	std::vector<Keyword> _lookupTables, _skipped; // FIELD, COLOR_SCALARS, and TEXTURE_COORDINATES are not supported
 };
 }
 
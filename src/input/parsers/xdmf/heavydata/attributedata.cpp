@@ -0,0 +1,37 @@
+
+#include "attributedata.h"
+#include "basis/containers/tarray.h"
+#include "basis/utilities/parser.h"
+#include "wrappers/mpi/communication.h"
+#include "esinfo/mpiinfo.h"
+#include "esinfo/eslog.h"
+#include "input/parsers/xdmf/lightdata/xdmfattribute.h"
+#include "input/parsers/xdmf/lightdata/xdmfdataitem.h"
+#include "wrappers/hdf5/w.hdf5.h"
+
+#include <vector>
+
+using namespace mesio;
+
+AttributeData::AttributeData(size_t grid, XDMFAttribute *attribute, XDMFDataItem *attributedata)
+: grid(grid), attribute(attribute), dimension(1)
+{
+	if (attributedata->format != XDMFDataItem::Format::HDF) {
+		eslog::error("XDMF parser: only HDF5 attributes are supported.\n");
+	}
+
+	for (size_t d = 1; d < attributedata->dimensions.size(); ++d) {
+		dimension *= attributedata->dimensions[d];
+	}
+	name = Parser::split(attributedata->data, ":")[1];
+	distribution = tarray<esint>::distribute(info::mpi::size, attributedata->dimensions[0]);
+}
+
+void AttributeData::read(HDF5 &file)
+{
+	if (MPITools::subset->within.rank == 0) {
+		esint nvalues = distribution[info::mpi::rank + MPITools::subset->within.size] - distribution[info::mpi::rank];
+		data.resize(nvalues * dimension);
+		file.read(name.c_str(), HDF5::DOUBLE, data.data(), dimension, nvalues, distribution[info::mpi::rank]);
+	}
+}
@@ -0,0 +1,31 @@
+
+#ifndef SRC_INPUT_FORMATS_XDMF_HEAVYDATA_ATTRIBUTEDATA_H_
+#define SRC_INPUT_FORMATS_XDMF_HEAVYDATA_ATTRIBUTEDATA_H_
+
+#include "basis/containers/allocators.h"
+
+#include <string>
+#include <vector>
+
+namespace mesio {
+
+class XDMFAttribute;
+class XDMFDataItem;
+class HDF5;
+
+class AttributeData {
+public:
+	AttributeData(size_t grid, XDMFAttribute *attribute, XDMFDataItem *attributedata);
+	void read(HDF5 &file);
+
+	size_t grid;
+	XDMFAttribute *attribute;
+	int dimension;
+	std::string name;
+	std::vector<esint> distribution;
+	std::vector<double> data;
+};
+
+}
+
+#endif /* SRC_INPUT_FORMATS_XDMF_HEAVYDATA_ATTRIBUTEDATA_H_ */
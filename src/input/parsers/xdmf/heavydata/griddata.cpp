@@ -6,6 +6,7 @@
 #include "input/meshbuilder.h"
 #include "input/parsers/mixedelementsparser.h"
 #include "input/parsers/xdmf/lightdata/lightdata.h"
+#include "input/parsers/xdmf/lightdata/xdmfattribute.h"
 #include "input/parsers/xdmf/lightdata/xdmfdataitem.h"
 #include "input/parsers/xdmf/lightdata/xdmfgrid.h"
 #include "input/parsers/xdmf/lightdata/xdmfdomain.h"
@@ -33,12 +34,13 @@ void GridData::scan()
 			switch (dynamic_cast<XDMFGrid*>(e)->type) {
 			case XDMFGrid::Type::Collection: break;
 			case XDMFGrid::Type::Tree: break;
-			case XDMFGrid::Type::Uniform: _grids.push_back(_Grid{ dynamic_cast<XDMFGrid*>(e), NULL, NULL, NULL, NULL }); break;
+			case XDMFGrid::Type::Uniform: _grids.push_back(_Grid{ dynamic_cast<XDMFGrid*>(e), NULL, NULL, NULL, NULL, {} }); break;
 			case XDMFGrid::Type::Subset: break;
 			}
 			break;
 		case XDMFElement::EType::Geometry: _grids.back().geometry = dynamic_cast<XDMFGeometry*>(e); break;
 		case XDMFElement::EType::Topology: _grids.back().topology = dynamic_cast<XDMFTopology*>(e); break;
+		case XDMFElement::EType::Attribute: _grids.back().attributes.push_back(dynamic_cast<XDMFAttribute*>(e)); break;
 		default: break;
 		}
 	});
@@ -86,6 +88,19 @@ void GridData::scan()
 		it->topologydata = xpath(it->topology->dataitem.front());
 		_geometry.push_back({ it->geometry, it->geometrydata });
 		_topology.push_back({ it->topology, it->topologydata });
+
+		for (auto attribute = it->attributes.begin(); attribute != it->attributes.end(); ++attribute) {
+			bool center = (*attribute)->center == XDMFAttribute::Center::Node || (*attribute)->center == XDMFAttribute::Center::Cell;
+			bool type = (*attribute)->type != XDMFAttribute::Type::Matrix && (*attribute)->type != XDMFAttribute::Type::GlobalID;
+			if (!center || !type) {
+				eslog::warning("XDMF parser: attribute '%s' is skipped (only node and cell values are supported).\n", (*attribute)->name.c_str());
+				continue;
+			}
+			if ((*attribute)->dataitem.size() != 1) {
+				eslog::error("XDMF parser error: Attribute element with exactly one DataItem is supported.\n");
+			}
+			_attributes.push_back(AttributeData(it - _grids.begin(), *attribute, xpath((*attribute)->dataitem.front())));
+		}
 	}
 }
 
@@ -104,6 +119,9 @@ void GridData::read()
 		_geometry[i].read(hdf5);
 		_topology[i].read(hdf5);
 	}
+	for (size_t i = 0; i < _attributes.size(); ++i) {
+		_attributes[i].read(hdf5); // values are scattered to non-readers during parsing
+	}
 	eslog::checkpointln("HDF5: READ");
 
 	int reduction = MPITools::subset->within.size;
@@ -275,9 +293,12 @@ void GridData::parse(MeshBuilder &mesh)
 		csize += _geometry[i].distribution[info::mpi::rank + 1] - _geometry[i].distribution[info::mpi::rank];
 	}
 
+	std::vector<size_t> noffset(_geometry.size() + 1), eoffset(_topology.size() + 1);
+	std::vector<int> egrid(_topology.size());
 	mesh.coordinates.reserve(csize);
 	for (size_t i = 0, nodes = 0; i < _geometry.size(); ++i) {
 		esint ncoordinates = _geometry[i].distribution[info::mpi::rank + 1] - _geometry[i].distribution[info::mpi::rank];
+		noffset[i] = mesh.coordinates.size();
 		if (_geometry[i].dimension == 3) {
 			for (esint n = 0; n < ncoordinates; ++n) {
 				mesh.coordinates.push_back(Point(_geometry[i].data[3 * n + 0], _geometry[i].data[3 * n + 1], _geometry[i].data[3 * n + 2]));
@@ -310,6 +331,7 @@ void GridData::parse(MeshBuilder &mesh)
 	mesh.eIDs.reserve(esize);
 	mesh.enodes.reserve(esize);
 	for (size_t i = 0, j = 0, nodes = 0, elements = 0; i < _topology.size(); ++i) {
+		eoffset[i] = mesh.etype.size();
 		if (_topology[i].etype == (int)Element::CODE::SIZE) {
 			std::vector<esint> ids;
 			for (size_t n = mixedparser.first[j]; n + TopologyData::align < _topology[i].data.size(); ++n) {
@@ -338,6 +360,7 @@ void GridData::parse(MeshBuilder &mesh)
 			if (dim[i] == 1) {
 				mesh.nregions[_grids[i].grid->name] = ids;
 			} else {
+				egrid[i] = 1;
 				mesh.eIDs.insert(mesh.eIDs.end(), ids.begin(), ids.end());
 				mesh.eregions[_grids[i].grid->name].swap(ids);
 				elements += mixedparser.nelements[j];
@@ -352,6 +375,7 @@ void GridData::parse(MeshBuilder &mesh)
 				}
 				mesh.nregions[_grids[i].grid->name].swap(ids);
 			} else {
+				egrid[i] = 1;
 				size_t start = mesh.enodes.size();
 				size_t offset = _topology[i].distribution[info::mpi::rank];
 				size_t size = _topology[i].distribution[info::mpi::rank + 1] - _topology[i].distribution[info::mpi::rank];
@@ -379,5 +403,68 @@ void GridData::parse(MeshBuilder &mesh)
 		}
 		nodes += _geometry[i].distribution.back();
 	}
+	noffset.back() = mesh.coordinates.size();
+	eoffset.back() = mesh.etype.size();
+
+	parseAttributes(mesh, noffset, eoffset, egrid);
 }
 
+void GridData::parseAttributes(MeshBuilder &mesh, const std::vector<size_t> &noffset, const std::vector<size_t> &eoffset, const std::vector<int> &egrid)
+{
+	// positions of XDMF components in the mesh data
+	static const int tensor[9] = { 0, 4, 8, 1, 5, 2, 3, 7, 6 }; // xx xy xz yx yy yz zx zy zz
+	static const int tensor6[6] = { 0, 3, 5, 1, 4, 2 }; // xx xy xz yy yz zz
+
+	for (auto a = _attributes.begin(); a != _attributes.end(); ++a) {
+		bool nodes = a->attribute->center == XDMFAttribute::Center::Node;
+		if (!nodes && !egrid[a->grid]) {
+			continue; // points are not included into elements
+		}
+
+		// values are read by readers according to the HDF5 distribution, the mesh has them according to the parsed nodes (elements)
+		const std::vector<size_t> &offset = nodes ? noffset : eoffset;
+		size_t local = offset[a->grid + 1] - offset[a->grid];
+		std::vector<size_t> current = Communication::getDistribution<size_t>(a->data.size());
+		std::vector<size_t> target = Communication::getDistribution<size_t>(local * a->dimension);
+		if (current.back() != target.back()) {
+			eslog::error("XDMF parser: attribute '%s' does not match grid '%s'.\n", a->attribute->name.c_str(), _grids[a->grid].grid->name.c_str());
+		}
+		if (!Communication::balance(a->data, current, target)) {
+			eslog::internalFailure("cannot balance attribute '%s'.\n", a->attribute->name.c_str());
+		}
+
+		std::map<std::string, MeshData::Field> &fields = nodes ? mesh.ndata : mesh.edata;
+		auto field = fields.find(a->attribute->name);
+		if (field == fields.end()) {
+			field = fields.insert(std::make_pair(a->attribute->name, MeshData::Field())).first;
+			field->second.dimension = a->dimension;
+			switch (a->attribute->type) {
+			case XDMFAttribute::Type::Vector: field->second.type = NamedData::DataType::VECTOR; break;
+			case XDMFAttribute::Type::Tensor: field->second.type = NamedData::DataType::TENSOR_SYMM; break;
+			case XDMFAttribute::Type::Tensor6: field->second.type = NamedData::DataType::TENSOR_ASYM; break;
+			default: field->second.type = a->dimension == 1 ? NamedData::DataType::SCALAR : NamedData::DataType::NUMBERED;
+			}
+			field->second.values.resize(offset.back() * a->dimension, 0); // grids without the attribute have zeros
+		}
+		if (field->second.dimension != a->dimension) {
+			eslog::error("XDMF parser: attribute '%s' has various dimensions in grids.\n", a->attribute->name.c_str());
+		}
+		double *values = field->second.values.data() + offset[a->grid] * a->dimension;
+		if (a->attribute->type == XDMFAttribute::Type::Tensor && a->dimension == 9) {
+			for (size_t i = 0; i < local; ++i) {
+				for (int d = 0; d < 9; ++d) {
+					values[9 * i + d] = a->data[9 * i + tensor[d]];
+				}
+			}
+		} else if (a->attribute->type == XDMFAttribute::Type::Tensor6 && a->dimension == 6) {
+			for (size_t i = 0; i < local; ++i) {
+				for (int d = 0; d < 6; ++d) {
+					values[6 * i + d] = a->data[6 * i + tensor6[d]];
+				}
+			}
+		} else {
+			std::copy(a->data.begin(), a->data.end(), values);
+		}
+		a->data.clear();
+	}
+}
@@ -2,6 +2,7 @@
 #ifndef SRC_INPUT_FORMATS_XDMF_HEAVYDATA_GRIDDATA_H_
 #define SRC_INPUT_FORMATS_XDMF_HEAVYDATA_GRIDDATA_H_
 
+#include "attributedata.h"
 #include "geometrydata.h"
 #include "topologydata.h"
 
@@ -13,6 +14,7 @@ class LightData;
 class XDMFGrid;
 class XDMFGeometry;
 class XDMFTopology;
+class XDMFAttribute;
 struct MeshBuilder;
 
 class GridData {
@@ -22,6 +24,7 @@ class GridData {
 		XDMFDataItem *geometrydata;
 		XDMFTopology *topology;
 		XDMFDataItem *topologydata;
+		std::vector<XDMFAttribute*> attributes;
 	};
 
 public:
@@ -33,10 +36,13 @@ public:
 	void parse(MeshBuilder &mesh);
 
 protected:
+	void parseAttributes(MeshBuilder &mesh, const std::vector<size_t> &noffset, const std::vector<size_t> &eoffset, const std::vector<int> &egrid);
+
 	LightData &_lightdata;
 	std::vector<_Grid> _grids;
 	std::vector<GeometryData> _geometry;
 	std::vector<TopologyData > _topology;
+	std::vector<AttributeData> _attributes;
 };
 
 }
@@ -7,6 +7,7 @@
 #include "esinfo/mpiinfo.h"
 #include "esinfo/eslog.hpp"
 
+#include "basis/containers/arena.h"
 #include "basis/containers/serializededata.h"
 #include "basis/utilities/parser.h"
 #include "basis/utilities/packing.h"
@@ -21,6 +22,9 @@
 #include "input/parsers/vtklegacy/vtklegacy.h"
 #include "input/parsers/netgen/netgen.h"
 #include "input/parsers/neper/neper.h"
+#include "input/parsers/stl/stl.h"
+#include "input/parsers/gmsh/gmsh.h"
+#include "input/parsers/generator/generator.h"
 
 #include "preprocessing/meshpreprocessing.h"
 #include "store/statisticsstore.h"
@@ -86,12 +90,16 @@ void Mesh::load()
 	case InputConfiguration::FORMAT::VTK_LEGACY:     data = new VTKLegacyLoader    (info::config::input); break;
 	case InputConfiguration::FORMAT::NETGET:         data = new NetgenNeutralLoader(info::config::input); break;
 	case InputConfiguration::FORMAT::NEPER:          data = new NeperLoader        (info::config::input); break;
+	case InputConfiguration::FORMAT::STL:            data = new STLLoader          (info::config::input); break;
+	case InputConfiguration::FORMAT::GMSH:           data = new GmshLoader         (info::config::input); break;
+	case InputConfiguration::FORMAT::GENERATOR:      data = new PartsGenerator     (info::config::input); break;
 	}
 
 	data->load();
 	data->build();
 
 	delete data;
+	Arena::release();
 }
 
 void Mesh::finish()
@@ -250,7 +258,7 @@ void Mesh::reclusterize()
 			mesh::computeElementsCenters(nodes, elements);
 		}
 		std::vector<esint> partition;
-		mesh::computeElementsClusterization(elements, nodes, partition);
+		partitionInfo.decomposerEdgecut = mesh::computeElementsClusterization(elements, nodes, partition);
 		mesh::exchangeElements(elements, nodes, elementsRegions, boundaryRegions, neighbors, neighborsWithMe, partition);
 		if (info::config::input.decomposition.force_continuity) {
 			std::vector<int> component;
@@ -372,8 +380,10 @@ void Mesh::preprocess()
 	reclusterize();
 	computePersistentParameters();
 	partitiate(preferedDomains);
+	mesh::computePartitionInfo(elements, nodes, domains, clusters, neighbors, partitionInfo);
 
 	DebugOutput::mesh();
+	Arena::release();
 	eslog::endln("MESH: PREPROCESSING FINISHED");
 }
 
@@ -524,20 +534,6 @@ void Mesh::duplicate()
 	eslog::endln("MESH: DUPLICATION FINISHED");
 }
 
-void Mesh::toBuffer()
-{
-	for (size_t i = 0; i < elements->data.size(); ++i) {
-		if (elements->data[i]->name.size()) {
-			elements->data[i]->toBuffer();
-		}
-	}
-	for (size_t i = 0; i < nodes->data.size(); ++i) {
-		if (nodes->data[i]->name.size()) {
-			nodes->data[i]->toBuffer();
-		}
-	}
-}
-
 void Mesh::printMeshStatistics()
 {
 	size_t namesize = 56;
@@ -1121,3 +1117,29 @@ void Mesh::printDecompositionStatistics()
 //	}
 }
 
+
+void Mesh::printPartitionStatistics()
+{
+	const PartitionInfo &p = partitionInfo;
+	eslog::info(" ==================================== PARTITION STATISTICS =================================== \n");
+	if (info::config::output.logger == OutputConfiguration::LOGGER::PARSER) {
+		eslog::info("partition: edgecut: %d, volume: %d, max volume: %d, neighbors: %d-%d, imbalance: %.3f\n", p.edgecut, p.volume, p.maxVolume, p.minNeighbors, p.maxNeighbors, p.elementImbalance);
+		return;
+	}
+	eslog::info("  %-24s : %16s %16s %16s\n", "", "MIN", "AVG", "MAX");
+	eslog::info("  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  \n");
+	eslog::info("  %-24s : %16d %16.2f %16d\n", "NEIGHBORS", p.minNeighbors, p.avgNeighbors, p.maxNeighbors);
+	eslog::info("  %-24s : %16.3f %16.3f %16.3f\n", "INTERFACE NODES RATIO", p.minInterfaceRatio, p.avgInterfaceRatio, p.maxInterfaceRatio);
+	eslog::info("  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  \n");
+	if (p.decomposerEdgecut == -1) {
+		eslog::info("  %-24s : %16s\n", "EDGE CUT", Parser::stringwithcommas(p.edgecut).c_str());
+	} else {
+		eslog::info("  %-24s : %16s %16s [DECOMPOSER]\n", "EDGE CUT", Parser::stringwithcommas(p.edgecut).c_str(), Parser::stringwithcommas(p.decomposerEdgecut).c_str());
+	}
+	eslog::info("  %-24s : %16s %16s [MAX]\n", "COMMUNICATION VOLUME", Parser::stringwithcommas(p.volume).c_str(), Parser::stringwithcommas(p.maxVolume).c_str());
+	eslog::info("  %-24s : %16.3f\n", "ELEMENTS IMBALANCE", p.elementImbalance);
+	eslog::info("  %-24s : %16.3f\n", "NODES IMBALANCE", p.nodeImbalance);
+	eslog::info("  %-24s : %16s %16s [DISCONNECTED] %d [MAX PARTS]\n", "CLUSTERS", Parser::stringwithcommas(p.clusters).c_str(), Parser::stringwithcommas(p.disconnectedClusters).c_str(), p.maxClusterParts);
+	eslog::info("  %-24s : %16s %16s [DISCONNECTED] %d [MAX PARTS]\n", "DOMAINS", Parser::stringwithcommas(p.domains).c_str(), Parser::stringwithcommas(p.disconnectedDomains).c_str(), p.maxDomainParts);
+	eslog::info(" ============================================================================================= \n");
+}
@@ -3,6 +3,7 @@
 #define SRC_MESH_MESH_H_
 
 #include "element.h"
+#include "store/partitioninfo.h"
 #include "basis/containers/point.h"
 
 #include <string>
@@ -48,9 +49,9 @@ public:
 	void preprocess();
 	void partitiate(int ndomains);
 	void duplicate();
-	void toBuffer();
 	void printMeshStatistics();
 	void printDecompositionStatistics();
+	void printPartitionStatistics();
 
 	ElementsRegionStore* allElements()
 	{
@@ -93,6 +94,8 @@ public:
 
 	ContactStore *contact;
 
+	PartitionInfo partitionInfo;
+
 	std::vector<int> neighbors;
 	std::vector<int> neighborsWithMe;
 
@@ -2,6 +2,8 @@
 #include "meshpreprocessing.h"
 
 #include "basis/containers/serializededata.h"
+#include "basis/logging/tracelogger.h"
+#include "basis/structures/roaringbitmap.h"
 #include "basis/utilities/utils.h"
 #include "esinfo/envinfo.h"
 #include "esinfo/eslog.h"
@@ -27,35 +29,11 @@ namespace mesh {
 
 void fillRegionMask(ElementStore *elements, const std::vector<ElementsRegionStore*> &elementsRegions)
 {
-	size_t threads = info::env::threads;
-
-	std::vector<std::vector<esint> > eregions(threads);
-
-	// regions are transfered via mask
-	auto bitMastSize = [](size_t elements)
-	{
-		size_t size = 8 * sizeof(esint);
-		return elements / size + (elements % size ? 1 : 0);
-	};
-	int regionsBitMaskSize = bitMastSize(elementsRegions.size());
-
+	elements->regions.resize(elementsRegions.size());
 	#pragma omp parallel for
-	for (size_t t = 0; t < threads; t++) {
-		esint maskOffset = 0;
-		eregions[t].resize(regionsBitMaskSize * elements->epointers->datatarray().size(t));
-		for (size_t r = 0; r < elementsRegions.size(); r++) {
-			maskOffset = r / (8 * sizeof(esint));
-			esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-
-			const auto &relements = elementsRegions[r]->elements->datatarray();
-			auto begin = std::lower_bound(relements.begin(), relements.end(), elements->epointers->datatarray().distribution()[t]);
-			auto end = std::lower_bound(relements.begin(), relements.end(), elements->epointers->datatarray().distribution()[t + 1]);
-			for (auto i = begin; i != end; ++i) {
-				eregions[t][(*i - elements->epointers->datatarray().distribution()[t]) * regionsBitMaskSize + maskOffset] |= bit;
-			}
-		}
+	for (size_t r = 0; r < elementsRegions.size(); r++) {
+		elements->regions[r] = RoaringBitmap(elementsRegions[r]->elements->datatarray().cbegin(), elementsRegions[r]->elements->datatarray().cend());
 	}
-	elements->regions = new serializededata<esint, esint>(regionsBitMaskSize, eregions);
 
 	eslog::checkpointln("MESH: REGION MASK FILLED");
 }
@@ -64,29 +42,55 @@ void processNamelessElements(ElementStore *elements, std::vector<ElementsRegionS
 {
 	size_t threads = info::env::threads;
 
-	std::vector<esint> nameless;
-	int rsize = elements->regions->edataSize();
-	esint eindex = 0;
-	for (auto regions = elements->regions->begin(); regions != elements->regions->end(); ++regions, ++eindex) {
-		bool named = regions->at(0) != 1;
-		for (int r = 1; !named && r < rsize; ++r) {
-			named = regions->at(r) != 0;
-		}
-		if (!named) {
-			nameless.push_back(eindex);
-		}
+	// nameless = ALL_ELEMENTS \ (union of named regions)
+	RoaringBitmap nameless = elements->regions[0];
+	for (size_t r = 1; r < elements->regions.size(); r++) {
+		nameless -= elements->regions[r];
 	}
 
-	esint size = nameless.size();
+	esint size = nameless.cardinality();
 	Communication::allReduce(&size, NULL, 1, MPITools::getType(size).mpitype, MPI_MAX);
 	if (size) {
+		std::vector<esint> nelements;
+		nameless.toVector(nelements);
 		elementsRegions.push_back(new ElementsRegionStore("NAMELESS_ELEMENT_SET"));
-		elementsRegions.back()->elements = new serializededata<esint, esint>(1, { threads, nameless });
+		elementsRegions.back()->elements = new serializededata<esint, esint>(1, { threads, nelements });
+		elements->regions.push_back(nameless);
 	}
 
 	eslog::checkpointln("MESH: CHECKED NAMELESS ELEMENTS");
 }
 
+void computeRegionsSignatures(const ElementStore *elements, const ElementStore *halo, std::vector<esint> &signatures)
+{
+	// the set of regions is refined region by region -> elements with the same signature are in the same regions
+	esint size = elements->distribution.process.size;
+	esint hsize = halo == NULL ? 0 : halo->distribution.process.size;
+	signatures.assign(size + hsize, 0);
+
+	esint classes = 1;
+	std::vector<esint> split(classes, -1), touched;
+	auto refine = [&] (esint e) {
+		if (split[signatures[e]] == -1) {
+			touched.push_back(signatures[e]);
+			split[signatures[e]] = classes++;
+		}
+		signatures[e] = split[signatures[e]];
+	};
+
+	for (size_t r = 0; r < elements->regions.size(); ++r) {
+		elements->regions[r].forEach([&] (esint e) { refine(e); });
+		if (halo != NULL && r < halo->regions.size()) {
+			halo->regions[r].forEach([&] (esint e) { refine(size + e); });
+		}
+		for (size_t i = 0; i < touched.size(); ++i) {
+			split[touched[i]] = -1;
+		}
+		touched.clear();
+		split.resize(classes, -1);
+	}
+}
+
 ElementStore* exchangeHalo(ElementStore *elements, NodeStore *nodes, std::vector<int> &neighbors)
 {
 	// halo elements are all elements that have some shared node
@@ -125,8 +129,6 @@ ElementStore* exchangeHalo(ElementStore *elements, NodeStore *nodes, std::vector
 		hElements[t].swap(telements);
 	}
 
-	int rsize = elements->regions->edataSize();
-
 	std::vector<std::vector<size_t> > tdist(neighbors.size());
 	for (size_t n = 0; n < neighbors.size(); ++n) {
 		tdist[n] = { 0, hElements[0][n].size() };
@@ -144,7 +146,7 @@ ElementStore* exchangeHalo(ElementStore *elements, NodeStore *nodes, std::vector
 	for (size_t n = 0; n < neighbors.size(); ++n) {
 		utils::removeDuplicates(hElements[0][n]);
 		tdist[n] = tarray<size_t>::distribute(threads, hElements[0][n].size());
-		sBuffer[n].resize((4 + rsize) * hElements[0][n].size());
+		sBuffer[n].resize(4 * hElements[0][n].size());
 	}
 
 	#pragma omp parallel for
@@ -153,14 +155,32 @@ ElementStore* exchangeHalo(ElementStore *elements, NodeStore *nodes, std::vector
 		const auto &body = elements->body->datatarray();
 		const auto &material = elements->material->datatarray();
 		const auto &epointer = elements->epointers->datatarray();
-		const auto &regions = elements->regions->datatarray();
 		for (size_t n = 0; n < neighbors.size(); ++n) {
 			for (size_t e = tdist[n][t]; e < tdist[n][t + 1]; e++) {
-				sBuffer[n][(4 + rsize) * e + 0] = IDs[hElements[0][n][e] - ebegin];
-				sBuffer[n][(4 + rsize) * e + 1] = body[hElements[0][n][e] - ebegin];
-				sBuffer[n][(4 + rsize) * e + 2] = material[hElements[0][n][e] - ebegin];
-				sBuffer[n][(4 + rsize) * e + 3] = (esint)epointer[hElements[0][n][e] - ebegin]->code;
-				memcpy(sBuffer[n].data() + (4 + rsize) * e + 4, regions.data() + (hElements[0][n][e] - ebegin) * rsize, sizeof(esint) * rsize);
+				sBuffer[n][4 * e + 0] = IDs[hElements[0][n][e] - ebegin];
+				sBuffer[n][4 * e + 1] = body[hElements[0][n][e] - ebegin];
+				sBuffer[n][4 * e + 2] = material[hElements[0][n][e] - ebegin];
+				sBuffer[n][4 * e + 3] = (esint)epointer[hElements[0][n][e] - ebegin]->code;
+			}
+		}
+	}
+
+	// only IDs of regions members are exchanged: [regions, (region, size, IDs), ...]
+	std::vector<std::vector<esint> > sRegions(neighbors.size(), std::vector<esint>({ 0 })), rRegions(neighbors.size());
+	#pragma omp parallel for
+	for (size_t n = 0; n < neighbors.size(); ++n) {
+		const auto &IDs = elements->IDs->datatarray();
+		std::vector<esint> local(hElements[0][n].size());
+		for (size_t e = 0; e < hElements[0][n].size(); e++) {
+			local[e] = hElements[0][n][e] - ebegin;
+		}
+		RoaringBitmap send(local);
+		for (size_t r = 0; r < elements->regions.size(); ++r) {
+			RoaringBitmap members = elements->regions[r] & send;
+			if (!members.empty()) {
+				++sRegions[n][0];
+				sRegions[n].insert(sRegions[n].end(), { (esint)r, (esint)members.cardinality() });
+				members.forEach([&] (esint e) { sRegions[n].push_back(IDs[e]); });
 			}
 		}
 	}
@@ -168,32 +188,40 @@ ElementStore* exchangeHalo(ElementStore *elements, NodeStore *nodes, std::vector
 	if (!Communication::exchangeUnknownSize(sBuffer, rBuffer, neighbors)) {
 		eslog::internalFailure("exchange halo elements.\n");
 	}
+	if (!Communication::exchangeUnknownSize(sRegions, rRegions, neighbors)) {
+		eslog::internalFailure("exchange halo elements regions.\n");
+	}
 
-	std::vector<std::vector<esint> > hid(threads), hregions(threads);
+	std::vector<std::vector<esint> > hid(threads);
 	std::vector<std::vector<int> > hbody(threads), hmaterial(threads);
 
 	std::vector<std::vector<Element*> > hcode(threads);
 
 	for (size_t n = 0; n < rBuffer.size(); ++n) {
-		std::vector<size_t> distribution = tarray<size_t>::distribute(threads, rBuffer[n].size() / (4 + rsize));
+		std::vector<size_t> distribution = tarray<size_t>::distribute(threads, rBuffer[n].size() / 4);
 		#pragma omp parallel for
 		for (size_t t = 0; t < threads; t++) {
 			for (size_t e = distribution[t]; e < distribution[t + 1]; ++e) {
-				hid[t].push_back(rBuffer[n][(4 + rsize) * e + 0]);
-				hbody[t].push_back(rBuffer[n][(4 + rsize) * e + 1]);
-				hmaterial[t].push_back(rBuffer[n][(4 + rsize) * e + 2]);
-				hcode[t].push_back(&Mesh::edata[rBuffer[n][(4 + rsize) * e + 3]]);
-				hregions[t].insert(hregions[t].end(), rBuffer[n].data() + (4 + rsize) * e + 4, rBuffer[n].data() + (4 + rsize) * e + 4 + rsize);
+				hid[t].push_back(rBuffer[n][4 * e + 0]);
+				hbody[t].push_back(rBuffer[n][4 * e + 1]);
+				hmaterial[t].push_back(rBuffer[n][4 * e + 2]);
+				hcode[t].push_back(&Mesh::edata[rBuffer[n][4 * e + 3]]);
 			}
 		}
 	}
 
+	std::vector<RoaringBitmap> hregions(elements->regions.size()); // by IDs
+	for (size_t n = 0; n < rRegions.size(); ++n) {
+		for (esint r = 0, p = 1; r < rRegions[n][0]; ++r, p += 2 + rRegions[n][p + 1]) {
+			hregions[rRegions[n][p]].add(rRegions[n].data() + p + 2, rRegions[n].data() + p + 2 + rRegions[n][p + 1]);
+		}
+	}
+
 	ElementStore *halo = new ElementStore();
 	halo->IDs = new serializededata<esint, esint>(1, hid);
 	halo->body = new serializededata<esint, int>(1, hbody);
 	halo->material = new serializededata<esint, int>(1, hmaterial);
 	halo->epointers = new serializededata<esint, Element*>(1, hcode);
-	halo->regions = new serializededata<esint, esint>(rsize, hregions);
 
 	halo->distribution.process.size = halo->IDs->datatarray().size();
 	halo->distribution.threads = halo->IDs->datatarray().distribution();
@@ -204,6 +232,16 @@ ElementStore* exchangeHalo(ElementStore *elements, NodeStore *nodes, std::vector
 	std::sort(permutation.begin(), permutation.end(), [&] (esint i, esint j) { return hIDs[i] < hIDs[j]; });
 	halo->permute(permutation);
 
+	halo->regions.resize(hregions.size());
+	#pragma omp parallel for
+	for (size_t r = 0; r < hregions.size(); ++r) {
+		auto it = hIDs.begin();
+		hregions[r].forEach([&] (esint id) {
+			it = std::lower_bound(it, hIDs.end(), id);
+			halo->regions[r].add(it - hIDs.begin());
+		});
+	}
+
 	eslog::checkpointln("MESH: HALO ELEMENTS EXCHANGED");
 	return halo;
 }
@@ -248,7 +286,8 @@ void computeRegionsBoundaryElementsFromNodes(const NodeStore *nodes, const Eleme
 	std::vector<std::vector<esint> > edist(threads), edata(threads), ecode(threads);
 	std::vector<std::vector<Element*> > epointers(threads);
 
-	int rsize = elements->regions->edataSize();
+	std::vector<esint> signatures;
+	computeRegionsSignatures(elements, halo, signatures);
 
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
@@ -262,7 +301,6 @@ void computeRegionsBoundaryElementsFromNodes(const NodeStore *nodes, const Eleme
 		esint element, neighbor, prev = 0;
 		auto enodes = elements->nodes->cbegin();
 		auto neighbors = elements->faceNeighbors->cbegin();
-		const auto &regions = elements->regions->datatarray();
 
 		for (size_t e = tdistribution[t]; e < tdistribution[t + 1]; e++) {
 			nodes.push_back((begin + e)->second);
@@ -300,12 +338,12 @@ void computeRegionsBoundaryElementsFromNodes(const NodeStore *nodes, const Eleme
 							} else if (element + elements->distribution.process.offset < neighbor) {
 								if (elements->distribution.process.isLocal(neighbor)) {
 									neighbor -= elements->distribution.process.offset;
-									if (memcmp(regions.data() + element * rsize, regions.data() + neighbor * rsize, sizeof(esint) * rsize) != 0) {
+									if (signatures[element] != signatures[neighbor]) {
 										addFace();
 									}
 								} else {
 									neighbor = std::lower_bound(halo->IDs->datatarray().begin(), halo->IDs->datatarray().end(), neighbor) - halo->IDs->datatarray().begin();
-									if (memcmp(regions.data() + element * rsize, halo->regions->datatarray().data() + neighbor * rsize, sizeof(esint) * rsize) != 0) {
+									if (signatures[element] != signatures[elements->distribution.process.size + neighbor]) {
 										addFace();
 									}
 								}
@@ -585,20 +623,20 @@ void computeRegionsElementNodes(const NodeStore *nodes, const ElementStore *elem
 	for (size_t r = 0; r < elementsRegions.size(); r++) {
 		std::vector<std::vector<esint> > rnodes(threads);
 		if (elementsRegions[r]->elements->structures()) {
+			std::vector<RoaringBitmap> tnodes(threads);
 			#pragma omp parallel for
 			for (size_t t = 0; t < threads; t++) {
-				rnodes[t].reserve(elements->nodes->datatarray().size(t));
 				auto enodes = elements->nodes->cbegin();
 				esint prev = 0;
-				for (auto e = elementsRegions[r]->elements->datatarray().cbegin(t); e != elementsRegions[r]->elements->datatarray().cend(t); prev = *e++) {
-					enodes += *e - prev;
-					rnodes[t].insert(rnodes[t].end(), enodes->begin(), enodes->end());
-				}
-				utils::sortAndRemoveDuplicates(rnodes[t]);
+				elements->regions[r].forEach(elements->distribution.threads[t], elements->distribution.threads[t + 1], [&] (esint e) {
+					enodes += e - prev;
+					prev = e;
+					for (auto n = enodes->begin(); n != enodes->end(); ++n) {
+						tnodes[t].add(*n);
+					}
+				});
 			}
-			utils::mergeThreadedUniqueData(rnodes);
-			rnodes.resize(1);
-			rnodes.resize(threads);
+			RoaringBitmap::unite(tnodes).toVector(rnodes[0]);
 			serializededata<esint, esint>::balance(1, rnodes);
 		}
 
@@ -717,51 +755,136 @@ void computeRegionsBoundaryParents(const NodeStore *nodes, const ElementStore *e
 }
 
 
+// the lock-free union-find (a root is the lowest element of a tree)
+static esint ufind(std::vector<esint> &parent, esint e)
+{
+	while (true) {
+		esint p = __atomic_load_n(&parent[e], __ATOMIC_RELAXED);
+		if (p == e) {
+			return e;
+		}
+		esint gp = __atomic_load_n(&parent[p], __ATOMIC_RELAXED);
+		if (p != gp) { // path halving
+			__atomic_compare_exchange_n(&parent[e], &p, gp, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+		}
+		e = gp;
+	}
+}
+
+static void uunion(std::vector<esint> &parent, esint a, esint b)
+{
+	while (true) {
+		a = ufind(parent, a);
+		b = ufind(parent, b);
+		if (a == b) {
+			return;
+		}
+		if (b < a) {
+			std::swap(a, b);
+		}
+		if (__atomic_compare_exchange_n(&parent[b], &b, a, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			return;
+		}
+	}
+}
+
+// equivalences of labels are stored as pairs [label, the lowest equivalent label]
+static void compressEquivalences(std::vector<esint> &pairs)
+{
+	std::unordered_map<esint, esint> parent;
+	auto find = [&] (esint label) {
+		auto it = parent.find(label);
+		if (it == parent.end()) {
+			return label;
+		}
+		esint root = label;
+		while (parent.count(root) && parent[root] != root) {
+			root = parent[root];
+		}
+		while (label != root) { // path compression
+			esint next = parent[label];
+			parent[label] = root;
+			label = next;
+		}
+		return root;
+	};
+
+	for (size_t i = 0; i < pairs.size(); i += 2) {
+		esint a = find(pairs[i]), b = find(pairs[i + 1]);
+		if (a != b) {
+			parent[std::max(a, b)] = std::min(a, b);
+		}
+	}
+
+	pairs.clear();
+	std::vector<esint> labels;
+	for (auto it = parent.begin(); it != parent.end(); ++it) {
+		labels.push_back(it->first);
+	}
+	std::sort(labels.begin(), labels.end());
+	for (size_t i = 0; i < labels.size(); ++i) {
+		esint root = find(labels[i]);
+		if (root != labels[i]) {
+			pairs.push_back(labels[i]);
+			pairs.push_back(root);
+		}
+	}
+}
+
 void computeBodies(ElementStore *elements, BodyStore *bodies, std::vector<ElementsRegionStore*> &elementsRegions, std::vector<int> &neighbors)
 {
+	int threads = info::env::threads;
 	esint ebegin = elements->distribution.process.offset;
 	esint eend = ebegin + elements->distribution.process.size;
 	esint nbodies = 0, boffset;
 	std::vector<int> body(elements->distribution.process.size, -1);
 
-	{ // DFS for body search
-		for (esint e = 0; e < elements->distribution.process.size; ++e) {
-			std::vector<esint> stack;
-			if (body[e] == -1) {
-				stack.push_back(e);
-				body[e] = nbodies;
-				while (stack.size()) {
-					esint current = stack.back();
-					stack.pop_back();
-					auto dual = elements->faceNeighbors->cbegin() + current;
-					for (auto n = dual->begin(); n != dual->end(); ++n) {
-						if (*n != -1 && ebegin <= *n && *n < eend) {
-							if (body[*n - ebegin] == -1) {
-								stack.push_back(*n - ebegin);
-								body[*n - ebegin] = nbodies;
-							}
-						}
+	{ // parallel union-find over the local part of the dual graph
+		std::vector<esint> parent(elements->distribution.process.size);
+		std::iota(parent.begin(), parent.end(), 0);
+		std::vector<esint> distribution = tarray<esint>::distribute(threads, parent.size());
+
+		#pragma omp parallel for
+		for (int t = 0; t < threads; t++) {
+			auto dual = elements->faceNeighbors->cbegin() + distribution[t];
+			for (esint e = distribution[t]; e < distribution[t + 1]; ++e, ++dual) {
+				for (auto n = dual->begin(); n != dual->end(); ++n) {
+					if (ebegin <= *n && *n < eend && e < *n - ebegin) {
+						uunion(parent, e, *n - ebegin);
 					}
 				}
-				nbodies++;
+			}
+		}
+
+		#pragma omp parallel for
+		for (int t = 0; t < threads; t++) {
+			for (esint e = distribution[t]; e < distribution[t + 1]; ++e) {
+				parent[e] = ufind(parent, e);
+			}
+		}
+
+		// bodies are numbered according to the lowest element
+		std::vector<esint> root(parent.size());
+		for (size_t e = 0; e < parent.size(); ++e) {
+			if (parent[e] == (esint)e) {
+				root[e] = nbodies++;
 			}
 		}
 
 		// use unique indices across processes
 		boffset = nbodies;
 		Communication::exscan(boffset);
-		for (size_t i = 0; i < body.size(); ++i) {
-			body[i] += boffset;
+
+		#pragma omp parallel for
+		for (int t = 0; t < threads; t++) {
+			for (esint e = distribution[t]; e < distribution[t + 1]; ++e) {
+				body[e] = root[parent[e]] + boffset;
+			}
 		}
 	}
 
-	std::unordered_map<esint, std::unordered_set<esint> > graph; // compact representation (vertex, edges)
-	std::unordered_map<esint, esint> holders, labels;
-	{ // exchange edges of the compact dual and compute compact representation
-		for (esint b = 0; b < nbodies; ++b) {
-			graph[b + boffset];
-			holders[b + boffset] = info::mpi::rank;
-		}
+	std::vector<esint> equivalences;
+	{ // a single exchange of bodies of elements on the interface to neighboring processes
 		struct ebody { esint e, b; };
 		std::vector<esint> edistribution = Communication::getDistribution(elements->distribution.process.size);
 		std::vector<std::vector<ebody> > sBuffer(neighbors.size()), rBuffer(neighbors.size());
@@ -775,26 +898,12 @@ void computeBodies(ElementStore *elements, BodyStore *bodies, std::vector<Elemen
 		for (esint e = 0; e < elements->distribution.process.size; ++e, ++dual) {
 			for (auto n = dual->begin(); n != dual->end(); ++n) {
 				if (*n != -1 && (*n < ebegin || eend <= *n)) {
-					sBuffer[e2roffset(*n)].push_back(ebody{e + ebegin, body[e]});
-				}
-			}
-		}
-
-		for (size_t n = 0; n < sBuffer.size(); ++n) { // compute compact representation
-			std::sort(sBuffer[n].begin(), sBuffer[n].end(), [] (const ebody &i, const ebody &j) { return i.e < j.e; });
-			size_t i = 0, last = 0;
-			while (i < sBuffer[n].size()) {
-				last = i++;
-				while (i < sBuffer[n].size() && sBuffer[n][last].b == sBuffer[n][i].b) {
-					++i;
-				}
-				// i points to the first element with different body
-				if (sBuffer[n][last].e != sBuffer[n][i - 1].e) {
-					sBuffer[n][last] = sBuffer[n][i - 1];
+					esint roffset = e2roffset(*n);
+					if (sBuffer[roffset].empty() || sBuffer[roffset].back().e != e + ebegin) {
+						sBuffer[roffset].push_back(ebody{e + ebegin, body[e]});
+					}
 				}
-				++last;
 			}
-			sBuffer[n].resize(last);
 		}
 
 		if (!Communication::exchangeUnknownSize(sBuffer, rBuffer, neighbors)) {
@@ -807,216 +916,49 @@ void computeBodies(ElementStore *elements, BodyStore *bodies, std::vector<Elemen
 				if (*n != -1 && (*n < ebegin || eend <= *n)) {
 					esint roffset = e2roffset(*n);
 					esint nbody = std::lower_bound(rBuffer[roffset].begin(), rBuffer[roffset].end(), *n, [] (const ebody &ebody, esint eindex) { return ebody.e < eindex; })->b;
-					graph[body[e]].insert(nbody);
-					holders[nbody] = neighbors[roffset];
+					equivalences.push_back(body[e]);
+					equivalences.push_back(nbody);
 				}
 			}
 		}
+		compressEquivalences(equivalences);
 	}
 
-	std::unordered_set<int> nn;
-	for (auto n = holders.begin(); n != holders.end(); ++n) {
-		if (n->second != info::mpi::rank) {
-			nn.insert(n->second);
-		}
-	}
-
+	// tree reduction of equivalences to the root process (the number of rounds depends only on the number of processes)
 	for (int groups = 1; groups < info::mpi::size; groups = groups << 1) {
-		// remove vertices without edges (full body found)
-		//////////////////////////////////////////////////
-		for (auto v = graph.begin(); v != graph.end(); ) {
-			if (v->second.empty()) {
-				v = graph.erase(v);
-			} else {
-				++v;
-			}
+		trace::Scope trace("computeBodies: reduction round"); // the number of spans is independent of the number of bodies
+		std::vector<int> partner;
+		if (info::mpi::rank % (2 * groups) == groups) {
+			partner.push_back(info::mpi::rank - groups);
 		}
-
-		// compute the process that receives vertices without edge to other group
-		/////////////////////////////////////////////////////////////////////////
-		int sink = (info::mpi::rank / groups) % 2 == 0 ? info::mpi::rank + groups : info::mpi::rank - groups;
-		if (info::mpi::size <= sink) {
-			sink = info::mpi::rank - groups;
+		if (info::mpi::rank % (2 * groups) == 0 && info::mpi::rank + groups < info::mpi::size) {
+			partner.push_back(info::mpi::rank + groups);
 		}
-		if (0 <= sink && sink < info::mpi::size) {
-			nn.insert(sink);
-			if (info::mpi::rank + groups < info::mpi::size && info::mpi::size <= info::mpi::rank + 2 * groups) {
-				nn.insert(info::mpi::rank + groups);
-			}
-		} else {
-			sink = info::mpi::rank;
+		std::vector<std::vector<esint> > sBuffer(1), rBuffer(1);
+		if (partner.size() && partner.front() < info::mpi::rank) {
+			sBuffer.front().swap(equivalences);
 		}
-
-		std::vector<int> neighbors(nn.begin(), nn.end());
-		std::sort(neighbors.begin(), neighbors.end());
-		auto n2i = [&] (int n) {
-			return std::lower_bound(neighbors.begin(), neighbors.end(), n) - neighbors.begin();
-		};
-
-		// compute target processes
-		///////////////////////////
-		std::unordered_map<esint, esint> targets = holders;
-		for (auto v = graph.begin(); v != graph.end(); ++v) {
-			for (auto n = v->second.begin(); n != v->second.end(); ++n) {
-				if ((info::mpi::rank / groups) % 2 != (targets[*n] / groups) % 2) {
-					if (targets[v->first] == info::mpi::rank) {
-						targets[v->first] = targets[*n];
-					} else {
-						if (std::abs(info::mpi::rank - targets[v->first]) < std::abs(info::mpi::rank - targets[*n])) {
-							targets[v->first] = targets[*n];
-						}
-					}
-				}
-			}
-		}
-
-		// vertices that are without neighbor in the other half are sent to the sink process
-		for (auto v = graph.begin(); v != graph.end(); ++v) {
-			if (targets[v->first] == info::mpi::rank) {
-				targets[v->first] = sink;
-			}
+		if (!Communication::exchangeUnknownSize(sBuffer, rBuffer, partner)) {
+			eslog::internalFailure("cannot exchange bodies equivalences\n");
 		}
-
-		// serialize and exchange target processes
-		//////////////////////////////////////////
-		std::vector<esint> sTargets;
-		std::vector<std::vector<esint> > rTargets(neighbors.size());
-		for (auto v = graph.begin(); v != graph.end(); ++v) {
-			sTargets.push_back(v->first); sTargets.push_back(targets[v->first]);
-		}
-		if (!Communication::exchangeUnknownSize(sTargets, rTargets, neighbors)) {
-			eslog::internalFailure("cannot exchange compact graph holders.\n");
-		}
-		for (size_t n = 0; n < rTargets.size(); ++n) {
-			for (size_t i = 0; i < rTargets[n].size(); i += 2) {
-				targets[rTargets[n][i]] = rTargets[n][i + 1];
-			}
-		}
-
-		// serialize and exchange graph
-		///////////////////////////////
-		std::vector<std::vector<esint> > sGraph(neighbors.size()), rGraph(neighbors.size());
-		for (auto v = graph.begin(); v != graph.end(); ++v) {
-			int t = n2i(targets[v->first]);
-			sGraph[t].push_back(v->first);
-			sGraph[t].push_back(v->second.size());
-			for (auto n = v->second.begin(); n != v->second.end(); ++n) {
-				sGraph[t].push_back(*n);
-				if ((targets[*n] / groups) % 2 == (neighbors[t] / groups) % 2) {
-					sGraph[t].push_back(targets[*n]);
-				} else {
-					sGraph[t].push_back(holders[*n]);
-				}
-			}
-		}
-
-		// update holders of exchanged vertices
-		///////////////////////////////////////
-		for (auto v = graph.begin(); v != graph.end(); ++v) {
-			for (auto n = v->second.begin(); n != v->second.end(); ++n) {
-				if ((targets[*n] / groups) % 2 == (info::mpi::rank / groups) % 2) {
-					holders[*n] = targets[*n];
-				}
-			}
-		}
-
-		if (!Communication::exchangeUnknownSize(sGraph, rGraph, neighbors)) {
-			eslog::internalFailure("cannot exchange compact graph.\n");
-		}
-		for (size_t n = 0; n < rGraph.size(); ++n) {
-			for (size_t i = 0; i < rGraph[n].size(); ) {
-				esint vertex = rGraph[n][i++];
-				holders[vertex] = info::mpi::rank;
-				for (esint e = 0; e < rGraph[n][i]; ++e) {
-					graph[vertex].insert(rGraph[n][i + 1 + 2 * e]);
-					holders[rGraph[n][i + 1 + 2 * e]] = rGraph[n][i + 1 + 2 * e + 1];
-				}
-				i += 2 * rGraph[n][i] + 1;
-			}
-		}
-
-		// BFS to compute re-mapping (vertices are renumbered to the lowest number of a neighboring vertex)
-		///////////////////////////////////////////////////////////////////////////////////////////////////
-		std::unordered_map<esint, esint> remap;
-		for (auto v = graph.begin(); v != graph.end(); ++v) {
-			esint min = v->first;
-			std::unordered_set<esint> marked;
-			if (remap.find(v->first) == remap.end()) {
-				std::vector<esint> stack({ v->first });
-				while (stack.size()) {
-					auto e = graph[stack.back()];
-					marked.insert(stack.back());
-					stack.pop_back();
-					for (auto n = e.begin(); n != e.end(); ++n) {
-						if (graph.find(*n) != graph.end() && marked.find(*n) == marked.end()) {
-							stack.push_back(*n);
-							min = std::min(min, *n);
-						}
-					}
-				}
-			}
-			for (auto m = marked.begin(); m != marked.end(); ++m) {
-				remap[*m] = min;
-				if (labels.find(*m) != labels.end() || (boffset <= *m && *m < boffset + nbodies)) {
-					labels[*m] = min;
-					labels[min] = min;
-				}
-			}
-		}
-
-		// exchange re-mapping data in order to synchronize edges
-		/////////////////////////////////////////////////////////
-		nn.clear();
-		for (auto n = holders.begin(); n != holders.end(); ++n) {
-			if (n->second != info::mpi::rank) {
-				nn.insert(n->second);
-			}
-		}
-		neighbors.assign(nn.begin(), nn.end());
-		std::sort(neighbors.begin(), neighbors.end());
-
-		std::vector<esint> sMap;
-		std::vector<std::vector<esint> > rMap(neighbors.size());
-		for (auto m = remap.begin(); m != remap.end(); ++m) {
-			sMap.push_back(m->first); sMap.push_back(m->second);
-		}
-		if (!Communication::exchangeUnknownSize(sMap, rMap, neighbors)) {
-			eslog::internalFailure("cannot exchange re-mapped vertices.\n");
-		}
-		for (size_t n = 0; n < rMap.size(); ++n) {
-			for (size_t i = 0; i < rMap[n].size(); i += 2) {
-				remap[rMap[n][i]] = rMap[n][i + 1];
-			}
+		trace.bytes(sBuffer.front().size() * sizeof(esint), rBuffer.front().size() * sizeof(esint));
+		if (rBuffer.front().size()) {
+			equivalences.insert(equivalences.end(), rBuffer.front().begin(), rBuffer.front().end());
+			compressEquivalences(equivalences);
 		}
+	}
+	Communication::broadcastUnknownSize(equivalences);
 
-		// update merged graph
-		//////////////////////
-		std::unordered_map<esint, std::unordered_set<esint> > mgraph;
-		std::unordered_map<esint, esint> mholders;
-		for (auto v = graph.begin(); v != graph.end(); ++v) {
-			mholders[remap[v->first]] = info::mpi::rank;
-			for (auto n = v->second.begin(); n != v->second.end(); ++n) {
-				if (graph.find(*n) != graph.end()) {
-					if (remap[v->first] != remap[*n]) {
-						mgraph[remap[v->first]].insert(remap[*n]);
-					}
-				} else {
-					mgraph[remap[v->first]].insert(remap[*n]);
-					mholders[remap[*n]] = holders[*n];
-				}
-			}
+	std::unordered_map<esint, esint> labels;
+	for (size_t i = 0; i < equivalences.size(); i += 2) {
+		if (boffset <= equivalences[i] && equivalences[i] < boffset + nbodies) {
+			labels[equivalences[i]] = equivalences[i + 1];
 		}
-
-		mgraph.swap(graph);
-		mholders.swap(holders);
 	}
-
 	for (esint b = boffset; b < boffset + nbodies; ++b) {
-		auto it = labels.find(b);
-		while (it != labels.end() && it->first != it->second) {
-			it = labels.find(it->second);
+		if (labels.find(b) == labels.end()) {
+			labels[b] = b;
 		}
-		labels[b] = it != labels.end() ? it->second : b;
 	}
 
 	bodies->size = 0;
@@ -1046,13 +988,13 @@ void computeBodies(ElementStore *elements, BodyStore *bodies, std::vector<Elemen
 		memcpy(elements->body->datatarray().data(), body.data(), elements->distribution.process.size * sizeof(int));
 	}
 
-	int rsize = elements->regions->edataSize();
+	int rsize = elementsRegions.size() / (8 * sizeof(esint)) + (elementsRegions.size() % (8 * sizeof(esint)) ? 1 : 0);
 	std::vector<esint> bodyRegions(bodies->totalSize * rsize);
-	for (esint e = 0; e < elements->distribution.process.size; ++e) {
-		int b = elements->body->datatarray()[e];
-		for (int r = 0; r < rsize; ++r) {
-			bodyRegions[rsize * b + r] |= elements->regions->datatarray()[rsize * e + r];
-		}
+	for (size_t r = 0; r < elements->regions.size(); ++r) {
+		esint bit = (esint)1 << (r % (8 * sizeof(esint)));
+		elements->regions[r].forEach([&] (esint e) {
+			bodyRegions[rsize * elements->body->datatarray()[e] + r / (8 * sizeof(esint))] |= bit;
+		});
 	}
 
 	Communication::allReduce(bodyRegions.data(), NULL, bodyRegions.size(), MPITools::getType<esint>().mpitype, MPI_BOR);
@@ -1071,11 +1013,9 @@ void computeBodies(ElementStore *elements, BodyStore *bodies, std::vector<Elemen
 	}
 
 	for (int b = 0; b < bodies->totalSize; ++b) {
-		for (int r = 0, rindex = 0; r < rsize; ++r) {
-			for (size_t bit = 0; bit < 8 * sizeof(esint) && bit + r * sizeof(esint) < elementsRegions.size(); ++bit, ++rindex) {
-				if (bodyRegions[b * rsize + r] & (1 << bit)) {
-					elementsRegions[rindex]->bodies.push_back(b);
-				}
+		for (size_t r = 0; r < elementsRegions.size(); ++r) {
+			if (bodyRegions[b * rsize + r / (8 * sizeof(esint))] & ((esint)1 << (r % (8 * sizeof(esint))))) {
+				elementsRegions[r]->bodies.push_back(b);
 			}
 		}
 	}
@@ -1206,6 +1146,9 @@ void computeRegionsSurface(ElementStore *elements, NodeStore *nodes, ElementStor
 	esint eBegin = elements->distribution.process.offset;
 	esint eEnd = eBegin + elements->distribution.process.size;
 
+	std::vector<esint> signatures;
+	computeRegionsSignatures(elements, halo, signatures);
+
 	for (size_t r = 0; r < elementsRegions.size(); r++) {
 		std::vector<std::vector<esint> > faces(threads), facesDistribution(threads), ecounters(threads, std::vector<esint>((int)Element::CODE::SIZE));
 		std::vector<std::vector<Element*> > fpointers(threads);
@@ -1213,10 +1156,8 @@ void computeRegionsSurface(ElementStore *elements, NodeStore *nodes, ElementStor
 		#pragma omp parallel for
 		for (size_t t = 0; t < threads; t++) {
 			esint hindex, addFace = 0;
-			int rsize = elements->regions->edataSize();
 			auto nodes = elements->nodes->cbegin();
 			auto neighs = elements->faceNeighbors->cbegin();
-			const auto &regions = elements->regions->datatarray();
 			const auto &epointers = elements->epointers->datatarray();
 
 			std::vector<esint> fdist, fdata, ecounter((int)Element::CODE::SIZE);
@@ -1233,9 +1174,9 @@ void computeRegionsSurface(ElementStore *elements, NodeStore *nodes, ElementStor
 					if (neighs->at(n) != -1 && r) {
 						if (neighs->at(n) < eBegin || eEnd <= neighs->at(n)) {
 							hindex = std::lower_bound(halo->IDs->datatarray().begin(), halo->IDs->datatarray().end(), neighs->at(n)) - halo->IDs->datatarray().begin();
-							addFace = memcmp(regions.data() + *e * rsize, halo->regions->datatarray().data() + hindex * rsize, sizeof(esint) * rsize);
+							addFace = signatures[*e] != signatures[elements->distribution.process.size + hindex];
 						} else {
-							addFace = memcmp(regions.data() + *e * rsize, regions.data() + (neighs->at(n) - eBegin) * rsize, sizeof(esint) * rsize);
+							addFace = signatures[*e] != signatures[neighs->at(n) - eBegin];
 						}
 					} else {
 						addFace = neighs->at(n) == -1;
@@ -0,0 +1,444 @@
+
+#include "meshpreprocessing.h"
+
+#include "basis/containers/tarray.h"
+#include "basis/utilities/utils.h"
+#include "esinfo/envinfo.h"
+#include "esinfo/eslog.hpp"
+#include "esinfo/mpiinfo.h"
+#include "wrappers/mpi/communication.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace mesio {
+namespace mesh {
+
+// vertices of neighboring ranks that are adjacent to local vertices
+// values of a vertex are stored at 'column' = local index, or 'vertices' + index to 'ids' for remote vertices
+struct DualHalo {
+	esint begin, end;
+	std::vector<int> neighbors;
+	std::vector<std::vector<esint> > send, recv;
+	std::vector<esint> ids, columns;
+
+	DualHalo(const DualGraph &graph)
+	{
+		begin = graph.distribution[info::mpi::rank];
+		end = graph.distribution[info::mpi::rank + 1];
+
+		auto rank = [&] (esint vertex) -> int {
+			return std::upper_bound(graph.distribution.begin(), graph.distribution.end(), vertex) - graph.distribution.begin() - 1;
+		};
+
+		for (size_t i = 0; i < graph.neighbors.size(); ++i) {
+			if (graph.neighbors[i] < begin || end <= graph.neighbors[i]) {
+				neighbors.push_back(rank(graph.neighbors[i]));
+			}
+		}
+		utils::sortAndRemoveDuplicates(neighbors);
+
+		send.resize(neighbors.size());
+		for (esint v = 0; v < end - begin; ++v) {
+			for (esint i = graph.frames[v]; i < graph.frames[v + 1]; ++i) {
+				if (graph.neighbors[i] < begin || end <= graph.neighbors[i]) {
+					size_t n = std::lower_bound(neighbors.begin(), neighbors.end(), rank(graph.neighbors[i])) - neighbors.begin();
+					if (send[n].empty() || send[n].back() != v) {
+						send[n].push_back(v);
+					}
+				}
+			}
+		}
+
+		std::vector<std::vector<esint> > sIDs(neighbors.size()), rIDs(neighbors.size());
+		for (size_t n = 0; n < neighbors.size(); ++n) {
+			for (size_t i = 0; i < send[n].size(); ++i) {
+				sIDs[n].push_back(send[n][i] + begin);
+			}
+		}
+		if (!Communication::exchangeUnknownSize(sIDs, rIDs, neighbors)) {
+			eslog::internalFailure("cannot exchange dual graph halo.\n");
+		}
+		for (size_t n = 0; n < neighbors.size(); ++n) {
+			ids.insert(ids.end(), rIDs[n].begin(), rIDs[n].end());
+		}
+		utils::sortAndRemoveDuplicates(ids);
+
+		recv.resize(neighbors.size());
+		for (size_t n = 0; n < neighbors.size(); ++n) {
+			for (size_t i = 0; i < rIDs[n].size(); ++i) {
+				recv[n].push_back(end - begin + std::lower_bound(ids.begin(), ids.end(), rIDs[n][i]) - ids.begin());
+			}
+		}
+
+		columns.resize(graph.neighbors.size());
+		#pragma omp parallel for
+		for (size_t i = 0; i < graph.neighbors.size(); ++i) {
+			if (begin <= graph.neighbors[i] && graph.neighbors[i] < end) {
+				columns[i] = graph.neighbors[i] - begin;
+			} else {
+				columns[i] = end - begin + std::lower_bound(ids.begin(), ids.end(), graph.neighbors[i]) - ids.begin();
+			}
+		}
+	}
+
+	size_t size() const
+	{
+		return end - begin + ids.size();
+	}
+
+	// copy values of local vertices to neighbors
+	void synchronize(std::vector<esint> &values) const
+	{
+		std::vector<std::vector<esint> > sBuffer(neighbors.size()), rBuffer(neighbors.size());
+		for (size_t n = 0; n < neighbors.size(); ++n) {
+			for (size_t i = 0; i < send[n].size(); ++i) {
+				sBuffer[n].push_back(values[send[n][i]]);
+			}
+			rBuffer[n].resize(recv[n].size());
+		}
+		if (!Communication::exchangeKnownSize(sBuffer, rBuffer, neighbors)) {
+			eslog::internalFailure("cannot synchronize values of dual graph halo.\n");
+		}
+		for (size_t n = 0; n < neighbors.size(); ++n) {
+			for (size_t i = 0; i < recv[n].size(); ++i) {
+				values[recv[n][i]] = rBuffer[n][i];
+			}
+		}
+	}
+
+	int neighbor(const DualGraph &graph, esint vertex) const
+	{
+		int rank = std::upper_bound(graph.distribution.begin(), graph.distribution.end(), vertex) - graph.distribution.begin() - 1;
+		return std::lower_bound(neighbors.begin(), neighbors.end(), rank) - neighbors.begin();
+	}
+};
+
+// both end points of an edge have to compute the same priority
+static uint64_t priority(esint v, esint u)
+{
+	uint64_t h = (uint64_t)std::min(v, u) * 0x9E3779B97F4A7C15ull ^ (uint64_t)std::max(v, u) * 0xC2B2AE3D27D4EB4Full;
+	return h ^ (h >> 31);
+}
+
+// distributed heavy edge matching (a vertex is matched with the neighbor connected by the heaviest edge if both agree)
+bool coarsenDualGraph(const DualGraph &fine, DualGraph &coarse, std::vector<esint> &map, esint maxvweight)
+{
+	int rounds = 8;
+	DualHalo halo(fine);
+	esint vertices = halo.end - halo.begin;
+
+	std::vector<esint> vweights(halo.size()), match(halo.size(), -1), column(vertices, -1);
+	std::copy(fine.vweights.begin(), fine.vweights.end(), vweights.begin());
+	halo.synchronize(vweights);
+
+	size_t threads = info::env::threads;
+	std::vector<size_t> distribution = tarray<size_t>::distribute(threads, vertices);
+
+	for (int round = 0; round < rounds; ++round) {
+		std::vector<esint> proposal(halo.size(), -1);
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			for (size_t v = distribution[t]; v < distribution[t + 1]; ++v) {
+				if (match[v] != -1) {
+					continue;
+				}
+				esint gv = halo.begin + v, best = -1, bestweight = 0;
+				uint64_t bestpriority = 0;
+				for (esint i = fine.frames[v]; i < fine.frames[v + 1]; ++i) {
+					esint c = halo.columns[i];
+					if (match[c] != -1 || vweights[v] + vweights[c] > maxvweight) {
+						continue;
+					}
+					uint64_t p = priority(gv, fine.neighbors[i]);
+					if (best == -1 || bestweight < fine.eweights[i] || (bestweight == fine.eweights[i] && bestpriority < p)) {
+						best = i;
+						bestweight = fine.eweights[i];
+						bestpriority = p;
+					}
+				}
+				if (best != -1) {
+					proposal[v] = fine.neighbors[best];
+					column[v] = halo.columns[best];
+				}
+			}
+		}
+		halo.synchronize(proposal);
+
+		esint matched = 0;
+		#pragma omp parallel for reduction(+:matched)
+		for (size_t t = 0; t < threads; t++) {
+			for (size_t v = distribution[t]; v < distribution[t + 1]; ++v) {
+				if (proposal[v] != -1 && proposal[column[v]] == halo.begin + (esint)v) {
+					match[v] = proposal[v];
+					++matched;
+				}
+			}
+		}
+		halo.synchronize(match);
+
+		esint total;
+		Communication::allReduce(&matched, &total, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
+		if (total == 0) {
+			break;
+		}
+	}
+
+	// the coarse vertex is stored by the owner of the matched vertex with the lower index
+	std::vector<esint> cmap(halo.size(), -1);
+	esint owned = 0;
+	for (esint v = 0; v < vertices; ++v) {
+		if (match[v] == -1) {
+			match[v] = halo.begin + v;
+		}
+		if (halo.begin + v <= match[v]) {
+			cmap[v] = owned++;
+		}
+	}
+
+	coarse.distribution = Communication::getDistribution<esint>(owned);
+	esint cbegin = coarse.distribution[info::mpi::rank], cend = coarse.distribution[info::mpi::rank + 1];
+
+	esint ftotal = fine.distribution.back(), ctotal = coarse.distribution.back();
+	if (ftotal * 0.9 < ctotal) {
+		return false;
+	}
+
+	for (esint v = 0; v < vertices; ++v) {
+		if (cmap[v] != -1) {
+			cmap[v] += cbegin;
+		} else if (halo.begin <= match[v] && match[v] < halo.end) {
+			cmap[v] = cmap[match[v] - halo.begin];
+		}
+	}
+	halo.synchronize(cmap);
+	for (esint v = 0; v < vertices; ++v) {
+		if (cmap[v] == -1) {
+			cmap[v] = cmap[column[v]];
+		}
+	}
+	halo.synchronize(cmap);
+
+	// vertices matched with a vertex of other rank are sent to the owner: coarse vertex, weight, degree, [neighbor, weight]
+	std::vector<std::vector<esint> > sBuffer(halo.neighbors.size()), rBuffer(halo.neighbors.size());
+	for (esint v = 0; v < vertices; ++v) {
+		if (cmap[v] < cbegin || cend <= cmap[v]) {
+			std::vector<esint> &buffer = sBuffer[halo.neighbor(fine, match[v])];
+			buffer.push_back(cmap[v]);
+			buffer.push_back(fine.vweights[v]);
+			buffer.push_back(0);
+			size_t degree = buffer.size() - 1;
+			for (esint i = fine.frames[v]; i < fine.frames[v + 1]; ++i) {
+				if (cmap[halo.columns[i]] != cmap[v]) {
+					buffer.push_back(cmap[halo.columns[i]]);
+					buffer.push_back(fine.eweights[i]);
+					++buffer[degree];
+				}
+			}
+		}
+	}
+	if (!Communication::exchangeUnknownSize(sBuffer, rBuffer, halo.neighbors)) {
+		eslog::internalFailure("cannot exchange matched vertices of dual graph.\n");
+	}
+
+	std::vector<esint> remote, cfine(2 * (cend - cbegin), -1), cremote(cend - cbegin, -1);
+	for (size_t n = 0; n < rBuffer.size(); ++n) {
+		for (size_t i = 0; i < rBuffer[n].size(); i += 3 + 2 * rBuffer[n][i + 2]) {
+			cremote[rBuffer[n][i] - cbegin] = remote.size();
+			remote.insert(remote.end(), rBuffer[n].begin() + i, rBuffer[n].begin() + i + 3 + 2 * rBuffer[n][i + 2]);
+		}
+	}
+	for (esint v = 0; v < vertices; ++v) {
+		if (cbegin <= cmap[v] && cmap[v] < cend) {
+			esint c = cmap[v] - cbegin;
+			cfine[2 * c + (cfine[2 * c] == -1 ? 0 : 1)] = v;
+		}
+	}
+
+	std::vector<size_t> cdistribution = tarray<size_t>::distribute(threads, cend - cbegin);
+	std::vector<std::vector<esint> > tneighbors(threads), teweights(threads);
+	coarse.frames.resize(cend - cbegin + 1);
+	coarse.vweights.resize(cend - cbegin);
+
+	#pragma omp parallel for
+	for (size_t t = 0; t < threads; t++) {
+		std::vector<std::pair<esint, esint> > edges;
+		std::vector<esint> neighbors, eweights;
+		for (size_t c = cdistribution[t]; c < cdistribution[t + 1]; ++c) {
+			edges.clear();
+			coarse.vweights[c] = 0;
+			for (int f = 0; f < 2; ++f) {
+				esint v = cfine[2 * c + f];
+				if (v != -1) {
+					coarse.vweights[c] += fine.vweights[v];
+					for (esint i = fine.frames[v]; i < fine.frames[v + 1]; ++i) {
+						if (cmap[halo.columns[i]] != cbegin + (esint)c) {
+							edges.push_back(std::make_pair(cmap[halo.columns[i]], fine.eweights[i]));
+						}
+					}
+				}
+			}
+			if (cremote[c] != -1) {
+				const esint *r = remote.data() + cremote[c];
+				coarse.vweights[c] += r[1];
+				for (esint e = 0; e < r[2]; ++e) {
+					edges.push_back(std::make_pair(r[3 + 2 * e], r[4 + 2 * e]));
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			for (size_t e = 0; e < edges.size(); ++e) {
+				if (e && edges[e - 1].first == edges[e].first) {
+					eweights.back() += edges[e].second;
+				} else {
+					neighbors.push_back(edges[e].first);
+					eweights.push_back(edges[e].second);
+				}
+			}
+			coarse.frames[c + 1] = neighbors.size();
+		}
+		tneighbors[t].swap(neighbors);
+		teweights[t].swap(eweights);
+	}
+
+	utils::threadDistributionToFullDistribution(coarse.frames, cdistribution);
+	coarse.neighbors.clear();
+	coarse.eweights.clear();
+	for (size_t t = 0; t < threads; t++) {
+		coarse.neighbors.insert(coarse.neighbors.end(), tneighbors[t].begin(), tneighbors[t].end());
+		coarse.eweights.insert(coarse.eweights.end(), teweights[t].begin(), teweights[t].end());
+	}
+
+	map.assign(cmap.begin(), cmap.begin() + vertices);
+	return true;
+}
+
+void projectPartition(const DualGraph &fine, const std::vector<esint> &map, const DualGraph &coarse, const std::vector<esint> &cpartition, std::vector<esint> &partition)
+{
+	esint cbegin = coarse.distribution[info::mpi::rank], cend = coarse.distribution[info::mpi::rank + 1];
+
+	// a coarse vertex is stored by a neighboring rank of the fine graph
+	DualHalo halo(fine);
+	std::vector<std::vector<esint> > sRequest(halo.neighbors.size()), rRequest(halo.neighbors.size());
+	std::vector<std::vector<esint> > sPartition(halo.neighbors.size()), rPartition(halo.neighbors.size());
+	partition.resize(map.size());
+	for (size_t v = 0; v < map.size(); ++v) {
+		if (cbegin <= map[v] && map[v] < cend) {
+			partition[v] = cpartition[map[v] - cbegin];
+		} else {
+			sRequest[halo.neighbor(coarse, map[v])].push_back(map[v]);
+		}
+	}
+	if (!Communication::exchangeUnknownSize(sRequest, rRequest, halo.neighbors)) {
+		eslog::internalFailure("cannot request partition of coarse vertices.\n");
+	}
+	for (size_t n = 0; n < halo.neighbors.size(); ++n) {
+		for (size_t i = 0; i < rRequest[n].size(); ++i) {
+			sPartition[n].push_back(cpartition[rRequest[n][i] - cbegin]);
+		}
+		rPartition[n].resize(sRequest[n].size());
+	}
+	if (!Communication::exchangeKnownSize(sPartition, rPartition, halo.neighbors)) {
+		eslog::internalFailure("cannot exchange partition of coarse vertices.\n");
+	}
+	std::vector<size_t> offset(halo.neighbors.size());
+	for (size_t v = 0; v < map.size(); ++v) {
+		if (map[v] < cbegin || cend <= map[v]) {
+			size_t n = halo.neighbor(coarse, map[v]);
+			partition[v] = rPartition[n][offset[n]++];
+		}
+	}
+}
+
+// greedy moves of boundary vertices to parts with the highest gain
+// parts are visited in alternating directions in order to avoid swapping of vertices between ranks
+esint refinePartition(const DualGraph &graph, esint parts, double tolerance, std::vector<esint> &partition)
+{
+	int passes = 8;
+	DualHalo halo(graph);
+	esint vertices = halo.end - halo.begin;
+
+	std::vector<esint> part(halo.size()), pweights(parts);
+	std::copy(partition.begin(), partition.end(), part.begin());
+	halo.synchronize(part);
+	for (esint v = 0; v < vertices; ++v) {
+		pweights[part[v]] += graph.vweights[v];
+	}
+	Communication::allReduce(pweights, Communication::OP::SUM);
+	double maxpweight = tolerance * std::accumulate(pweights.begin(), pweights.end(), 0.0) / parts;
+
+	std::vector<std::pair<esint, esint> > connections;
+	for (int pass = 0; pass < passes; ++pass) {
+		std::vector<esint> delta(parts);
+		std::vector<double> budget(parts);
+		for (esint p = 0; p < parts; ++p) {
+			budget[p] = std::max(0.0, maxpweight - pweights[p]) / (halo.neighbors.size() + 1);
+		}
+
+		esint moved = 0;
+		for (esint v = 0; v < vertices; ++v) {
+			esint p = part[v], internal = 0;
+			connections.clear();
+			for (esint i = graph.frames[v]; i < graph.frames[v + 1]; ++i) {
+				esint q = part[halo.columns[i]];
+				if (q == p) {
+					internal += graph.eweights[i];
+				} else {
+					connections.push_back(std::make_pair(q, graph.eweights[i]));
+				}
+			}
+			if (connections.empty()) {
+				continue;
+			}
+			std::sort(connections.begin(), connections.end());
+			esint best = -1, bestgain = 0;
+			for (size_t c = 0, e = 0; c < connections.size(); c = e) {
+				esint q = connections[c].first, gain = -internal;
+				for (e = c; e < connections.size() && connections[e].first == q; ++e) {
+					gain += connections[e].second;
+				}
+				if ((pass % 2 == 0) != (p < q) || budget[q] < graph.vweights[v]) {
+					continue;
+				}
+				if (bestgain < gain || (gain == bestgain && pweights[p] + delta[p] > maxpweight && (best == -1 || pweights[q] < pweights[best]))) {
+					best = q;
+					bestgain = gain;
+				}
+			}
+			if (best != -1) {
+				part[v] = best;
+				budget[best] -= graph.vweights[v];
+				delta[p] -= graph.vweights[v];
+				delta[best] += graph.vweights[v];
+				++moved;
+			}
+		}
+
+		esint total;
+		Communication::allReduce(&moved, &total, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
+		if (total == 0) {
+			break;
+		}
+		Communication::allReduce(delta, Communication::OP::SUM);
+		for (esint p = 0; p < parts; ++p) {
+			pweights[p] += delta[p];
+		}
+		halo.synchronize(part);
+	}
+
+	esint edgecut = 0, total;
+	for (esint v = 0; v < vertices; ++v) {
+		for (esint i = graph.frames[v]; i < graph.frames[v + 1]; ++i) {
+			if (part[v] != part[halo.columns[i]]) {
+				edgecut += graph.eweights[i];
+			}
+		}
+	}
+	Communication::allReduce(&edgecut, &total, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
+
+	std::copy(part.begin(), part.begin() + vertices, partition.begin());
+	return total / 2;
+}
+
+}
+}
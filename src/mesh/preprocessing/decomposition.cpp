@@ -45,11 +45,15 @@ void computeDecomposedDual(const ElementStore *elements, std::vector<esint> &dua
 	std::vector<esint> dDistribution(elements->distribution.process.size + 1);
 	std::vector<std::vector<esint> > dData(threads);
 
+	std::vector<esint> signatures;
+	if (separateRegions) {
+		computeRegionsSignatures(elements, NULL, signatures);
+	}
+
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
 		std::vector<esint> tdata;
 		int mat1 = 0, mat2 = 0, reg = 0, etype1 = 0, etype2 = 0;
-		int rsize = separateRegions ? elements->regions->edataSize() : 0;
 
 		auto neighs = elements->faceNeighbors->cbegin(t);
 		for (size_t e = elements->distribution.threads[t]; e < elements->distribution.threads[t + 1]; ++e, ++neighs) {
@@ -60,7 +64,7 @@ void computeDecomposedDual(const ElementStore *elements, std::vector<esint> &dua
 						mat2 = elements->material->datatarray()[*n - eBegin];
 					}
 					if (separateRegions) {
-						reg = memcmp(elements->regions->datatarray().data() + e * rsize, elements->regions->datatarray().data() + (*n - eBegin) * rsize, sizeof(esint) * rsize);
+						reg = signatures[e] != signatures[*n - eBegin];
 					}
 					if (separateEtypes) {
 						etype1 = (int)elements->epointers->datatarray()[e]->type;
@@ -36,6 +36,8 @@ void computeElementIntervals(const DomainStore *domains, ElementStore *elements)
 {
 	size_t threads = info::env::threads;
 	std::vector<std::vector<esint> > iboundaries(threads);
+	std::vector<esint> signatures;
+	computeRegionsSignatures(elements, NULL, signatures);
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
 		for (size_t d = domains->distribution[t]; d < domains->distribution[t + 1]; ++d) {
@@ -46,7 +48,7 @@ void computeElementIntervals(const DomainStore *domains, ElementStore *elements)
 				if (elements->epointers->datatarray()[e]->code != elements->epointers->datatarray()[e - 1]->code) {
 					iboundaries[t].push_back(e);
 				}
-				if (memcmp(elements->regions->datatarray().data() + e * elements->regions->edataSize(), elements->regions->datatarray().data() + (e - 1) * elements->regions->edataSize(), sizeof(esint) * elements->regions->edataSize())) {
+				if (signatures[e] != signatures[e - 1]) {
 					iboundaries[t].push_back(e);
 				}
 			}
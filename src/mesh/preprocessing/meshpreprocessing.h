@@ -22,6 +22,7 @@ struct SurfaceStore;
 struct ContactStore;
 struct BodyStore;
 struct ClusterStore;
+struct PartitionInfo;
 struct ElementsInterval;
 struct ElementsDistributionInfo;
 template <typename TEBoundaries, typename TEData> class serializededata;
@@ -63,7 +64,16 @@ void computeElementsCenters(const NodeStore *nodes, ElementStore *elements);
 int getStronglyConnectedComponents(const ElementStore *elements, std::vector<int> &component);
 void computeComponentDual(const ElementStore *elements, esint coffset, esint csize, const std::vector<int> &component, const std::vector<int> &neighbors, std::vector<esint> &dualDist, std::vector<esint> &dualData);
 
-void computeElementsClusterization(const ElementStore *elements, const NodeStore *nodes, std::vector<esint> &partition);
+// distributed (weighted) dual graph, vertices of ranks are given by 'distribution'
+struct DualGraph {
+	std::vector<esint> distribution, frames, neighbors, vweights, eweights;
+};
+
+bool coarsenDualGraph(const DualGraph &fine, DualGraph &coarse, std::vector<esint> &map, esint maxvweight);
+void projectPartition(const DualGraph &fine, const std::vector<esint> &map, const DualGraph &coarse, const std::vector<esint> &cpartition, std::vector<esint> &partition);
+esint refinePartition(const DualGraph &graph, esint parts, double tolerance, std::vector<esint> &partition);
+
+esint computeElementsClusterization(const ElementStore *elements, const NodeStore *nodes, std::vector<esint> &partition);
 void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<ElementsRegionStore*> &elementsRegions, std::vector<BoundaryRegionStore*> &boundaryRegions, std::vector<int> &neighbors, std::vector<int> &neighborsWithMe, const std::vector<esint> &partition);
 void computeContinuousClusterization(const ElementStore *elements, const NodeStore *nodes, const std::vector<esint> &dualDist, const std::vector<esint> &dualData, esint coffset, esint csize, const std::vector<int> &component, const std::vector<int> &neighborsWithMe, std::vector<esint> &partition);
 
@@ -79,6 +89,8 @@ void computeRegionsElementDistribution(const ElementStore *elements, std::vector
 
 void fillRegionMask(ElementStore *elements, const std::vector<ElementsRegionStore*> &elementsRegions);
 void processNamelessElements(ElementStore *elements, std::vector<ElementsRegionStore*> &elementsRegions);
+// elements (local followed by halo) with the same signature belong to the same regions
+void computeRegionsSignatures(const ElementStore *elements, const ElementStore *halo, std::vector<esint> &signatures);
 
 ElementStore* exchangeHalo(ElementStore *elements, NodeStore *nodes, std::vector<int> &neighbors);
 
@@ -126,6 +138,7 @@ void computeNodeDomainDistribution(ElementStore *elements, NodeStore *nodes, Dom
 void computeLocalIndices(ElementStore *elements, DomainStore *domains);
 
 void computeElementIntervals(const DomainStore *domains, ElementStore *elements);
+void computePartitionInfo(const ElementStore *elements, const NodeStore *nodes, const DomainStore *domains, const ClusterStore *clusters, const std::vector<int> &neighbors, PartitionInfo &partition);
 
 void computeRegionsElementIntervals(const ElementStore *elements, std::vector<ElementsRegionStore*> &elementsRegions);
 void computeRegionsBoundaryIntervals(const DomainStore *domains, std::vector<BoundaryRegionStore*> &boundaryRegions, std::vector<ContactInterfaceStore*> &contactInterfaces);
@@ -0,0 +1,141 @@
+
+#include "meshpreprocessing.h"
+
+#include "mesh/store/elementstore.h"
+#include "mesh/store/nodestore.h"
+#include "mesh/store/domainstore.h"
+#include "mesh/store/clusterstore.h"
+#include "mesh/store/partitioninfo.h"
+#include "basis/containers/serializededata.h"
+#include "esinfo/envinfo.h"
+#include "esinfo/eslog.hpp"
+#include "esinfo/mpiinfo.h"
+#include "wrappers/mpi/communication.h"
+
+#include <algorithm>
+
+namespace mesio {
+namespace mesh {
+
+// label all elements face connected to 'seed' within the interval [begin, end) that satisfy 'same'
+template <typename TSame>
+static void fillPart(const ElementStore *elements, esint seed, esint begin, esint end, std::vector<esint> &label, TSame same)
+{
+	esint eoffset = elements->distribution.process.offset;
+	std::vector<esint> stack(1, seed);
+	label[seed] = seed;
+	while (stack.size()) {
+		auto neighs = elements->faceNeighbors->cbegin() + stack.back();
+		stack.pop_back();
+		for (auto n = neighs->begin(); n != neighs->end(); ++n) {
+			esint ln = *n - eoffset;
+			if (*n != -1 && begin <= ln && ln < end && label[ln] == -1 && same(seed, ln)) {
+				label[ln] = seed;
+				stack.push_back(ln);
+			}
+		}
+	}
+}
+
+void computePartitionInfo(const ElementStore *elements, const NodeStore *nodes, const DomainStore *domains, const ClusterStore *clusters, const std::vector<int> &neighbors, PartitionInfo &partition)
+{
+	int threads = info::env::threads;
+	esint ebegin = elements->distribution.process.offset, eend = elements->distribution.process.next;
+
+	std::vector<esint> tcut(threads), tvolume(threads), tinterface(threads);
+	#pragma omp parallel for
+	for (int t = 0; t < threads; ++t) {
+		esint cut = 0, volume = 0, interface = 0;
+		for (auto neighs = elements->faceNeighbors->cbegin(t); neighs != elements->faceNeighbors->cend(t); ++neighs) {
+			for (auto n = neighs->begin(); n != neighs->end(); ++n) {
+				if (*n != -1 && (*n < ebegin || eend <= *n)) {
+					++cut;
+				}
+			}
+		}
+		for (auto ranks = nodes->ranks->cbegin(t); ranks != nodes->ranks->cend(t); ++ranks) {
+			if (ranks->size() > 1) {
+				volume += ranks->size() - 1;
+				++interface;
+			}
+		}
+		tcut[t] = cut;
+		tvolume[t] = volume;
+		tinterface[t] = interface;
+	}
+
+	// domains are processed by threads, clusters by the whole process since they can span domains of all threads
+	std::vector<esint> label(elements->distribution.process.size, -1), edomain(elements->distribution.process.size);
+	std::vector<esint> dparts(domains->size);
+	#pragma omp parallel for
+	for (int t = 0; t < threads; ++t) {
+		for (size_t d = domains->distribution[t]; d < domains->distribution[t + 1]; ++d) {
+			std::fill(edomain.begin() + domains->elements[d], edomain.begin() + domains->elements[d + 1], d);
+			for (esint e = domains->elements[d]; e < domains->elements[d + 1]; ++e) {
+				if (label[e] == -1) {
+					fillPart(elements, e, domains->elements[d], domains->elements[d + 1], label, [] (esint, esint) { return true; });
+					++dparts[d];
+				}
+			}
+		}
+	}
+	std::fill(label.begin(), label.end(), -1);
+	std::vector<esint> cparts(clusters->size);
+	for (esint e = 0; e < elements->distribution.process.size; ++e) {
+		if (label[e] == -1) {
+			fillPart(elements, e, 0, elements->distribution.process.size, label, [&] (esint e1, esint e2) {
+				return domains->cluster[edomain[e1]] == domains->cluster[edomain[e2]];
+			});
+			++cparts[domains->cluster[edomain[e]]];
+		}
+	}
+
+	esint cut = 0, volume = 0, interface = 0;
+	for (int t = 0; t < threads; ++t) {
+		cut += tcut[t];
+		volume += tvolume[t];
+		interface += tinterface[t];
+	}
+	double ratio = nodes->size ? (double)interface / nodes->size : 0;
+
+	esint sum[6] = {
+			cut, volume, (esint)neighbors.size(),
+			(esint)std::count_if(dparts.begin(), dparts.end(), [] (esint parts) { return parts > 1; }),
+			(esint)std::count_if(cparts.begin(), cparts.end(), [] (esint parts) { return parts > 1; }),
+			domains->size };
+	esint max[6] = {
+			volume, (esint)neighbors.size(), elements->distribution.process.size, nodes->uniqInfo.size,
+			dparts.size() ? *std::max_element(dparts.begin(), dparts.end()) : 0,
+			cparts.size() ? *std::max_element(cparts.begin(), cparts.end()) : 0 };
+	esint min = neighbors.size();
+	double dmax[2] = { ratio, -ratio }, dsum = ratio;
+
+	Communication::allReduce(sum, NULL, 6, MPITools::getType<esint>().mpitype, MPI_SUM);
+	Communication::allReduce(max, NULL, 6, MPITools::getType<esint>().mpitype, MPI_MAX);
+	Communication::allReduce(&min, NULL, 1, MPITools::getType<esint>().mpitype, MPI_MIN);
+	Communication::allReduce(dmax, NULL, 2, MPI_DOUBLE, MPI_MAX);
+	Communication::allReduce(&dsum, NULL, 1, MPI_DOUBLE, MPI_SUM);
+
+	partition.edgecut = sum[0] / 2;
+	partition.volume = sum[1];
+	partition.maxVolume = max[0];
+	partition.minNeighbors = min;
+	partition.maxNeighbors = max[1];
+	partition.avgNeighbors = (double)sum[2] / info::mpi::size;
+	partition.elementImbalance = (double)max[2] * info::mpi::size / elements->distribution.process.totalSize;
+	partition.nodeImbalance = (double)max[3] * info::mpi::size / nodes->uniqInfo.totalSize;
+	partition.domains = sum[5];
+	partition.disconnectedDomains = sum[3];
+	partition.maxDomainParts = max[4];
+	partition.clusters = clusters->totalSize;
+	partition.disconnectedClusters = sum[4];
+	partition.maxClusterParts = max[5];
+	partition.minInterfaceRatio = -dmax[1];
+	partition.maxInterfaceRatio = dmax[0];
+	partition.avgInterfaceRatio = dsum / info::mpi::size;
+
+	eslog::checkpointln("MESH: PARTITION QUALITY EVALUATED");
+}
+
+}
+}
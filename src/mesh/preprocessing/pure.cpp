@@ -1,8 +1,11 @@
 
 #include "meshpreprocessing.h"
 
+#include "basis/containers/arena.h"
 #include "basis/containers/serializededata.h"
+#include "basis/logging/tracelogger.h"
 #include "basis/sfc/hilbertcurve.h"
+#include "basis/structures/roaringbitmap.h"
 #include "basis/utilities/utils.h"
 #include "basis/utilities/parser.h"
 #include "esinfo/config.h"
@@ -25,6 +28,7 @@
 #include "wrappers/scotch/w.scotch.h"
 
 #include <vector>
+#include <limits>
 #include <numeric>
 #include <algorithm>
 
@@ -182,45 +186,37 @@ void linkNodesAndElements(
 		std::sort(localLinks.begin(), localLinks.end());
 	}
 
-	std::vector<std::vector<esint> > linksBoundaries(threads);
-	std::vector<std::vector<esint> > linksData(threads);
+	auto key = [&] (size_t n) -> esint {
+		return sortedIDs ? nIDs->datatarray()[n] : (esint)n;
+	};
 
+	std::vector<size_t> lbegin(threads), llink(threads);
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
 		if (ndistribution[t] != ndistribution[t + 1]) {
-			auto llink = localLinks.begin();
-			if (sortedIDs) {
-				llink = std::lower_bound(localLinks.begin(), localLinks.end(), nIDs->datatarray()[ndistribution[t]], [] (std::pair<esint, esint> &p, esint n) { return p.first < n; });
-			} else {
-				llink = std::lower_bound(localLinks.begin(), localLinks.end(), ndistribution[t], [] (std::pair<esint, esint> &p, esint n) { return p.first < n; });
-			}
-			esint current;
-
-			std::vector<esint> tBoundaries, tData;
-			if (t == 0) {
-				tBoundaries.push_back(0);
-			}
-
-			for (size_t n = ndistribution[t]; n < ndistribution[t + 1] && llink != localLinks.end(); ++n) {
-				current = llink->first;
-				if (
-						(sortedIDs && current == nIDs->datatarray()[n]) ||
-						(!sortedIDs && current == (esint)n)) {
+			lbegin[t] = std::lower_bound(localLinks.begin(), localLinks.end(), key(ndistribution[t]), [] (std::pair<esint, esint> &p, esint n) { return p.first < n; }) - localLinks.begin();
+		}
+		llink[t] = lbegin[t];
+	}
 
-					while (llink != localLinks.end() && current == llink->first) {
-						tData.push_back(llink->second);
-						++llink;
-					}
-				}
-				tBoundaries.push_back(llink - localLinks.begin());
-			}
+	auto count = [&] (size_t t, size_t n) {
+		size_t begin = llink[t];
+		while (llink[t] < localLinks.size() && localLinks[llink[t]].first == key(n)) {
+			++llink[t];
+		}
+		return llink[t] - begin;
+	};
 
-			linksBoundaries[t].swap(tBoundaries);
-			linksData[t].swap(tData);
+	auto fill = [&] (size_t t, size_t n, esint *data) {
+		if (n == ndistribution[t]) {
+			llink[t] = lbegin[t];
 		}
-	}
+		for (; llink[t] < localLinks.size() && localLinks[llink[t]].first == key(n); ++llink[t]) {
+			*data++ = localLinks[llink[t]].second;
+		}
+	};
 
-	nelements = new serializededata<esint, esint>(linksBoundaries, linksData);
+	nelements = serializededata<esint, esint>::build(ndistribution, count, fill);
 	eslog::checkpointln("MESH: NODES AND ELEMENTS LINKED");
 }
 
@@ -274,71 +270,79 @@ void computeElementsNeighbors(
 
 	size_t threads = info::env::threads;
 
-	std::vector<std::vector<esint> > dualDistribution(threads);
-	std::vector<std::vector<esint> > dualData(threads);
-
-	#pragma omp parallel for
-	for (size_t t = 0; t < threads; t++) {
-		auto nodes = enodes->cbegin(t);
-
-		std::vector<esint> tdist, tdata, intersection;
-		if (t == 0) {
-			tdist.push_back(0);
-		}
-		for (size_t e = eIDs->datatarray().distribution()[t]; e < eIDs->datatarray().distribution()[t + 1]; ++e, ++nodes) {
-			bool hasNeighbor = false;
-			for (auto interface = across(epointers->datatarray()[e])->begin(); interface != across(epointers->datatarray()[e])->end(); ++interface) {
-				auto telements = nelements->cbegin() + nodes->at(*interface->begin());
-				intersection.clear();
-				for (auto n = telements->begin(); n != telements->end(); ++n) {
-					if (*n != eIDs->datatarray()[e]) {
-						intersection.push_back(*n);
-					}
+	std::vector<std::vector<esint> > intersection(threads);
+	auto intersect = [&] (size_t t, size_t e, serializededata<esint, esint>::const_iterator &nodes, edata<const int> &interface) {
+		auto telements = nelements->cbegin() + nodes->at(*interface.begin());
+		intersection[t].clear();
+		for (auto n = telements->begin(); n != telements->end(); ++n) {
+			if (*n != eIDs->datatarray()[e]) {
+				intersection[t].push_back(*n);
+			}
+		}
+		for (auto n = interface.begin() + 1; n != interface.end() && intersection[t].size(); ++n) {
+			telements = nelements->cbegin() + nodes->at(*n);
+			auto it1 = intersection[t].begin();
+			auto it2 = telements->begin();
+			auto last = intersection[t].begin();
+			while (it1 != intersection[t].end()) {
+				while (it2 != telements->end() && *it2 < *it1) {
+					++it2;
 				}
-				for (auto n = interface->begin() + 1; n != interface->end() && intersection.size(); ++n) {
-					telements = nelements->cbegin() + nodes->at(*n);
-					auto it1 = intersection.begin();
-					auto it2 = telements->begin();
-					auto last = intersection.begin();
-					while (it1 != intersection.end()) {
-						while (it2 != telements->end() && *it2 < *it1) {
-							++it2;
-						}
-						if (it2 == telements->end()) {
-							break;
-						}
-						if (*it1 == *it2) {
-							*last++ = *it1++;
-						} else {
-							it1++;
-						}
-					}
-					intersection.resize(last - intersection.begin());
+				if (it2 == telements->end()) {
+					break;
 				}
-				if (insertNeighSize) {
-					tdata.push_back(intersection.size());
-					tdata.insert(tdata.end(), intersection.begin(), intersection.end());
+				if (*it1 == *it2) {
+					*last++ = *it1++;
 				} else {
-					tdata.push_back(intersection.size() ? intersection.front() : -1);
-					if (intersection.size() > 1) {
-						eslog::error("Input error: a face shared by 3 elements found.\n");
-					}
+					it1++;
 				}
-				hasNeighbor = hasNeighbor | intersection.size();
 			}
-			tdist.push_back(tdata.size());
-//			if (!hasNeighbor && elements->distribution.size != 1) {
-//				eslog::error("Input error: a dangling element found (the element without any neighbor).\n");
-//			}
+			intersection[t].resize(last - intersection[t].begin());
 		}
+	};
 
-		dualDistribution[t].swap(tdist);
-		dualData[t].swap(tdata);
+	std::vector<serializededata<esint, esint>::const_iterator> tnodes;
+	for (size_t t = 0; t < threads; t++) {
+		tnodes.push_back(enodes->cbegin(t));
 	}
 
-	utils::threadDistributionToFullDistribution(dualDistribution);
+	// with max 1 neighbor per face the size is given by the element type, otherwise the first pass only counts intersections
+	auto count = [&] (size_t t, size_t e) {
+		esint size = 0;
+		const serializededata<int, int> *faces = across(epointers->datatarray()[e]);
+		if (insertNeighSize) {
+			for (auto interface = faces->begin(); interface != faces->end(); ++interface) {
+				intersect(t, e, tnodes[t], *interface);
+				size += 1 + intersection[t].size();
+			}
+			++tnodes[t];
+		} else {
+			size = faces->structures();
+		}
+		return size;
+	};
 
-	eneighbors = new serializededata<esint, esint>(dualDistribution, dualData);
+	auto fill = [&] (size_t t, size_t e, esint *data) {
+		const serializededata<int, int> *faces = across(epointers->datatarray()[e]);
+		if (e == eIDs->datatarray().distribution()[t]) {
+			tnodes[t] = enodes->cbegin(t);
+		}
+		for (auto interface = faces->begin(); interface != faces->end(); ++interface) {
+			intersect(t, e, tnodes[t], *interface);
+			if (insertNeighSize) {
+				*data++ = intersection[t].size();
+				data = std::copy(intersection[t].begin(), intersection[t].end(), data);
+			} else {
+				*data++ = intersection[t].size() ? intersection[t].front() : -1;
+				if (intersection[t].size() > 1) {
+					eslog::error("Input error: a face shared by 3 elements found.\n");
+				}
+			}
+		}
+		++tnodes[t];
+	};
+
+	eneighbors = serializededata<esint, esint>::build(eIDs->datatarray().distribution(), count, fill);
 
 	eslog::checkpointln("MESH: ELEMENTS NEIGHBOURS COMPUTED");
 }
@@ -435,6 +439,43 @@ esint getSFCDecomposition(const ElementStore *elements, const NodeStore *nodes,
 	return 0; // edge cut is not computed
 }
 
+// coarsen the dual graph until the graph gathered to roots has bounded size
+static void reduceDualGraph(std::vector<DualGraph> &graphs, std::vector<std::vector<esint> > &maps, esint vertices, int roots)
+{
+	int maxlevels = 30;
+	graphs.front().distribution = Communication::getDistribution<esint>(vertices);
+
+	size_t coarse = info::config::input.decomposition.coarse_graph_size;
+	// a bound beyond the range of esint is never reached
+	if (coarse == 0 || coarse > (size_t)std::numeric_limits<esint>::max() / roots) {
+		return;
+	}
+	esint total = graphs.front().distribution.back();
+	esint target = std::max((esint)(roots * coarse), (esint)(32 * info::mpi::size));
+	if (total <= target) {
+		return;
+	}
+
+	graphs.front().vweights.resize(vertices, 1);
+	graphs.front().eweights.resize(graphs.front().neighbors.size(), 1);
+
+	// coarse vertices are kept small enough to allow balanced partition
+	esint maxvweight = std::max<int64_t>(2, 4 * (int64_t)total / target);
+	while (graphs.back().distribution.back() > target && (int)graphs.size() < maxlevels) {
+		graphs.push_back(DualGraph());
+		maps.push_back(std::vector<esint>());
+		if (!coarsenDualGraph(graphs[graphs.size() - 2], graphs.back(), maps.back(), maxvweight)) {
+			graphs.pop_back();
+			maps.pop_back();
+			break;
+		}
+	}
+	eslog::checkpoint("MESH: DUAL GRAPH COARSENED");
+	eslog::param("LEVELS", (int)graphs.size() - 1);
+	eslog::param("VERTICES", graphs.back().distribution.back());
+	eslog::ln();
+}
+
 esint callParallelDecomposer(const ElementStore *elements, const NodeStore *nodes, std::vector<esint> &eframes, std::vector<esint> &eneighbors, std::vector<esint> &partition)
 {
 	DebugOutput::meshDual(eframes, eneighbors);
@@ -449,7 +490,7 @@ esint callParallelDecomposer(const ElementStore *elements, const NodeStore *node
 			) {
 
 		eslog::checkpointln("MESH: RECLUSTERIZED SKIPPED");
-		return edgecut;
+		return -1;
 	}
 
 	if (info::config::input.decomposition.parallel_decomposer == DecompositionConfiguration::ParallelDecomposer::HILBERT_CURVE) {
@@ -493,31 +534,57 @@ esint callParallelDecomposer(const ElementStore *elements, const NodeStore *node
 		}
 	} else {
 		MPIType type = MPITools::getType<esint>();
-		std::vector<esint> gframes, gneighbors, gpartition, edistribution;
+		std::vector<esint> gframes, gneighbors, gpartition, gvweights, geweights, edistribution;
 		std::vector<size_t> offsets;
 
+		// only a graph of bounded size is gathered to roots
+		int roots = info::config::input.decomposition.parallel_decomposer == DecompositionConfiguration::ParallelDecomposer::METIS ? 1 : MPITools::subset->acrosssize;
+		std::vector<DualGraph> graphs(1);
+		std::vector<std::vector<esint> > maps;
+		graphs.front().frames.swap(eframes);
+		graphs.front().neighbors.swap(eneighbors);
+		reduceDualGraph(graphs, maps, partition.size(), roots);
+
+		std::vector<esint> cpartition(graphs.back().vweights.size(), info::mpi::rank);
+		std::vector<esint> &lpartition = graphs.size() > 1 ? cpartition : partition;
+		esint *vweights = NULL, *eweights = NULL, weights = 0;
+
 		if (info::config::input.decomposition.parallel_decomposer == DecompositionConfiguration::ParallelDecomposer::METIS) {
-			Communication::gatherUnknownSize(eframes, gframes, &MPITools::singleton->within);
-			Communication::gatherUnknownSize(eneighbors, gneighbors, &MPITools::singleton->within);
-			Communication::gatherUnknownSize(partition, gpartition, offsets, &MPITools::singleton->within);
+			Communication::gatherUnknownSize(graphs.back().frames, gframes, &MPITools::singleton->within);
+			Communication::gatherUnknownSize(graphs.back().neighbors, gneighbors, &MPITools::singleton->within);
+			Communication::gatherUnknownSize(lpartition, gpartition, offsets, &MPITools::singleton->within);
+			if (graphs.size() > 1) {
+				Communication::gatherUnknownSize(graphs.back().vweights, gvweights, &MPITools::singleton->within);
+				Communication::gatherUnknownSize(graphs.back().eweights, geweights, &MPITools::singleton->within);
+			}
 		} else {
-			Communication::gatherUnknownSize(eframes, gframes, &MPITools::subset->within);
-			Communication::gatherUnknownSize(eneighbors, gneighbors, &MPITools::subset->within);
-			Communication::gatherUnknownSize(partition, gpartition, offsets, &MPITools::subset->within);
+			Communication::gatherUnknownSize(graphs.back().frames, gframes, &MPITools::subset->within);
+			Communication::gatherUnknownSize(graphs.back().neighbors, gneighbors, &MPITools::subset->within);
+			Communication::gatherUnknownSize(lpartition, gpartition, offsets, &MPITools::subset->within);
+			if (graphs.size() > 1) {
+				Communication::gatherUnknownSize(graphs.back().vweights, gvweights, &MPITools::subset->within);
+				Communication::gatherUnknownSize(graphs.back().eweights, geweights, &MPITools::subset->within);
+			}
+		}
+		if (graphs.size() > 1) {
+			vweights = gvweights.data();
+			eweights = geweights.data();
+			weights = 1;
 		}
 
 		eslog::checkpointln("MESH: MPI PROCESSES REDUCED");
 
+		// frames of ranks are concatenated (a vertex without neighbors can follow the leading zero)
 		auto fixframes = [&] () {
-			size_t size = gframes.size();
-			for (size_t i = 1, j = 1, offset = 0; j < gframes.size(); i++, j++) {
-				while (gframes[j] == 0) {
-					offset += gframes[j++ - 1];
-					--size;
+			std::vector<esint> frames(1, 0);
+			frames.reserve(gpartition.size() + 1);
+			for (size_t r = 0; r + 1 < offsets.size(); ++r) {
+				const esint *rframes = gframes.data() + offsets[r] + r;
+				for (size_t v = 1; v <= offsets[r + 1] - offsets[r]; ++v) {
+					frames.push_back(frames.back() + rframes[v] - rframes[v - 1]);
 				}
-				gframes[i] = gframes[j] + offset;
 			}
-			gframes.resize(size);
+			gframes.swap(frames);
 		};
 
 		if (info::config::input.decomposition.parallel_decomposer == DecompositionConfiguration::ParallelDecomposer::METIS) {
@@ -526,7 +593,7 @@ esint callParallelDecomposer(const ElementStore *elements, const NodeStore *node
 				info::config::input.decomposition.metis_options.continuous = 0;
 				edgecut = METIS::call(info::config::input.decomposition.metis_options,
 						gpartition.size(), gframes.data(), gneighbors.data(),
-						0, NULL, NULL, info::mpi::size, gpartition.data());
+						weights, vweights, eweights, info::mpi::size, gpartition.data());
 				info::config::input.decomposition.metis_options.continuous = 1;
 			}
 			Communication::barrier();
@@ -541,12 +608,12 @@ esint callParallelDecomposer(const ElementStore *elements, const NodeStore *node
 				case DecompositionConfiguration::ParallelDecomposer::PARMETIS:
 					edgecut = ParMETIS::call(ParMETIS::METHOD::ParMETIS_V3_PartKway,
 							MPITools::subset->across, edistribution.data(), gframes.data(), gneighbors.data(),
-							0, NULL, 0, NULL, NULL, gpartition.data());
+							0, NULL, weights, vweights, eweights, gpartition.data());
 					break;
 				case DecompositionConfiguration::ParallelDecomposer::PTSCOTCH:
 					edgecut = PTScotch::call(
 							MPITools::subset->across, edistribution.data(), gframes.data(), gneighbors.data(),
-							0, NULL, 0, NULL, NULL, gpartition.data());
+							0, NULL, weights, vweights, eweights, gpartition.data());
 					break;
 				case DecompositionConfiguration::ParallelDecomposer::HILBERT_CURVE: break; // never accessed
 				}
@@ -572,7 +639,7 @@ esint callParallelDecomposer(const ElementStore *elements, const NodeStore *node
 					prev = edgecut;
 					edgecut = ParMETIS::call(ParMETIS::METHOD::ParMETIS_V3_RefineKway,
 							MPITools::subset->across, edistribution.data(), gframes.data(), gneighbors.data(),
-							0, NULL, 0, NULL, NULL, gpartition.data());
+							0, NULL, weights, vweights, eweights, gpartition.data());
 				}
 			}
 			Communication::barrier(&MPITools::subset->within);
@@ -581,23 +648,37 @@ esint callParallelDecomposer(const ElementStore *elements, const NodeStore *node
 
 		if (info::config::input.decomposition.parallel_decomposer == DecompositionConfiguration::ParallelDecomposer::METIS) {
 			Communication::broadcastUnknownSize(offsets, &MPITools::singleton->within);
-			Communication::scatterv(gpartition, partition, offsets, &MPITools::singleton->within);
+			Communication::scatterv(gpartition, lpartition, offsets, &MPITools::singleton->within);
 			Communication::broadcast(&edgecut, 1, type.mpitype, 0, &MPITools::singleton->within);
 		} else {
 			Communication::broadcastUnknownSize(offsets, &MPITools::subset->within);
-			Communication::scatterv(gpartition, partition, offsets, &MPITools::subset->within);
+			Communication::scatterv(gpartition, lpartition, offsets, &MPITools::subset->within);
 			Communication::broadcast(&edgecut, 1, type.mpitype, 0, &MPITools::subset->within);
 		}
 		eslog::checkpointln("MESH: MPI PROCESSES EXPANDED");
+
+		// the partition is projected to finer graphs and boundary vertices are refined at each level
+		for (size_t l = graphs.size() - 1; l > 0; --l) {
+			std::vector<esint> fpartition;
+			projectPartition(graphs[l - 1], maps[l - 1], graphs[l], cpartition, fpartition);
+			edgecut = refinePartition(graphs[l - 1], info::mpi::size, info::config::input.decomposition.refinement_tolerance, fpartition);
+			cpartition.swap(fpartition);
+		}
+		if (graphs.size() > 1) {
+			partition.swap(cpartition);
+			eslog::checkpointln("MESH: CLUSTERS REFINED ON THE DUAL GRAPH");
+		}
+		graphs.front().frames.swap(eframes);
+		graphs.front().neighbors.swap(eneighbors);
 	}
 
 	return edgecut;
 }
 
-void computeElementsClusterization(const ElementStore *elements, const NodeStore *nodes, std::vector<esint> &partition)
+esint computeElementsClusterization(const ElementStore *elements, const NodeStore *nodes, std::vector<esint> &partition)
 {
 	if (info::mpi::size == 1) {
-		return;
+		return -1; // the decomposer is not called
 	}
 
 	// Disable due to horible scalability
@@ -675,7 +756,7 @@ void computeElementsClusterization(const ElementStore *elements, const NodeStore
 
 	eslog::checkpointln("MESH: DUAL GRAPH COMPUTED");
 
-	callParallelDecomposer(elements, nodes, dDistribution, dData.front(), partition);
+	return callParallelDecomposer(elements, nodes, dDistribution, dData.front(), partition);
 }
 
 int getStronglyConnectedComponents(const ElementStore *elements, std::vector<int> &component)
@@ -782,6 +863,7 @@ void computeContinuousClusterization(const ElementStore *elements, const NodeSto
 void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<ElementsRegionStore*> &elementsRegions, std::vector<BoundaryRegionStore*> &boundaryRegions, std::vector<int> &neighbors, std::vector<int> &neighborsWithMe, const std::vector<esint> &partition)
 {
 	eslog::startln("EXCHANGE EL: STARTED", "EXCHANGE EL");
+	Arena::Scope arena;
 
 	// 0. Compute targets
 	// 1. Serialize element data
@@ -837,7 +919,7 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	std::vector<std::vector<esint> >    elemsNodesData(threads);
 	std::vector<std::vector<esint> >    elemsNeighborsDistribution(threads);
 	std::vector<std::vector<esint> >    elemsNeighborsData(threads);
-	std::vector<std::vector<esint> >    elemsRegions(threads);
+	std::vector<std::vector<double> >   elemsData(threads);
 
 	NodeStore *newNodes = new NodeStore();
 
@@ -845,47 +927,57 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	std::vector<std::vector<Point> >  nodesCoordinates(threads);
 	std::vector<std::vector<esint> >  nodesElemsDistribution(threads);
 	std::vector<std::vector<esint> >  nodesElemsData(threads);
-	std::vector<std::vector<esint> >  nodesRegions(threads);
+	std::vector<std::vector<double> > nodesData(threads);
 
 	std::vector<std::vector<std::vector<esint> > >    boundaryEDistribution(boundaryRegions.size(), std::vector<std::vector<esint> >(threads));
 	std::vector<std::vector<std::vector<esint> > >    boundaryEData(boundaryRegions.size(), std::vector<std::vector<esint> >(threads));
 	std::vector<std::vector<std::vector<Element*> > > boundaryEPointers(boundaryRegions.size(), std::vector<std::vector<Element*> >(threads));
 
-	// regions are transfered via mask
-	int eregionsBitMaskSize = elementsRegions.size() / (8 * sizeof(esint)) + (elementsRegions.size() % (8 * sizeof(esint)) ? 1 : 0);
-	int bregionsBitMaskSize = boundaryRegions.size() / (8 * sizeof(esint)) + (boundaryRegions.size() % (8 * sizeof(esint)) ? 1 : 0);
+	// fields are transfered as values of all fields appended behind the element (node) data
+	size_t edatasize = 0, ndatasize = 0;
+	for (size_t i = 0; i < elements->data.size(); i++) {
+		edatasize += elements->data[i]->dimension;
+	}
+	for (size_t i = 0; i < nodes->data.size(); i++) {
+		ndatasize += nodes->data[i]->dimension;
+	}
 
 	// serialize data that have to be exchanged
 	// the first thread value denotes the thread data size
 
-	// threads x target x elements(id, body, material, code, dualsize, dualdata, nodesize, nodeindices)
-	std::vector<std::vector<std::vector<esint> > > sElements(threads, std::vector<std::vector<esint> >(targets.size(), std::vector<esint>({ 0 })));
-	std::vector<std::vector<esint> > rElements;
+	// arena buffers cannot grow (old buffers are not reclaimed) -> they are reserved to exact sizes before filling
+	// the buffer of the first thread is reserved for data of all threads since it is sent to targets
 
-	// threads x target x nodes(id, point, linksize, links, regionMask) + size
-	std::vector<std::vector<std::vector<esint> > > sNodes(threads, std::vector<std::vector<esint> >(targets.size(), std::vector<esint>({ 0 })));
-	std::vector<std::vector<esint> > rNodes;
+	// threads x target x elements(id, body, material, code, dualsize, dualdata, nodesize, nodeindices, fields)
+	std::vector<std::vector<arenavector<esint> > > sElements(threads);
+	std::vector<arenavector<esint> > rElements;
 
-	// threads x target x boundary(prefix, (code, nodes))
+	// threads x target x nodes(id, point, linksize, links, fields) + size
+	std::vector<std::vector<arenavector<esint> > > sNodes(threads);
+	std::vector<arenavector<esint> > rNodes;
+
+	// threads x target x boundary(prefix, (code, nodes)), sizes are not known in advance -> the common allocator
 	std::vector<std::vector<std::vector<esint> > > sBoundary(threads, std::vector<std::vector<esint> >(targets.size(), std::vector<esint>(boundaryRegions.size())));
 	std::vector<std::vector<esint> > rBoundary;
 
 	// Step 1: Serialize element data
 
-	std::vector<esint> regionElementMask(elements->IDs->datatarray().size() * eregionsBitMaskSize);
+	std::vector<std::vector<size_t> > esize(threads, std::vector<size_t>(targets.size(), 1));
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
-		esint maskOffset = 0;
-		for (size_t r = 0; r < elementsRegions.size(); r++) {
-			maskOffset = r / (8 * sizeof(esint));
-			esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-			auto begin = std::lower_bound(elementsRegions[r]->elements->datatarray().begin(), elementsRegions[r]->elements->datatarray().end(), elements->IDs->datatarray().distribution()[t]);
-			auto end = std::lower_bound(elementsRegions[r]->elements->datatarray().begin(), elementsRegions[r]->elements->datatarray().end(), elements->IDs->datatarray().distribution()[t + 1]);
-			for (auto i = begin; i != end; ++i) {
-				regionElementMask[*i * eregionsBitMaskSize + maskOffset] |= bit;
+		auto enodes = elements->nodes->cbegin(t);
+		auto eneighbors = elements->faceNeighbors->cbegin(t);
+		for (size_t e = elements->IDs->datatarray().distribution()[t]; e < elements->IDs->datatarray().distribution()[t + 1]; ++e, ++enodes, ++eneighbors) {
+			if (partition[e] != info::mpi::rank) {
+				esize[t][t2i(partition[e])] += 6 + enodes->size() + eneighbors->size() + edatasize * sizeof(double) / sizeof(esint);
 			}
 		}
 	}
+	for (size_t t = 1; t < threads; t++) {
+		for (size_t i = 0; i < targets.size(); i++) {
+			esize[0][i] += esize[t][i];
+		}
+	}
 
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
@@ -896,8 +988,13 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 		auto enodes = elements->nodes->cbegin(t);
 		auto eneighbors = elements->faceNeighbors->cbegin(t);
 		auto nIDs = nodes->IDs->datatarray().data();
+		trace::Scope trace("exchangeElements: serialize elements");
 
-		std::vector<std::vector<esint> > tsElements(targets.size(), std::vector<esint>({ 0 }));
+		std::vector<arenavector<esint> > tsElements(targets.size());
+		for (size_t i = 0; i < targets.size(); i++) {
+			tsElements[i].reserve(esize[t][i]);
+			tsElements[i].push_back(0);
+		}
 
 		std::vector<esint>  telemsIDs;
 		std::vector<int>      telemsBody;
@@ -907,7 +1004,7 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 		std::vector<esint>  telemsNodesData;
 		std::vector<esint>  telemsNeighborsDistribution;
 		std::vector<esint>  telemsNeighborsData;
-		std::vector<esint>  telemsRegions;
+		std::vector<double> telemsData;
 		if (t == 0) {
 			telemsNodesDistribution.push_back(0);
 			telemsNeighborsDistribution.push_back(0);
@@ -920,7 +1017,6 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 		telemsEpointer.reserve(1.5 * elements->IDs->datatarray().size() / threads);
 		telemsNodesDistribution.reserve(1.5 * elements->IDs->datatarray().size() / threads);
 		telemsNeighborsDistribution.reserve(1.5 * elements->IDs->datatarray().size() / threads);
-		telemsRegions.reserve(1.5 * elements->IDs->datatarray().size() / threads);
 
 		size_t target;
 		for (size_t e = elements->IDs->datatarray().distribution()[t]; e < elements->IDs->datatarray().distribution()[t + 1]; ++e, ++enodes, ++eneighbors) {
@@ -935,7 +1031,10 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 				telemsNodesDistribution.push_back(telemsNodesData.size());
 				telemsNeighborsData.insert(telemsNeighborsData.end(), eneighbors->begin(), eneighbors->end());
 				telemsNeighborsDistribution.push_back(telemsNeighborsData.size());
-				telemsRegions.insert(telemsRegions.end(), regionElementMask.begin() + e * eregionsBitMaskSize, regionElementMask.begin() + (e + 1) * eregionsBitMaskSize);
+				for (size_t i = 0; i < elements->data.size(); i++) {
+					const std::vector<double> &values = elements->data[i]->data;
+					telemsData.insert(telemsData.end(), values.begin() + e * elements->data[i]->dimension, values.begin() + (e + 1) * elements->data[i]->dimension);
+				}
 			} else {
 				target = t2i(partition[e]);
 				tsElements[target].insert(tsElements[target].end(), { IDs[e], body[e], material[e], static_cast<int>(epointer[e]->code) });
@@ -945,7 +1044,10 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 				}
 				tsElements[target].push_back(eneighbors->size());
 				tsElements[target].insert(tsElements[target].end(), eneighbors->begin(), eneighbors->end());
-				tsElements[target].insert(tsElements[target].end(), regionElementMask.begin() + e * eregionsBitMaskSize, regionElementMask.begin() + (e + 1) * eregionsBitMaskSize);
+				for (size_t i = 0; i < elements->data.size(); i++) {
+					const double *values = elements->data[i]->data.data();
+					tsElements[target].insert(tsElements[target].end(), reinterpret_cast<const esint*>(values + e * elements->data[i]->dimension), reinterpret_cast<const esint*>(values + (e + 1) * elements->data[i]->dimension));
+				}
 			}
 		}
 
@@ -957,7 +1059,7 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 		elemsNodesData[t].swap(telemsNodesData);
 		elemsNeighborsDistribution[t].swap(telemsNeighborsDistribution);
 		elemsNeighborsData[t].swap(telemsNeighborsData);
-		elemsRegions[t].swap(telemsRegions);
+		elemsData[t].swap(telemsData);
 
 		sElements[t].swap(tsElements);
 	}
@@ -966,48 +1068,59 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 
 	// Step 2: Serialize node data
 
-	std::vector<esint> regionNodeMask(nodes->size * bregionsBitMaskSize);
+	esint eBegin = Communication::getDistribution(elements->IDs->datatarray().size())[info::mpi::rank];
+	esint eEnd = eBegin + elements->IDs->datatarray().size();
+
+	std::vector<std::vector<size_t> > nsize(threads, std::vector<size_t>(targets.size(), 1));
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
-		esint maskOffset = 0;
-		for (size_t r = 0; r < boundaryRegions.size(); r++) {
-			if (boundaryRegions[r]->nodes) {
-				maskOffset = r / (8 * sizeof(esint));
-				esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-				auto begin = std::lower_bound(boundaryRegions[r]->nodes->datatarray().begin(), boundaryRegions[r]->nodes->datatarray().end(), nodes->IDs->datatarray().distribution()[t]);
-				auto end = std::lower_bound(boundaryRegions[r]->nodes->datatarray().begin(), boundaryRegions[r]->nodes->datatarray().end(), nodes->IDs->datatarray().distribution()[t + 1]);
-				for (auto i = begin; i != end; ++i) {
-					regionNodeMask[*i * bregionsBitMaskSize + maskOffset] |= bit;
+		auto elems = nodes->elements->cbegin(t);
+		std::vector<bool> last(targets.size());
+		for (size_t n = nodes->IDs->datatarray().distribution()[t]; n < nodes->IDs->datatarray().distribution()[t + 1]; ++n, ++elems) {
+			std::fill(last.begin(), last.end(), false);
+			for (auto e = elems->begin(); e != elems->end(); ++e) {
+				if (eBegin <= *e && *e < eEnd && partition[*e - eBegin] != info::mpi::rank) {
+					size_t target = t2i(partition[*e - eBegin]);
+					if (!last[target]) {
+						nsize[t][target] += 2 + sizeof(Point) / sizeof(esint) + elems->size() + ndatasize * sizeof(double) / sizeof(esint);
+						last[target] = true;
+					}
 				}
 			}
 		}
 	}
-
-	esint eBegin = Communication::getDistribution(elements->IDs->datatarray().size())[info::mpi::rank];
-	esint eEnd = eBegin + elements->IDs->datatarray().size();
+	for (size_t t = 1; t < threads; t++) {
+		for (size_t i = 0; i < targets.size(); i++) {
+			nsize[0][i] += nsize[t][i];
+		}
+	}
 
 	#pragma omp parallel for
 	for (size_t t = 0; t < threads; t++) {
 		const auto &IDs = nodes->IDs->datatarray();
 		const auto &coordinates = nodes->coordinates->datatarray();
 		auto elems = nodes->elements->cbegin(t);
+		trace::Scope trace("exchangeElements: serialize nodes");
 
 		std::vector<esint>  tnodesIDs;
 		std::vector<Point>    tnodesCoordinates;
 		std::vector<esint>  tnodesElemsDistribution;
 		std::vector<esint>  tnodesElemsData;
-		std::vector<esint>  tnodesRegions;
+		std::vector<double> tnodesData;
 
 		if (t == 0) {
 			tnodesElemsDistribution.push_back(0);
 		}
 
-		std::vector<std::vector<esint> > tsNodes(targets.size(), std::vector<esint>({ 0 }));
+		std::vector<arenavector<esint> > tsNodes(targets.size());
+		for (size_t i = 0; i < targets.size(); i++) {
+			tsNodes[i].reserve(nsize[t][i]);
+			tsNodes[i].push_back(0);
+		}
 
 		tnodesIDs.reserve(1.5 * nodes->IDs->datatarray().size() / threads);
 		tnodesCoordinates.reserve(1.5 * nodes->IDs->datatarray().size() / threads);
 		tnodesElemsDistribution.reserve(1.5 * nodes->IDs->datatarray().size() / threads);
-		tnodesRegions.reserve(1.5 * nodes->IDs->datatarray().size() / threads);
 
 		size_t target;
 		std::vector<bool> last(targets.size() + 1); // targets + me
@@ -1021,7 +1134,10 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 						tsNodes[target].insert(tsNodes[target].end(), reinterpret_cast<const esint*>(coordinates.data() + n), reinterpret_cast<const esint*>(coordinates.data() + n + 1));
 						tsNodes[target].push_back(elems->size());
 						tsNodes[target].insert(tsNodes[target].end(), elems->begin(), elems->end());
-						tsNodes[target].insert(tsNodes[target].end(), regionNodeMask.begin() + n * bregionsBitMaskSize, regionNodeMask.begin() + (n + 1) * bregionsBitMaskSize);
+						for (size_t i = 0; i < nodes->data.size(); i++) {
+							const double *values = nodes->data[i]->data.data();
+							tsNodes[target].insert(tsNodes[target].end(), reinterpret_cast<const esint*>(values + n * nodes->data[i]->dimension), reinterpret_cast<const esint*>(values + (n + 1) * nodes->data[i]->dimension));
+						}
 						last[target] = true;
 					}
 					if (!last.back() && partition[*e - eBegin] == info::mpi::rank) {
@@ -1029,7 +1145,10 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 						tnodesCoordinates.push_back(coordinates[n]);
 						tnodesElemsData.insert(tnodesElemsData.end(), elems->begin(), elems->end());
 						tnodesElemsDistribution.push_back(tnodesElemsData.size());
-						tnodesRegions.insert(tnodesRegions.end(), regionNodeMask.begin() + n * bregionsBitMaskSize, regionNodeMask.begin() + (n + 1) * bregionsBitMaskSize);
+						for (size_t i = 0; i < nodes->data.size(); i++) {
+							const std::vector<double> &values = nodes->data[i]->data;
+							tnodesData.insert(tnodesData.end(), values.begin() + n * nodes->data[i]->dimension, values.begin() + (n + 1) * nodes->data[i]->dimension);
+						}
 						last.back() = true;
 					}
 				}
@@ -1040,7 +1159,7 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 		nodesCoordinates[t].swap(tnodesCoordinates);
 		nodesElemsDistribution[t].swap(tnodesElemsDistribution);
 		nodesElemsData[t].swap(tnodesElemsData);
-		nodesRegions[t].swap(tnodesRegions);
+		nodesData[t].swap(tnodesData);
 
 		sNodes[t].swap(tsNodes);
 	}
@@ -1127,6 +1246,87 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	}
 	eslog::checkpointln("EXCHANGE EL: SERIALIZE BOUNDARIES");
 
+	// Step 2.2: Serialize regions (only IDs of regions members are exchanged)
+
+	// target x [elements regions, (region, size, IDs), ..., boundary regions, (region, size, IDs), ...]
+	std::vector<std::vector<esint> > sRegions(targets.size()), rRegions;
+	std::vector<RoaringBitmap> eregions(elementsRegions.size()), nregions(boundaryRegions.size()); // by IDs
+	{
+		std::vector<size_t> section(targets.size()), header(targets.size());
+		auto openSection = [&] () {
+			for (size_t i = 0; i < targets.size(); i++) {
+				section[i] = sRegions[i].size();
+				sRegions[i].push_back(0);
+			}
+		};
+		auto openRegion = [&] (esint r) {
+			for (size_t i = 0; i < targets.size(); i++) {
+				header[i] = sRegions[i].size();
+				sRegions[i].insert(sRegions[i].end(), { r, 0 });
+			}
+		};
+		auto closeRegion = [&] () {
+			for (size_t i = 0; i < targets.size(); i++) {
+				if (sRegions[i].size() == header[i] + 2) {
+					sRegions[i].resize(header[i]);
+				} else {
+					sRegions[i][header[i] + 1] = sRegions[i].size() - header[i] - 2;
+					++sRegions[i][section[i]];
+				}
+			}
+		};
+
+		std::vector<esint> kept;
+		const auto &eIDs = elements->IDs->datatarray();
+		openSection();
+		for (size_t r = 0; r < elementsRegions.size(); r++) {
+			openRegion(r);
+			for (auto e = elementsRegions[r]->elements->datatarray().cbegin(); e != elementsRegions[r]->elements->datatarray().cend(); ++e) {
+				if (partition[*e] == info::mpi::rank) {
+					kept.push_back(eIDs[*e]);
+				} else {
+					sRegions[t2i(partition[*e])].push_back(eIDs[*e]);
+				}
+			}
+			closeRegion();
+			eregions[r] = RoaringBitmap(kept);
+			kept.clear();
+		}
+
+		const auto &nIDs = nodes->IDs->datatarray();
+		std::vector<bool> last(targets.size() + 1); // targets + me
+		openSection();
+		for (size_t r = 0; r < boundaryRegions.size(); r++) {
+			if (boundaryRegions[r]->nodes) {
+				openRegion(r);
+				for (auto n = boundaryRegions[r]->nodes->datatarray().cbegin(); n != boundaryRegions[r]->nodes->datatarray().cend(); ++n) {
+					std::fill(last.begin(), last.end(), false);
+					auto elems = nodes->elements->cbegin() + *n;
+					for (auto e = elems->begin(); e != elems->end(); ++e) {
+						if (eBegin <= *e && *e < eEnd) {
+							if (partition[*e - eBegin] == info::mpi::rank) {
+								if (!last.back()) {
+									kept.push_back(nIDs[*n]);
+									last.back() = true;
+								}
+							} else {
+								size_t target = t2i(partition[*e - eBegin]);
+								if (!last[target]) {
+									sRegions[target].push_back(nIDs[*n]);
+									last[target] = true;
+								}
+							}
+						}
+					}
+				}
+				closeRegion();
+				nregions[r] = RoaringBitmap(kept);
+				kept.clear();
+			}
+		}
+	}
+	eslog::checkpointln("EXCHANGE EL: SERIALIZE REGIONS");
+
 	// Step 3: Send data to target processes
 
 	#pragma omp parallel for
@@ -1153,6 +1353,10 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	if (!Communication::sendVariousTargets(sBoundary[0], rBoundary, targets)) {
 		eslog::internalFailure("exchange boundary data.\n");
 	}
+
+	if (!Communication::sendVariousTargets(sRegions, rRegions, targets)) {
+		eslog::internalFailure("exchange regions data.\n");
+	}
 	eslog::checkpointln("EXCHANGE EL: EXCHANGE");
 
 	// Step 4: Deserialize element data
@@ -1174,7 +1378,7 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 			std::vector<esint>  telemsNodesData;
 			std::vector<esint>  telemsNeighborsDistribution;
 			std::vector<esint>  telemsNeighborsData;
-			std::vector<esint>  telemsRegions;
+				std::vector<double> telemsData;
 
 			telemsIDs.reserve(rdistribution[t + 1] - rdistribution[t]);
 			telemsBody.reserve(rdistribution[t + 1] - rdistribution[t]);
@@ -1182,7 +1386,6 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 			telemsEpointer.reserve(rdistribution[t + 1] - rdistribution[t]);
 			telemsNodesDistribution.reserve(rdistribution[t + 1] - rdistribution[t] + 1);
 			telemsNeighborsDistribution.reserve(rdistribution[t + 1] - rdistribution[t] + 1);
-			telemsRegions.reserve(rdistribution[t + 1] - rdistribution[t]);
 
 			esint distOffset = 0, neighOffset = 0;
 
@@ -1210,8 +1413,9 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 				telemsNeighborsData.insert(telemsNeighborsData.end(), rElements[i].begin() + e + 1, rElements[i].begin() + e + 1 + rElements[i][e]);
 				telemsNeighborsDistribution.push_back(telemsNeighborsData.size() + neighOffset);
 				e += rElements[i][e++]; // neighbors + neighbors size
-				telemsRegions.insert(telemsRegions.end(), rElements[i].begin() + e, rElements[i].begin() + e + eregionsBitMaskSize);
-				e += eregionsBitMaskSize;
+				telemsData.resize(telemsData.size() + edatasize);
+				memcpy(telemsData.data() + telemsData.size() - edatasize, rElements[i].data() + e, edatasize * sizeof(double));
+				e += edatasize * sizeof(double) / sizeof(esint);
 			}
 
 			elemsIDs[t].insert(elemsIDs[t].end(), telemsIDs.begin(), telemsIDs.end());
@@ -1222,7 +1426,7 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 			elemsNodesData[t].insert(elemsNodesData[t].end(), telemsNodesData.begin(), telemsNodesData.end());
 			elemsNeighborsDistribution[t].insert(elemsNeighborsDistribution[t].end(), telemsNeighborsDistribution.begin(), telemsNeighborsDistribution.end());
 			elemsNeighborsData[t].insert(elemsNeighborsData[t].end(), telemsNeighborsData.begin(), telemsNeighborsData.end());
-			elemsRegions[t].insert(elemsRegions[t].end(), telemsRegions.begin(), telemsRegions.end());
+			elemsData[t].insert(elemsData[t].end(), telemsData.begin(), telemsData.end());
 		}
 	}
 
@@ -1249,14 +1453,13 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 			std::vector<Point>    tnodesCoordinates;
 			std::vector<esint>  tnodesElemsDistribution;
 			std::vector<esint>  tnodesElemsData;
-			std::vector<esint>  tnodesRegions;
+				std::vector<double> tnodesData;
 			std::vector<esint>  tnodeSet;
 			std::vector<esint>  tnpermutation;
 
 			tnodesIDs.reserve(rdistribution[t + 1] - rdistribution[t]);
 			tnodesCoordinates.reserve(rdistribution[t + 1] - rdistribution[t]);
 			tnodesElemsDistribution.reserve(rdistribution[t + 1] - rdistribution[t]);
-			tnodesRegions.reserve(rdistribution[t + 1] - rdistribution[t]);
 			tnodeSet.reserve(rdistribution[t + 1] - rdistribution[t]);
 
 			esint distOffset = 0;
@@ -1272,7 +1475,7 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 				tnpermutation.push_back(n);
 				n += 1 + sizeof(Point) / sizeof(esint); // id, Point
 				n += 1 + rNodes[i][n]; // linksize, links
-				n += bregionsBitMaskSize; // region mask
+				n += ndatasize * sizeof(double) / sizeof(esint); // fields
 			}
 			std::sort(tnpermutation.begin(), tnpermutation.end(), [&] (esint n1, esint n2) {
 				return rNodes[i][n1] < rNodes[i][n2];
@@ -1295,8 +1498,8 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 					tnodesElemsData.insert(tnodesElemsData.end(), rNodes[i].begin() + index + 1, rNodes[i].begin() + index + 1 + rNodes[i][index]);
 					tnodesElemsDistribution.push_back(tnodesElemsData.size() + distOffset);
 					index += rNodes[i][index] + 1; // linksize + links
-					tnodesRegions.insert(tnodesRegions.end(), rNodes[i].begin() + index, rNodes[i].begin() + index + bregionsBitMaskSize);
-					index += bregionsBitMaskSize; // region mask
+					tnodesData.resize(tnodesData.size() + ndatasize);
+					memcpy(tnodesData.data() + tnodesData.size() - ndatasize, rNodes[i].data() + index, ndatasize * sizeof(double));
 				}
 			}
 
@@ -1304,7 +1507,7 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 			nodesCoordinates[t].insert(nodesCoordinates[t].end(), tnodesCoordinates.begin(), tnodesCoordinates.end());
 			nodesElemsDistribution[t].insert(nodesElemsDistribution[t].end(), tnodesElemsDistribution.begin(), tnodesElemsDistribution.end());
 			nodesElemsData[t].insert(nodesElemsData[t].end(), tnodesElemsData.begin(), tnodesElemsData.end());
-			nodesRegions[t].insert(nodesRegions[t].end(), tnodesRegions.begin(), tnodesRegions.end());
+			nodesData[t].insert(nodesData[t].end(), tnodesData.begin(), tnodesData.end());
 			tnodeset[t].swap(tnodeSet);
 		}
 
@@ -1366,6 +1569,20 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	}
 	eslog::checkpointln("EXCHANGE EL: DESERIALIZE BOUDARIES");
 
+	// Step 4: Deserialize regions data
+	for (size_t i = 0; i < rRegions.size(); ++i) {
+		size_t p = 0;
+		auto unpack = [&] (std::vector<RoaringBitmap> &regions) {
+			for (esint r = 0, size = rRegions[i][p++]; r < size; ++r) {
+				regions[rRegions[i][p]].add(rRegions[i].data() + p + 2, rRegions[i].data() + p + 2 + rRegions[i][p + 1]);
+				p += 2 + rRegions[i][p + 1];
+			}
+		};
+		unpack(eregions);
+		unpack(nregions);
+	}
+	eslog::checkpointln("EXCHANGE EL: DESERIALIZE REGIONS");
+
 	// elements are redistributed later while decomposition -> distribution is not changed now
 	std::vector<size_t> elemDistribution(threads + 1);
 	for (size_t t = 1; t <= threads; t++) {
@@ -1378,19 +1595,32 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	newElements->epointers = new serializededata<esint, Element*>(1, elemsEpointer);
 	newElements->nodes = new serializededata<esint, esint>(elemsNodesDistribution, elemsNodesData); // global IDs
 
-	newElements->regions = new serializededata<esint, esint>(eregionsBitMaskSize, elemsRegions);
-
 	newElements->faceNeighbors = new serializededata<esint, esint>(elemsNeighborsDistribution, elemsNeighborsData);
 
 	newElements->distribution.process.size = newElements->IDs->structures();
 	newElements->distribution.threads = newElements->IDs->datatarray().distribution();
 
-	// Step 5: Balance node data to threads
-	std::vector<size_t> nodeDistribution(threads);
-	for (size_t t = 1; t < threads; t++) {
-		nodeDistribution[t] = nodeDistribution[t - 1] + nodesIDs[t - 1].size();
+	// thread data are stored in the same order as IDs
+	auto fillData = [&] (NamedData *data, size_t offset, size_t datasize, const std::vector<std::vector<double> > &values) {
+		std::vector<size_t> distribution(threads + 1);
+		for (size_t t = 0; t < threads; t++) {
+			distribution[t + 1] = distribution[t] + values[t].size() / datasize;
+		}
+		#pragma omp parallel for
+		for (size_t t = 0; t < threads; t++) {
+			for (size_t i = distribution[t], j = 0; i < distribution[t + 1]; ++i, j += datasize) {
+				for (int d = 0; d < data->dimension; ++d) {
+					data->data[i * data->dimension + d] = values[t][j + offset + d];
+				}
+			}
+		}
+	};
+
+	for (size_t i = 0, offset = 0; i < elements->data.size(); offset += elements->data[i++]->dimension) {
+		fillData(newElements->appendData(elements->data[i]->dimension, elements->data[i]->dataType, elements->data[i]->name), offset, edatasize, elemsData);
 	}
 
+	// Step 5: Balance node data to threads
 	serializededata<esint, esint>::balance(1, nodesIDs);
 	serializededata<esint, Point>::balance(1, nodesCoordinates);
 	serializededata<esint, esint>::balance(nodesElemsDistribution, nodesElemsData);
@@ -1401,6 +1631,10 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	newNodes->size = newNodes->IDs->datatarray().size();
 	newNodes->distribution = newNodes->IDs->datatarray().distribution();
 
+	for (size_t i = 0, offset = 0; i < nodes->data.size(); offset += nodes->data[i++]->dimension) {
+		fillData(newNodes->appendData(nodes->data[i]->dimension, nodes->data[i]->dataType, nodes->data[i]->name), offset, ndatasize, nodesData);
+	}
+
 	for (size_t r = 0; r < boundaryRegions.size(); r++) {
 		if (boundaryRegions[r]->originalDimension) {
 			delete boundaryRegions[r]->elements;
@@ -1412,46 +1646,6 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 		}
 	}
 
-	for (size_t r = 0; r < elementsRegions.size(); r++) {
-		esint maskOffset = r / (8 * sizeof(esint));
-		esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-		delete elementsRegions[r]->elements;
-		std::vector<std::vector<esint> > regionelems(threads);
-
-		#pragma omp parallel for
-		for (size_t t = 0; t < threads; t++) {
-			for (size_t i = 0; i < elemsRegions[t].size(); i += eregionsBitMaskSize) {
-				if (elemsRegions[t][i + maskOffset] & bit) {
-					regionelems[t].push_back(elemDistribution[t] + i / eregionsBitMaskSize);
-				}
-			}
-		}
-
-		serializededata<esint, esint>::balance(1, regionelems);
-		elementsRegions[r]->elements = new serializededata<esint, esint>(1, regionelems);
-	}
-
-	for (size_t r = 0; r < boundaryRegions.size(); r++) {
-		if (boundaryRegions[r]->nodes) {
-			esint maskOffset = r / (8 * sizeof(esint));
-			esint bit = (esint)1 << (r % (8 * sizeof(esint)));
-			delete boundaryRegions[r]->nodes;
-			std::vector<std::vector<esint> > regionnodes(threads);
-
-			#pragma omp parallel for
-			for (size_t t = 0; t < threads; t++) {
-				for (size_t i = 0; i < nodesRegions[t].size(); i += bregionsBitMaskSize) {
-					if (nodesRegions[t][i + maskOffset] & bit) {
-						regionnodes[t].push_back(nodeDistribution[t] + i / bregionsBitMaskSize);
-					}
-				}
-			}
-
-			serializededata<esint, esint>::balance(1, regionnodes);
-			boundaryRegions[r]->nodes = new serializededata<esint, esint>(1, regionnodes);
-		}
-	}
-
 	std::vector<size_t> eIDsOLD = Communication::getDistribution(elements->epointers->datatarray().size());
 	std::vector<size_t> eIDsNEW = Communication::getDistribution(newElements->epointers->datatarray().size());
 
@@ -1474,7 +1668,54 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	utils::inplaceMerge(nodesElemsData);
 	utils::removeDuplicates(nodesElemsData[0]);
 
-	std::vector<std::vector<esint> > requestedIDs, receivedTargets, IDrequests;
+	// regions members are given by IDs -> map them to new offsets
+	auto toOffsets = [] (const RoaringBitmap &IDs, const std::vector<esint> &sorted, const std::vector<esint> &permutation, std::vector<esint> &members) {
+		members.clear();
+		members.reserve(IDs.cardinality());
+		size_t i = 0;
+		IDs.forEach([&] (esint id) {
+			while (i < sorted.size() && sorted[i] < id) ++i;
+			if (i < sorted.size() && sorted[i] == id) {
+				members.push_back(permutation[i]);
+			}
+		});
+		std::sort(members.begin(), members.end());
+	};
+	auto toRegion = [] (const std::vector<esint> &members, const std::vector<size_t> &distribution) {
+		std::vector<size_t> mdistribution(distribution.size());
+		for (size_t t = 0; t < distribution.size(); t++) {
+			mdistribution[t] = std::lower_bound(members.begin(), members.end(), distribution[t]) - members.begin();
+		}
+		return new serializededata<esint, esint>(1, tarray<esint>(mdistribution, members));
+	};
+
+	std::vector<esint> members;
+	newElements->regions.resize(elementsRegions.size());
+	for (size_t r = 0; r < elementsRegions.size(); r++) {
+		delete elementsRegions[r]->elements;
+		toOffsets(eregions[r], sortedElements, epermutation, members);
+		elementsRegions[r]->elements = toRegion(members, elemDistribution);
+		newElements->regions[r] = RoaringBitmap(members);
+	}
+
+	if (std::any_of(boundaryRegions.begin(), boundaryRegions.end(), [] (const BoundaryRegionStore *region) { return region->nodes != NULL; })) {
+		std::vector<esint> npermutation(newNodes->size), sortedNodes(newNodes->size);
+		const auto &nIDs = newNodes->IDs->datatarray();
+		std::iota(npermutation.begin(), npermutation.end(), 0);
+		std::sort(npermutation.begin(), npermutation.end(), [&] (esint i, esint j) { return nIDs[i] < nIDs[j]; });
+		for (size_t n = 0; n < npermutation.size(); n++) {
+			sortedNodes[n] = nIDs[npermutation[n]];
+		}
+		for (size_t r = 0; r < boundaryRegions.size(); r++) {
+			if (boundaryRegions[r]->nodes) {
+				delete boundaryRegions[r]->nodes;
+				toOffsets(nregions[r], sortedNodes, npermutation, members);
+				boundaryRegions[r]->nodes = toRegion(members, newNodes->distribution);
+			}
+		}
+	}
+
+	std::vector<arenavector<esint> > requestedIDs, receivedTargets, IDrequests;
 	std::vector<std::vector<int> > IDtargets(threads);
 	std::vector<int> sources;
 
@@ -1568,38 +1809,42 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	}
 	utils::sortAndRemoveDuplicates(IDtargets[0]);
 
-	std::vector<std::vector<std::vector<esint> > > newIDrequests(threads, std::vector<std::vector<esint> >(IDtargets[0].size()));
-	std::vector<std::vector<esint> > newIDs;
+	std::vector<arenavector<esint> > newIDrequests(IDtargets[0].size());
+	std::vector<arenavector<esint> > newIDs;
+
+	std::vector<size_t> rsize(IDtargets[0].size());
+	for (size_t r = 0; r < receivedTargets.size(); r++) {
+		for (size_t e = 0; e < receivedTargets[r].size(); ++e) {
+			++rsize[std::lower_bound(IDtargets[0].begin(), IDtargets[0].end(), receivedTargets[r][e]) - IDtargets[0].begin()];
+		}
+	}
+	for (size_t n = 0; n < IDtargets[0].size(); n++) {
+		newIDrequests[n].reserve(rsize[n]);
+	}
 
 	for (size_t r = 0; r < receivedTargets.size(); r++) {
 		rdistribution = tarray<size_t>::distribute(threads, receivedTargets[r].size());
 
+		std::vector<std::vector<std::vector<esint> > > tnewIDrequests(threads, std::vector<std::vector<esint> >(IDtargets[0].size()));
 		#pragma omp parallel for
 		for (size_t t = 0; t < threads; ++t) {
 			size_t tindex;
-			std::vector<std::vector<esint> > tnewIDrequests(IDtargets[0].size());
-
 			for (size_t e = rdistribution[t]; e < rdistribution[t + 1]; ++e) {
 				tindex = std::lower_bound(IDtargets[0].begin(), IDtargets[0].end(), receivedTargets[r][e]) - IDtargets[0].begin();
-				tnewIDrequests[tindex].push_back(requestedIDs[r][e]);
-			}
-
-			for (size_t n = 0; n < IDtargets[0].size(); n++) {
-				newIDrequests[t][n].insert(newIDrequests[t][n].end(), tnewIDrequests[n].begin(), tnewIDrequests[n].end());
+				tnewIDrequests[t][tindex].push_back(requestedIDs[r][e]);
 			}
 		}
 
-		for (size_t t = 1; t < threads; ++t) {
+		for (size_t t = 0; t < threads; ++t) {
 			for (size_t n = 0; n < IDtargets[0].size(); n++) {
-				newIDrequests[0][n].insert(newIDrequests[0][n].end(), newIDrequests[t][n].begin(), newIDrequests[t][n].end());
-				newIDrequests[t][n].clear();
+				newIDrequests[n].insert(newIDrequests[n].end(), tnewIDrequests[t][n].begin(), tnewIDrequests[t][n].end());
 			}
 		}
 	}
 
 	eslog::checkpointln("EXCHANGE EL: PROC REQUESTS");
 
-	if (!Communication::sendVariousTargets(newIDrequests[0], IDrequests, IDtargets[0], sources)) {
+	if (!Communication::sendVariousTargets(newIDrequests, IDrequests, IDtargets[0], sources)) {
 		eslog::internalFailure("request new ID.\n");
 	}
 
@@ -1631,12 +1876,12 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	std::vector<std::pair<esint, esint> > IDMap(offsets.back());
 
 	for (size_t r = 0; r < newIDs.size(); r++) {
-		rdistribution = tarray<size_t>::distribute(threads, newIDrequests[0][r].size());
+		rdistribution = tarray<size_t>::distribute(threads, newIDrequests[r].size());
 
 		#pragma omp parallel for
 		for (size_t t = 0; t < threads; ++t) {
 			for (size_t e = rdistribution[t]; e < rdistribution[t + 1]; ++e) {
-				IDMap[offsets[r] + e].first = newIDrequests[0][r][e];
+				IDMap[offsets[r] + e].first = newIDrequests[r][e];
 				IDMap[offsets[r] + e].second = newIDs[r][e];
 			}
 		}
@@ -1751,7 +1996,9 @@ void exchangeElements(ElementStore* &elements, NodeStore* &nodes, std::vector<El
 	delete newElements;
 	delete newNodes;
 
-	eslog::endln("EXCHANGE EL: FINISH");
+	eslog::end("EXCHANGE EL: FINISH");
+	eslog::param("arena[MB]", Arena::highWaterMark() / 1024. / 1024.);
+	eslog::ln();
 	eslog::checkpointln("MESH: ELEMENTS EXCHANGED");
 }
 
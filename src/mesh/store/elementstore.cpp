@@ -10,9 +10,19 @@
 #include "basis/containers/point.h"
 #include "basis/containers/serializededata.h"
 #include "basis/utilities/packing.h"
+#include "basis/utilities/utils.h"
 
 using namespace mesio;
 
+static std::vector<std::vector<esint> > regionsMembers(const std::vector<RoaringBitmap> &regions)
+{
+	std::vector<std::vector<esint> > members(regions.size());
+	for (size_t r = 0; r < regions.size(); ++r) {
+		regions[r].toVector(members[r]);
+	}
+	return members;
+}
+
 ElementStore::ElementStore()
 : IDs(NULL),
   nodes(NULL),
@@ -21,7 +31,6 @@ ElementStore::ElementStore()
   body(NULL),
   contact(NULL),
   material(NULL),
-  regions(NULL),
   epointers(NULL),
 
   faceNeighbors(NULL),
@@ -46,7 +55,7 @@ size_t ElementStore::packedFullSize() const
 	packedSize += utils::packedSize(body);
 	packedSize += utils::packedSize(contact);
 	packedSize += utils::packedSize(material);
-	packedSize += utils::packedSize(regions);
+	packedSize += utils::packedSize(regionsMembers(regions));
 	packedSize += utils::packedSize(faceNeighbors);
 	packedSize += utils::packedSize(edgeNeighbors);
 	packedSize += utils::packedSize(stiffness);
@@ -79,7 +88,7 @@ void ElementStore::packFull(char* &p) const
 	utils::pack(body, p);
 	utils::pack(contact, p);
 	utils::pack(material, p);
-	utils::pack(regions, p);
+	utils::pack(regionsMembers(regions), p);
 	utils::pack(faceNeighbors, p);
 	utils::pack(edgeNeighbors, p);
 	utils::pack(stiffness, p);
@@ -115,7 +124,9 @@ void ElementStore::unpackFull(const char* &p)
 	utils::unpack(body, p);
 	utils::unpack(contact, p);
 	utils::unpack(material, p);
-	utils::unpack(regions, p);
+	std::vector<std::vector<esint> > members;
+	utils::unpack(members, p);
+	regions.assign(members.begin(), members.end());
 	utils::unpack(faceNeighbors, p);
 	utils::unpack(edgeNeighbors, p);
 	utils::unpack(stiffness, p);
@@ -279,7 +290,6 @@ ElementStore::~ElementStore()
 	if (body != NULL) { delete body; }
 	if (contact != NULL) { delete contact; }
 	if (material != NULL) { delete material; }
-	if (regions != NULL) { delete regions; }
 	if (epointers != NULL) { delete epointers; }
 
 	if (faceNeighbors != NULL) { delete faceNeighbors; }
@@ -302,7 +312,13 @@ void ElementStore::store(const std::string &file)
 
 	Store::storedata(os, "body", body);
 	Store::storedata(os, "material", material);
-	Store::storedata(os, "regions", regions);
+	os << "regions\n";
+	for (size_t r = 0; r < regions.size(); ++r) {
+		os << "[ ";
+		regions[r].forEach([&] (esint e) { os << e << " "; });
+		os << "]\n";
+	}
+	os << "\n";
 	Store::storedata(os, "epointers", epointers);
 
 	Store::storedata(os, "neighbors", faceNeighbors);
@@ -319,7 +335,19 @@ void ElementStore::permute(const std::vector<esint> &permutation, const std::vec
 	if (body != NULL) { body->permute(permutation, threading); }
 	if (contact != NULL) { contact->permute(permutation, threading); }
 	if (material != NULL) { material->permute(permutation, threading); }
-	if (regions != NULL) { regions->permute(permutation, threading); }
+	if (regions.size()) {
+		// permutation[i] is the old position of the i-th element
+		std::vector<esint> position(permutation.size());
+		for (size_t i = 0; i < permutation.size(); ++i) {
+			position[permutation[i]] = i;
+		}
+		#pragma omp parallel for
+		for (size_t r = 0; r < regions.size(); ++r) {
+			std::vector<esint> members;
+			regions[r].forEach([&] (esint e) { members.push_back(position[e]); });
+			regions[r] = RoaringBitmap(members);
+		}
+	}
 
 	if (epointers != NULL) { epointers->permute(permutation, threading); }
 
@@ -328,7 +356,11 @@ void ElementStore::permute(const std::vector<esint> &permutation, const std::vec
 
 	if (stiffness != NULL) { stiffness->permute(permutation, threading); }
 
-	// TODO: permute data
+	for (size_t i = 0; i < data.size(); i++) {
+		if (data[i]->data.size()) {
+			utils::permute(data[i]->data, permutation, data[i]->dimension);
+		}
+	}
 }
 
 void ElementStore::reindex(const serializededata<esint, esint> *nIDs)
@@ -360,13 +392,13 @@ void ElementData::statistics(const tarray<esint> &elements, esint totalsize, Sta
 	for (auto e = elements.begin(); e != elements.end(); ++e) {
 		double value = 0;
 		for (int d = 0; d < dimension; d++) {
-			value += store[*e * dimension + d] * store[*e * dimension + d];
-			(statistics + d + doffset)->min    = std::min((statistics + d + doffset)->min, store[*e * dimension + d]);
-			(statistics + d + doffset)->max    = std::max((statistics + d + doffset)->max, store[*e * dimension + d]);
-			(statistics + d + doffset)->avg   += store[*e * dimension + d];
-			(statistics + d + doffset)->norm  += store[*e * dimension + d] * store[*e * dimension + d];
-			(statistics + d + doffset)->absmin = std::min((statistics + d + doffset)->min, std::fabs(store[*e * dimension + d]));
-			(statistics + d + doffset)->absmax = std::max((statistics + d + doffset)->max, std::fabs(store[*e * dimension + d]));
+			value += data[*e * dimension + d] * data[*e * dimension + d];
+			(statistics + d + doffset)->min    = std::min((statistics + d + doffset)->min, data[*e * dimension + d]);
+			(statistics + d + doffset)->max    = std::max((statistics + d + doffset)->max, data[*e * dimension + d]);
+			(statistics + d + doffset)->avg   += data[*e * dimension + d];
+			(statistics + d + doffset)->norm  += data[*e * dimension + d] * data[*e * dimension + d];
+			(statistics + d + doffset)->absmin = std::min((statistics + d + doffset)->min, std::fabs(data[*e * dimension + d]));
+			(statistics + d + doffset)->absmax = std::max((statistics + d + doffset)->max, std::fabs(data[*e * dimension + d]));
 		}
 		if (dataType == DataType::VECTOR) {
 			value = std::sqrt(value);
@@ -7,6 +7,7 @@
 #include "elementsinterval.h"
 #include "contactinfo.h"
 #include "nameddata.h"
+#include "basis/structures/roaringbitmap.h"
 
 #include <cstddef>
 #include <string>
@@ -45,7 +46,7 @@ struct ElementStore {
 	serializededata<esint, int>* body;
 	serializededata<esint, ContactInfo>* contact;
 	serializededata<esint, int>* material;
-	serializededata<esint, esint>* regions;
+	std::vector<RoaringBitmap> regions; // elements of each region
 	serializededata<esint, Element*>* epointers;
 
 	serializededata<esint, esint>* faceNeighbors;
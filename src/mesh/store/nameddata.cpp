@@ -8,13 +8,12 @@ std::vector<std::string> NamedData::coordinateSuffixes = { "_X", "_Y", "_Z", "_X
 std::vector<std::string> NamedData::numberSuffixes = { "_1ST", "_2ND", "_3RD" };
 
 NamedData::NamedData(int dimension, DataType datatype, const std::string &name)
-: dimension(dimension), dataType(datatype), name(name), store(data)
+: dimension(dimension), dataType(datatype), name(name)
 {
 
 }
 
 NamedData::NamedData(const char* &packedData)
-: store(data)
 {
 	utils::unpack(dimension, packedData);
 	utils::unpack(dataType, packedData);
@@ -43,12 +42,6 @@ int NamedData::nstatistics() const
 	}
 }
 
-void NamedData::toBuffer()
-{
-	buffer = data;
-	store = buffer;
-}
-
 std::string NamedData::suffix(int index) const
 {
 	switch (dataType) {
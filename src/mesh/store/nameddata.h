@@ -23,7 +23,7 @@ struct NamedData {
 	DataType dataType;
 	std::string name;
 
-	std::vector<double> data, buffer, &store;
+	std::vector<double> data;
 
 	NamedData(int dimension, DataType datatype, const std::string &name);
 	NamedData(const char* &packedData);
@@ -32,8 +32,6 @@ struct NamedData {
 	bool onlySuffixed() const;
 	int nstatistics() const;
 
-	void toBuffer();
-
 	std::string suffix(int index) const;
 
 	size_t packedSize();
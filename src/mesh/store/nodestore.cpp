@@ -10,6 +10,7 @@
 #include "basis/containers/point.h"
 #include "basis/containers/serializededata.h"
 #include "basis/utilities/packing.h"
+#include "basis/utilities/utils.h"
 
 using namespace mesio;
 
@@ -252,6 +253,12 @@ void NodeStore::permute(const std::vector<esint> &permutation, const std::vector
 	if (coordinates != NULL) { coordinates->permute(permutation, distribution); }
 	if (ranks != NULL) { ranks->permute(permutation, distribution); }
 	if (domains != NULL) { domains->permute(permutation, distribution); }
+
+	for (size_t i = 0; i < data.size(); i++) {
+		if (data[i]->data.size()) {
+			utils::permute(data[i]->data, permutation, data[i]->dimension);
+		}
+	}
 }
 
 std::vector<esint> NodeStore::gatherNodeDistribution()
@@ -285,13 +292,13 @@ void NodeData::statistics(const tarray<esint> &nodes, esint totalsize, Statistic
 		if (*nranks->begin() == info::mpi::rank) {
 			double value = 0;
 			for (int d = 0; d < dimension; d++) {
-				value += store[*n * dimension + d] * store[*n * dimension + d];
-				(statistics + d + doffset)->min    = std::min((statistics + d + doffset)->min, store[*n * dimension + d]);
-				(statistics + d + doffset)->max    = std::max((statistics + d + doffset)->max, store[*n * dimension + d]);
-				(statistics + d + doffset)->avg   += store[*n * dimension + d];
-				(statistics + d + doffset)->norm  += store[*n * dimension + d] * store[*n * dimension + d];
-				(statistics + d + doffset)->absmin = std::min((statistics + d + doffset)->absmin, std::fabs(store[*n * dimension + d]));
-				(statistics + d + doffset)->absmax = std::max((statistics + d + doffset)->absmax, std::fabs(store[*n * dimension + d]));
+				value += data[*n * dimension + d] * data[*n * dimension + d];
+				(statistics + d + doffset)->min    = std::min((statistics + d + doffset)->min, data[*n * dimension + d]);
+				(statistics + d + doffset)->max    = std::max((statistics + d + doffset)->max, data[*n * dimension + d]);
+				(statistics + d + doffset)->avg   += data[*n * dimension + d];
+				(statistics + d + doffset)->norm  += data[*n * dimension + d] * data[*n * dimension + d];
+				(statistics + d + doffset)->absmin = std::min((statistics + d + doffset)->absmin, std::fabs(data[*n * dimension + d]));
+				(statistics + d + doffset)->absmax = std::max((statistics + d + doffset)->absmax, std::fabs(data[*n * dimension + d]));
 			}
 			if (dataType == DataType::VECTOR) {
 				value = std::sqrt(value);
@@ -0,0 +1,34 @@
+
+#ifndef SRC_MESH_STORE_PARTITIONINFO_H_
+#define SRC_MESH_STORE_PARTITIONINFO_H_
+
+namespace mesio {
+
+// quality of the elements distribution among processes (clusters) and domains (all values are global)
+struct PartitionInfo {
+	esint edgecut;            // number of faces shared by elements of different processes
+	esint decomposerEdgecut;  // edge cut reported by the parallel decomposer (-1 if it was not called)
+
+	esint volume, maxVolume;  // number of nodes values sent by all processes / by the busiest process
+	esint minNeighbors, maxNeighbors;
+	double avgNeighbors;
+
+	double elementImbalance, nodeImbalance; // max / avg of elements and unique nodes per process
+
+	esint clusters, disconnectedClusters, maxClusterParts;
+	esint domains, disconnectedDomains, maxDomainParts;
+
+	double minInterfaceRatio, avgInterfaceRatio, maxInterfaceRatio; // interface nodes / nodes per process
+
+	PartitionInfo()
+	: edgecut(0), decomposerEdgecut(-1),
+	  volume(0), maxVolume(0), minNeighbors(0), maxNeighbors(0), avgNeighbors(0),
+	  elementImbalance(1), nodeImbalance(1),
+	  clusters(0), disconnectedClusters(0), maxClusterParts(0),
+	  domains(0), disconnectedDomains(0), maxDomainParts(0),
+	  minInterfaceRatio(0), avgInterfaceRatio(0), maxInterfaceRatio(0) {}
+};
+
+}
+
+#endif /* SRC_MESH_STORE_PARTITIONINFO_H_ */
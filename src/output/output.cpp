@@ -13,8 +13,12 @@
 #include "esinfo/config.h"
 #include "esinfo/eslog.h"
 #include "esinfo/meshinfo.h"
+#include "mesh/store/elementstore.h"
+#include "mesh/store/nodestore.h"
+#include "mesh/store/nameddata.h"
 #include "wrappers/pthread/w.pthread.h"
 
+#include <algorithm>
 #include <vector>
 
 namespace mesio {
@@ -33,7 +37,7 @@ struct OutputExecutor {
 	}
 
 	virtual void mesh() = 0;
-	virtual void solution() = 0;
+	virtual void solution(double time) = 0;
 
 	std::vector<OutputWriter*> writers;
 };
@@ -47,9 +51,10 @@ public:
 		}
 	}
 
-	virtual void solution()
+	virtual void solution(double time)
 	{
 		for (size_t i = 0; i < writers.size(); ++i) {
+			writers[i]->_time = time;
 			writers[i]->updateSolution();
 		}
 	}
@@ -57,50 +62,89 @@ public:
 
 
 
+// steps are copied to slots and stored by a pinned thread, hence the computation waits only if all slots are occupied
 class AsyncOutputExecutor: public DirectOutputExecutor, public Pthread::Executor, public Pthread {
-	struct SharedData {
+	struct Step {
 		enum class TAG {
 			MESH,
-			SOLUTION,
-			DUMMY
+			SOLUTION
 		} tag;
+		double time;
 
-		SharedData(TAG tag): tag(tag) {}
-	} app, thread;
+		std::vector<NamedData*> data;
+		std::vector<std::vector<double> > values;
+		std::vector<std::pair<const NamedData*, const std::vector<double>*> > view; // passed to writers instead of the shared data
+	};
 
 public:
-	AsyncOutputExecutor(): Pthread(this), app(SharedData::TAG::DUMMY), thread(app)
+	AsyncOutputExecutor(): Pthread(this, info::config::output.steps), _steps(std::max(info::config::output.steps, (size_t)1)), _tag(Step::TAG::MESH), _time(0)
 	{
 
 	}
 
-	void copy()
+	~AsyncOutputExecutor()
 	{
-		info::mesh->toBuffer();
-		thread = app;
+		Pthread::wait();
 	}
 
-	void call()
+	void copy(size_t slot)
 	{
-		if (thread.tag == SharedData::TAG::MESH) {
+		Step &step = _steps[slot];
+		step.tag = _tag;
+		step.time = _time;
+		step.data.clear();
+		for (size_t i = 0; i < info::mesh->elements->data.size(); ++i) {
+			if (info::mesh->elements->data[i]->name.size()) {
+				step.data.push_back(info::mesh->elements->data[i]);
+			}
+		}
+		for (size_t i = 0; i < info::mesh->nodes->data.size(); ++i) {
+			if (info::mesh->nodes->data[i]->name.size()) {
+				step.data.push_back(info::mesh->nodes->data[i]);
+			}
+		}
+		step.values.resize(step.data.size()); // allocated memory is reused by later steps
+		step.view.clear();
+		for (size_t i = 0; i < step.data.size(); ++i) {
+			step.values[i].assign(step.data[i]->data.begin(), step.data[i]->data.end());
+			step.view.push_back(std::make_pair(step.data[i], &step.values[i]));
+		}
+	}
+
+	void call(size_t slot)
+	{
+		Step &step = _steps[slot];
+		for (size_t i = 0; i < writers.size(); ++i) {
+			writers[i]->_step = &step.view;
+		}
+		if (step.tag == Step::TAG::MESH) {
 			DirectOutputExecutor::mesh();
 		}
-		if (thread.tag == SharedData::TAG::SOLUTION) {
-			DirectOutputExecutor::solution();
+		if (step.tag == Step::TAG::SOLUTION) {
+			DirectOutputExecutor::solution(step.time);
+		}
+		for (size_t i = 0; i < writers.size(); ++i) {
+			writers[i]->_step = NULL;
 		}
 	}
 
 	virtual void mesh()
 	{
-		app = SharedData(SharedData::TAG::MESH); // dummy type
+		_tag = Step::TAG::MESH;
 		Pthread::call();
 	}
 
-	virtual void solution()
+	virtual void solution(double time)
 	{
-		app = SharedData(SharedData::TAG::SOLUTION);
+		_tag = Step::TAG::SOLUTION;
+		_time = time;
 		Pthread::call();
 	}
+
+protected:
+	std::vector<Step> _steps;
+	Step::TAG _tag;
+	double _time;
 };
 
 }
@@ -109,7 +153,7 @@ using namespace mesio;
 
 OutputWriter::OutputWriter()
 : _path(info::config::output.path + "/"), _directory("PREPOSTDATA/"),
-  _measure(info::config::output.mode == OutputConfiguration::MODE::SYNC), _allowed(true)
+  _measure(info::config::output.mode == OutputConfiguration::MODE::SYNC), _allowed(true), _time(0), _step(NULL)
 {
 	size_t namebegin = info::config::input.path.find_last_of("/") + 1;
 	size_t nameend = info::config::input.path.find_last_of(".");
@@ -126,6 +170,18 @@ void OutputWriter::createOutputDirectory()
 	utils::createDirectory({ _path, _directory });
 }
 
+const std::vector<double>& OutputWriter::stored(const NamedData *data) const
+{
+	if (_step) {
+		for (size_t i = 0; i < _step->size(); ++i) {
+			if ((*_step)[i].first == data) {
+				return *(*_step)[i].second;
+			}
+		}
+	}
+	return data->data;
+}
+
 Output::Output()
 : _direct(new DirectOutputExecutor()), _async(NULL)
 {
@@ -140,6 +196,7 @@ Output::Output()
 		case OutputConfiguration::FORMAT::XDMF: writer = new XDMF(); break;
 		case OutputConfiguration::FORMAT::STL_SURFACE: writer = new STL(); break;
 		case OutputConfiguration::FORMAT::NETGEN: writer = new Netgen(); break;
+		case OutputConfiguration::FORMAT::VTK_LEGACY_BINARY: writer = new VTKLegacy(true); break;
 		default:
 			eslog::internalFailure("implement the selected output format.\n");
 		}
@@ -176,10 +233,15 @@ void Output::updateMesh()
 }
 
 void Output::updateSolution()
+{
+	updateSolution(0);
+}
+
+void Output::updateSolution(double time)
 {
 	if (_allowed) {
-		if (_async) { _async->solution(); }
-		if (_direct) { _direct->solution(); }
+		if (_async) { _async->solution(time); }
+		if (_direct) { _direct->solution(time); }
 	}
 }
 
@@ -3,13 +3,19 @@
 #define SRC_OUTPUT_OUTPUT_H_
 
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace mesio {
 
 class DirectOutputExecutor;
 class AsyncOutputExecutor;
+struct NamedData;
 
 class OutputWriter {
+friend class DirectOutputExecutor;
+friend class AsyncOutputExecutor;
+
 public:
 	virtual bool storeStep() { return true; }
 
@@ -22,8 +28,13 @@ protected:
 	OutputWriter();
 	void createOutputDirectory();
 
+	// values of the data to be stored (the copy of a queued step if the writer runs in the asynchronous output thread)
+	const std::vector<double>& stored(const NamedData *data) const;
+
 	std::string _path, _directory, _name;
 	bool _measure, _allowed;
+	double _time; // physical time of the stored solution
+	const std::vector<std::pair<const NamedData*, const std::vector<double>*> > *_step;
 };
 
 class Output: public OutputWriter {
@@ -33,6 +44,7 @@ public:
 
 	void updateMesh();
 	void updateSolution();
+	void updateSolution(double time);
 
 	void suppress();
 	void permit();
@@ -4,9 +4,12 @@
 #include "writer/vtkwritter.h"
 #include "basis/containers/point.h"
 #include "basis/containers/serializededata.h"
+#include "basis/containers/tarray.h"
 #include "basis/utilities/sysutils.h"
+#include "basis/utilities/utils.h"
 #include "wrappers/mpi/communication.h"
 #include "esinfo/config.h"
+#include "esinfo/envinfo.h"
 #include "esinfo/meshinfo.h"
 #include "esinfo/mpiinfo.h"
 #include "esinfo/eslog.h"
@@ -19,6 +22,7 @@
 #include "mesh/store/surfacestore.h"
 #include "mesh/store/contactstore.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <fstream>
 #include <vector>
@@ -31,13 +35,6 @@ DebugOutput::DebugOutput(double clusterShrinkRatio, double domainShrinkRatio, bo
 {
 	_path = utils::createDirectory({ info::config::output.path, "DEBUG_VISUALIZATION" });
 
-	if (Visualization::isRoot()) {
-		_writer.description("# vtk DataFile Version 2.0\n");
-		_writer.description("EXAMPLE\n");
-		_writer.description("ASCII\n");
-		_writer.description("DATASET UNSTRUCTURED_GRID\n");
-	}
-
 	if (withDomains) {
 		if (_mesh.nodes->domains == NULL) {
 			mesh::computeNodeDomainDistribution(info::mesh->elements, info::mesh->nodes, info::mesh->domains, info::mesh->neighborsWithMe);
@@ -67,139 +64,123 @@ DebugOutput::DebugOutput(double clusterShrinkRatio, double domainShrinkRatio, bo
 	_ccenter /= _mesh.nodes->size;
 }
 
-void DebugOutput::points(esint nother, esint &noffset, esint &nsize)
+DebugOutput::~DebugOutput()
 {
-	noffset = _mesh.nodes->size;
-	nsize = Communication::exscan(noffset);
-
-	if (Visualization::isRoot()) {
-		_writer.points(nsize + nother);
-	}
-	for (esint n = 0; n < _mesh.nodes->size; ++n) {
-		Point p = Visualization::shrink(_mesh.nodes->coordinates->datatarray()[n], _ccenter, Point(), _clusterShrinkRatio, 1);
-		_writer.point(p.x, p.y, p.z);
-	}
-	_writer.groupData();
+	if (_dcenters) { delete[] _dcenters; }
 }
 
-void DebugOutput::pointsInDomains(esint nother, esint &noffset, esint &nsize)
+static bool selectedRank()
 {
-	noffset = _mesh.nodes->domains->datatarray().size();
-	nsize = Communication::exscan(noffset);
+	const std::vector<int> &ranks = info::config::output.debug_ranks;
+	return ranks.empty() || std::find(ranks.begin(), ranks.end(), info::mpi::rank) != ranks.end();
+}
 
-	esint gnother;
-	Communication::allReduce(&nother, &gnother, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
+bool DebugOutput::selected(const Point &p) const
+{
+	const std::vector<double> &box = info::config::output.debug_box;
+	if (box.size() < 6) {
+		return true;
+	}
+	return
+			box[0] <= p.x && p.x <= box[3] &&
+			box[1] <= p.y && p.y <= box[4] &&
+			box[2] <= p.z && p.z <= box[5];
+}
 
-	if (Visualization::isRoot()) {
-		_writer.points(nsize + gnother);
+// elements of selected processes and regions with the center inside the box
+std::vector<char> DebugOutput::selectedElements() const
+{
+	std::vector<char> selection(_mesh.elements->distribution.process.size, selectedRank());
+	if (selection.empty() || !selection.front()) {
+		return selection;
+	}
+	if (info::config::output.debug_regions.size()) {
+		std::fill(selection.begin(), selection.end(), 0);
+		for (size_t r = 0; r < _mesh.elementsRegions.size(); ++r) {
+			const std::vector<std::string> &regions = info::config::output.debug_regions;
+			if (std::find(regions.begin(), regions.end(), _mesh.elementsRegions[r]->name) != regions.end()) {
+				for (auto e = _mesh.elementsRegions[r]->elements->datatarray().begin(); e != _mesh.elementsRegions[r]->elements->datatarray().end(); ++e) {
+					selection[*e] = 1;
+				}
+			}
+		}
 	}
-	auto c = _mesh.nodes->coordinates->datatarray().begin();
-	for (auto n = _mesh.nodes->domains->begin(); n != _mesh.nodes->domains->end(); ++n, ++c) {
-		for (auto d = n->begin(); d != n->end(); ++d) {
-			Point p = Visualization::shrink(*c, _ccenter, _dcenters[*d - _mesh.domains->offset], _clusterShrinkRatio, _domainShrinkRatio);
-			_writer.point(p.x, p.y, p.z);
+	if (info::config::output.debug_box.size() >= 6) {
+		std::vector<esint> distribution = tarray<esint>::distribute(info::env::threads, selection.size());
+		#pragma omp parallel for
+		for (int t = 0; t < info::env::threads; ++t) {
+			auto enodes = _mesh.elements->nodes->cbegin() + distribution[t];
+			for (esint e = distribution[t]; e < distribution[t + 1]; ++e, ++enodes) {
+				if (selection[e]) {
+					Point center;
+					for (auto n = enodes->begin(); n != enodes->end(); ++n) {
+						center += _mesh.nodes->coordinates->datatarray()[*n];
+					}
+					selection[e] = selected(center / enodes->size());
+				}
+			}
 		}
 	}
-	_writer.groupData();
+	return selection;
 }
 
-esint DebugOutput::elements(esint noffset, esint nother, esint nothernodes)
+// merge cells created by threads
+void DebugOutput::cells(const std::vector<std::vector<esint> > &tsizes, const std::vector<std::vector<esint> > &tnodes, const std::vector<std::vector<int> > &ttypes)
 {
-	esint esize = _mesh.elementsRegions.front()->elements->structures(), gesize;
-	Communication::allReduce(&esize, &gesize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-	esint ensize = _mesh.elements->nodes->datatarray().size(), gensize;
-	Communication::allReduce(&ensize, &gensize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-
-	if (Visualization::isRoot()) {
-		_writer.cells(gesize + nother, gesize + gensize + nother + nothernodes);
-	}
-
-	for (auto e = _mesh.elements->nodes->begin(); e != _mesh.elements->nodes->end(); ++e) {
-		_writer.cell(e->size(), e->data(), noffset);
+	_cdistribution.assign(1, 0);
+	for (size_t t = 0; t < tsizes.size(); ++t) {
+		for (size_t c = 0; c < tsizes[t].size(); ++c) {
+			_cdistribution.push_back(_cdistribution.back() + tsizes[t][c]);
+		}
+		_cnodes.insert(_cnodes.end(), tnodes[t].begin(), tnodes[t].end());
+		_ctypes.insert(_ctypes.end(), ttypes[t].begin(), ttypes[t].end());
 	}
-	_writer.groupData();
-
-	return gesize;
 }
 
-esint DebugOutput::elementsInDomains(esint noffset, esint nother, esint nothernodes)
+void DebugOutput::store(const std::string &name)
 {
-	esint esize = _mesh.elementsRegions.front()->elements->structures(), gesize;
-	Communication::allReduce(&esize, &gesize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-	esint ensize = _mesh.elements->nodes->datatarray().size(), gensize;
-	Communication::allReduce(&ensize, &gensize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
+	esint poffset = _points.size(), coffset = _ctypes.size(), noffset = _cnodes.size();
+	esint psize = Communication::exscan(poffset);
+	esint csize = Communication::exscan(coffset);
+	esint nsize = Communication::exscan(noffset);
 
 	if (Visualization::isRoot()) {
-		_writer.cells(gesize, gesize + gensize);
-	}
-
-	for (auto e = _mesh.domains->nodes->begin(); e != _mesh.domains->nodes->end(); ++e) {
-		_writer.cell(e->size(), e->data(), noffset);
+		_writer.description("# vtk DataFile Version 2.0\n");
+		_writer.description("EXAMPLE\n");
+		_writer.description("BINARY\n");
+		_writer.description("DATASET UNSTRUCTURED_GRID\n");
+		_writer.points(psize);
 	}
+	_writer.float32s(3 * _points.size(), [&] (esint i) { return _points[i / 3][i % 3]; });
 	_writer.groupData();
 
-	return esize;
-}
-
-void DebugOutput::data(const std::string &name, const std::vector<Point> &points, const std::vector<std::vector<esint> > &cells, const std::vector<esint> &celltypes, const std::vector<std::vector<double> > &celldata)
-{
-	std::ofstream os(name + ".vtk");
-	os << "# vtk DataFile Version 2.0\n";
-	os << "CLIP\n";
-	os << "ASCII\n";
-	os << "DATASET UNSTRUCTURED_GRID\n\n";
-
-	os << "POINTS " << points.size() << " float\n";
-	for (size_t pp = 0; pp < points.size(); ++pp) {
-		os << points[pp].x << " " << points[pp].y << " " << points[pp].z << "\n";
-	}
-	os << "\n";
-
-	esint cnodes = 0;
-	for (size_t cc = 0; cc < cells.size(); ++cc) {
-		cnodes += cells[cc].size();
-	}
-
-	os << "CELLS " << cells.size() << " " << cells.size() + cnodes << "\n";
-	for (size_t cc = 0; cc < cells.size(); ++cc) {
-		os << cells[cc].size();
-		for (size_t cn = 0; cn < cells[cc].size(); ++cn) {
-			os << " " << cells[cc][cn];
-		}
-		os << "\n";
-	}
-	os << "\n";
-
-	os << "CELL_TYPES " << celltypes.size() << "\n";
-	for (size_t cc = 0; cc < celltypes.size(); ++cc) {
-		os << celltypes[cc] << "\n";
-	}
-	os << "\n";
-
-	os << "CELL_DATA " << cells.size() << "\n";
-	os << "SCALARS DISTANCE float 1\n";
-	os << "LOOKUP_TABLE default\n";
-	for (size_t dd = 0; dd < celldata.size(); ++dd) {
-		for (size_t cd = 0; cd < celldata[dd].size(); ++cd) {
-			os << celldata[dd][cd] << "\n";
+	if (Visualization::isRoot()) {
+		_writer.cells(csize, csize + nsize);
+	}
+	std::vector<int> cells(_cnodes.size() + _ctypes.size());
+	std::vector<esint> distribution = tarray<esint>::distribute(info::env::threads, _ctypes.size());
+	#pragma omp parallel for
+	for (int t = 0; t < info::env::threads; ++t) {
+		for (esint c = distribution[t]; c < distribution[t + 1]; ++c) {
+			int *cell = cells.data() + _cdistribution[c] + c;
+			*cell++ = _cdistribution[c + 1] - _cdistribution[c];
+			for (esint n = _cdistribution[c]; n < _cdistribution[c + 1]; ++n) {
+				*cell++ = _cnodes[n] + poffset;
+			}
 		}
 	}
-}
+	_writer.int32s(cells.size(), [&] (esint i) { return cells[i]; });
+	_writer.groupData();
 
-void DebugOutput::etypes(esint esize, esint nother)
-{
 	if (Visualization::isRoot()) {
-		_writer.celltypes(esize + nother);
-	}
-	for (auto e = _mesh.elements->epointers->datatarray().begin(); e != _mesh.elements->epointers->datatarray().end(); ++e) {
-		_writer.type((*e)->code);
+		_writer.celltypes(csize);
 	}
+	_writer.int32s(_ctypes.size(), [&] (esint i) { return _ctypes[i]; });
 	_writer.groupData();
-}
 
-DebugOutput::~DebugOutput()
-{
-	if (_dcenters) { delete[] _dcenters; }
+	_writer.commitFile(_path + name);
+	_writer.reorder();
+	_writer.write();
 }
 
 void DebugOutput::mesh(double clusterShrinkRatio, double domainShrinkRatio)
@@ -209,154 +190,106 @@ void DebugOutput::mesh(double clusterShrinkRatio, double domainShrinkRatio)
 	}
 
 	DebugOutput output(clusterShrinkRatio, 1, false);
-
-	esint noffset, nsize;
-	output.points(0, noffset, nsize);
-	output._writer.groupData();
-
-	esint esize = output.elements(noffset, 0, 0);
-	output._writer.groupData();
-
-	output.etypes(esize, 0);
-	output._writer.groupData();
-
-	output._writer.commitFile(output._path + "mesh.vtk");
-	output._writer.reorder();
-	output._writer.write();
-}
-
-void DebugOutput::faceNeighbors()
-{
-	if (!info::config::output.debug) {
-		return;
-	}
-
-	DebugOutput output(1, 1, false);
-
-	if (output._mesh.elements->centers == NULL) {
-		mesh::computeElementsCenters(info::mesh->nodes, info::mesh->elements);
-	}
-
-	esint psize = output._mesh.elements->centers->datatarray().size(), gpsize;
-	Communication::allReduce(&psize, &gpsize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-	if (Visualization::isRoot()) {
-		output._writer.points(gpsize);
-	}
-	for (size_t n = 0; n < output._mesh.elements->centers->datatarray().size(); ++n) {
-		Point &p = output._mesh.elements->centers->datatarray()[n];
-		output._writer.point(p.x, p.y, p.z);
-	}
-	output._writer.groupData();
-
-	esint esize = 0, gesize;
-	auto id = output._mesh.elements->IDs->begin();
-	for (auto neigh = output._mesh.elements->faceNeighbors->begin(); neigh != output._mesh.elements->faceNeighbors->end(); ++neigh, ++id) {
-		for (auto n = neigh->begin(); n != neigh->end(); ++n) {
-			if (id->front() < *n) {
-				++esize;
+	std::vector<char> selection = output.selectedElements();
+
+	// only nodes of selected elements are stored
+	std::vector<esint> nmap(output._mesh.nodes->size, -1);
+	auto enodes = output._mesh.elements->nodes->cbegin();
+	for (size_t e = 0; e < selection.size(); ++e, ++enodes) {
+		if (selection[e]) {
+			for (auto n = enodes->begin(); n != enodes->end(); ++n) {
+				nmap[*n] = 0;
 			}
 		}
 	}
-	Communication::allReduce(&esize, &gesize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-
-	if (Visualization::isRoot()) {
-		output._writer.cells(gesize, gesize + 2 * gesize);
+	for (esint n = 0; n < output._mesh.nodes->size; ++n) {
+		if (nmap[n] == 0) {
+			nmap[n] = output._points.size();
+			output._points.push_back(Visualization::shrink(output._mesh.nodes->coordinates->datatarray()[n], output._ccenter, Point(), output._clusterShrinkRatio, 1));
+		}
 	}
 
-	id = output._mesh.elements->IDs->begin();
-	for (auto neigh = output._mesh.elements->faceNeighbors->begin(); neigh != output._mesh.elements->faceNeighbors->end(); ++neigh, ++id) {
-		for (auto n = neigh->begin(); n != neigh->end(); ++n) {
-			if (id->front() < *n) {
-				esint nn[2] = { id->front(), *n };
-				output._writer.cell(2, nn);
+	int threads = info::env::threads;
+	std::vector<std::vector<esint> > tsizes(threads), tnodes(threads);
+	std::vector<std::vector<int> > ttypes(threads);
+	std::vector<esint> distribution = tarray<esint>::distribute(threads, selection.size());
+	#pragma omp parallel for
+	for (int t = 0; t < threads; ++t) {
+		auto enodes = output._mesh.elements->nodes->cbegin() + distribution[t];
+		for (esint e = distribution[t]; e < distribution[t + 1]; ++e, ++enodes) {
+			if (selection[e]) {
+				tsizes[t].push_back(enodes->size());
+				for (auto n = enodes->begin(); n != enodes->end(); ++n) {
+					tnodes[t].push_back(nmap[*n]);
+				}
+				ttypes[t].push_back(VTKASCIIWritter::ecode(output._mesh.elements->epointers->datatarray()[e]->code));
 			}
 		}
 	}
-	output._writer.groupData();
+	output.cells(tsizes, tnodes, ttypes);
+	output.store("mesh.vtk");
+}
 
-	if (Visualization::isRoot()) {
-		output._writer.celltypes(gesize);
+// points are centers of all elements (edges refer to them by IDs), edges are stored for selected elements
+void DebugOutput::graph(const std::string &name, const std::function<std::pair<const esint*, const esint*>(esint)> &neighbors)
+{
+	if (_mesh.elements->centers == NULL) {
+		mesh::computeElementsCenters(info::mesh->nodes, info::mesh->elements);
 	}
-	id = output._mesh.elements->IDs->begin();
-	for (auto neigh = output._mesh.elements->faceNeighbors->begin(); neigh != output._mesh.elements->faceNeighbors->end(); ++neigh, ++id) {
-		for (auto n = neigh->begin(); n != neigh->end(); ++n) {
-			if (id->front() < *n) {
-				output._writer.type(Element::CODE::LINE2);
+	std::vector<char> selection = selectedElements();
+
+	_points.assign(_mesh.elements->centers->datatarray().begin(), _mesh.elements->centers->datatarray().end());
+	esint poffset = _points.size();
+	Communication::exscan(poffset);
+
+	int threads = info::env::threads;
+	std::vector<std::vector<esint> > tsizes(threads), tnodes(threads);
+	std::vector<std::vector<int> > ttypes(threads);
+	std::vector<esint> distribution = tarray<esint>::distribute(threads, selection.size());
+	#pragma omp parallel for
+	for (int t = 0; t < threads; ++t) {
+		for (esint e = distribution[t]; e < distribution[t + 1]; ++e) {
+			if (selection[e]) {
+				esint id = _mesh.elements->IDs->datatarray()[e];
+				std::pair<const esint*, const esint*> neighs = neighbors(e);
+				for (const esint *n = neighs.first; n != neighs.second; ++n) {
+					if (id < *n) {
+						tsizes[t].push_back(2);
+						tnodes[t].push_back(id - poffset);
+						tnodes[t].push_back(*n - poffset);
+						ttypes[t].push_back(VTKASCIIWritter::ecode(Element::CODE::LINE2));
+					}
+				}
 			}
 		}
 	}
-	output._writer.groupData();
-
-	output._writer.commitFile(output._path + "faceNeighbors.vtk");
-	output._writer.reorder();
-	output._writer.write();
+	cells(tsizes, tnodes, ttypes);
+	store(name);
 }
 
-void DebugOutput::meshDual(std::vector<esint> &frames, std::vector<esint> &neighbors)
+void DebugOutput::faceNeighbors()
 {
 	if (!info::config::output.debug) {
 		return;
 	}
 
 	DebugOutput output(1, 1, false);
+	output.graph("faceNeighbors.vtk", [&] (esint e) {
+		auto neighs = output._mesh.elements->faceNeighbors->cbegin() + e;
+		return std::make_pair(neighs->data(), neighs->data() + neighs->size());
+	});
+}
 
-	if (output._mesh.elements->centers == NULL) {
-		mesh::computeElementsCenters(info::mesh->nodes, info::mesh->elements);
-	}
-
-	esint psize = output._mesh.elements->centers->datatarray().size(), gpsize;
-	Communication::allReduce(&psize, &gpsize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-	if (Visualization::isRoot()) {
-		output._writer.points(gpsize);
-	}
-	for (size_t n = 0; n < output._mesh.elements->centers->datatarray().size(); ++n) {
-		Point &p = output._mesh.elements->centers->datatarray()[n];
-		output._writer.point(p.x, p.y, p.z);
-	}
-	output._writer.groupData();
-
-	esint esize = 0, gesize;
-	auto id = output._mesh.elements->IDs->begin();
-	for (size_t e = 0; e < frames.size() - 1; ++e, ++id) {
-		for (auto n = frames[e]; n != frames[e + 1]; ++n) {
-			if (id->front() < neighbors[n]) {
-				++esize;
-			}
-		}
-	}
-	Communication::allReduce(&esize, &gesize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-
-	if (Visualization::isRoot()) {
-		output._writer.cells(gesize, gesize + 2 * gesize);
-	}
-
-	id = output._mesh.elements->IDs->begin();
-	for (size_t e = 0; e < frames.size() - 1; ++e, ++id) {
-		for (auto n = frames[e]; n != frames[e + 1]; ++n) {
-			if (id->front() < neighbors[n]) {
-				esint nn[2] = { id->front(), neighbors[n] };
-				output._writer.cell(2, nn);
-			}
-		}
-	}
-	output._writer.groupData();
-
-	if (Visualization::isRoot()) {
-		output._writer.celltypes(gesize);
-	}
-	id = output._mesh.elements->IDs->begin();
-	for (size_t e = 0; e < frames.size() - 1; ++e, ++id) {
-		for (auto n = frames[e]; n != frames[e + 1]; ++n) {
-			if (id->front() < neighbors[n]) {
-				output._writer.type(Element::CODE::LINE2);
-			}
-		}
+void DebugOutput::meshDual(std::vector<esint> &frames, std::vector<esint> &neighbors)
+{
+	if (!info::config::output.debug) {
+		return;
 	}
-	output._writer.groupData();
 
-	output._writer.commitFile(output._path + "meshDual.vtk");
-	output._writer.reorder();
-	output._writer.write();
+	DebugOutput output(1, 1, false);
+	output.graph("meshDual.vtk", [&] (esint e) {
+		return std::make_pair<const esint*, const esint*>(neighbors.data() + frames[e], neighbors.data() + frames[e + 1]);
+	});
 }
 
 void DebugOutput::corners(double clusterShrinkRatio, double domainShrinkRatio)
@@ -391,70 +324,30 @@ void DebugOutput::contact(double clusterShrinkRatio, double domainShrinkRatio)
 	auto *sside = info::mesh->contact->sparseSide;
 	auto *dside = info::mesh->contact->denseSide;
 
-	esint cells = 0, gcells, points = 0, poffset;
-	for (auto s = sside->datatarray().begin(); s != sside->datatarray().end(); ++s) {
-		for (auto d = dside->datatarray().begin() + s->denseSegmentBegin; d != dside->datatarray().begin() + s->denseSegmentEnd; ++d) {
-			if (!d->skip) {
-				points += 3 * d->triangles;
-				cells += d->triangles;
-			}
-		}
-	}
-
-	poffset = points;
-	points = Communication::exscan(poffset);
-	Communication::allReduce(&cells, &gcells, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-
-	if (Visualization::isRoot()) {
-		output._writer.points(points);
-	}
-
-	esint triangle = 0;
-	for (auto s = sside->datatarray().begin(); s != sside->datatarray().end(); ++s) {
-		for (auto d = dside->datatarray().begin() + s->denseSegmentBegin; d != dside->datatarray().begin() + s->denseSegmentEnd; ++d) {
-			if (!d->skip) {
-				for (esint t = 0; t < d->triangles; ++t) {
-					const Triangle &tr = output._mesh.contact->intersections->datatarray()[triangle++];
-					output._writer.point(tr.p[0].x, tr.p[0].y, tr.p[0].z);
-					output._writer.point(tr.p[1].x, tr.p[1].y, tr.p[1].z);
-					output._writer.point(tr.p[2].x, tr.p[2].y, tr.p[2].z);
-				}
-			} else {
-				triangle += d->triangles;
-			}
-		}
-	}
-	output._writer.groupData();
-
-	if (Visualization::isRoot()) {
-		output._writer.cells(gcells, 4 * gcells);
-	}
-	for (auto s = sside->datatarray().begin(); s != sside->datatarray().end(); ++s) {
-		for (auto d = dside->datatarray().begin() + s->denseSegmentBegin; d != dside->datatarray().begin() + s->denseSegmentEnd; ++d) {
-			if (!d->skip) {
-				for (esint t = d->triangleOffset; t < d->triangleOffset + d->triangles; ++t) {
-					esint nn[3] = { poffset++, poffset++, poffset++};
-					output._writer.cell(3, nn);
+	std::vector<std::vector<esint> > tsizes(1), tnodes(1);
+	std::vector<std::vector<int> > ttypes(1);
+	if (selectedRank()) {
+		esint triangle = 0;
+		for (auto s = sside->datatarray().begin(); s != sside->datatarray().end(); ++s) {
+			for (auto d = dside->datatarray().begin() + s->denseSegmentBegin; d != dside->datatarray().begin() + s->denseSegmentEnd; ++d) {
+				for (esint t = 0; t < d->triangles; ++t, ++triangle) {
+					const Triangle &tr = output._mesh.contact->intersections->datatarray()[triangle];
+					if (!d->skip && output.selected((tr.p[0] + tr.p[1] + tr.p[2]) / 3)) {
+						for (int p = 0; p < 3; ++p) {
+							tnodes[0].push_back(output._points.size());
+							output._points.push_back(tr.p[p]);
+						}
+						tsizes[0].push_back(3);
+						ttypes[0].push_back(VTKASCIIWritter::ecode(Element::CODE::TRIANGLE3));
+					}
 				}
 			}
 		}
 	}
-	output._writer.groupData();
-
-	if (Visualization::isRoot()) {
-		output._writer.celltypes(gcells);
-	}
-	for (esint i = 0; i < cells; ++i) {
-		output._writer.type(Element::CODE::TRIANGLE3);
-	}
-	output._writer.groupData();
-
-	output._writer.commitFile(output._path + "contact.vtk");
-	output._writer.reorder();
-	output._writer.write();
+	output.cells(tsizes, tnodes, ttypes);
+	output.store("contact.vtk");
 }
 
-
 void DebugOutput::surface(const char* name, double clusterShrinkRatio, double domainShrinkRatio)
 {
 	if (!info::config::output.debug) {
@@ -462,36 +355,46 @@ void DebugOutput::surface(const char* name, double clusterShrinkRatio, double do
 	}
 
 	DebugOutput output(clusterShrinkRatio, domainShrinkRatio, false);
+	SurfaceStore *surf = output._mesh.surface;
 
-	esint points = 0, noffset, nsize;
-	output.points(points, noffset, nsize);
-
-	// elements
-
-	esint gesize, esize = output._mesh.surface->epointers->datatarray().size();
-	Communication::allReduce(&esize, &gesize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-	esint gensize, ensize = output._mesh.surface->enodes->datatarray().size();
-	Communication::allReduce(&ensize, &gensize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-
-	if (Visualization::isRoot()) {
-		output._writer.cells(gesize, gesize + gensize);
+	// only nodes of selected elements are stored
+	std::vector<esint> nmap(surf->coordinates->datatarray().size(), -1);
+	std::vector<char> selection(surf->epointers->datatarray().size(), selectedRank());
+	auto enodes = surf->enodes->cbegin();
+	for (size_t e = 0; e < selection.size(); ++e, ++enodes) {
+		if (selection[e]) {
+			Point center;
+			for (auto n = enodes->begin(); n != enodes->end(); ++n) {
+				center += surf->coordinates->datatarray()[*n];
+			}
+			if ((selection[e] = output.selected(center / enodes->size()))) {
+				for (auto n = enodes->begin(); n != enodes->end(); ++n) {
+					nmap[*n] = 0;
+				}
+			}
+		}
 	}
-
-	for (auto e = output._mesh.surface->enodes->begin(); e != output._mesh.surface->enodes->end(); ++e) {
-		output._writer.cell(e->size(), e->data(), output._mesh.surface->nodes->datatarray().data(), noffset);
+	for (size_t n = 0; n < nmap.size(); ++n) {
+		if (nmap[n] == 0) {
+			nmap[n] = output._points.size();
+			output._points.push_back(Visualization::shrink(surf->coordinates->datatarray()[n], output._ccenter, Point(), output._clusterShrinkRatio, 1));
+		}
 	}
-	output._writer.groupData();
 
-	if (Visualization::isRoot()) {
-		output._writer.celltypes(gesize);
-	}
-	for (auto e = output._mesh.surface->epointers->datatarray().begin(); e != output._mesh.surface->epointers->datatarray().end(); ++e) {
-		output._writer.type((*e)->code);
+	std::vector<std::vector<esint> > tsizes(1), tnodes(1);
+	std::vector<std::vector<int> > ttypes(1);
+	enodes = surf->enodes->cbegin();
+	for (size_t e = 0; e < selection.size(); ++e, ++enodes) {
+		if (selection[e]) {
+			tsizes[0].push_back(enodes->size());
+			for (auto n = enodes->begin(); n != enodes->end(); ++n) {
+				tnodes[0].push_back(nmap[*n]);
+			}
+			ttypes[0].push_back(VTKASCIIWritter::ecode(surf->epointers->datatarray()[e]->code));
+		}
 	}
-	output._writer.groupData();
-	output._writer.commitFile(output._path + std::string(name) + ".vtk");
-	output._writer.reorder();
-	output._writer.write();
+	output.cells(tsizes, tnodes, ttypes);
+	output.store(std::string(name) + ".vtk");
 }
 
 void DebugOutput::warpedNormals(const char* name, double clusterShrinkRatio, double domainShrinkRatio)
@@ -501,66 +404,84 @@ void DebugOutput::warpedNormals(const char* name, double clusterShrinkRatio, dou
 	}
 
 	DebugOutput output(1, 1, false);
-
 	SurfaceStore *surf = output._mesh.surface;
 
-	esint psize = surf->enodes->datatarray().size() + 2 * surf->size, gpsize;
-	Communication::allReduce(&psize, &gpsize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
-	if (Visualization::isRoot()) {
-		output._writer.points(gpsize);
-	}
-	auto enodes = surf->enodes->begin();
-	auto normal = surf->normal->datatarray().begin();
-	auto center = surf->base->datatarray().begin();
-	for (esint e = 0; e < surf->size; ++e, ++enodes, ++normal, ++center) {
-		Point &p = *center;
-		Point &n = *normal;
-		double scale = 0.001;
-		output._writer.point(p.x, p.y, p.z);
-		output._writer.point(p.x + scale * n.x, p.y + scale * n.y, p.z + scale * n.z);
-		for (auto nn = enodes->begin(); nn != enodes->end(); ++nn) {
-			Point pn = surf->coordinates->datatarray()[*nn];
-			double distance = (pn - p) * n;
-			pn = pn - n * distance;
-			output._writer.point(pn.x, pn.y, pn.z);
+	// a normal is a line from the element center, nodes are projected to the plane given by the normal
+	std::vector<std::vector<esint> > tsizes(1), tnodes(1);
+	std::vector<std::vector<int> > ttypes(1);
+	if (selectedRank()) {
+		auto enodes = surf->enodes->cbegin();
+		auto normal = surf->normal->datatarray().begin();
+		auto center = surf->base->datatarray().begin();
+		for (esint e = 0; e < surf->size; ++e, ++enodes, ++normal, ++center) {
+			const Point &p = *center, &n = *normal;
+			if (!output.selected(p)) {
+				continue;
+			}
+			double scale = 0.001;
+			tsizes[0].push_back(2);
+			tnodes[0].push_back(output._points.size());
+			output._points.push_back(p);
+			tnodes[0].push_back(output._points.size());
+			output._points.push_back(p + n * scale);
+			ttypes[0].push_back(VTKASCIIWritter::ecode(Element::CODE::LINE2));
+
+			tsizes[0].push_back(enodes->size());
+			for (auto nn = enodes->begin(); nn != enodes->end(); ++nn) {
+				Point pn = surf->coordinates->datatarray()[*nn];
+				tnodes[0].push_back(output._points.size());
+				output._points.push_back(pn - n * ((pn - p) * n));
+			}
+			ttypes[0].push_back(VTKASCIIWritter::ecode(surf->epointers->datatarray()[e]->code));
 		}
 	}
-	output._writer.groupData();
+	output.cells(tsizes, tnodes, ttypes);
+	output.store(std::string(name) + ".vtk");
+}
 
-	esint esize = 2 * surf->size, gesize;
-	Communication::allReduce(&esize, &gesize, 1, MPITools::getType<esint>().mpitype, MPI_SUM);
+void DebugOutput::data(const std::string &name, const std::vector<Point> &points, const std::vector<std::vector<esint> > &cells, const std::vector<esint> &celltypes, const std::vector<std::vector<double> > &celldata)
+{
+	std::ofstream os(name + ".vtk");
+	os << "# vtk DataFile Version 2.0\n";
+	os << "CLIP\n";
+	os << "ASCII\n";
+	os << "DATASET UNSTRUCTURED_GRID\n\n";
 
-	if (Visualization::isRoot()) {
-		output._writer.cells(gesize, gesize + gpsize);
+	os << "POINTS " << points.size() << " float\n";
+	for (size_t pp = 0; pp < points.size(); ++pp) {
+		os << points[pp].x << " " << points[pp].y << " " << points[pp].z << "\n";
 	}
-	enodes = surf->enodes->begin();
-	for (esint e = 0, n = 0; e < surf->size; ++e, ++enodes) {
-		output._writer.int32s(2);
-		output._writer.int32s(n++);
-		output._writer.int32ln(n++);
+	os << "\n";
 
-		output._writer.int32s(enodes->size());
-		for (auto nn = enodes->begin(); nn != enodes->end(); ++nn) {
-			output._writer.int32s(n++);
-		}
-		output._writer.push('\n');
+	esint cnodes = 0;
+	for (size_t cc = 0; cc < cells.size(); ++cc) {
+		cnodes += cells[cc].size();
 	}
 
-	output._writer.groupData();
-
-	if (Visualization::isRoot()) {
-		output._writer.celltypes(gesize);
+	os << "CELLS " << cells.size() << " " << cells.size() + cnodes << "\n";
+	for (size_t cc = 0; cc < cells.size(); ++cc) {
+		os << cells[cc].size();
+		for (size_t cn = 0; cn < cells[cc].size(); ++cn) {
+			os << " " << cells[cc][cn];
+		}
+		os << "\n";
 	}
-	auto epointers = surf->epointers->datatarray().begin();
-	for (esint e = 0; e < surf->size; ++e, ++epointers) {
-		output._writer.type(Element::CODE::LINE2);
-		output._writer.type((*epointers)->code);
+	os << "\n";
+
+	os << "CELL_TYPES " << celltypes.size() << "\n";
+	for (size_t cc = 0; cc < celltypes.size(); ++cc) {
+		os << celltypes[cc] << "\n";
 	}
-	output._writer.groupData();
+	os << "\n";
 
-	output._writer.commitFile(output._path + std::string(name) + ".vtk");
-	output._writer.reorder();
-	output._writer.write();
+	os << "CELL_DATA " << cells.size() << "\n";
+	os << "SCALARS DISTANCE float 1\n";
+	os << "LOOKUP_TABLE default\n";
+	for (size_t dd = 0; dd < celldata.size(); ++dd) {
+		for (size_t cd = 0; cd < celldata[dd].size(); ++cd) {
+			os << celldata[dd][cd] << "\n";
+		}
+	}
 }
 
 void DebugOutput::closeElements(double clusterShrinkRatio, double domainShrinkRatio)
@@ -4,8 +4,10 @@
 
 #include "writer/vtkwritter.h"
 #include "basis/containers/point.h"
+#include <functional>
 #include <string>
 #include <sstream>
+#include <utility>
 
 namespace mesio {
 
@@ -35,19 +37,24 @@ protected:
 	DebugOutput(double clusterShrinkRatio, double domainShrinkRatio, bool withDomains);
 	~DebugOutput();
 
-	void points(esint nother, esint &noffset, esint &nsize);
-	void pointsInDomains(esint nother, esint &noffset, esint &nsize);
-	esint elements(esint noffset, esint nother, esint nothernodes);
-	esint elementsInDomains(esint noffset, esint nother, esint nothernodes);
-	void etypes(esint esize, esint nother);
+	bool selected(const Point &p) const;
+	std::vector<char> selectedElements() const;
+	void cells(const std::vector<std::vector<esint> > &tsizes, const std::vector<std::vector<esint> > &tnodes, const std::vector<std::vector<int> > &ttypes);
+	void store(const std::string &name);
+	void graph(const std::string &name, const std::function<std::pair<const esint*, const esint*>(esint)> &neighbors);
 
 	std::string _path;
-	VTKASCIIWritter _writer;
+	VTKBinaryWritter _writer;
 
 	Mesh &_mesh;
 	Point _ccenter;
 	Point *_dcenters;
 	double _clusterShrinkRatio, _domainShrinkRatio;
+
+	// the local part of the stored mesh (nodes of cells are local indices of points)
+	std::vector<Point> _points;
+	std::vector<esint> _cdistribution, _cnodes;
+	std::vector<int> _ctypes;
 };
 
 }
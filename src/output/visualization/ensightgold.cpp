@@ -23,7 +23,7 @@
 using namespace mesio;
 
 EnSightGold::EnSightGold()
-: _ftt(NULL), _withIDs(false), _step(-1)
+: _withIDs(false), _changeCoordinates(info::config::output.change_coords), _nsteps(0), _tail(0)
 {
 	_geometry = _directory + _name + ".geo";
 	_fixedDataPath = _directory;
@@ -34,21 +34,11 @@ EnSightGold::~EnSightGold()
 
 }
 
-EnSightGold::FTT::FTT(EnSightGold *parent)
-: EnSightGold()
-{
-//	_directory += std::to_string(step::outfrequency.current) + "/";
-//	_name = parent->_name + ".freq." + std::to_string(step::outfrequency.current);
-	if (isRoot()) {
-		createOutputDirectory();
-	}
-}
-
 void EnSightGold::updateMesh()
 {
 	if (_measure) { eslog::startln("ENSIGHT: STORING STARTED", "ENSIGHT"); }
 	if (info::mpi::irank == 0) {
-		geometry();
+		geometry(false);
 //		if (info::config::output.store_decomposition) {
 //			decomposition();
 //		}
@@ -70,52 +60,31 @@ void EnSightGold::updateMesh()
 
 void EnSightGold::updateSolution()
 {
-	EnSightGold *writer = this;
-
-//	if (step::outstep.type == step::TYPE::FTT && step::outftt.isFirst()) {
-//		_ftt = new FTT(this);
-//	}
-//
-//	switch (step::outstep.type) {
-//	case step::TYPE::TIME:      _times.push_back(step::outtime.current); break;
-//	case step::TYPE::FREQUENCY: _times.push_back(step::outfrequency.current); break;
-//	case step::TYPE::FTT: _ftt->_times.push_back(step::outftt.time); writer = _ftt; break;
-//	}
+	_times.push_back(_time);
+	if (_times.size() == 1) {
+		_variables.clear(); // variables of the first step are listed in the case file
+	}
 
-	size_t nvars = 0;
+	if (_changeCoordinates && _times.size() > 1 && info::mpi::irank == 0) {
+		geometry(true);
+	}
 	for (size_t di = 0; di < info::mesh->elements->data.size(); di++) {
-		nvars += writer->edata(info::mesh->elements->data[di]);
+		edata(info::mesh->elements->data[di]);
 	}
 	for (size_t di = 0; di < info::mesh->nodes->data.size(); di++) {
-		nvars += writer->ndata(info::mesh->nodes->data[di]);
+		ndata(info::mesh->nodes->data[di]);
 	}
-//	if (nvars != _variables.size()) {
-//		_variables.clear();
-//	}
-
-//	if (_step != step::outstep.loadstep || info::mpi::grank == 0 || (step::outstep.type == step::TYPE::FTT && info::mpi::rank == 0)) {
-//		_step = step::outstep.loadstep;
-//		if (step::outduplicate.instances > 1 && step::outstep.substep - step::outduplicate.offset + 1 == step::outduplicate.size) {
-//			// TODO: generalize
-//			_times.clear();
-//			for (auto f = step::outfrequency.start; f < step::outfrequency.final; f += step::outfrequency.shift) {
-//				_times.push_back(f + step::outfrequency.shift);
-//			}
-//		}
-//
-//		updateValues();
-//	}
 
-	writer->_writer.reorder();
-	writer->_writer.write();
+	_writer.reorder();
+	_writer.write();
 
-	if (info::mpi::rank == 0) {
-		casefile();
+	if (info::mpi::grank == 0) {
+		if (_times.size() == 1) {
+			casefile();
+		} else {
+			timestep();
+		}
 	}
-
-//	if (step::outstep.type == step::TYPE::FTT && step::outftt.isLast()) {
-//		delete _ftt;
-//	}
 }
 
 std::string EnSightGold::dataname(const NamedData *data, int d)
@@ -129,9 +98,19 @@ std::string EnSightGold::dataname(const NamedData *data, int d)
 	return data->name + data->suffix(d);
 }
 
+static std::string filesection(size_t steps)
+{
+	return "\n\nFILE\nfile set:               1\nnumber of steps:        " + std::to_string(steps) + "\n";
+}
+
 void EnSightGold::casefile()
 {
-	std::ofstream os(_path + _name + ".case");
+	std::vector<double> times = _times;
+	if (_changeCoordinates && times.empty()) {
+		times.push_back(0); // the geometry is the first step
+	}
+
+	std::stringstream os;
 
 	os << "\n# output from MESIO library (mesio.it4.cz)";
 	os << "\n#";
@@ -140,7 +119,11 @@ void EnSightGold::casefile()
 	os << "\ntype: ensight gold";
 	os << "\n";
 	os << "\nGEOMETRY";
-	os << "\nmodel: " << _geometry;
+	if (_changeCoordinates) {
+		os << "\nmodel: 1 1 " << _geometry << " change_coords_only";
+	} else {
+		os << "\nmodel: " << _geometry;
+	}
 	os << "\n";
 	os << "\nVARIABLE";
 	os << "\n";
@@ -150,31 +133,53 @@ void EnSightGold::casefile()
 //		os << "scalar per element: CLUSTER " << _fixedDataPath << "CLUSTER" << "\n";
 //		os << "scalar per element: MPI     " << _fixedDataPath << "MPI" << "\n";
 //	}
-	if (_times.size()) {
+	if (times.size()) {
 		for (size_t i = 0; i < _variables.size(); ++i) {
 			os << "\n" << _variables[i];
 		}
 		os << "\n";
 		os << "\nTIME";
 		os << "\ntime set:               1";
-		os << "\nnumber of steps:        " << _times.size();
-		os << "\nfilename start numbers: 1";
-		os << "\nfilename increment:     1";
+		os << "\nnumber of steps:        ";
+		_nsteps = os.tellp();
+		os << std::setw(10) << std::left << times.size();
 		os << "\ntime values:";
-		for (size_t i = 0; i < _times.size(); ++i) {
-			if (i % 10 == 0) {
-				os << "\n" << _times[i];
-			} else {
-				os << " " << _times[i];
-			}
+		for (size_t i = 0; i < times.size(); ++i) {
+			os << "\n" << times[i];
 		}
+		_tail = os.tellp();
+		os << filesection(times.size());
 	}
+
+	std::ofstream(_path + _name + ".case") << os.str();
 }
 
-void EnSightGold::geometry()
+void EnSightGold::timestep()
+{
+	// only the number of steps is rewritten, the time value and the file section are appended
+	std::stringstream steps, tail;
+	steps << std::setw(10) << std::left << _times.size();
+	tail << "\n" << _times.back();
+	size_t end = _tail + tail.str().size();
+	tail << filesection(_times.size());
+
+	std::fstream os(_path + _name + ".case", std::ios::in | std::ios::out);
+	os.seekp(_nsteps);
+	os << steps.str();
+	os.seekp(_tail);
+	os << tail.str();
+	_tail = end;
+}
+
+void EnSightGold::geometry(bool coordinatesOnly)
 {
 	if (isRoot()) {
-		_writer.format();
+		if (!coordinatesOnly) {
+			_writer.format();
+		}
+		if (_changeCoordinates) {
+			_writer.description("BEGIN TIME STEP");
+		}
 		_writer.description("EnSight Gold geometry format");
 		_writer.description("----------------------------");
 
@@ -192,17 +197,18 @@ void EnSightGold::geometry()
 			_writer.int32(store->nodeInfo.totalSize);
 		}
 
+		const esint *nodes = store->nodes->datatarray().data() + store->nodeInfo.nhalo;
 		if (_withIDs) {
-			for (esint n = 0, i = store->nodeInfo.nhalo; n < store->nodeInfo.size; ++n, ++i) {
-				_writer.int32(info::mesh->nodes->IDs->datatarray()[store->nodes->datatarray()[i]]);
-			}
+			_writer.int32s(store->nodeInfo.size, [&] (esint n) {
+				return (int)info::mesh->nodes->IDs->datatarray()[nodes[n]];
+			});
 			_writer.groupData();
 		}
 
 		for (int d = 0; d < 3; ++d) {
-			for (esint n = 0, i = store->nodeInfo.nhalo; n < store->nodeInfo.size; ++n, ++i) {
-				_writer.float32(info::mesh->nodes->coordinates->datatarray()[store->nodes->datatarray()[i]][d]);
-			}
+			_writer.float32s(store->nodeInfo.size, [&] (esint n) {
+				return (float)info::mesh->nodes->coordinates->datatarray()[nodes[n]][d];
+			});
 			_writer.groupData();
 		}
 	};
@@ -217,22 +223,21 @@ void EnSightGold::geometry()
 		}
 
 		nodes(region);
-		for (int etype = 0; etype < static_cast<int>(Element::CODE::SIZE); etype++) {
+		for (int etype = 0; !coordinatesOnly && etype < static_cast<int>(Element::CODE::SIZE); etype++) {
 			if (region->distribution.code[etype].totalSize) {
 				if (isRoot()) {
 					_writer.description(EnsightOutputWriter::codetotype(etype));
 					_writer.int32(region->distribution.code[etype].totalSize);
 				}
 
+				int enodes = Mesh::edata[etype].nodes;
 				for (size_t i = 0; i < region->eintervals.size(); i++) {
 					if (region->eintervals[i].code == etype) {
-						for (esint e = region->eintervals[i].begin; e < region->eintervals[i].end; ++e) {
-							auto element = info::mesh->elements->nodes->cbegin() + region->elements->datatarray()[e];
-							for (auto n = element->begin(); n != element->end(); ++n) {
-								_writer.enode(region->getPosition(*n) + 1);
-							}
-							_writer.eend();
-						}
+						const esint *elements = region->elements->datatarray().data() + region->eintervals[i].begin;
+						_writer.int32s((region->eintervals[i].end - region->eintervals[i].begin) * enodes, [&] (esint n) {
+							auto element = info::mesh->elements->nodes->cbegin() + elements[n / enodes];
+							return (int)region->getPosition(element->at(n % enodes)) + 1;
+						});
 					}
 				}
 
@@ -249,6 +254,9 @@ void EnSightGold::geometry()
 		}
 
 		nodes(region);
+		if (coordinatesOnly) {
+			return;
+		}
 		if (region->dimension) {
 			for (int etype = 0; etype < static_cast<int>(Element::CODE::SIZE); etype++) {
 				if (region->distribution.code[etype].totalSize) {
@@ -257,15 +265,14 @@ void EnSightGold::geometry()
 						_writer.int32(region->distribution.code[etype].totalSize);
 					}
 
+					int enodes = Mesh::edata[etype].nodes;
 					for (size_t i = 0; i < region->eintervals.size(); i++) {
 						if (region->eintervals[i].code == etype) {
-							for (esint e = region->eintervals[i].begin; e < region->eintervals[i].end; ++e) {
-								auto element = region->elements->cbegin() + e;
-								for (auto n = element->begin(); n != element->end(); ++n) {
-									_writer.enode(region->getPosition(*n) + 1);
-								}
-								_writer.eend();
-							}
+							esint begin = region->eintervals[i].begin;
+							_writer.int32s((region->eintervals[i].end - begin) * enodes, [&] (esint n) {
+								auto element = region->elements->cbegin() + begin + n / enodes;
+								return (int)region->getPosition(element->at(n % enodes)) + 1;
+							});
 						}
 					}
 
@@ -278,9 +285,9 @@ void EnSightGold::geometry()
 				_writer.int32(region->nodeInfo.totalSize);
 			}
 
-			for (esint i = 0; i < region->nodeInfo.size; ++i) {
-				_writer.int32(region->nodeInfo.offset + i + 1);
-			}
+			_writer.int32s(region->nodeInfo.size, [&] (esint i) {
+				return (int)(region->nodeInfo.offset + i + 1);
+			});
 			_writer.groupData();
 		}
 	};
@@ -293,7 +300,13 @@ void EnSightGold::geometry()
 		boundary(info::mesh->contactInterfaces[r]);
 	}
 
-	_writer.commitFile(_path + _geometry);
+	if (_changeCoordinates) {
+		if (isRoot()) {
+			_writer.description("END TIME STEP");
+		}
+		_writer.groupData();
+	}
+	_writer.commitFile(_path + _geometry, _changeCoordinates);
 }
 
 int EnSightGold::ndata(const NamedData *data)
@@ -301,111 +314,61 @@ int EnSightGold::ndata(const NamedData *data)
 	if (!storeData(data)) {
 		return 0;
 	}
-
-	auto niterator = [this] (esint size, esint *nodes, std::function<void(esint nindex)> callback) {
-		for (esint n = 0; n < size; ++n) {
-			callback(nodes[n]);
-		}
+	const std::vector<double> &dvalues = stored(data);
+
+	// values of the d-th dimension of all nodes of the region (zeros for d >= dimension)
+	auto values = [&] (const RegionStore *region, int d) {
+		const esint *nodes = region->nodes->datatarray().data() + region->nodeInfo.nhalo;
+		_writer.float32s(region->nodeInfo.size, [&] (esint n) {
+			return d < data->dimension ? (float)dvalues[nodes[n] * data->dimension + d] : 0.f;
+		});
 		_writer.groupData();
 	};
 
-	if (data->dataType == NamedData::DataType::VECTOR) {
-		std::stringstream file;
-		file << _path + _directory + dataname(data, 0) + "." << std::setw(4) << std::setfill('0') << _times.size();
-
+	auto store = [&] (int d, int dimension) {
+		std::string name = dataname(data, d);
+		if (_times.size() == 1) {
+			_variables.push_back(std::string(dimension == 1 ? "scalar" : "vector") + " per node: 1 1 " + name + " " + _directory + name);
+		}
 		if (isRoot()) {
-			_writer.description(dataname(data, 0));
+			_writer.description("BEGIN TIME STEP");
+			_writer.description(name);
 		}
 
 		int part = 1;
-		for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r, ++part) {
-			if (isRoot()) {
-				_writer.description("part");
-				_writer.int32(part);
-				_writer.description("coordinates");
-			}
-
-			const ElementsRegionStore *region = info::mesh->elementsRegions[r];
-			for (int d = 0; d < data->dimension; ++d) {
-				niterator(region->nodeInfo.size, region->nodes->datatarray().data() + region->nodeInfo.nhalo, [&] (esint nindex) {
-					_writer.float32(data->store[nindex * data->dimension + d]);
-				});
-			}
-			if (data->dimension == 2) {
-				niterator(region->nodeInfo.size, region->nodes->datatarray().data() + region->nodeInfo.nhalo, [&] (esint nindex) {
-					_writer.float32(0);
-				});
-			}
-		}
-
-		auto boundary = [&] (const BoundaryRegionStore *region) {
+		auto regiondata = [&] (const RegionStore *region) {
 			if (isRoot()) {
 				_writer.description("part");
-				_writer.int32(part);
+				_writer.int32(part++);
 				_writer.description("coordinates");
 			}
-
-			for (int d = 0; d < data->dimension; ++d) {
-				niterator(region->nodeInfo.size, region->nodes->datatarray().data() + region->nodeInfo.nhalo, [&] (esint nindex) {
-					_writer.float32(data->store[nindex * data->dimension + d]);
-				});
-			}
-			if (data->dimension == 2) {
-				niterator(region->nodeInfo.size, region->nodes->datatarray().data() + region->nodeInfo.nhalo, [&] (esint nindex) {
-					_writer.float32(0);
-				});
+			for (int dd = 0; dd < dimension; ++dd) {
+				values(region, dimension == 1 ? d : dd);
 			}
 		};
 
-		for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r, ++part) {
-			boundary(info::mesh->boundaryRegions[r]);
+		for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r) {
+			regiondata(info::mesh->elementsRegions[r]);
 		}
-		for (size_t r = 0; r < info::mesh->contactInterfaces.size(); ++r, ++part) {
-			boundary(info::mesh->contactInterfaces[r]);
+		for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r) {
+			regiondata(info::mesh->boundaryRegions[r]);
+		}
+		for (size_t r = 0; r < info::mesh->contactInterfaces.size(); ++r) {
+			regiondata(info::mesh->contactInterfaces[r]);
 		}
-		_writer.commitFile(file.str());
-	} else {
-		for (int d = 0; d < data->dimension; ++d) {
-			std::stringstream file;
-			file << _path + _directory + dataname(data, d) + "." << std::setw(4) << std::setfill('0') << _times.size();
-
-			if (isRoot()) {
-				_writer.description(dataname(data, d));
-			}
-
-			int part = 1;
-			for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r, ++part) {
-				if (isRoot()) {
-					_writer.description("part");
-					_writer.int32(part);
-					_writer.description("coordinates");
-				}
-
-				const ElementsRegionStore *region = info::mesh->elementsRegions[r];
-				niterator(region->nodeInfo.size, region->nodes->datatarray().data() + region->nodeInfo.nhalo, [&] (esint nindex) {
-					_writer.float32(data->store[nindex * data->dimension + d]);
-				});
-			}
-
-			auto boundary = [&] (const BoundaryRegionStore *region) {
-				if (isRoot()) {
-					_writer.description("part");
-					_writer.int32(part);
-					_writer.description("coordinates");
-				}
 
-				niterator(region->nodeInfo.size, region->nodes->datatarray().data() + region->nodeInfo.nhalo, [&] (esint nindex) {
-					_writer.float32(data->store[nindex * data->dimension + d]);
-				});
-			};
+		if (isRoot()) {
+			_writer.description("END TIME STEP");
+		}
+		_writer.groupData();
+		_writer.commitFile(_path + _directory + name, true);
+	};
 
-			for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r, ++part) {
-				boundary(info::mesh->boundaryRegions[r]);
-			}
-			for (size_t r = 0; r < info::mesh->contactInterfaces.size(); ++r, ++part) {
-				boundary(info::mesh->contactInterfaces[r]);
-			}
-			_writer.commitFile(file.str());
+	if (data->dataType == NamedData::DataType::VECTOR) {
+		store(0, 3);
+	} else {
+		for (int d = 0; d < data->dimension; ++d) {
+			store(d, 1);
 		}
 	}
 	return 1;
@@ -416,23 +379,29 @@ int EnSightGold::edata(const NamedData *data)
 	if (!storeData(data)) {
 		return 0;
 	}
+	const std::vector<double> &dvalues = stored(data);
 
-	auto eiterator = [&] (const ElementsRegionStore *region, int etype, std::function<void(const ElementsInterval &interval, esint eindex)> callback) {
+	// values of the d-th dimension of elements of the given type (zeros for d >= dimension)
+	auto values = [&] (const ElementsRegionStore *region, int etype, int d) {
 		for (size_t i = 0; i < region->eintervals.size(); i++) {
 			if (region->eintervals[i].code == etype) {
-				for (esint e = region->eintervals[i].begin; e < region->eintervals[i].end; ++e) {
-					callback(region->eintervals[i], region->elements->datatarray()[e]);
-				}
+				const esint *elements = region->elements->datatarray().data() + region->eintervals[i].begin;
+				_writer.float32s(region->eintervals[i].end - region->eintervals[i].begin, [&] (esint e) {
+					return d < data->dimension ? (float)dvalues[elements[e] * data->dimension + d] : 0.f;
+				});
 			}
 		}
 		_writer.groupData();
 	};
 
-	if (data->dataType == NamedData::DataType::VECTOR) {
-		std::stringstream file;
-		file << _path + _directory + dataname(data, 0) + "." << std::setw(4) << std::setfill('0') << _times.size();
+	auto store = [&] (int d, int dimension) {
+		std::string name = dataname(data, d);
+		if (_times.size() == 1) {
+			_variables.push_back(std::string(dimension == 1 ? "scalar" : "vector") + " per element: 1 1 " + name + " " + _directory + name);
+		}
 		if (isRoot()) {
-			_writer.description(dataname(data, 0));
+			_writer.description("BEGIN TIME STEP");
+			_writer.description(name);
 		}
 
 		for (size_t r = 1, part = 1; r < info::mesh->elementsRegions.size(); ++r, ++part) {
@@ -440,53 +409,30 @@ int EnSightGold::edata(const NamedData *data)
 				_writer.description("part");
 				_writer.int32(part);
 			}
-
 			for (int etype = 0; etype < static_cast<int>(Element::CODE::SIZE); etype++) {
 				if (info::mesh->elementsRegions[r]->distribution.code[etype].totalSize) {
 					if (isRoot()) {
 						_writer.description(EnsightOutputWriter::codetotype(etype));
 					}
-
-					for (int d = 0; d < data->dimension; ++d) {
-						eiterator(info::mesh->elementsRegions[r], etype, [&] (const ElementsInterval &interval, esint eindex) {
-							_writer.float32(data->store[eindex * data->dimension + d]);
-						});
-					}
-					if (data->dimension == 2) {
-						eiterator(info::mesh->elementsRegions[r], etype, [&] (const ElementsInterval &interval, esint eindex) {
-							_writer.float32(0);
-						});
+					for (int dd = 0; dd < dimension; ++dd) {
+						values(info::mesh->elementsRegions[r], etype, dimension == 1 ? d : dd);
 					}
 				}
 			}
 		}
-		_writer.commitFile(file.str());
-	} else {
-		for (int d = 0; d < data->dimension; ++d) {
-			std::stringstream file;
-			file << _path + _directory + dataname(data, d) + "." << std::setw(4) << std::setfill('0') << _times.size();
 
-			if (isRoot()) {
-				_writer.description(dataname(data, 0));
-			}
+		if (isRoot()) {
+			_writer.description("END TIME STEP");
+		}
+		_writer.groupData();
+		_writer.commitFile(_path + _directory + name, true);
+	};
 
-			for (size_t r = 1, part = 1; r < info::mesh->elementsRegions.size(); ++r, ++part) {
-				if (isRoot()) {
-					_writer.description("part");
-					_writer.int32(part);
-				}
-				for (int etype = 0; etype < static_cast<int>(Element::CODE::SIZE); etype++) {
-					if (info::mesh->elementsRegions[r]->distribution.code[etype].totalSize) {
-						if (isRoot()) {
-							_writer.description(EnsightOutputWriter::codetotype(etype));
-						}
-						eiterator(info::mesh->elementsRegions[r], etype, [&] (const ElementsInterval &interval, esint eindex) {
-							_writer.float32(data->store[eindex * data->dimension + d]);
-						});
-					}
-				}
-			}
-			_writer.commitFile(file.str());
+	if (data->dataType == NamedData::DataType::VECTOR) {
+		store(0, 3);
+	} else {
+		for (int d = 0; d < data->dimension; ++d) {
+			store(d, 1);
 		}
 	}
 	return 1;
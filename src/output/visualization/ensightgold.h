@@ -13,9 +13,8 @@ namespace mesio {
 class ElementsRegionStore;
 class ElementsInterval;
 
+// transient data are stored to single files (each step is appended between BEGIN TIME STEP / END TIME STEP)
 class EnSightGold: public Visualization {
-
-	class FTT;
 public:
 	EnSightGold();
 	~EnSightGold();
@@ -26,28 +25,21 @@ public:
 protected:
 	std::string dataname(const NamedData *data, int d);
 	void casefile();
-	void geometry();
+	void timestep();
+	void geometry(bool coordinatesOnly);
 	int ndata(const NamedData *data);
 	int edata(const NamedData *data);
 	void decomposition();
 
-	FTT *_ftt;
-
-	bool _withIDs;
-	int _step;
+	bool _withIDs, _changeCoordinates;
 	std::string _geometry;
 	std::string _fixedDataPath;
 	std::vector<std::string> _variables;
 	std::vector<double> _times;
+	size_t _nsteps, _tail; // offsets of the number of steps and the end of time values in the case file
 	EnsightBinaryOutputWriter _writer;
 };
 
-class EnSightGold::FTT: public EnSightGold {
-
-public:
-	FTT(EnSightGold *parent);
-};
-
 }
 
 #endif /* SRC_OUTPUT_VISUALIZATION_ENSIGHTGOLD_H_ */
@@ -16,7 +16,111 @@
 
 using namespace mesio;
 
+// hexahedron faces (outward) from HEXA8
+static const int hfaces[6][4] = { { 0, 1, 5, 4 }, { 3, 2, 1, 0 }, { 4, 5, 6, 7 }, { 7, 6, 2, 3 }, { 1, 2, 6, 5 }, { 3, 0, 4, 7 } };
+
+// prism permutations that move a given node to the position 0
+static const int ppermutation[6][6] = {
+		{ 0, 1, 2, 3, 4, 5 }, { 1, 2, 0, 4, 5, 3 }, { 2, 0, 1, 5, 3, 4 },
+		{ 3, 5, 4, 0, 2, 1 }, { 4, 3, 5, 1, 0, 2 }, { 5, 4, 3, 2, 1, 0 } };
+
+static int tetrasize(Element::CODE code)
+{
+	switch (code) {
+	case Element::CODE::TETRA4:
+	case Element::CODE::TETRA10:
+		return 1;
+	case Element::CODE::PYRAMID5:
+	case Element::CODE::PYRAMID13:
+		return 2;
+	case Element::CODE::PRISMA6:
+	case Element::CODE::PRISMA15:
+		return 3;
+	case Element::CODE::HEXA8:
+	case Element::CODE::HEXA20:
+		return 12;
+	default:
+		return 0;
+	}
+}
+
+static int trianglesize(Element::CODE code)
+{
+	switch (code) {
+	case Element::CODE::TRIANGLE3:
+	case Element::CODE::TRIANGLE6:
+		return 1;
+	case Element::CODE::SQUARE4:
+	case Element::CODE::SQUARE8:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+// split the quadrilateral [a, b, c, d] by the diagonal going through the node with the lowest global index
+// all processes choose the same diagonal for shared faces
+static void quadrilateral(const esint *n, int a, int b, int c, int d, int triangles[2][3])
+{
+	if (std::min(n[a], n[c]) < std::min(n[b], n[d])) {
+		triangles[0][0] = a; triangles[0][1] = b; triangles[0][2] = c;
+		triangles[1][0] = a; triangles[1][1] = c; triangles[1][2] = d;
+	} else {
+		triangles[0][0] = a; triangles[0][1] = b; triangles[0][2] = d;
+		triangles[1][0] = b; triangles[1][1] = c; triangles[1][2] = d;
+	}
+}
+
+// split element with global node indices 'n' into tetrahedra (local indices, index 8 is the center of a hexahedron)
+static int tetrahedra(Element::CODE code, const esint *n, int tetra[12][4])
+{
+	switch (code) {
+	case Element::CODE::TETRA4:
+	case Element::CODE::TETRA10:
+		tetra[0][0] = 0; tetra[0][1] = 1; tetra[0][2] = 2; tetra[0][3] = 3;
+		return 1;
+	case Element::CODE::PYRAMID5:
+	case Element::CODE::PYRAMID13: {
+		int triangles[2][3];
+		quadrilateral(n, 0, 1, 2, 3, triangles);
+		for (int t = 0; t < 2; ++t) {
+			tetra[t][0] = triangles[t][0]; tetra[t][1] = triangles[t][1]; tetra[t][2] = triangles[t][2]; tetra[t][3] = 4;
+		}
+		return 2;
+	}
+	case Element::CODE::PRISMA6:
+	case Element::CODE::PRISMA15: {
+		int min = std::min_element(n, n + 6) - n;
+		const int *v = ppermutation[min];
+		// faces with the minimal node are split by diagonals from v[0], the rest face [v1, v2, v5, v4] by the global rule
+		if (std::min(n[v[1]], n[v[5]]) < std::min(n[v[2]], n[v[4]])) {
+			tetra[0][0] = v[0]; tetra[0][1] = v[1]; tetra[0][2] = v[2]; tetra[0][3] = v[5];
+			tetra[1][0] = v[0]; tetra[1][1] = v[1]; tetra[1][2] = v[5]; tetra[1][3] = v[4];
+		} else {
+			tetra[0][0] = v[0]; tetra[0][1] = v[1]; tetra[0][2] = v[2]; tetra[0][3] = v[4];
+			tetra[1][0] = v[0]; tetra[1][1] = v[4]; tetra[1][2] = v[2]; tetra[1][3] = v[5];
+		}
+		tetra[2][0] = v[0]; tetra[2][1] = v[4]; tetra[2][2] = v[5]; tetra[2][3] = v[3];
+		return 3;
+	}
+	case Element::CODE::HEXA8:
+	case Element::CODE::HEXA20: {
+		int triangles[2][3];
+		for (int f = 0; f < 6; ++f) {
+			quadrilateral(n, hfaces[f][0], hfaces[f][1], hfaces[f][2], hfaces[f][3], triangles);
+			for (int t = 0; t < 2; ++t) {
+				tetra[2 * f + t][0] = triangles[t][0]; tetra[2 * f + t][1] = triangles[t][1]; tetra[2 * f + t][2] = triangles[t][2]; tetra[2 * f + t][3] = 8;
+			}
+		}
+		return 12;
+	}
+	default:
+		return 0;
+	}
+}
+
 Netgen::Netgen()
+: _coffset(0), _csize(0), _ctotal(0)
 {
 
 }
@@ -26,49 +130,131 @@ Netgen::~Netgen()
 
 }
 
+void Netgen::insertTetrahedra(esint region, esint element)
+{
+	const auto &position = info::mesh->nodes->uniqInfo.position;
+	const auto &coordinates = info::mesh->nodes->coordinates->datatarray();
+	Element::CODE code = info::mesh->elements->epointers->datatarray()[element]->code;
+	auto nodes = (info::mesh->elements->nodes->cbegin() + element)->data();
+
+	esint n[9];
+	Point p[9];
+	int coarse = std::min(8, Mesh::edata[(int)code].coarseNodes);
+	for (int i = 0; i < coarse; ++i) {
+		n[i] = position[nodes[i]];
+		p[i] = coordinates[nodes[i]];
+	}
+	if (_centers[element] != -1) {
+		n[8] = info::mesh->nodes->uniqInfo.totalSize + _coffset + _centers[element];
+		p[8] = Point();
+		for (int i = 0; i < coarse; ++i) {
+			p[8] += p[i];
+		}
+		p[8] /= coarse;
+	}
+
+	int tetra[12][4];
+	for (int t = 0, size = tetrahedra(code, n, tetra); t < size; ++t) {
+		int *v = tetra[t];
+		if (Point::cross(p[v[1]] - p[v[0]], p[v[2]] - p[v[0]]) * (p[v[3]] - p[v[0]]) < 0) {
+			std::swap(v[1], v[2]);
+		}
+		_writer.int32s(region);
+		_writer.int32s(n[v[0]] + 1);
+		_writer.int32s(n[v[1]] + 1);
+		_writer.int32s(n[v[2]] + 1);
+		_writer.int32ln(n[v[3]] + 1);
+	}
+}
+
+void Netgen::insertTriangles(esint region, Element::CODE code, const esint *nodes)
+{
+	const auto &position = info::mesh->nodes->uniqInfo.position;
+	esint n[4];
+	for (int i = 0; i < trianglesize(code) + 2; ++i) {
+		n[i] = position[nodes[i]];
+	}
+
+	int triangles[2][3] = { { 0, 1, 2 } };
+	if (trianglesize(code) == 2) {
+		quadrilateral(n, 0, 1, 2, 3, triangles);
+	}
+	for (int t = 0; t < trianglesize(code); ++t) {
+		_writer.int32s(region);
+		_writer.int32s(n[triangles[t][0]] + 1);
+		_writer.int32s(n[triangles[t][1]] + 1);
+		_writer.int32ln(n[triangles[t][2]] + 1);
+	}
+}
+
 void Netgen::updateMesh()
 {
+	if (info::mesh->dimension != 3) {
+		eslog::error("Netgen writer error: only volumetric geometry can be stored in Netgen neutral format.\n");
+	}
 	for (size_t i = 0; i < info::mesh->elements->distribution.code.size(); ++i) {
-		if (info::mesh->elements->distribution.code[i].totalSize && (int)i != (int)Element::CODE::TETRA4) {
-			eslog::error("Netgen writer error: only tetrahedral geometry can be stored in Netgen neutral format.\n");
+		if (info::mesh->elements->distribution.code[i].totalSize && tetrasize((Element::CODE)i) == 0) {
+			eslog::error("Netgen writer error: not supported element type.\n");
 		}
 	}
 
+	_centers.resize(info::mesh->elements->distribution.process.size);
+	_csize = 0;
+	for (esint e = 0; e < info::mesh->elements->distribution.process.size; ++e) {
+		_centers[e] = tetrasize(info::mesh->elements->epointers->datatarray()[e]->code) == 12 ? _csize++ : -1;
+	}
+	_coffset = _csize;
+	_ctotal = Communication::exscan(_coffset);
+
 	if (Visualization::isRoot()) {
-		_writer.int32ln(info::mesh->nodes->uniqInfo.totalSize);
+		_writer.int32ln(info::mesh->nodes->uniqInfo.totalSize + _ctotal);
 	}
-	for (esint n = 0, i = info::mesh->nodes->uniqInfo.nhalo; n < info::mesh->nodes->uniqInfo.size; ++n, ++i) {
+	_writer.parallel(info::mesh->nodes->uniqInfo.size, [&] (esint n) {
+		esint i = info::mesh->nodes->uniqInfo.nhalo + n;
 		_writer.float32(info::mesh->nodes->coordinates->datatarray()[i].x);
 		_writer.float32(info::mesh->nodes->coordinates->datatarray()[i].y);
 		_writer.float32ln(info::mesh->nodes->coordinates->datatarray()[i].z);
+	});
+	_writer.groupData();
+
+	for (esint e = 0; e < info::mesh->elements->distribution.process.size; ++e) {
+		if (_centers[e] != -1) {
+			auto element = info::mesh->elements->nodes->cbegin() + e;
+			Point center;
+			for (int n = 0; n < 8; ++n) {
+				center += info::mesh->nodes->coordinates->datatarray()[element->at(n)];
+			}
+			center /= 8;
+			_writer.float32(center.x);
+			_writer.float32(center.y);
+			_writer.float32ln(center.z);
+		}
 	}
 	_writer.groupData();
 
 	esint nelements = 0;
 	for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r) {
-		nelements +=  info::mesh->elementsRegions[r]->distribution.process.totalSize;
+		for (size_t i = 0; i < info::mesh->elementsRegions[r]->distribution.code.size(); ++i) {
+			nelements += tetrasize((Element::CODE)i) * info::mesh->elementsRegions[r]->distribution.code[i].totalSize;
+		}
 	}
 	if (Visualization::isRoot()) {
 		_writer.int32ln(nelements);
 	}
 	for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r) {
 		const ElementsRegionStore *region = info::mesh->elementsRegions[r];
-
-		for (auto e = region->elements->datatarray().begin(); e != region->elements->datatarray().end(); ++e) {
-			auto element = (info::mesh->elements->nodes->cbegin() + *e)->data();
-			_writer.int32s(r);
-			_writer.int32s(info::mesh->nodes->uniqInfo.position[element[0]] + 1);
-			_writer.int32s(info::mesh->nodes->uniqInfo.position[element[1]] + 1);
-			_writer.int32s(info::mesh->nodes->uniqInfo.position[element[2]] + 1);
-			_writer.int32ln(info::mesh->nodes->uniqInfo.position[element[3]] + 1);
-		}
+		_writer.parallel((esint)region->elements->datatarray().size(), [&] (esint e) {
+			insertTetrahedra(r, region->elements->datatarray()[e]);
+		});
 	}
 	_writer.groupData();
 
 	esint nboundary = 0;
 	for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r) {
-		if (info::mesh->boundaryRegions[r]->dimension) {
-			nboundary +=  info::mesh->boundaryRegions[r]->distribution.process.totalSize;
+		if (info::mesh->boundaryRegions[r]->dimension == 2) {
+			for (size_t i = 0; i < info::mesh->boundaryRegions[r]->distribution.code.size(); ++i) {
+				nboundary += trianglesize((Element::CODE)i) * info::mesh->boundaryRegions[r]->distribution.code[i].totalSize;
+			}
 		}
 	}
 	if (Visualization::isRoot()) {
@@ -77,14 +263,10 @@ void Netgen::updateMesh()
 	for (size_t r = 1, bindex = 1; r < info::mesh->boundaryRegions.size(); ++r) {
 		const BoundaryRegionStore *region = info::mesh->boundaryRegions[r];
 
-		if (region->dimension) {
-			for (auto e = region->elements->begin(); e != region->elements->end(); ++e) {
-				auto element = e->data();
-				_writer.int32s(bindex);
-				_writer.int32s(info::mesh->nodes->uniqInfo.position[element[0]] + 1);
-				_writer.int32s(info::mesh->nodes->uniqInfo.position[element[1]] + 1);
-				_writer.int32ln(info::mesh->nodes->uniqInfo.position[element[2]] + 1);
-			}
+		if (region->dimension == 2) {
+			_writer.parallel((esint)region->elements->structures(), [&] (esint e) {
+				insertTriangles(bindex, region->epointers->datatarray()[e]->code, (region->elements->cbegin() + e)->data());
+			});
 			++bindex;
 		}
 	}
@@ -95,8 +277,76 @@ void Netgen::updateMesh()
 	_writer.write();
 }
 
-void Netgen::updateSolution()
+void Netgen::insertData(const NamedData *data, bool nodal)
 {
-	// TODO
+	const std::vector<double> &dvalues = stored(data);
+	// Netgen solution format: a header followed by values for each node (or tetrahedron)
+	auto values = [&] (const double *value) {
+		for (int d = 0; d + 1 < data->dimension; ++d) {
+			_writer.float32(value[d]);
+		}
+		_writer.float32ln(value[data->dimension - 1]);
+	};
+
+	if (nodal) {
+		if (Visualization::isRoot()) {
+			_writer.description("solution " + data->name + " -size=" + std::to_string(info::mesh->nodes->uniqInfo.totalSize + _ctotal) + " -components=" + std::to_string(data->dimension) + " -type=nodal\n");
+		}
+		_writer.parallel(info::mesh->nodes->uniqInfo.size, [&] (esint n) {
+			values(dvalues.data() + (info::mesh->nodes->uniqInfo.nhalo + n) * data->dimension);
+		});
+		_writer.groupData();
+
+		std::vector<double> center(data->dimension);
+		for (esint e = 0; e < info::mesh->elements->distribution.process.size; ++e) {
+			if (_centers[e] != -1) {
+				auto element = info::mesh->elements->nodes->cbegin() + e;
+				std::fill(center.begin(), center.end(), 0);
+				for (int n = 0; n < 8; ++n) {
+					for (int d = 0; d < data->dimension; ++d) {
+						center[d] += dvalues[element->at(n) * data->dimension + d] / 8;
+					}
+				}
+				values(center.data());
+			}
+		}
+		_writer.groupData();
+	} else {
+		esint nelements = 0;
+		for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r) {
+			for (size_t i = 0; i < info::mesh->elementsRegions[r]->distribution.code.size(); ++i) {
+				nelements += tetrasize((Element::CODE)i) * info::mesh->elementsRegions[r]->distribution.code[i].totalSize;
+			}
+		}
+		if (Visualization::isRoot()) {
+			_writer.description("solution " + data->name + " -size=" + std::to_string(nelements) + " -components=" + std::to_string(data->dimension) + " -type=element\n");
+		}
+		for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r) {
+			const ElementsRegionStore *region = info::mesh->elementsRegions[r];
+			_writer.parallel((esint)region->elements->datatarray().size(), [&] (esint e) {
+				esint element = region->elements->datatarray()[e];
+				for (int t = 0; t < tetrasize(info::mesh->elements->epointers->datatarray()[element]->code); ++t) {
+					values(dvalues.data() + element * data->dimension);
+				}
+			});
+		}
+		_writer.groupData();
+	}
+	_writer.commitFile(_path + _name + "." + data->name + ".sol");
 }
 
+void Netgen::updateSolution()
+{
+	for (size_t i = 0; i < info::mesh->nodes->data.size(); ++i) {
+		if (storeData(info::mesh->nodes->data[i])) {
+			insertData(info::mesh->nodes->data[i], true);
+		}
+	}
+	for (size_t i = 0; i < info::mesh->elements->data.size(); ++i) {
+		if (storeData(info::mesh->elements->data[i])) {
+			insertData(info::mesh->elements->data[i], false);
+		}
+	}
+	_writer.reorder();
+	_writer.write();
+}
@@ -5,6 +5,8 @@
 #include "visualization.h"
 #include "writer/netgenwritter.h"
 
+#include <vector>
+
 namespace mesio {
 
 class Mesh;
@@ -17,7 +19,16 @@ struct Netgen: public Visualization {
 	void updateSolution();
 
 protected:
+	void insertTetrahedra(esint region, esint element);
+	void insertTriangles(esint region, Element::CODE code, const esint *nodes);
+	void insertData(const NamedData *data, bool nodal);
+
 	NetgenASCIIWritter _writer;
+
+	// Netgen neutral format contains tetrahedra only, hexahedra are split around their centers
+	// that are stored after mesh nodes ([offset, offset + size) of [0, total))
+	std::vector<esint> _centers; // center index for each element (-1 for non-hexahedral elements)
+	esint _coffset, _csize, _ctotal;
 };
 
 }
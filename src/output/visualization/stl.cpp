@@ -10,6 +10,7 @@
 
 #include "mesh/mesh.h"
 #include "mesh/store/nodestore.h"
+#include "mesh/store/elementstore.h"
 #include "mesh/store/surfacestore.h"
 
 using namespace mesio;
@@ -29,8 +30,27 @@ void STL::updateMesh()
 	std::string filename = _directory + "file.stl";
 	std::string name = _path + filename;
 
+	// bodies surface is stored for volumetric meshes, elements are stored for surface meshes
+	const esint *triangles;
+	const Point *coordinates;
+	std::vector<esint> etriangles;
+	if (info::mesh->dimension == 3) {
+		triangles = info::mesh->surface->triangles->datatarray().data();
+		coordinates = info::mesh->surface->coordinates->datatarray().data();
+	} else {
+		auto element = info::mesh->elements->nodes->cbegin();
+		const auto &epointers = info::mesh->elements->epointers->datatarray();
+		for (esint e = 0; e < info::mesh->elements->distribution.process.size; ++e, ++element) {
+			for (auto n = epointers[e]->triangles->datatarray().cbegin(); n != epointers[e]->triangles->datatarray().cend(); ++n) {
+				etriangles.push_back(element->at(*n));
+			}
+		}
+		triangles = etriangles.data();
+		coordinates = info::mesh->nodes->coordinates->datatarray().data();
+	}
+
 	int size, gsize;
-	size = info::mesh->surface->triangles->structures();
+	size = info::mesh->dimension == 3 ? info::mesh->surface->triangles->structures() : etriangles.size() / 3;
 	Communication::reduce(&size, &gsize, 1, MPI_INT, MPI_SUM, 0, MPITools::asynchronous);
 
 	if (info::mpi::rank == 0) {
@@ -38,20 +58,23 @@ void STL::updateMesh()
 		_writer.storeSize(gsize);
 	}
 
-	for (auto t = info::mesh->surface->triangles->cbegin(); t != info::mesh->surface->triangles->cend(); ++t) {
+	_writer.parallel(size, [&] (int t) {
 		Point p[3] = {
-				info::mesh->surface->coordinates->datatarray()[t->at(0)],
-				info::mesh->surface->coordinates->datatarray()[t->at(1)],
-				info::mesh->surface->coordinates->datatarray()[t->at(2)],
+				coordinates[triangles[3 * t + 0]],
+				coordinates[triangles[3 * t + 1]],
+				coordinates[triangles[3 * t + 2]],
 		};
 		Point n = Point::cross(p[1] - p[0], p[2] - p[0]);
+		if (n.length() > 0) {
+			n.normalize();
+		}
 
 		_writer.beginFace(n.x, n.y, n.z);
 		_writer.addVertex(p[0].x, p[0].y, p[0].z);
 		_writer.addVertex(p[1].x, p[1].y, p[1].z);
 		_writer.addVertex(p[2].x, p[2].y, p[2].z);
 		_writer.endFace();
-	}
+	});
 
 	_writer.groupData();
 
@@ -39,7 +39,7 @@ bool Visualization::storeStep()
 
 bool Visualization::storeData(const NamedData *data)
 {
-	return false;
+	return data->name.size();
 }
 
 Point Visualization::shrink(const Point &p, const Point &ccenter, const Point &dcenter, double cratio, double dratio) {
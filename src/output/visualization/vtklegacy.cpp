@@ -4,6 +4,9 @@
 #include "basis/containers/serializededata.h"
 #include "wrappers/mpi/communication.h"
 #include "basis/utilities/sysutils.h"
+#include "basis/utilities/utils.h"
+#include "basis/containers/tarray.h"
+#include "esinfo/envinfo.h"
 #include "esinfo/eslog.h"
 #include "esinfo/config.h"
 #include "esinfo/mpiinfo.h"
@@ -20,7 +23,19 @@
 
 using namespace mesio;
 
-VTKLegacy::VTKLegacy()
+// the total number of element nodes in the region (all processes)
+template <typename TStore>
+static esint enodes(const TStore *store)
+{
+	esint enodes = 0;
+	for (size_t i = 0; i < store->distribution.code.size(); i++) {
+		enodes += store->distribution.code[i].totalSize * Mesh::edata[i].nodes;
+	}
+	return enodes;
+}
+
+VTKLegacy::VTKLegacy(bool binary)
+: _binary(binary)
 {
 	_suffix = ".vtk";
 }
@@ -34,53 +49,59 @@ void VTKLegacy::updateMesh()
 {
 	if (_measure) { eslog::startln("VTK LEGACY: STARTED", "VTK LEGACY"); }
 
-	_points.resize((size_t)info::mesh->nodes->size * 13 * 3 + 1);
-	_esize.resize(2 * 20 + 1); // max is the largest element size
-	_ecode.resize(3 * (int)Element::CODE::SIZE + 1);
-	_cells.resize(info::mesh->elementsRegions.size() + info::mesh->boundaryRegions.size() + info::mesh->contactInterfaces.size() - 2);
-	for (esint n = 0; n < info::mesh->nodes->size; ++n) {
-		const Point &p = info::mesh->nodes->coordinates->datatarray()[n];
-		sprintf(_points.data() + (size_t)n * 13 * 3, "%12.5e %12.5e %12.5e\n", p.x, p.y, p.z);
-	}
-	for (int n = 0; n < 20; ++n) {
-		sprintf(_esize.data() + n * 2, "%d", n + 1);
-	}
-	for (int n = 0; n < (int)Element::CODE::SIZE; ++n) {
-		sprintf(_ecode.data() + n * 3, "%2d\n", _writer.ecode(Mesh::edata[n].code));
-	}
+	int index = 0;
+	_geometry.clear();
+	_geometry.resize(info::mesh->elementsRegions.size() + info::mesh->boundaryRegions.size() + info::mesh->contactInterfaces.size() - 2);
+	if (!_binary) {
+		_points.resize((size_t)info::mesh->nodes->size * 13 * 3 + 1);
+		_esize.resize(2 * 20 + 1); // max is the largest element size
+		_ecode.resize(3 * (int)Element::CODE::SIZE + 1);
+		_cells.resize(_geometry.size());
+		for (esint n = 0; n < info::mesh->nodes->size; ++n) {
+			const Point &p = info::mesh->nodes->coordinates->datatarray()[n];
+			sprintf(_points.data() + (size_t)n * 13 * 3, "%12.5e %12.5e %12.5e\n", p.x, p.y, p.z);
+		}
+		for (int n = 0; n < 20; ++n) {
+			sprintf(_esize.data() + n * 2, "%d", n + 1);
+		}
+		for (int n = 0; n < (int)Element::CODE::SIZE; ++n) {
+			sprintf(_ecode.data() + n * 3, "%2d\n", _writer.ecode(Mesh::edata[n].code));
+		}
 
-	int index = 0, intsize = 11;
-	for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r, ++index) {
-		esint nnodes = info::mesh->elementsRegions[r]->nodes->datatarray().size();
-		if (info::mesh->elements->distribution.process.size < nnodes * 5) {
-			_cells[index].resize(info::mesh->nodes->size * (intsize + sizeof(int)) + 1);
-			for (esint n = 0; n < nnodes; ++n) {
-				esint nn = info::mesh->elementsRegions[r]->nodes->datatarray()[n];
-				int chars = sprintf(_cells[index].data() + nn * (intsize + sizeof(int)), " %d", (int)info::mesh->elementsRegions[r]->nodeInfo.position[n]);
-				memcpy(_cells[index].data() + nn * (intsize + sizeof(int)) + intsize, &chars, sizeof(int));
+		int intsize = 11;
+		index = 0;
+		for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r, ++index) {
+			esint nnodes = info::mesh->elementsRegions[r]->nodes->datatarray().size();
+			if (info::mesh->elements->distribution.process.size < nnodes * 5) {
+				_cells[index].resize(info::mesh->nodes->size * (intsize + sizeof(int)) + 1);
+				for (esint n = 0; n < nnodes; ++n) {
+					esint nn = info::mesh->elementsRegions[r]->nodes->datatarray()[n];
+					int chars = sprintf(_cells[index].data() + nn * (intsize + sizeof(int)), " %d", (int)info::mesh->elementsRegions[r]->nodeInfo.position[n]);
+					memcpy(_cells[index].data() + nn * (intsize + sizeof(int)) + intsize, &chars, sizeof(int));
+				}
+			} else {
+				_cells[index].resize(nnodes * (intsize + sizeof(int)) + 1);
+				for (esint n = 0; n < nnodes; ++n) {
+					int chars = sprintf(_cells[index].data() + n * (intsize + sizeof(int)), " %d", (int)info::mesh->elementsRegions[r]->nodeInfo.position[n]);
+					memcpy(_cells[index].data() + n * (intsize + sizeof(int)) + intsize, &chars, sizeof(int));
+				}
 			}
-		} else {
+		}
+		for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r, ++index) {
+			esint nnodes = info::mesh->boundaryRegions[r]->nodes->datatarray().size();
 			_cells[index].resize(nnodes * (intsize + sizeof(int)) + 1);
 			for (esint n = 0; n < nnodes; ++n) {
-				int chars = sprintf(_cells[index].data() + n * (intsize + sizeof(int)), " %d", (int)info::mesh->elementsRegions[r]->nodeInfo.position[n]);
+				int chars = sprintf(_cells[index].data() + n * (intsize + sizeof(int)), " %d", (int)info::mesh->boundaryRegions[r]->nodeInfo.position[n]);
 				memcpy(_cells[index].data() + n * (intsize + sizeof(int)) + intsize, &chars, sizeof(int));
 			}
 		}
-	}
-	for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r, ++index) {
-		esint nnodes = info::mesh->boundaryRegions[r]->nodes->datatarray().size();
-		_cells[index].resize(nnodes * (intsize + sizeof(int)) + 1);
-		for (esint n = 0; n < nnodes; ++n) {
-			int chars = sprintf(_cells[index].data() + n * (intsize + sizeof(int)), " %d", (int)info::mesh->boundaryRegions[r]->nodeInfo.position[n]);
-			memcpy(_cells[index].data() + n * (intsize + sizeof(int)) + intsize, &chars, sizeof(int));
-		}
-	}
-	for (size_t r = 0; r < info::mesh->contactInterfaces.size(); ++r, ++index) {
-		esint nnodes = info::mesh->contactInterfaces[r]->nodes->datatarray().size();
-		_cells[index].resize(nnodes * (intsize + sizeof(int)) + 1);
-		for (esint n = 0; n < nnodes; ++n) {
-			int chars = sprintf(_cells[index].data() + n * (intsize + sizeof(int)), " %d", (int)info::mesh->contactInterfaces[r]->nodeInfo.position[n]);
-			memcpy(_cells[index].data() + n * (intsize + sizeof(int)) + intsize, &chars, sizeof(int));
+		for (size_t r = 0; r < info::mesh->contactInterfaces.size(); ++r, ++index) {
+			esint nnodes = info::mesh->contactInterfaces[r]->nodes->datatarray().size();
+			_cells[index].resize(nnodes * (intsize + sizeof(int)) + 1);
+			for (esint n = 0; n < nnodes; ++n) {
+				int chars = sprintf(_cells[index].data() + n * (intsize + sizeof(int)), " %d", (int)info::mesh->contactInterfaces[r]->nodeInfo.position[n]);
+				memcpy(_cells[index].data() + n * (intsize + sizeof(int)) + intsize, &chars, sizeof(int));
+			}
 		}
 	}
 
@@ -88,28 +109,43 @@ void VTKLegacy::updateMesh()
 	for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r, ++index) {
 		insertHeader();
 		insertPoints(info::mesh->elementsRegions[r]);
-		insertElements(info::mesh->elementsRegions[r], _cells[index]);
+		if (_binary) {
+			insertBinaryElements(info::mesh->elementsRegions[r]);
+		} else {
+			insertElements(info::mesh->elementsRegions[r], _cells[index]);
+		}
 //		if (info::config::output.store_decomposition) {
 //			if (isRoot()) {
 //				_writer.celldata(ncells);
 //			}
 //			insertDecomposition(info::mesh->elementsRegions[r]);
 //		}
+		_writer.cache(_geometry[index]);
 		_writer.commitFile(_path + _name + "." + info::mesh->elementsRegions[r]->name + _suffix);
 	}
 
-	for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r, ++index) {
+	auto boundary = [&] (const BoundaryRegionStore *region) {
 		insertHeader();
-		insertPoints(info::mesh->boundaryRegions[r]);
-		insertElements(info::mesh->boundaryRegions[r], _cells[index]);
-		_writer.commitFile(_path + _name + "." + info::mesh->boundaryRegions[r]->name + _suffix);
+		insertPoints(region);
+		if (_binary) {
+			insertBinaryElements(region);
+		} else {
+			insertElements(region, _cells[index]);
+		}
+		_writer.cache(_geometry[index]);
+		_writer.commitFile(_path + _name + "." + region->name + _suffix);
+	};
+
+	for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r, ++index) {
+		boundary(info::mesh->boundaryRegions[r]);
 	}
 	for (size_t r = 0; r < info::mesh->contactInterfaces.size(); ++r, ++index) {
-		insertHeader();
-		insertPoints(info::mesh->contactInterfaces[r]);
-		insertElements(info::mesh->contactInterfaces[r], _cells[index]);
-		_writer.commitFile(_path + _name + "." + info::mesh->contactInterfaces[r]->name + _suffix);
+		boundary(info::mesh->contactInterfaces[r]);
 	}
+
+	// formatted values are not needed anymore since the geometry is cached in the serialized form
+	std::vector<char, initless_allocator<char> >().swap(_points);
+	std::vector<std::vector<char, initless_allocator<char> > >().swap(_cells);
 	if (_measure) { eslog::checkpointln("VTK LEGACY: GEOMETRY SERIALIZED"); }
 
 	_writer.reorder();
@@ -129,11 +165,9 @@ void VTKLegacy::updateSolution(const std::string &dir, const std::string &name,
 {
 	int index = 0;
 	for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r, ++index) {
-		insertHeader();
-		insertPoints(info::mesh->elementsRegions[r]);
-		esint ncells = insertElements(info::mesh->elementsRegions[r], _cells[index]);
+		_writer.restore(_geometry[index]);
 		if (isRoot()) {
-			_writer.celldata(ncells);
+			_writer.celldata(info::mesh->elementsRegions[r]->distribution.process.totalSize);
 		}
 //		if (info::config::output.store_decomposition) {
 //			insertDecomposition(info::mesh->elementsRegions[r]);
@@ -158,9 +192,7 @@ void VTKLegacy::updateSolution(const std::string &dir, const std::string &name,
 	}
 
 	auto boundary = [&] (const BoundaryRegionStore *region) {
-		insertHeader();
-		insertPoints(region);
-		insertElements(region, _cells[index]);
+		_writer.restore(_geometry[index]);
 		if (isRoot()) {
 			_writer.pointdata(region->nodeInfo.totalSize);
 		}
@@ -186,7 +218,7 @@ void VTKLegacy::insertHeader()
 	if (isRoot()) {
 		_writer.description("# vtk DataFile Version 2.0\n");
 		_writer.description("EXAMPLE\n");
-		_writer.description("ASCII\n");
+		_writer.description(_binary ? "BINARY\n" : "ASCII\n");
 		_writer.description("DATASET UNSTRUCTURED_GRID\n");
 	}
 }
@@ -196,28 +228,29 @@ void VTKLegacy::insertPoints(const RegionStore *store)
 	if (isRoot()) {
 		_writer.points(store->nodeInfo.totalSize);
 	}
-	for (esint n = 0, i = store->nodeInfo.nhalo; n < store->nodeInfo.size; ++n, ++i) {
-		_writer.insert(13 * 3, _points.data() + (size_t)store->nodes->datatarray()[i] * 13 * 3);
+	if (_binary) {
+		const esint *nodes = store->nodes->datatarray().data() + store->nodeInfo.nhalo;
+		_writer.float32s(3 * store->nodeInfo.size, [&] (esint i) {
+			return info::mesh->nodes->coordinates->datatarray()[nodes[i / 3]][i % 3];
+		});
+	} else {
+		_writer.parallel(store->nodeInfo.size, [&] (esint n) {
+			_writer.insert(13 * 3, _points.data() + (size_t)store->nodes->datatarray()[store->nodeInfo.nhalo + n] * 13 * 3);
+		});
 	}
 	_writer.groupData();
 }
 
 esint VTKLegacy::insertElements(const ElementsRegionStore *store, const std::vector<char, initless_allocator<char> > &data)
 {
-	esint enodes = 0;
-	for (size_t i = 0; i < store->distribution.code.size(); i++) {
-		if (store->distribution.code[i].size) {
-			enodes += store->distribution.code[i].size * Mesh::edata[i].nodes;
-		}
-	}
-
 	if (isRoot()) {
-		_writer.cells(store->distribution.process.totalSize, store->distribution.process.totalSize + enodes);
+		_writer.cells(store->distribution.process.totalSize, store->distribution.process.totalSize + enodes(store));
 	}
 	int intsize = 11;
-	for (auto e = store->elements->datatarray().cbegin(); e != store->elements->datatarray().cend(); ++e) {
+	const auto &elements = store->elements->datatarray();
+	_writer.parallel((esint)elements.size(), [&] (esint i) {
 		esint nnodes = store->nodes->datatarray().size();
-		auto element = info::mesh->elements->nodes->cbegin() + *e;
+		auto element = info::mesh->elements->nodes->cbegin() + elements[i];
 		_writer.insert(element->size() > 9 ? 2 : 1, _esize.data() + element->size() * 2 - 2);
 		if (info::mesh->elements->distribution.process.size < nnodes * 5) {
 			for (auto n = element->begin(); n != element->end(); ++n) {
@@ -232,15 +265,15 @@ esint VTKLegacy::insertElements(const ElementsRegionStore *store, const std::vec
 			}
 		}
 		_writer.push('\n');
-	}
+	});
 	_writer.groupData();
 
 	if (isRoot()) {
 		_writer.celltypes(store->distribution.process.totalSize);
 	}
-	for (auto e = store->elements->datatarray().cbegin(); e != store->elements->datatarray().cend(); ++e) {
-		_writer.insert(3, _ecode.data() + 3 * (int)info::mesh->elements->epointers->datatarray()[*e]->code);
-	}
+	_writer.parallel((esint)elements.size(), [&] (esint i) {
+		_writer.insert(3, _ecode.data() + 3 * (int)info::mesh->elements->epointers->datatarray()[elements[i]]->code);
+	});
 	_writer.groupData();
 
 	return store->distribution.process.totalSize;
@@ -249,18 +282,12 @@ esint VTKLegacy::insertElements(const ElementsRegionStore *store, const std::vec
 esint VTKLegacy::insertElements(const BoundaryRegionStore *store, const std::vector<char, initless_allocator<char> > &data)
 {
 	if (store->dimension) {
-		esint enodes = 0;
-		for (size_t i = 0; i < store->distribution.code.size(); i++) {
-			if (store->distribution.code[i].size) {
-				enodes += store->distribution.code[i].size * Mesh::edata[i].nodes;
-			}
-		}
-
 		if (isRoot()) {
-			_writer.cells(store->distribution.process.totalSize, store->distribution.process.totalSize + enodes);
+			_writer.cells(store->distribution.process.totalSize, store->distribution.process.totalSize + enodes(store));
 		}
 		int intsize = 11;
-		for (auto e = store->elements->cbegin(); e != store->elements->cend(); ++e) {
+		_writer.parallel((esint)store->elements->structures(), [&] (esint i) {
+			auto e = store->elements->cbegin() + i;
 			_writer.insert(e->size() > 9 ? 2 : 1, _esize.data() + e->size() * 2 - 2);
 			for (auto n = e->begin(); n != e->end(); ++n) {
 				esint p = std::lower_bound(store->nodes->datatarray().begin(), store->nodes->datatarray().end(), *n) - store->nodes->datatarray().begin();
@@ -268,15 +295,15 @@ esint VTKLegacy::insertElements(const BoundaryRegionStore *store, const std::vec
 				_writer.insert(size, data.data() + (intsize + sizeof(int)) * p);
 			}
 			_writer.push('\n');
-		}
+		});
 		_writer.groupData();
 
 		if (isRoot()) {
 			_writer.celltypes(store->distribution.process.totalSize);
 		}
-		for (esint e = 0; e < store->distribution.process.size; ++e) {
+		_writer.parallel(store->distribution.process.size, [&] (esint e) {
 			_writer.insert(3, _ecode.data() + 3 * (int)store->epointers->datatarray()[e]->code);
-		}
+		});
 		_writer.groupData();
 
 		return store->distribution.process.totalSize;
@@ -284,17 +311,18 @@ esint VTKLegacy::insertElements(const BoundaryRegionStore *store, const std::vec
 		if (isRoot()) {
 			_writer.cells(store->nodeInfo.totalSize, 2 * store->nodeInfo.totalSize);
 		}
-		for (esint n = 0, i = store->nodeInfo.offset; n < store->nodeInfo.size; ++n, ++i) {
+		_writer.parallel(store->nodeInfo.size, [&] (esint n) {
+			esint i = store->nodeInfo.offset + n;
 			_writer.cell(1, &i);
-		}
+		});
 		_writer.groupData();
 
 		if (isRoot()) {
 			_writer.celltypes(store->nodeInfo.totalSize);
 		}
-		for (auto n = 0; n < store->nodeInfo.size; ++n) {
+		_writer.parallel(store->nodeInfo.size, [&] (esint n) {
 			_writer.insert(3, _ecode.data() + 3 * (int)Element::CODE::POINT1);
-		}
+		});
 		_writer.groupData();
 
 		return store->nodeInfo.totalSize;
@@ -306,9 +334,17 @@ void VTKLegacy::insertData(NamedData *data, esint nindices, esint *indices)
 	if (!storeData(data)) {
 		return;
 	}
+	if (_binary) {
+		insertBinaryData(data, nindices, indices);
+		return;
+	}
+	const std::vector<double> &values = stored(data);
 
 	if (data->dataType == NamedData::DataType::SCALAR) {
 		for (int d = 0; d < data->dimension; ++d) {
+			if (d) {
+				_writer.groupData(); // each component is a separate array
+			}
 			if (isRoot()) {
 				if (data->dimension > 1) {
 					_writer.data("SCALARS", data->name + data->coordinateSuffixes[d], "float 1");
@@ -317,21 +353,24 @@ void VTKLegacy::insertData(NamedData *data, esint nindices, esint *indices)
 				}
 				_writer.description("LOOKUP_TABLE default\n");
 			}
-			for (esint n = 0; n < nindices; ++n) {
-				_writer.float32ln(data->store[indices[n] * data->dimension + d]);
-			}
+			_writer.parallel(nindices, [&] (esint n) {
+				_writer.float32ln(values[indices[n] * data->dimension + d]);
+			});
 		}
 	}
 
 	if (data->dataType == NamedData::DataType::NUMBERED) {
 		for (int d = 0; d < data->dimension; ++d) {
+			if (d) {
+				_writer.groupData(); // each component is a separate array
+			}
 			if (isRoot()) {
 				_writer.data("SCALARS", data->name + data->numberSuffixes[d], "float 1");
 				_writer.description("LOOKUP_TABLE default\n");
 			}
-			for (esint n = 0; n < nindices; ++n) {
-				_writer.float32ln(data->store[indices[n] * data->dimension + d]);
-			}
+			_writer.parallel(nindices, [&] (esint n) {
+				_writer.float32ln(values[indices[n] * data->dimension + d]);
+			});
 		}
 	}
 
@@ -339,45 +378,195 @@ void VTKLegacy::insertData(NamedData *data, esint nindices, esint *indices)
 		if (isRoot()) {
 			_writer.data("VECTORS", data->name, "float");
 		}
-		for (esint n = 0; n < nindices; ++n) {
-			_writer.float32s (                      data->store[indices[n] * data->dimension]);
-			_writer.float32s (data->dimension > 1 ? data->store[indices[n] * data->dimension + 1] : .0);
-			_writer.float32ln(data->dimension > 2 ? data->store[indices[n] * data->dimension + 2] : .0);
-		}
+		_writer.parallel(nindices, [&] (esint n) {
+			_writer.float32s (                      values[indices[n] * data->dimension]);
+			_writer.float32s (data->dimension > 1 ? values[indices[n] * data->dimension + 1] : .0);
+			_writer.float32ln(data->dimension > 2 ? values[indices[n] * data->dimension + 2] : .0);
+		});
 	}
 
 	if (data->dataType == NamedData::DataType::TENSOR_ASYM) {
 		if (isRoot()) {
 			_writer.data("TENSORS", data->name, "float");
 		}
-		for (esint n = 0; n < nindices; ++n) {
-			_writer.float32s (data->store[indices[n] * data->dimension + 0]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 3]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 5]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 3]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 1]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 4]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 5]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 4]);
-			_writer.float32ln(data->store[indices[n] * data->dimension + 2]);
-		}
+		_writer.parallel(nindices, [&] (esint n) {
+			_writer.float32s (values[indices[n] * data->dimension + 0]);
+			_writer.float32s (values[indices[n] * data->dimension + 3]);
+			_writer.float32s (values[indices[n] * data->dimension + 5]);
+			_writer.float32s (values[indices[n] * data->dimension + 3]);
+			_writer.float32s (values[indices[n] * data->dimension + 1]);
+			_writer.float32s (values[indices[n] * data->dimension + 4]);
+			_writer.float32s (values[indices[n] * data->dimension + 5]);
+			_writer.float32s (values[indices[n] * data->dimension + 4]);
+			_writer.float32ln(values[indices[n] * data->dimension + 2]);
+		});
 	}
 
 	if (data->dataType == NamedData::DataType::TENSOR_SYMM) {
 		if (isRoot()) {
 			_writer.data("TENSORS", data->name, "float");
 		}
-		for (esint n = 0; n < nindices; ++n) {
-			_writer.float32s (data->store[indices[n] * data->dimension + 0]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 3]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 5]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 6]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 1]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 4]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 8]);
-			_writer.float32s (data->store[indices[n] * data->dimension + 7]);
-			_writer.float32ln(data->store[indices[n] * data->dimension + 2]);
+		_writer.parallel(nindices, [&] (esint n) {
+			_writer.float32s (values[indices[n] * data->dimension + 0]);
+			_writer.float32s (values[indices[n] * data->dimension + 3]);
+			_writer.float32s (values[indices[n] * data->dimension + 5]);
+			_writer.float32s (values[indices[n] * data->dimension + 6]);
+			_writer.float32s (values[indices[n] * data->dimension + 1]);
+			_writer.float32s (values[indices[n] * data->dimension + 4]);
+			_writer.float32s (values[indices[n] * data->dimension + 8]);
+			_writer.float32s (values[indices[n] * data->dimension + 7]);
+			_writer.float32ln(values[indices[n] * data->dimension + 2]);
+		});
+	}
+	_writer.groupData();
+}
+
+// node positions are stored as a sequence [size, n1, n2, ..., size, n1, ...]
+template <typename TPosition>
+static void binaryCells(VTKBinaryWritter &writer, esint size, const TPosition &position, const std::function<serializededata<esint, esint>::const_iterator(esint)> &element)
+{
+	std::vector<esint> offsets(size + 1);
+	std::vector<esint> distribution = tarray<esint>::distribute(info::env::threads, size);
+	#pragma omp parallel for
+	for (int t = 0; t < info::env::threads; ++t) {
+		for (esint e = distribution[t]; e < distribution[t + 1]; ++e) {
+			offsets[e] = 1 + element(e)->size();
+		}
+	}
+	utils::sizesToOffsets(offsets);
+
+	std::vector<int> cells(offsets.back());
+	#pragma omp parallel for
+	for (int t = 0; t < info::env::threads; ++t) {
+		for (esint e = distribution[t]; e < distribution[t + 1]; ++e) {
+			auto nodes = element(e);
+			int *cell = cells.data() + offsets[e];
+			*cell++ = nodes->size();
+			for (auto n = nodes->begin(); n != nodes->end(); ++n) {
+				*cell++ = position(*n);
+			}
+		}
+	}
+	writer.int32s(cells.size(), [&] (esint i) { return cells[i]; });
+}
+
+void VTKLegacy::insertBinaryElements(const ElementsRegionStore *store)
+{
+	if (isRoot()) {
+		_writer.cells(store->distribution.process.totalSize, store->distribution.process.totalSize + enodes(store));
+	}
+	const auto &elements = store->elements->datatarray();
+	const auto &nodes = store->nodes->datatarray();
+	auto element = [&] (esint e) { return info::mesh->elements->nodes->cbegin() + elements[e]; };
+	if (info::mesh->elements->distribution.process.size < (esint)nodes.size() * 5) {
+		std::vector<int> position(info::mesh->nodes->size);
+		std::vector<esint> distribution = tarray<esint>::distribute(info::env::threads, nodes.size());
+		#pragma omp parallel for
+		for (int t = 0; t < info::env::threads; ++t) {
+			for (esint n = distribution[t]; n < distribution[t + 1]; ++n) {
+				position[nodes[n]] = store->nodeInfo.position[n];
+			}
 		}
+		binaryCells(_writer, elements.size(), [&] (esint n) { return position[n]; }, element);
+	} else {
+		binaryCells(_writer, elements.size(), [&] (esint n) {
+			return (int)store->nodeInfo.position[std::lower_bound(nodes.begin(), nodes.end(), n) - nodes.begin()];
+		}, element);
+	}
+	_writer.groupData();
+
+	if (isRoot()) {
+		_writer.celltypes(store->distribution.process.totalSize);
+	}
+	_writer.int32s(elements.size(), [&] (esint i) {
+		return VTKASCIIWritter::ecode(info::mesh->elements->epointers->datatarray()[elements[i]]->code);
+	});
+	_writer.groupData();
+}
+
+void VTKLegacy::insertBinaryElements(const BoundaryRegionStore *store)
+{
+	if (store->dimension) {
+		if (isRoot()) {
+			_writer.cells(store->distribution.process.totalSize, store->distribution.process.totalSize + enodes(store));
+		}
+		const auto &nodes = store->nodes->datatarray();
+		binaryCells(_writer, store->elements->structures(), [&] (esint n) {
+			return (int)store->nodeInfo.position[std::lower_bound(nodes.begin(), nodes.end(), n) - nodes.begin()];
+		}, [&] (esint e) { return store->elements->cbegin() + e; });
+		_writer.groupData();
+
+		if (isRoot()) {
+			_writer.celltypes(store->distribution.process.totalSize);
+		}
+		_writer.int32s(store->distribution.process.size, [&] (esint e) {
+			return VTKASCIIWritter::ecode(store->epointers->datatarray()[e]->code);
+		});
+		_writer.groupData();
+	} else {
+		if (isRoot()) {
+			_writer.cells(store->nodeInfo.totalSize, 2 * store->nodeInfo.totalSize);
+		}
+		_writer.int32s(2 * store->nodeInfo.size, [&] (esint i) {
+			return i % 2 ? (int)(store->nodeInfo.offset + i / 2) : 1;
+		});
+		_writer.groupData();
+
+		if (isRoot()) {
+			_writer.celltypes(store->nodeInfo.totalSize);
+		}
+		_writer.int32s(store->nodeInfo.size, [&] (esint n) {
+			return VTKASCIIWritter::ecode(Element::CODE::POINT1);
+		});
+		_writer.groupData();
+	}
+}
+
+void VTKLegacy::insertBinaryData(NamedData *data, esint nindices, esint *indices)
+{
+	const std::vector<double> &values = stored(data);
+	// a binary array is not terminated by the new line
+	auto header = [&] (const std::string &type, const std::string &name, const std::string &format) {
+		if (isRoot()) {
+			_writer.push('\n');
+			_writer.data(type, name, format);
+		}
+	};
+
+	if (data->dataType == NamedData::DataType::SCALAR || data->dataType == NamedData::DataType::NUMBERED) {
+		for (int d = 0; d < data->dimension; ++d) {
+			if (d) {
+				_writer.groupData(); // each component is a separate array
+			}
+			if (data->dataType == NamedData::DataType::NUMBERED) {
+				header("SCALARS", data->name + data->numberSuffixes[d], "float 1");
+			} else {
+				header("SCALARS", data->dimension > 1 ? data->name + data->coordinateSuffixes[d] : data->name, "float 1");
+			}
+			if (isRoot()) {
+				_writer.description("LOOKUP_TABLE default\n");
+			}
+			_writer.float32s(nindices, [&] (esint n) {
+				return values[indices[n] * data->dimension + d];
+			});
+		}
+	}
+
+	if (data->dataType == NamedData::DataType::VECTOR) {
+		header("VECTORS", data->name, "float");
+		_writer.float32s(3 * nindices, [&] (esint i) {
+			return i % 3 < data->dimension ? values[indices[i / 3] * data->dimension + i % 3] : .0;
+		});
+	}
+
+	if (data->dataType == NamedData::DataType::TENSOR_ASYM || data->dataType == NamedData::DataType::TENSOR_SYMM) {
+		static const int asym[9] = { 0, 3, 5, 3, 1, 4, 5, 4, 2 };
+		static const int symm[9] = { 0, 3, 5, 6, 1, 4, 8, 7, 2 };
+		const int *map = data->dataType == NamedData::DataType::TENSOR_ASYM ? asym : symm;
+		header("TENSORS", data->name, "float");
+		_writer.float32s(9 * nindices, [&] (esint i) {
+			return values[indices[i / 9] * data->dimension + map[i % 9]];
+		});
 	}
 	_writer.groupData();
 }
@@ -390,9 +579,9 @@ void VTKLegacy::insertDecomposition(const ElementsRegionStore *store)
 			_writer.description("LOOKUP_TABLE default\n");
 		}
 		for (auto i = store->eintervals.begin(); i != store->eintervals.end(); ++i) {
-			for (esint e = i->begin; e < i->end; ++e) {
-				_writer.int32ln(callback(*i, e));
-			}
+			_writer.parallel(i->end - i->begin, [&] (esint e) {
+				_writer.int32ln(callback(*i, i->begin + e));
+			});
 		}
 		_writer.groupData();
 	};
@@ -15,7 +15,7 @@ class BoundaryRegionStore;
 
 class VTKLegacy: public Visualization {
 public:
-	VTKLegacy();
+	VTKLegacy(bool binary = false);
 	~VTKLegacy();
 
 	void updateMesh();
@@ -29,11 +29,19 @@ protected:
 	esint insertElements(const ElementsRegionStore *store, const std::vector<char, initless_allocator<char> > &data);
 	esint insertElements(const BoundaryRegionStore *store, const std::vector<char, initless_allocator<char> > &data);
 
+	void insertBinaryElements(const ElementsRegionStore *store);
+	void insertBinaryElements(const BoundaryRegionStore *store);
+
 	void insertData(NamedData *data, esint nindices, esint *indices);
+	void insertBinaryData(NamedData *data, esint nindices, esint *indices);
 	void insertDecomposition(const ElementsRegionStore *store);
 protected:
 	std::string _suffix;
-	VTKASCIIWritter _writer;
+	bool _binary;
+	VTKBinaryWritter _writer;
+
+	// serialized geometry of each region file (it is the same for all solution steps)
+	std::vector<OutputFile::Cache> _geometry;
 
 	std::vector<char, initless_allocator<char> > _points, _esize, _ecode;
 	std::vector<std::vector<char, initless_allocator<char> > > _cells;
@@ -5,6 +5,8 @@
 #include "basis/io/outputfile.h"
 #include "mesh/element.h"
 
+#include <cstring>
+
 namespace mesio {
 
 struct EnsightOutputWriter {
@@ -72,6 +74,33 @@ struct EnsightBinaryOutputWriter: public OutputFilePack {
 	{
 
 	}
+
+	// bulk insert: value(i) for i in [0, size) are filled directly to the buffer by threads
+	template <typename TValue, typename TCallback>
+	void values(esint size, const TCallback &value)
+	{
+		char *data = extend(sizeof(TValue) * size);
+		std::vector<esint> distribution = tarray<esint>::distribute(info::env::threads, size);
+		#pragma omp parallel for // serial on the asynchronous output thread (see Pthread)
+		for (int t = 0; t < info::env::threads; ++t) {
+			for (esint i = distribution[t]; i < distribution[t + 1]; ++i) {
+				TValue v = value(i);
+				memcpy(data + sizeof(TValue) * i, &v, sizeof(TValue));
+			}
+		}
+	}
+
+	template <typename TCallback>
+	void int32s(esint size, const TCallback &value)
+	{
+		values<int>(size, value);
+	}
+
+	template <typename TCallback>
+	void float32s(esint size, const TCallback &value)
+	{
+		values<float>(size, value);
+	}
 };
 
 struct EnsightASCIIOutputWriter: public OutputFilePack {
@@ -9,6 +9,11 @@ namespace mesio {
 
 struct NetgenASCIIWritter: public OutputFilePack {
 
+	void description(const std::string &description)
+	{
+		insert(description.size(), description.data());
+	}
+
 	void int32(int value)
 	{
 		insert(snprintf(buffer, bsize, "%d", value));
@@ -3,8 +3,13 @@
 #define SRC_OUTPUT_RESULT_VISUALIZATION_VTKWRITTER_H_
 
 #include "basis/io/outputfile.h"
+#include "basis/containers/tarray.h"
+#include "esinfo/envinfo.h"
 #include "mesh/element.h"
 
+#include <cstdint>
+#include <cstring>
+
 namespace mesio {
 
 struct VTKASCIIWritter: public OutputFilePack {
@@ -153,6 +158,53 @@ struct VTKASCIIWritter: public OutputFilePack {
 		insert(snprintf(buffer, bsize, "%f\n", value));
 	}
 };
+
+// headers are the same as in the ASCII format, arrays are stored in big-endian
+struct VTKBinaryWritter: public VTKASCIIWritter {
+	using VTKASCIIWritter::int32s;
+	using VTKASCIIWritter::float32s;
+
+	// bulk insert: value(i) for i in [0, size) are filled directly to the buffer by threads
+	template <typename TValue, typename TCallback>
+	void values(esint size, const TCallback &value)
+	{
+		static_assert(sizeof(TValue) == sizeof(uint32_t), "only 32-bit values are supported");
+		char *data = extend(sizeof(TValue) * size);
+		std::vector<esint> distribution = tarray<esint>::distribute(info::env::threads, size);
+		#pragma omp parallel for // serial on the asynchronous output thread (see Pthread)
+		for (int t = 0; t < info::env::threads; ++t) {
+			for (esint i = distribution[t]; i < distribution[t + 1]; ++i) {
+				TValue v = value(i);
+				memcpy(data + sizeof(TValue) * i, &v, sizeof(TValue));
+			}
+			bigendian(data + sizeof(TValue) * distribution[t], distribution[t + 1] - distribution[t]);
+		}
+	}
+
+	template <typename TCallback>
+	void int32s(esint size, const TCallback &value)
+	{
+		values<int>(size, value);
+	}
+
+	template <typename TCallback>
+	void float32s(esint size, const TCallback &value)
+	{
+		values<float>(size, value);
+	}
+
+	// swap bytes of 32-bit words in a separate loop (it is vectorized by the compiler)
+	static void bigendian(char *data, esint size)
+	{
+		#pragma omp simd
+		for (esint i = 0; i < size; ++i) {
+			uint32_t w;
+			memcpy(&w, data + sizeof(uint32_t) * i, sizeof(uint32_t));
+			w = __builtin_bswap32(w);
+			memcpy(data + sizeof(uint32_t) * i, &w, sizeof(uint32_t));
+		}
+	}
+};
 }
 
 
@@ -172,7 +172,7 @@ static void fillAttribute(const std::string &path, XML::Element *xml, XDMF::Attr
 	dataitem->value = path + ".h5:" + heavydata.name;
 }
 
-static void fillGeometryAttribute(const std::string &path, XML::Element *xml, XDMF::Attribute &heavydata, const RegionStore *store, const NamedData *data, int iteration)
+static void fillGeometryAttribute(const std::string &path, XML::Element *xml, XDMF::Attribute &heavydata, const RegionStore *store, const NamedData *data, const std::vector<double> &values, int iteration)
 {
 	heavydata.name = store->name + "_" + data->name + "_" + std::to_string(iteration);
 	heavydata.dimension = data->dimension > 1 ? 3 : 1;
@@ -183,7 +183,7 @@ static void fillGeometryAttribute(const std::string &path, XML::Element *xml, XD
 	heavydata.values.reserve((data->dimension > 1 ? 3 : 1) * store->nodeInfo.size);
 	for (auto n = store->nodes->datatarray().cbegin() + store->nodeInfo.nhalo; n != store->nodes->datatarray().cend(); ++n) {
 		for (int d = 0; d < data->dimension; ++d) {
-			heavydata.values.push_back(data->store[*n * data->dimension + d]);
+			heavydata.values.push_back(values[*n * data->dimension + d]);
 		}
 		if (data->dimension == 2) {
 			heavydata.values.push_back(0);
@@ -193,7 +193,7 @@ static void fillGeometryAttribute(const std::string &path, XML::Element *xml, XD
 	fillAttribute(path, xml, heavydata, data->name, "Node");
 }
 
-static void fillTopologyAttribute(const std::string &path, XML::Element *xml, XDMF::Attribute &heavydata, const ElementsRegionStore *store, const NamedData *data, int iteration)
+static void fillTopologyAttribute(const std::string &path, XML::Element *xml, XDMF::Attribute &heavydata, const ElementsRegionStore *store, const NamedData *data, const std::vector<double> &values, int iteration)
 {
 	heavydata.name = store->name + "_" + data->name + "_" + std::to_string(iteration);
 	heavydata.dimension = data->dimension > 1 ? 3 : 1;
@@ -204,7 +204,7 @@ static void fillTopologyAttribute(const std::string &path, XML::Element *xml, XD
 	heavydata.values.reserve((data->dimension > 1 ? 3 : 1) * store->elements->structures());
 	for (auto e = store->elements->datatarray().cbegin(); e != store->elements->datatarray().cend(); ++e) {
 		for (int d = 0; d < data->dimension; ++d) {
-			heavydata.values.push_back(data->store[*e * data->dimension + d]);
+			heavydata.values.push_back(values[*e * data->dimension + d]);
 
 		}
 		if (data->dimension == 2) {
@@ -421,7 +421,7 @@ void XDMF::updateSolution()
 			rindex = 0;
 			for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r, ++rindex) {
 				attributes.push_back({});
-				fillTopologyAttribute(_directory + _name, _data->region[rindex], attributes.back(), info::mesh->elementsRegions[r], info::mesh->elements->data[di], _data->iteration);
+				fillTopologyAttribute(_directory + _name, _data->region[rindex], attributes.back(), info::mesh->elementsRegions[r], info::mesh->elements->data[di], stored(info::mesh->elements->data[di]), _data->iteration);
 			}
 		}
 	}
@@ -431,15 +431,15 @@ void XDMF::updateSolution()
 			rindex = 0;
 			for (size_t r = 1; r < info::mesh->elementsRegions.size(); ++r, ++rindex) {
 				attributes.push_back({});
-				fillGeometryAttribute(_directory + _name, _data->region[rindex], attributes.back(), info::mesh->elementsRegions[r], info::mesh->nodes->data[di], _data->iteration);
+				fillGeometryAttribute(_directory + _name, _data->region[rindex], attributes.back(), info::mesh->elementsRegions[r], info::mesh->nodes->data[di], stored(info::mesh->nodes->data[di]), _data->iteration);
 			}
 			for (size_t r = 1; r < info::mesh->boundaryRegions.size(); ++r, ++rindex) {
 				attributes.push_back({});
-				fillGeometryAttribute(_directory + _name, _data->region[rindex], attributes.back(), info::mesh->boundaryRegions[r], info::mesh->nodes->data[di], _data->iteration);
+				fillGeometryAttribute(_directory + _name, _data->region[rindex], attributes.back(), info::mesh->boundaryRegions[r], info::mesh->nodes->data[di], stored(info::mesh->nodes->data[di]), _data->iteration);
 			}
 			for (size_t r = 0; r < info::mesh->contactInterfaces.size(); ++r, ++rindex) {
 				attributes.push_back({});
-				fillGeometryAttribute(_directory + _name, _data->region[rindex], attributes.back(), info::mesh->contactInterfaces[r], info::mesh->nodes->data[di], _data->iteration);
+				fillGeometryAttribute(_directory + _name, _data->region[rindex], attributes.back(), info::mesh->contactInterfaces[r], info::mesh->nodes->data[di], stored(info::mesh->nodes->data[di]), _data->iteration);
 			}
 		}
 	}
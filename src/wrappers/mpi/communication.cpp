@@ -6,6 +6,7 @@
 #include "basis/utilities/utils.h"
 #include "basis/utilities/sysutils.h"
 #include "basis/utilities/parser.h"
+#include "basis/logging/tracelogger.h"
 #include "esinfo/mpiinfo.h"
 #include "esinfo/eslog.h"
 #include "mesh/store/statisticsstore.h"
@@ -20,6 +21,16 @@ using namespace mesio;
 
 #define __GAP__ 1000
 
+// bytes of 'size' items of 'type' (computed only if spans are collected)
+static size_t traced(size_t size, MPI_Datatype type)
+{
+	int tsize = 0;
+	if (trace::enabled) {
+		MPI_Type_size(type, &tsize);
+	}
+	return size * tsize;
+}
+
 MPIOperations* MPITools::operations = NULL;
 MPIGroup* MPITools::procs = NULL;
 MPIGroup* MPITools::node = NULL;
@@ -51,6 +62,7 @@ int Communication::TAG::SPLITTERS         = 17 * __GAP__;
 int Communication::TAG::ALLREDUCE         = 18 * __GAP__;
 int Communication::TAG::SCATTERV          = 19 * __GAP__;
 int Communication::TAG::SCATTER           = 20 * __GAP__;
+int Communication::TAG::OUTPUT            = 21 * __GAP__;
 
 template<typename Ttype>
 static void _scan(void *in, void *out, int *len, MPI_Datatype *datatype)
@@ -315,6 +327,7 @@ void Communication::RecursiveHalving::exchanged()
 bool Communication::computeSFCBalancedBorders(SpaceFillingCurve &sfc, std::vector<esint> &sfcbuckets, std::vector<esint> &permutation, std::vector<esint> &sfcborders)
 {
 	eslog::start("SFC BORDERS", "SFC");
+	trace::Scope trace("Communication::computeSFCBalancedBorders");
 
 	esint esize = sfcbuckets.size();
 	esize = Communication::exscan(esize);
@@ -374,7 +387,10 @@ bool Communication::computeSFCBalancedBorders(SpaceFillingCurve &sfc, std::vecto
 
 		eslog::checkpointln("SCOUNT");
 
+		double wait = trace::time();
 		MPI_Allreduce(scounts.data(), rcounts.data(), scounts.size(), MPITools::getType<esint>().mpitype, MPI_SUM, info::mpi::comm);
+		trace.wait(wait);
+		trace.bytes(sizeof(esint) * scounts.size(), sizeof(esint) * rcounts.size());
 
 		eslog::checkpoint("ALLREDUCE");
 		eslog::param("COUNT", scounts.size());
@@ -432,7 +448,10 @@ bool Communication::computeSFCBalancedBorders(SpaceFillingCurve &sfc, std::vecto
 
 		eslog::checkpointln("DEEPER SCOUNT");
 
+		double wait = trace::time();
 		MPI_Allreduce(scounts.data(), rcounts.data(), scounts.size(), MPITools::getType<esint>().mpitype, MPI_SUM, info::mpi::comm);
+		trace.wait(wait);
+		trace.bytes(sizeof(esint) * scounts.size(), sizeof(esint) * rcounts.size());
 
 		eslog::checkpoint("DEEPER ALLREDUCE");
 		eslog::param("DEEPER COUNT", scounts.size());
@@ -517,6 +536,7 @@ static void getMedian(esint *keys, esint targetsum, esint tolerance, esint begin
 
 bool Communication::computeSplitters(std::vector<esint> &keys, std::vector<esint> &permutation, std::vector<esint> &splitters, MPIGroup *group)
 {
+	trace::Scope trace("Communication::computeSplitters");
 	splitters.resize(group->size + 1);
 	MPIType type = MPITools::getType<esint>();
 
@@ -525,8 +545,10 @@ bool Communication::computeSplitters(std::vector<esint> &keys, std::vector<esint
 	if (keys.size()) {
 		mymax = keys[permutation.back()];
 	}
+	double wait = trace::time();
 	MPI_Allreduce(&mymax, &max, 1, MPITools::getType<esint>().mpitype, MPI_MAX, group->communicator);
 	MPI_Allreduce(&mysize, &size, 1, MPITools::getType<esint>().mpitype, MPI_SUM, group->communicator);
+	trace.wait(wait);
 	splitters.back() = max + 1;
 
 	std::vector<esint> targetDistribution = tarray<esint>::distribute(group->size, size), distribution(group->size + 1);
@@ -544,10 +566,19 @@ bool Communication::computeSplitters(std::vector<esint> &keys, std::vector<esint
 	auto receive = [&] (int rank) {
 		int recvsize;
 		MPI_Status status;
+		double wait = trace::time();
 		MPI_Probe(rank, TAG::SPLITTERS, group->communicator, &status);
 		MPI_Get_count(&status, type.mpitype, &recvsize);
 		recv.resize(recvsize / type.mpisize);
 		MPI_Recv(recv.data(), recvsize, type.mpitype, rank, TAG::SPLITTERS, group->communicator, MPI_STATUS_IGNORE);
+		trace.wait(wait);
+		trace.bytes(0, sizeof(esint) * recv.size());
+	};
+	auto post = [&] (esint *data, size_t size, int rank) {
+		double wait = trace::time();
+		MPI_Send(data, type.mpisize * size, type.mpitype, rank, TAG::SPLITTERS, group->communicator);
+		trace.wait(wait);
+		trace.bytes(sizeof(esint) * size, 0);
 	};
 
 	RecursiveHalving rh(group->rank, 0, group->size);
@@ -564,11 +595,11 @@ bool Communication::computeSplitters(std::vector<esint> &keys, std::vector<esint
 			}
 
 			if (rh.isodd()) {
-				MPI_Send(send.data() + localmid, type.mpisize * (send.size() - localmid), type.mpitype, rh.mid, TAG::SPLITTERS, group->communicator);
+				post(send.data() + localmid, send.size() - localmid, rh.mid);
 				recv.clear();
 			}
 			if (rh.ispaired()) {
-				MPI_Send(send.data() + localmid, type.mpisize * (send.size() - localmid), type.mpitype, rh.twin, TAG::SPLITTERS, group->communicator);
+				post(send.data() + localmid, send.size() - localmid, rh.twin);
 				receive(rh.twin);
 			}
 
@@ -582,7 +613,7 @@ bool Communication::computeSplitters(std::vector<esint> &keys, std::vector<esint
 			}
 
 			receive(rh.twin);
-			MPI_Send(send.data(), type.mpisize * localmid, type.mpitype, rh.twin, TAG::SPLITTERS, group->communicator);
+			post(send.data(), localmid, rh.twin);
 
 			if (rh.treatodd()) {
 				recvmid.swap(recv);
@@ -623,7 +654,10 @@ bool Communication::computeSplitters(std::vector<esint> &keys, std::vector<esint
 
 bool Communication::barrier(MPIGroup *group)
 {
+	trace::Scope trace("Communication::barrier");
+	double wait = trace::time();
 	MPI_Barrier(group->communicator);
+	trace.wait(wait);
 	return true;
 }
 
@@ -632,7 +666,11 @@ bool Communication::broadcast(void *data, size_t size, MPI_Datatype type, int ro
 	if (size != (size_t)(int)size) {
 		return false;
 	}
+	trace::Scope trace("Communication::broadcast");
+	trace.bytes(group->rank == root ? traced(size, type) : 0, group->rank == root ? 0 : traced(size, type));
+	double wait = trace::time();
 	MPI_Bcast(data, size, type, root, group->communicator);
+	trace.wait(wait);
 	return true;
 }
 
@@ -641,6 +679,9 @@ bool Communication::reduce(void *in, void *out, size_t size, MPI_Datatype type,
 	if (size != (size_t)(int)size) {
 		return false;
 	}
+	trace::Scope trace("Communication::reduce");
+	trace.bytes(traced(size, type), 0);
+	double wait = trace::time();
 	if (out == NULL) {
 		if (info::mpi::rank == root) {
 			MPI_Reduce(MPI_IN_PLACE, in, size, type, op, root, group->communicator);
@@ -650,6 +691,7 @@ bool Communication::reduce(void *in, void *out, size_t size, MPI_Datatype type,
 	} else {
 		MPI_Reduce(in, out, size, type, op, root, group->communicator);
 	}
+	trace.wait(wait);
 	return true;
 }
 
@@ -658,11 +700,15 @@ bool Communication::allReduce(void *in, void *out, size_t size, MPI_Datatype typ
 	if (size != (size_t)(int)size) {
 		return false;
 	}
+	trace::Scope trace("Communication::allReduce");
+	trace.bytes(traced(size, type), traced(size, type));
+	double wait = trace::time();
 	if (out == NULL) {
 		MPI_Allreduce(MPI_IN_PLACE, in, size, type, op, group->communicator);
 	} else {
 		MPI_Allreduce(in, out, size, type, op, group->communicator);
 	}
+	trace.wait(wait);
 	return true;
 }
 
@@ -671,18 +717,25 @@ bool Communication::allGather(void *in, void *out, size_t size, MPI_Datatype typ
 	if (size != (size_t)(int)size) {
 		return false;
 	}
+	trace::Scope trace("Communication::allGather");
+	trace.bytes(traced(size, type), traced(size * group->size, type));
+	double wait = trace::time();
 	MPI_Allgather(in, size, type, out, size, type, group->communicator);
+	trace.wait(wait);
 	return true;
 }
 
 void Communication::serialize(std::function<void(void)> fnc, MPIGroup *group)
 {
+	trace::Scope trace("Communication::serialize");
 	for (int r = 0; r < group->size; ++r) {
 		if (r == group->rank) {
 			fnc();
 			utils::callusleep(500);
 		}
+		double wait = trace::time();
 		MPI_Barrier(group->communicator);
+		trace.wait(wait);
 	}
 	MPI_Barrier(group->communicator);
 }
@@ -133,7 +133,8 @@ struct Communication {
 		BALANCE, ALL_TO_ALLV,
 		EXSCAN, DISTRIBUTION,
 		SEND_VARIOUS, ALL_TO_ALL_OPT,
-		SPLITTERS, ALLREDUCE, SCATTERV, SCATTER;
+		SPLITTERS, ALLREDUCE, SCATTERV, SCATTER,
+		OUTPUT;
 	};
 
 	static bool computeSFCBalancedBorders(SpaceFillingCurve &sfc, std::vector<esint> &sfcbuckets, std::vector<esint> &permutation, std::vector<esint> &sfcborders);
@@ -142,17 +143,17 @@ struct Communication {
 	template <typename Ttype, typename Talloc=std::allocator<Ttype> >
 	static bool allToAllWithDataSizeAndTarget(const std::vector<Ttype, Talloc> &sBuffer, std::vector<Ttype, Talloc> &rBuffer, int left = 0, int right = MPITools::procs->size, MPIGroup *group = MPITools::procs);
 
-	template <typename Ttype>
-	static bool exchangeKnownSize(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group = MPITools::procs);
+	template <typename Ttype, typename Talloc=std::allocator<Ttype> >
+	static bool exchangeKnownSize(const std::vector<std::vector<Ttype, Talloc> > &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group = MPITools::procs);
 
-	template <typename Ttype>
-	static bool exchangeKnownSize(const std::vector<Ttype> &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group = MPITools::procs);
+	template <typename Ttype, typename Talloc=std::allocator<Ttype> >
+	static bool exchangeKnownSize(const std::vector<Ttype, Talloc> &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group = MPITools::procs);
 
-	template <typename Ttype>
-	static bool exchangeUnknownSize(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group = MPITools::procs);
+	template <typename Ttype, typename Talloc=std::allocator<Ttype> >
+	static bool exchangeUnknownSize(const std::vector<std::vector<Ttype, Talloc> > &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group = MPITools::procs);
 
-	template <typename Ttype>
-	static bool exchangeUnknownSize(const std::vector<Ttype> &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group = MPITools::procs);
+	template <typename Ttype, typename Talloc=std::allocator<Ttype> >
+	static bool exchangeUnknownSize(const std::vector<Ttype, Talloc> &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group = MPITools::procs);
 
 	template <typename Ttype, typename Talloc=std::allocator<Ttype> >
 	static bool receiveLower(std::vector<Ttype, Talloc> &sBuffer, std::vector<Ttype, Talloc> &rBuffer, MPIGroup *group = MPITools::procs);
@@ -205,15 +206,15 @@ struct Communication {
 	template <typename Ttype>
 	static std::vector<Ttype> getDistribution(Ttype size, MPIGroup *group = MPITools::procs);
 
-	template <typename Ttype>
-	static bool sendVariousTargets(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &targets, MPIGroup *group = MPITools::procs)
+	template <typename Ttype, typename Talloc=std::allocator<Ttype> >
+	static bool sendVariousTargets(const std::vector<std::vector<Ttype, Talloc> > &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &targets, MPIGroup *group = MPITools::procs)
 	{
 		std::vector<int> sources;
 		return sendVariousTargets(sBuffer, rBuffer, targets, sources, group);
 	}
 
-	template <typename Ttype>
-	static bool sendVariousTargets(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &targets, std::vector<int> &sources, MPIGroup *group = MPITools::procs);
+	template <typename Ttype, typename Talloc=std::allocator<Ttype> >
+	static bool sendVariousTargets(const std::vector<std::vector<Ttype, Talloc> > &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &targets, std::vector<int> &sources, MPIGroup *group = MPITools::procs);
 
 	template <typename Ttype>
 	static void allReduce(std::vector<Ttype> &data, OP op, int left = 0, int right = MPITools::procs->size, MPIGroup *group = MPITools::procs);
@@ -1,5 +1,6 @@
 
 #include "communication.h"
+#include "basis/logging/tracelogger.h"
 
 #include <algorithm>
 #include <cmath>
@@ -55,9 +56,10 @@ inline MPIType MPITools::getType()
 	return { MPI_BYTE, sizeof(Ttype), false };
 }
 
-template <typename Ttype>
-bool Communication::exchangeKnownSize(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
+template <typename Ttype, typename Talloc>
+bool Communication::exchangeKnownSize(const std::vector<std::vector<Ttype, Talloc> > &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::exchangeKnownSize");
 	MPIType type(MPITools::getType<Ttype>());
 
 	for (size_t n = 0; n < neighbors.size(); n++) {
@@ -73,6 +75,7 @@ bool Communication::exchangeKnownSize(const std::vector<std::vector<Ttype> > &sB
 	for (size_t n = 0; n < neighbors.size(); n++) {
 		// bullxmpi violate MPI standard (cast away constness)
 		MPI_Isend(const_cast<Ttype*>(sBuffer[n].data()), type.mpisize * sBuffer[n].size(), type.mpitype, neighbors[n], TAG::EX_KNOWN, group->communicator, req.data() + 2 * n);
+		trace.bytes(sizeof(Ttype) * sBuffer[n].size(), sizeof(Ttype) * rBuffer[n].size());
 	}
 
 	for (size_t n = 0; n < neighbors.size(); n++) {
@@ -80,16 +83,19 @@ bool Communication::exchangeKnownSize(const std::vector<std::vector<Ttype> > &sB
 		MPI_Irecv(const_cast<Ttype*>(rBuffer[n].data()), type.mpisize * rBuffer[n].size(), type.mpitype, neighbors[n], TAG::EX_KNOWN, group->communicator, req.data() + 2 * n + 1);
 	}
 
+	double wait = trace::time();
 	MPI_Waitall(2 * neighbors.size(), req.data(), MPI_STATUSES_IGNORE);
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::EX_KNOWN;
 	}
 	return true;
 }
 
-template <typename Ttype>
-bool Communication::exchangeKnownSize(const std::vector<Ttype> &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
+template <typename Ttype, typename Talloc>
+bool Communication::exchangeKnownSize(const std::vector<Ttype, Talloc> &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::exchangeKnownSize");
 	MPIType type(MPITools::getType<Ttype>());
 
 	if (type.mpisize * sBuffer.size() > 1 << 30) {
@@ -105,6 +111,7 @@ bool Communication::exchangeKnownSize(const std::vector<Ttype> &sBuffer, std::ve
 	for (size_t n = 0; n < neighbors.size(); n++) {
 		// bullxmpi violate MPI standard (cast away constness)
 		MPI_Isend(const_cast<Ttype*>(sBuffer.data()), type.mpisize * sBuffer.size(), type.mpitype, neighbors[n], TAG::EX_KNOWN, group->communicator, req.data() + 2 * n);
+		trace.bytes(sizeof(Ttype) * sBuffer.size(), sizeof(Ttype) * rBuffer[n].size());
 	}
 
 	for (size_t n = 0; n < neighbors.size(); n++) {
@@ -112,7 +119,9 @@ bool Communication::exchangeKnownSize(const std::vector<Ttype> &sBuffer, std::ve
 		MPI_Irecv(const_cast<Ttype*>(rBuffer[n].data()), type.mpisize * rBuffer[n].size(), type.mpitype, neighbors[n], TAG::EX_KNOWN, group->communicator, req.data() + 2 * n + 1);
 	}
 
+	double wait = trace::time();
 	MPI_Waitall(2 * neighbors.size(), req.data(), MPI_STATUSES_IGNORE);
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::EX_KNOWN;
 	}
@@ -120,9 +129,10 @@ bool Communication::exchangeKnownSize(const std::vector<Ttype> &sBuffer, std::ve
 }
 
 
-template <typename Ttype>
-bool Communication::exchangeUnknownSize(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
+template <typename Ttype, typename Talloc>
+bool Communication::exchangeUnknownSize(const std::vector<std::vector<Ttype, Talloc> > &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::exchangeUnknownSize");
 	auto n2i = [ & ] (size_t neighbor) {
 		return std::lower_bound(neighbors.begin(), neighbors.end(), neighbor) - neighbors.begin();
 	};
@@ -139,8 +149,10 @@ bool Communication::exchangeUnknownSize(const std::vector<std::vector<Ttype> > &
 	for (size_t n = 0; n < neighbors.size(); n++) {
 		// bullxmpi violate MPI standard (cast away constness)
 		MPI_Isend(const_cast<Ttype*>(sBuffer[n].data()), type.mpisize * sBuffer[n].size(), type.mpitype, neighbors[n], TAG::EX_UNKNOWN, group->communicator, req.data() + n);
+		trace.bytes(sizeof(Ttype) * sBuffer[n].size(), 0);
 	}
 
+	double wait = trace::time();
 	size_t counter = 0;
 	while (counter < neighbors.size()) {
 		MPI_Status status;
@@ -149,20 +161,23 @@ bool Communication::exchangeUnknownSize(const std::vector<std::vector<Ttype> > &
 		MPI_Get_count(&status, type.mpitype, &count);
 		rBuffer[n2i(status.MPI_SOURCE)].resize(count / type.mpisize);
 		MPI_Recv(rBuffer[n2i(status.MPI_SOURCE)].data(), count, type.mpitype, status.MPI_SOURCE, TAG::EX_UNKNOWN, group->communicator, MPI_STATUS_IGNORE);
+		trace.bytes(0, sizeof(Ttype) * rBuffer[n2i(status.MPI_SOURCE)].size());
 		counter++;
 	}
 
 	MPI_Waitall(neighbors.size(), req.data(), MPI_STATUSES_IGNORE);
 	MPI_Barrier(group->communicator); // MPI_Probe(ANY_SOURCE) can be problem when calling this function more times
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::EX_UNKNOWN;
 	}
 	return true;
 }
 
-template <typename Ttype>
-bool Communication::exchangeUnknownSize(const std::vector<Ttype> &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
+template <typename Ttype, typename Talloc>
+bool Communication::exchangeUnknownSize(const std::vector<Ttype, Talloc> &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::exchangeUnknownSize");
 	auto n2i = [ & ] (size_t neighbor) {
 		return std::lower_bound(neighbors.begin(), neighbors.end(), neighbor) - neighbors.begin();
 	};
@@ -176,8 +191,10 @@ bool Communication::exchangeUnknownSize(const std::vector<Ttype> &sBuffer, std::
 	for (size_t n = 0; n < neighbors.size(); n++) {
 		// bullxmpi violate MPI standard (cast away constness)
 		MPI_Isend(const_cast<Ttype*>(sBuffer.data()), type.mpisize * sBuffer.size(), type.mpitype, neighbors[n], TAG::EX_UNKNOWN, group->communicator, req.data() + n);
+		trace.bytes(sizeof(Ttype) * sBuffer.size(), 0);
 	}
 
+	double wait = trace::time();
 	size_t counter = 0;
 	MPI_Status status;
 	while (counter < neighbors.size()) {
@@ -186,11 +203,13 @@ bool Communication::exchangeUnknownSize(const std::vector<Ttype> &sBuffer, std::
 		MPI_Get_count(&status, type.mpitype, &count);
 		rBuffer[n2i(status.MPI_SOURCE)].resize(count / type.mpisize);
 		MPI_Recv(rBuffer[n2i(status.MPI_SOURCE)].data(), count, type.mpitype, status.MPI_SOURCE, TAG::EX_UNKNOWN, group->communicator, MPI_STATUS_IGNORE);
+		trace.bytes(0, sizeof(Ttype) * rBuffer[n2i(status.MPI_SOURCE)].size());
 		counter++;
 	}
 
 	MPI_Waitall(neighbors.size(), req.data(), MPI_STATUSES_IGNORE);
 	MPI_Barrier(group->communicator); // MPI_Probe(ANY_SOURCE) can be problem when calling this function more times
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::EX_UNKNOWN;
 	}
@@ -200,7 +219,10 @@ bool Communication::exchangeUnknownSize(const std::vector<Ttype> &sBuffer, std::
 template <typename Ttype, typename Talloc>
 bool Communication::receiveLower(std::vector<Ttype, Talloc> &sBuffer, std::vector<Ttype, Talloc> &rBuffer, MPIGroup *group)
 {
+	trace::Scope trace("Communication::receiveLower");
+	trace.bytes(group->rank + 1 != group->size ? sizeof(Ttype) * sBuffer.size() : 0, group->rank ? sizeof(Ttype) * sBuffer.size() : 0);
 	rBuffer.resize(sBuffer.size());
+	double wait = trace::time();
 	if (group->rank % 2 == 1) {
 		MPI_Recv(rBuffer.data(), rBuffer.size() * sizeof(Ttype), MPI_BYTE, group->rank - 1, 0, group->communicator, MPI_STATUS_IGNORE);
 		if (group->rank + 1 != group->size) {
@@ -214,12 +236,14 @@ bool Communication::receiveLower(std::vector<Ttype, Talloc> &sBuffer, std::vecto
 			MPI_Recv(rBuffer.data(), rBuffer.size() * sizeof(Ttype), MPI_BYTE, group->rank - 1, 0, group->communicator, MPI_STATUS_IGNORE);
 		}
 	}
+	trace.wait(wait);
 	return true;
 }
 
 template <typename Ttype>
 bool Communication::receiveLowerKnownSize(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::receiveLowerKnownSize");
 	MPIType type(MPITools::getType<Ttype>());
 
 	for (size_t n = 0; n < neighbors.size(); n++) {
@@ -239,13 +263,17 @@ bool Communication::receiveLowerKnownSize(const std::vector<std::vector<Ttype> >
 		if (neighbors[n] > group->rank) {
 			// bullxmpi violate MPI standard (cast away constness)
 			MPI_Isend(const_cast<Ttype*>(sBuffer[n].data()), type.mpisize * sBuffer[n].size(), type.mpitype, neighbors[n], TAG::R_LOW_KNOWN, group->communicator, req.data() + n);
+			trace.bytes(sizeof(Ttype) * sBuffer[n].size(), 0);
 		}
 		if (neighbors[n] < group->rank) {
 			MPI_Irecv(rBuffer[n].data(), type.mpisize * rBuffer[n].size(), type.mpitype, neighbors[n], TAG::R_LOW_KNOWN, group->communicator, req.data() + n);
+			trace.bytes(0, sizeof(Ttype) * rBuffer[n].size());
 		}
 	}
 
+	double wait = trace::time();
 	MPI_Waitall(neighbors.size(), req.data(), MPI_STATUSES_IGNORE);
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::R_LOW_KNOWN;
 	}
@@ -255,6 +283,7 @@ bool Communication::receiveLowerKnownSize(const std::vector<std::vector<Ttype> >
 template <typename Ttype>
 bool Communication::receiveLowerUnknownSize(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::receiveLowerUnknownSize");
 	MPIType type(MPITools::getType<Ttype>());
 	for (size_t n = 0; n < neighbors.size(); n++) {
 		if (type.mpisize * sBuffer[n].size() > 1 << 30) {
@@ -272,22 +301,26 @@ bool Communication::receiveLowerUnknownSize(const std::vector<std::vector<Ttype>
 		if (group->rank < neighbors[n]) {
 			// bullxmpi violate MPI standard (cast away constness)
 			MPI_Isend(const_cast<Ttype*>(sBuffer[n].data()), type.mpisize * sBuffer[n].size(), type.mpitype, neighbors[n], TAG::R_LOW_UNKNOWN, group->communicator, req.data() + rSize++);
+			trace.bytes(sizeof(Ttype) * sBuffer[n].size(), 0);
 		}
 	}
 
 	size_t counter = neighbors.end() - std::lower_bound(neighbors.begin(), neighbors.end(), group->rank);
 	MPI_Status status;
+	double wait = trace::time();
 	while (counter < neighbors.size()) {
 		MPI_Probe(MPI_ANY_SOURCE, TAG::R_LOW_UNKNOWN, group->communicator, &status);
 		int count;
 		MPI_Get_count(&status, type.mpitype, &count);
 		rBuffer[n2i(status.MPI_SOURCE)].resize(count / type.mpisize);
 		MPI_Recv(rBuffer[n2i(status.MPI_SOURCE)].data(), count, type.mpitype, status.MPI_SOURCE, TAG::R_LOW_UNKNOWN, group->communicator, MPI_STATUS_IGNORE);
+		trace.bytes(0, sizeof(Ttype) * rBuffer[n2i(status.MPI_SOURCE)].size());
 		counter++;
 	}
 
 	MPI_Waitall(rSize, req.data(), MPI_STATUSES_IGNORE);
 	MPI_Barrier(group->communicator); // MPI_Iprobe(ANY_SOURCE) can be problem when calling this function more times
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::R_LOW_UNKNOWN;
 	}
@@ -297,7 +330,10 @@ bool Communication::receiveLowerUnknownSize(const std::vector<std::vector<Ttype>
 template <typename Ttype, typename Talloc>
 bool Communication::receiveUpper(std::vector<Ttype, Talloc> &sBuffer, std::vector<Ttype, Talloc> &rBuffer, MPIGroup *group)
 {
+	trace::Scope trace("Communication::receiveUpper");
+	trace.bytes(group->rank ? sizeof(Ttype) * sBuffer.size() : 0, group->rank + 1 != group->size ? sizeof(Ttype) * sBuffer.size() : 0);
 	rBuffer.resize(sBuffer.size());
+	double wait = trace::time();
 	if (group->rank % 2 == 1) {
 		MPI_Send(sBuffer.data(), sBuffer.size() * sizeof(Ttype), MPI_BYTE, group->rank - 1, 0, group->communicator);
 		if (group->rank + 1 != group->size) {
@@ -311,12 +347,14 @@ bool Communication::receiveUpper(std::vector<Ttype, Talloc> &sBuffer, std::vecto
 			MPI_Send(sBuffer.data(), sBuffer.size() * sizeof(Ttype), MPI_BYTE, group->rank - 1, 0, group->communicator);
 		}
 	}
+	trace.wait(wait);
 	return true;
 }
 
 template <typename Ttype>
 bool Communication::receiveUpperKnownSize(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::receiveUpperKnownSize");
 	MPIType type(MPITools::getType<Ttype>());
 	for (size_t n = 0; n < neighbors.size(); n++) {
 		if (neighbors[n] < group->rank) {
@@ -335,13 +373,17 @@ bool Communication::receiveUpperKnownSize(const std::vector<std::vector<Ttype> >
 		if (neighbors[n] < group->rank) {
 			// bullxmpi violate MPI standard (cast away constness)
 			MPI_Isend(const_cast<Ttype*>(sBuffer[n].data()), type.mpisize * sBuffer[n].size(), type.mpitype, neighbors[n], TAG::R_UP_KNOWN, group->communicator, req.data() + n);
+			trace.bytes(sizeof(Ttype) * sBuffer[n].size(), 0);
 		}
 		if (neighbors[n] > group->rank) {
 			MPI_Irecv(rBuffer[n].data(), type.mpisize * rBuffer[n].size(), type.mpitype, neighbors[n], TAG::R_UP_KNOWN, group->communicator, req.data() + n);
+			trace.bytes(0, sizeof(Ttype) * rBuffer[n].size());
 		}
 	}
 
+	double wait = trace::time();
 	MPI_Waitall(neighbors.size(), req.data(), MPI_STATUSES_IGNORE);
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::R_UP_KNOWN;
 	}
@@ -351,6 +393,7 @@ bool Communication::receiveUpperKnownSize(const std::vector<std::vector<Ttype> >
 template <typename Ttype>
 bool Communication::receiveUpperUnknownSize(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::receiveUpperUnknownSize");
 	MPIType type(MPITools::getType<Ttype>());
 	for (size_t n = 0; n < neighbors.size() && neighbors[n] < group->rank; n++) {
 		if (type.mpisize * sBuffer[n].size() > 1 << 30) {
@@ -367,21 +410,25 @@ bool Communication::receiveUpperUnknownSize(const std::vector<std::vector<Ttype>
 	for (size_t n = 0; n < neighbors.size() && neighbors[n] < group->rank; n++) {
 		// bullxmpi violate MPI standard (cast away constness)
 		MPI_Isend(const_cast<Ttype*>(sBuffer[n].data()), type.mpisize * sBuffer[n].size(), type.mpitype, neighbors[n], TAG::R_UP_UNKNOWN, group->communicator, req.data() + rSize++);
+		trace.bytes(sizeof(Ttype) * sBuffer[n].size(), 0);
 	}
 
 	size_t counter = std::lower_bound(neighbors.begin(), neighbors.end(), group->rank) - neighbors.begin();
 	MPI_Status status;
+	double wait = trace::time();
 	while (counter < neighbors.size()) {
 		MPI_Probe(MPI_ANY_SOURCE, TAG::R_UP_UNKNOWN, group->communicator, &status);
 		int count;
 		MPI_Get_count(&status, type.mpitype, &count);
 		rBuffer[n2i(status.MPI_SOURCE)].resize(count / type.mpisize);
 		MPI_Recv(rBuffer[n2i(status.MPI_SOURCE)].data(), count, type.mpitype, status.MPI_SOURCE, TAG::R_UP_UNKNOWN, group->communicator, MPI_STATUS_IGNORE);
+		trace.bytes(0, sizeof(Ttype) * rBuffer[n2i(status.MPI_SOURCE)].size());
 		counter++;
 	}
 
 	MPI_Waitall(rSize, req.data(), MPI_STATUSES_IGNORE);
 	MPI_Barrier(group->communicator); // MPI_Iprobe(ANY_SOURCE) can be problem when calling this function more times
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::R_UP_UNKNOWN;
 	}
@@ -391,6 +438,7 @@ bool Communication::receiveUpperUnknownSize(const std::vector<std::vector<Ttype>
 template <typename Ttype>
 bool Communication::gatherUniformNeighbors(const std::vector<Ttype> &sBuffer, std::vector<Ttype> &rBuffer, const std::vector<int> &neighbors, MPIGroup *group)
 {
+	trace::Scope trace("Communication::gatherUniformNeighbors");
 	MPIType type(MPITools::getType<Ttype>());
 
 	if (type.mpisize * sBuffer.size() > 1 << 30) {
@@ -401,6 +449,7 @@ bool Communication::gatherUniformNeighbors(const std::vector<Ttype> &sBuffer, st
 	for (size_t n = 0; n < neighbors.size(); n++) {
 		// bullxmpi violate MPI standard (cast away constness)
 		MPI_Isend(const_cast<Ttype*>(sBuffer.data()), type.mpisize * sBuffer.size(), type.mpitype, neighbors[n], TAG::GATHER_UNIFORM, group->communicator, req.data() + 2 * n);
+		trace.bytes(sizeof(Ttype) * sBuffer.size(), sizeof(Ttype) * sBuffer.size());
 	}
 
 	for (size_t n = 0; n < neighbors.size(); n++) {
@@ -408,7 +457,9 @@ bool Communication::gatherUniformNeighbors(const std::vector<Ttype> &sBuffer, st
 		MPI_Irecv(const_cast<Ttype*>(rBuffer.data() + n * sBuffer.size()), type.mpisize * sBuffer.size(), type.mpitype, neighbors[n], TAG::GATHER_UNIFORM, group->communicator, req.data() + 2 * n + 1);
 	}
 
+	double wait = trace::time();
 	MPI_Waitall(2 * neighbors.size(), req.data(), MPI_STATUSES_IGNORE);
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::GATHER_UNIFORM;
 	}
@@ -425,6 +476,8 @@ bool Communication::gatherUnknownSize(const std::vector<Ttype, Talloc> &sBuffer,
 template <typename Ttype, typename Talloc>
 bool Communication::gatherUnknownSize(const std::vector<Ttype, Talloc> &sBuffer, std::vector<Ttype, Talloc> &rBuffer, std::vector<size_t> &offsets, MPIGroup *group)
 {
+	trace::Scope trace("Communication::gatherUnknownSize");
+	trace.bytes(sizeof(Ttype) * sBuffer.size(), 0);
 	MPIType type(MPITools::getType<Ttype>());
 
 	if (Communication::manual) {
@@ -435,7 +488,9 @@ bool Communication::gatherUnknownSize(const std::vector<Ttype, Talloc> &sBuffer,
 		MPIType otype = MPITools::getType<size_t>();
 		size_t ssize = sBuffer.size(), rsize = 0;
 		offsets.resize(group->size + 1);
+		double wait = trace::time();
 		MPI_Allgather(&ssize, 1, otype.mpitype, offsets.data(), 1, otype.mpitype, group->communicator);
+		trace.wait(wait);
 		for (int i = 0; i <= group->size; ++i) {
 			size_t tmp = offsets[i];
 			offsets[i] = rsize;
@@ -455,13 +510,18 @@ bool Communication::gatherUnknownSize(const std::vector<Ttype, Talloc> &sBuffer,
 					int recvsize;
 					size_t offset = recv.size();
 					MPI_Status status;
+					double wait = trace::time();
 					MPI_Probe(rh.mid, TAG::GATHER_UNKNOWN, group->communicator, &status);
 					MPI_Get_count(&status, type.mpitype, &recvsize);
 					recv.resize(recv.size() + (recvsize / type.mpisize));
 					MPI_Recv(recv.data() + offset, recvsize, type.mpitype, rh.mid, TAG::GATHER_UNKNOWN, group->communicator, MPI_STATUS_IGNORE);
+					trace.wait(wait);
+					trace.bytes(0, sizeof(Ttype) * (recv.size() - offset));
 				}
 				if (rh.mid == rank) {
+					double wait = trace::time();
 					MPI_Send(recv.data(), recv.size() * type.mpisize, type.mpitype, rh.left, TAG::GATHER_UNKNOWN, group->communicator);
+					trace.wait(wait);
 					return true;
 				}
 			}
@@ -472,7 +532,9 @@ bool Communication::gatherUnknownSize(const std::vector<Ttype, Talloc> &sBuffer,
 
 	int size = type.mpisize * sBuffer.size();
 	std::vector<int> rSizes(group->size), rOffsets(group->size);
+	double wait = trace::time();
 	MPI_Gather(&size, 1, MPI_INT, rSizes.data(), 1, MPI_INT, 0, group->communicator);
+	trace.wait(wait);
 
 	if (!group->rank) {
 		size = 0;
@@ -484,7 +546,10 @@ bool Communication::gatherUnknownSize(const std::vector<Ttype, Talloc> &sBuffer,
 	}
 
 	// bullxmpi violate MPI standard (cast away constness)
+	wait = trace::time();
 	MPI_Gatherv(const_cast<Ttype*>(sBuffer.data()), type.mpisize * sBuffer.size(), type.mpitype, rBuffer.data(), rSizes.data(), rOffsets.data(), type.mpitype, 0, group->communicator);
+	trace.wait(wait);
+	trace.bytes(0, sizeof(Ttype) * rBuffer.size());
 
 	offsets.resize(group->size + 1);
 	for (size_t i = 0; i < rOffsets.size(); i++) {
@@ -496,6 +561,7 @@ bool Communication::gatherUnknownSize(const std::vector<Ttype, Talloc> &sBuffer,
 template <typename Ttype>
 bool Communication::allGatherUnknownSize(std::vector<Ttype> &data, MPIGroup *group)
 {
+	trace::Scope trace("Communication::allGatherUnknownSize");
 	MPIType type(MPITools::getType<Ttype>());
 	if (type.mpisize * data.size() > 1 << 30) {
 		return false;
@@ -513,17 +579,26 @@ bool Communication::allGatherUnknownSize(std::vector<Ttype> &data, MPIGroup *gro
 		auto receive = [&] (int rank) {
 			int recvsize;
 			MPI_Status status;
+			double wait = trace::time();
 			MPI_Probe(rank, TAG::ALLGATHER_UNKNOWN, group->communicator, &status);
 			MPI_Get_count(&status, type.mpitype, &recvsize);
 			recv.resize(recvsize / type.mpisize);
 			MPI_Recv(recv.data(), recvsize, type.mpitype, rank, TAG::ALLGATHER_UNKNOWN, group->communicator, MPI_STATUS_IGNORE);
+			trace.wait(wait);
+			trace.bytes(0, sizeof(Ttype) * recv.size());
+		};
+		auto post = [&] (int rank) {
+			double wait = trace::time();
+			MPI_Send(data.data(), data.size() * type.mpisize, type.mpitype, rank, TAG::ALLGATHER_UNKNOWN, group->communicator);
+			trace.wait(wait);
+			trace.bytes(sizeof(Ttype) * data.size(), 0);
 		};
 
 		while (levels) {
 			if (rh.recurse(levels--)) {
 				if (rh.islower()) {
 					if (rh.ispaired()) {
-						MPI_Send(data.data(), data.size() * type.mpisize, type.mpitype, rh.twin, TAG::ALLGATHER_UNKNOWN, group->communicator);
+						post(rh.twin);
 						receive(rh.twin);
 					} else {
 						receive(rh.mid);
@@ -532,9 +607,9 @@ bool Communication::allGatherUnknownSize(std::vector<Ttype> &data, MPIGroup *gro
 					recv.clear();
 				} else {
 					receive(rh.twin);
-					MPI_Send(data.data(), data.size() * type.mpisize, type.mpitype, rh.twin, TAG::ALLGATHER_UNKNOWN, group->communicator);
+					post(rh.twin);
 					if (rh.treatodd()) {
-						MPI_Send(data.data(), data.size() * type.mpisize, type.mpitype, rh.mid - 1, TAG::ALLGATHER_UNKNOWN, group->communicator);
+						post(rh.mid - 1);
 					}
 					data.insert(data.begin(), recv.begin(), recv.end());
 					recv.clear();
@@ -546,7 +621,9 @@ bool Communication::allGatherUnknownSize(std::vector<Ttype> &data, MPIGroup *gro
 
 	int size = type.mpisize * data.size();
 	std::vector<int> rSizes(group->size), rOffsets(group->size);
+	double wait = trace::time();
 	MPI_Allgather(&size, 1, MPI_INT, rSizes.data(), 1, MPI_INT, group->communicator);
+	trace.wait(wait);
 
 	std::vector<Ttype> rdata;
 	size = 0;
@@ -556,7 +633,10 @@ bool Communication::allGatherUnknownSize(std::vector<Ttype> &data, MPIGroup *gro
 	}
 	rdata.resize(size / type.mpisize);
 
+	wait = trace::time();
 	MPI_Allgatherv(data.data(), type.mpisize * data.size(), type.mpitype, rdata.data(), rSizes.data(), rOffsets.data(), type.mpitype, group->communicator);
+	trace.wait(wait);
+	trace.bytes(sizeof(Ttype) * data.size(), sizeof(Ttype) * rdata.size());
 
 	rdata.swap(data);
 	return true;
@@ -565,6 +645,7 @@ bool Communication::allGatherUnknownSize(std::vector<Ttype> &data, MPIGroup *gro
 template <typename Ttype>
 bool Communication::uniqueAllGatherUnknownSize(std::vector<Ttype> &data, MPIGroup *group)
 {
+	trace::Scope trace("Communication::uniqueAllGatherUnknownSize");
 	MPIType type(MPITools::getType<Ttype>());
 	if (type.mpisize * data.size() > 1 << 30) {
 		return false;
@@ -581,10 +662,19 @@ bool Communication::uniqueAllGatherUnknownSize(std::vector<Ttype> &data, MPIGrou
 	auto receive = [&] (int rank) {
 		int recvsize;
 		MPI_Status status;
+		double wait = trace::time();
 		MPI_Probe(rank, TAG::ALLGATHER_UNKNOWN, group->communicator, &status);
 		MPI_Get_count(&status, type.mpitype, &recvsize);
 		recv.resize(recvsize / type.mpisize);
 		MPI_Recv(recv.data(), recvsize, type.mpitype, rank, TAG::ALLGATHER_UNKNOWN, group->communicator, MPI_STATUS_IGNORE);
+		trace.wait(wait);
+		trace.bytes(0, sizeof(Ttype) * recv.size());
+	};
+	auto post = [&] (int rank) {
+		double wait = trace::time();
+		MPI_Send(data.data(), data.size() * type.mpisize, type.mpitype, rank, TAG::ALLGATHER_UNKNOWN, group->communicator);
+		trace.wait(wait);
+		trace.bytes(sizeof(Ttype) * data.size(), 0);
 	};
 
 	auto merge = [&] () {
@@ -598,7 +688,7 @@ bool Communication::uniqueAllGatherUnknownSize(std::vector<Ttype> &data, MPIGrou
 		if (rh.recurse(levels--)) {
 			if (rh.islower()) {
 				if (rh.ispaired()) {
-					MPI_Send(data.data(), data.size() * type.mpisize, type.mpitype, rh.twin, TAG::ALLGATHER_UNKNOWN, group->communicator);
+					post(rh.twin);
 					receive(rh.twin);
 				} else {
 					receive(rh.mid);
@@ -607,9 +697,9 @@ bool Communication::uniqueAllGatherUnknownSize(std::vector<Ttype> &data, MPIGrou
 				recv.clear();
 			} else {
 				receive(rh.twin);
-				MPI_Send(data.data(), data.size() * type.mpisize, type.mpitype, rh.twin, TAG::ALLGATHER_UNKNOWN, group->communicator);
+				post(rh.twin);
 				if (rh.treatodd()) {
-					MPI_Send(data.data(), data.size() * type.mpisize, type.mpitype, rh.mid - 1, TAG::ALLGATHER_UNKNOWN, group->communicator);
+					post(rh.mid - 1);
 				}
 				merge();
 				recv.clear();
@@ -626,16 +716,21 @@ bool Communication::broadcastUnknownSize(std::vector<Ttype> &buffer, MPIGroup *g
 	if (type.mpisize * buffer.size() > 1 << 30) {
 		return false;
 	}
+	trace::Scope trace("Communication::broadcastUnknownSize");
 	int size = buffer.size();
+	double wait = trace::time();
 	MPI_Bcast(&size, 1, MPI_INT, 0, group->communicator);
 	buffer.resize(size);
 	MPI_Bcast(buffer.data(), type.mpisize * size, type.mpitype, 0, group->communicator);
+	trace.wait(wait);
+	trace.bytes(group->rank ? 0 : sizeof(Ttype) * size, group->rank ? sizeof(Ttype) * size : 0);
 	return true;
 }
 
 template <typename Ttype, typename Tdistribution>
 bool Communication::balance(std::vector<Ttype> &buffer, const std::vector<Tdistribution> &currentDistribution, const std::vector<Tdistribution> &targetDistribution, MPIGroup *group)
 {
+	trace::Scope trace("Communication::balance");
 	MPIType type(MPITools::getType<Ttype>());
 	if (type.mpisize * buffer.size() > 1 << 30) {
 		return false;
@@ -691,7 +786,12 @@ bool Communication::balance(std::vector<Ttype> &buffer, const std::vector<Tdistr
 		}
 	}
 
+	for (int r = 0; r < group->size; ++r) {
+		trace.bytes(sizeof(Ttype) * ssize[r], sizeof(Ttype) * rsize[r]);
+	}
+	double wait = trace::time();
 	MPI_Waitall(nrequests, requests.data(), MPI_STATUSES_IGNORE);
+	trace.wait(wait);
 	buffer.swap(result);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::BALANCE;
@@ -702,6 +802,7 @@ bool Communication::balance(std::vector<Ttype> &buffer, const std::vector<Tdistr
 template <typename Ttype>
 bool Communication::allToAllV(const std::vector<Ttype> &sBuffer, std::vector<Ttype> &rBuffer, const std::vector<int> &ssize, const std::vector<int> &rsize, MPIGroup *group)
 {
+	trace::Scope trace("Communication::allToAllV");
 	MPIType type(MPITools::getType<Ttype>());
 	if (type.mpisize * sBuffer.size() > 1 << 30) {
 		return false;
@@ -716,7 +817,10 @@ bool Communication::allToAllV(const std::vector<Ttype> &sBuffer, std::vector<Tty
 		sdisp[r] = sdisp[r - 1] + _ssize[r - 1];
 		rdisp[r] = rdisp[r - 1] + _rsize[r - 1];
 	}
+	trace.bytes(sizeof(Ttype) * sBuffer.size(), sizeof(Ttype) * rBuffer.size());
+	double wait = trace::time();
 	MPI_Alltoallv(sBuffer.data(), _ssize.data(), sdisp.data(), type.mpitype, rBuffer.data(), _rsize.data(), rdisp.data(), type.mpitype, group->communicator);
+	trace.wait(wait);
 	return true;
 }
 
@@ -730,6 +834,9 @@ Ttype Communication::exscan(Ttype &value, MPIGroup *group)
 		return size;
 	}
 
+	trace::Scope trace("Communication::exscan");
+	trace.bytes(sizeof(Ttype), sizeof(Ttype));
+	double wait = trace::time();
 	if (type.isnative) {
 		MPI_Exscan(&size, &value, 1, MPITools::getType<Ttype>().mpitype, MPI_SUM, group->communicator);
 	} else {
@@ -742,6 +849,7 @@ Ttype Communication::exscan(Ttype &value, MPIGroup *group)
 		value = 0;
 	}
 	MPI_Barrier(group->communicator);
+	trace.wait(wait);
 	return size;
 }
 
@@ -758,6 +866,9 @@ bool Communication::exscan(std::vector<Ttype> &sum, std::vector<Ttype> &offset,
 		return true;
 	}
 
+	trace::Scope trace("Communication::exscan");
+	trace.bytes(sizeof(Ttype) * sum.size(), sizeof(Ttype) * sum.size());
+	double wait = trace::time();
 	MPI_Exscan(sum.data(), offset.data(), sum.size(), MPITools::getType<Ttype>().mpitype, MPI_SUM, group->communicator);
 	for (size_t i = 0; i < sum.size(); i++) {
 		sum[i] += offset[i];
@@ -767,26 +878,32 @@ bool Communication::exscan(std::vector<Ttype> &sum, std::vector<Ttype> &offset,
 		std::fill(offset.begin(), offset.end(), 0);
 	}
 	MPI_Barrier(group->communicator);
+	trace.wait(wait);
 	return true;
 }
 
 template <typename Ttype>
 std::vector<Ttype> Communication::getDistribution(Ttype size, MPIGroup *group)
 {
+	trace::Scope trace("Communication::getDistribution");
 	MPIType type(MPITools::getType<Ttype>());
 	std::vector<Ttype> result(group->size + 1);
 	Ttype esize = size;
 	Communication::exscan(esize, group);
 
+	trace.bytes(sizeof(Ttype), sizeof(Ttype) * result.size());
+	double wait = trace::time();
 	MPI_Allgather(&esize, type.mpisize, type.mpitype, result.data(), type.mpisize, type.mpitype, group->communicator);
 	result.back() = esize + size;
 	MPI_Bcast(&result.back(), type.mpisize, type.mpitype, group->size - 1, group->communicator);
+	trace.wait(wait);
 	return result;
 }
 
-template <typename Ttype>
-bool Communication::sendVariousTargets(const std::vector<std::vector<Ttype> > &sBuffer, std::vector<std::vector<Ttype> > &rBuffer, const std::vector<int> &targets, std::vector<int> &sources, MPIGroup *group)
+template <typename Ttype, typename Talloc>
+bool Communication::sendVariousTargets(const std::vector<std::vector<Ttype, Talloc> > &sBuffer, std::vector<std::vector<Ttype, Talloc> > &rBuffer, const std::vector<int> &targets, std::vector<int> &sources, MPIGroup *group)
 {
+	trace::Scope trace("Communication::sendVariousTargets");
 	MPIType type(MPITools::getType<Ttype>());
 	for (size_t n = 0; n < targets.size(); n++) {
 		if (type.mpisize * sBuffer[n].size() > 1 << 30) {
@@ -800,27 +917,33 @@ bool Communication::sendVariousTargets(const std::vector<std::vector<Ttype> > &s
 		smsgcounter[targets[n]] = 1;
 	}
 
+	double wait = trace::time();
 	MPI_Allreduce(smsgcounter.data(), rmsgcounter.data(), group->size, MPI_INT, MPI_SUM, group->communicator);
+	trace.wait(wait);
 
 	std::vector<MPI_Request> req(targets.size());
 	for (size_t t = 0; t < targets.size(); t++) {
 		MPI_Isend(const_cast<Ttype*>(sBuffer[t].data()), type.mpisize * sBuffer[t].size(), type.mpitype, targets[t], TAG::SEND_VARIOUS, group->communicator, req.data() + t);
+		trace.bytes(sizeof(Ttype) * sBuffer[t].size(), 0);
 	}
 
+	wait = trace::time();
 	int counter = 0;
 	MPI_Status status;
 	sources.clear();
-	std::vector<std::vector<Ttype> > tmpBuffer;
+	std::vector<std::vector<Ttype, Talloc> > tmpBuffer;
 	tmpBuffer.reserve(rmsgcounter[group->rank]);
 	while (counter < rmsgcounter[group->rank]) {
 		MPI_Probe(MPI_ANY_SOURCE, TAG::SEND_VARIOUS, group->communicator, &status);
 		int count;
 		MPI_Get_count(&status, type.mpitype, &count);
-		tmpBuffer.push_back(std::vector<Ttype>(count / type.mpisize));
+		tmpBuffer.push_back(std::vector<Ttype, Talloc>(count / type.mpisize));
 		MPI_Recv(tmpBuffer.back().data(), count, type.mpitype, status.MPI_SOURCE, TAG::SEND_VARIOUS, group->communicator, MPI_STATUS_IGNORE);
+		trace.bytes(0, sizeof(Ttype) * tmpBuffer.back().size());
 		sources.push_back(status.MPI_SOURCE);
 		counter++;
 	}
+	trace.wait(wait);
 
 	std::vector<int> permutation(sources.size());
 	for (size_t i = 0; i < sources.size(); i++) {
@@ -834,8 +957,10 @@ bool Communication::sendVariousTargets(const std::vector<std::vector<Ttype> > &s
 
 	std::sort(sources.begin(), sources.end());
 
+	wait = trace::time();
 	MPI_Waitall(targets.size(), req.data(), MPI_STATUSES_IGNORE);
 	MPI_Barrier(group->communicator); // MPI_Iprobe(ANY_SOURCE) can be problem when calling this function more times
+	trace.wait(wait);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::SEND_VARIOUS;
 	}
@@ -845,9 +970,23 @@ bool Communication::sendVariousTargets(const std::vector<std::vector<Ttype> > &s
 template <typename Ttype>
 void Communication::allReduce(std::vector<Ttype> &data, OP op, int left, int right, MPIGroup *group)
 {
+	trace::Scope trace("Communication::allReduce");
 	std::vector<Ttype> recv = data;
 	MPIType type(MPITools::getType<Ttype>());
 
+	auto post = [&] (int rank) {
+		double wait = trace::time();
+		MPI_Send(data.data(), type.mpisize * data.size(), type.mpitype, rank, TAG::ALLREDUCE, group->communicator);
+		trace.wait(wait);
+		trace.bytes(sizeof(Ttype) * data.size(), 0);
+	};
+	auto receive = [&] (int rank) {
+		double wait = trace::time();
+		MPI_Recv(recv.data(), type.mpisize * data.size(), type.mpitype, rank, TAG::ALLREDUCE, group->communicator, MPI_STATUS_IGNORE);
+		trace.wait(wait);
+		trace.bytes(0, sizeof(Ttype) * data.size());
+	};
+
 	auto merge = [&] () {
 		for (size_t i = 0; i < data.size(); ++i) {
 			switch (op) {
@@ -863,20 +1002,20 @@ void Communication::allReduce(std::vector<Ttype> &data, OP op, int left, int rig
 		if (rh.islower()) {
 			// LOWER half to UPPER half
 			if (rh.isodd()) {
-				MPI_Send(data.data(), type.mpisize * data.size(), type.mpitype, rh.mid, TAG::ALLREDUCE, group->communicator);
+				post(rh.mid);
 			}
 			if (rh.ispaired()) {
-				MPI_Send(data.data(), type.mpisize * data.size(), type.mpitype, rh.twin, TAG::ALLREDUCE, group->communicator);
-				MPI_Recv(recv.data(), type.mpisize * data.size(), type.mpitype, rh.twin, TAG::ALLREDUCE, group->communicator, MPI_STATUS_IGNORE);
+				post(rh.twin);
+				receive(rh.twin);
 				merge();
 			}
 		} else {
 			// UPPER half to LOWER half
-			MPI_Recv(recv.data(), type.mpisize * data.size(), type.mpitype, rh.twin, TAG::ALLREDUCE, group->communicator, MPI_STATUS_IGNORE);
-			MPI_Send(data.data(), type.mpisize * data.size(), type.mpitype, rh.twin, TAG::ALLREDUCE, group->communicator);
+			receive(rh.twin);
+			post(rh.twin);
 			merge();
 			if (rh.treatodd()) {
-				MPI_Recv(recv.data(), type.mpisize * data.size(), type.mpitype, rh.mid - 1, TAG::ALLREDUCE, group->communicator, MPI_STATUS_IGNORE);
+				receive(rh.mid - 1);
 				merge();
 			}
 		}
@@ -890,7 +1029,9 @@ void Communication::allReduce(std::vector<Ttype> &data, OP op, int left, int rig
 template <typename Ttype, typename Talloc>
 void Communication::scatterv(const std::vector<Ttype, Talloc> &sBuffer, std::vector<Ttype, Talloc> &rBuffer, std::vector<size_t> &displacement, MPIGroup *group)
 {
+	trace::Scope trace("Communication::scatterv");
 	MPIType type(MPITools::getType<Ttype>());
+	double wait = trace::time();
 
 	if (Communication::manual) {
 		int left = 0;
@@ -925,6 +1066,8 @@ void Communication::scatterv(const std::vector<Ttype, Talloc> &sBuffer, std::vec
 		rBuffer.resize(count[group->rank]);
 		MPI_Scatterv(sBuffer.data(), count.data(), disp.data(), type.mpitype, rBuffer.data(), count[group->rank], type.mpitype, 0, group->communicator);
 	}
+	trace.wait(wait);
+	trace.bytes(group->rank ? 0 : sizeof(Ttype) * (displacement.back() - displacement[1]), group->rank ? sizeof(Ttype) * rBuffer.size() : 0);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::SCATTERV;
 	}
@@ -937,7 +1080,9 @@ bool Communication::scatter(const std::vector<Ttype, Talloc> &sBuffer, std::vect
 		return false;
 	}
 
+	trace::Scope trace("Communication::scatter");
 	MPIType type(MPITools::getType<Ttype>());
+	double wait = trace::time();
 
 	if (Communication::manual) {
 		int left = 0;
@@ -968,6 +1113,8 @@ bool Communication::scatter(const std::vector<Ttype, Talloc> &sBuffer, std::vect
 		rBuffer.resize(size);
 		MPI_Scatter(sBuffer.data(), type.mpisize * size, type.mpitype, rBuffer.data(), type.mpisize * size, type.mpitype, 0, group->communicator);
 	}
+	trace.wait(wait);
+	trace.bytes(group->rank ? 0 : sizeof(Ttype) * (group->size - 1) * size, group->rank ? sizeof(Ttype) * size : 0);
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::SCATTER;
 	}
@@ -977,6 +1124,8 @@ bool Communication::scatter(const std::vector<Ttype, Talloc> &sBuffer, std::vect
 template <typename Ttype, typename Talloc>
 bool Communication::allToAllWithDataSizeAndTarget(const std::vector<Ttype, Talloc> &sBuffer, std::vector<Ttype, Talloc> &rBuffer, int left, int right, MPIGroup *group)
 {
+	trace::Scope trace("Communication::allToAllWithDataSizeAndTarget");
+	trace.bytes(sizeof(Ttype) * sBuffer.size(), 0);
 	MPIType type(MPITools::getType<Ttype>());
 	std::vector<Ttype, Talloc> prevsend, send, recv;
 	recv.reserve(sBuffer.size());
@@ -1125,6 +1274,7 @@ bool Communication::allToAllWithDataSizeAndTarget(const std::vector<Ttype, Tallo
 		}
 		rh.exchanged();
 	}
+	trace.bytes(0, sizeof(Ttype) * rBuffer.size());
 	if (group->communicator == MPI_COMM_WORLD) {
 		++TAG::ALL_TO_ALL_OPT;
 	}
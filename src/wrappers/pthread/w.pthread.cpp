@@ -1,8 +1,10 @@
 
 #include "w.pthread.h"
-#include "basis/utilities/sysutils.h"
+#include "esinfo/envinfo.h"
 
+#include <omp.h>
 #include <pthread.h>
+#include <sched.h>
 
 namespace mesio {
 
@@ -11,31 +13,22 @@ void* async(void *data);
 struct ThreadControl {
 	Pthread::Executor *executor;
 	pthread_t thread;
-	pthread_spinlock_t computationLock;
-	pthread_mutex_t outputLock;
+	pthread_mutex_t lock;
+	pthread_cond_t filled, released;
 
+	size_t slots, head, count; // slots in [head, head + count) are waiting for (or processed by) the thread
 	bool finish;
 
-	ThreadControl(Pthread::Executor *executor): executor(executor), finish(false)
+	ThreadControl(Pthread::Executor *executor, size_t slots): executor(executor), slots(slots ? slots : 1), head(0), count(0), finish(false)
 	{
-		pthread_spin_init(&computationLock, PTHREAD_PROCESS_PRIVATE);
-		pthread_spin_lock(&computationLock);
-		pthread_mutex_init(&outputLock, NULL);
-		pthread_mutex_lock(&outputLock);
+		pthread_mutex_init(&lock, NULL);
+		pthread_cond_init(&filled, NULL);
+		pthread_cond_init(&released, NULL);
 
 		pthread_attr_t attributes;
 		pthread_attr_init(&attributes);
 
-		cpu_set_t affinity;
-		pthread_attr_getaffinity_np(&attributes, sizeof(cpu_set_t), &affinity);
-
-		const int ncores = CPU_COUNT(&affinity);
-		int core = ncores - 1;
-		while (core >= 0) {
-			if (CPU_ISSET(core, &affinity)) {
-				core--;
-			}
-		}
+		int core = info::env::freeCore();
 		if (0 <= core) {
 			cpu_set_t cpumask;
 			CPU_ZERO(&cpumask);
@@ -49,49 +42,83 @@ struct ThreadControl {
 	}
 
 	~ThreadControl() {
+		pthread_mutex_lock(&lock);
+		finish = true;
+		pthread_cond_signal(&filled);
+		pthread_mutex_unlock(&lock);
+
 		pthread_join(thread, NULL);
-		pthread_spin_destroy(&computationLock);
-		pthread_mutex_destroy(&outputLock);
+		pthread_cond_destroy(&filled);
+		pthread_cond_destroy(&released);
+		pthread_mutex_destroy(&lock);
 	}
 };
 
 void* async(void *data)
 {
 	ThreadControl *threadControl = reinterpret_cast<ThreadControl*>(data);
-	pthread_spin_unlock(&threadControl->computationLock);
 
+	// the thread is pinned to a single core -> parallel regions started by the thread (e.g., formatting of output) are serial
+	omp_set_num_threads(1);
+
+	pthread_mutex_lock(&threadControl->lock);
 	while (true) {
-		pthread_mutex_lock(&threadControl->outputLock);
-		if (threadControl->finish) {
-			pthread_spin_unlock(&threadControl->computationLock);
+		while (threadControl->count == 0 && !threadControl->finish) {
+			pthread_cond_wait(&threadControl->filled, &threadControl->lock);
+		}
+		if (threadControl->count == 0) { // finish is set and all slots are processed
 			break;
 		}
-		threadControl->executor->call();
-		pthread_spin_unlock(&threadControl->computationLock);
+		size_t slot = threadControl->head;
+		pthread_mutex_unlock(&threadControl->lock);
+
+		threadControl->executor->call(slot);
+
+		pthread_mutex_lock(&threadControl->lock);
+		threadControl->head = (threadControl->head + 1) % threadControl->slots;
+		threadControl->count--;
+		pthread_cond_broadcast(&threadControl->released);
 	}
+	pthread_mutex_unlock(&threadControl->lock);
 	return NULL;
 }
 
-Pthread::Pthread(Executor *executor)
-: _threadControl(new ThreadControl(executor))
+Pthread::Pthread(Executor *executor, size_t slots)
+: _threadControl(new ThreadControl(executor, slots))
 {
 
 }
 
 Pthread::~Pthread()
 {
-	pthread_spin_lock(&_threadControl->computationLock);
-	_threadControl->finish = true;
-	pthread_mutex_unlock(&_threadControl->outputLock);
-	pthread_spin_lock(&_threadControl->computationLock);
 	delete _threadControl;
 }
 
 void Pthread::call()
 {
-	pthread_spin_lock(&_threadControl->computationLock);
-	_threadControl->executor->copy();
-	pthread_mutex_unlock(&_threadControl->outputLock);
+	// only one caller is assumed, hence the free slot cannot be taken by anyone else
+	pthread_mutex_lock(&_threadControl->lock);
+	while (_threadControl->count == _threadControl->slots) {
+		pthread_cond_wait(&_threadControl->released, &_threadControl->lock);
+	}
+	size_t slot = (_threadControl->head + _threadControl->count) % _threadControl->slots;
+	pthread_mutex_unlock(&_threadControl->lock);
+
+	_threadControl->executor->copy(slot);
+
+	pthread_mutex_lock(&_threadControl->lock);
+	_threadControl->count++;
+	pthread_cond_signal(&_threadControl->filled);
+	pthread_mutex_unlock(&_threadControl->lock);
+}
+
+void Pthread::wait()
+{
+	pthread_mutex_lock(&_threadControl->lock);
+	while (_threadControl->count) {
+		pthread_cond_wait(&_threadControl->released, &_threadControl->lock);
+	}
+	pthread_mutex_unlock(&_threadControl->lock);
 }
 
 }
@@ -2,23 +2,29 @@
 #ifndef SRC_WRAPPERS_PTHREAD_W_PTHREAD_H_
 #define SRC_WRAPPERS_PTHREAD_W_PTHREAD_H_
 
+#include <cstddef>
+
 namespace mesio {
 
 struct ThreadControl;
 
+// the executor is called by a separate thread pinned to a core without OpenMP threads
+// OpenMP regions started by the executor run serially (the thread has a single core)
+// up to 'slots' calls can be in flight, the caller is blocked only if all slots are occupied
 class Pthread {
 public:
 	class Executor {
 	public:
-		virtual void call() = 0;
-		virtual void copy() = 0;
+		virtual void call(size_t slot) = 0; // called by the thread
+		virtual void copy(size_t slot) = 0; // called by the caller before the slot is passed to the thread
 		virtual ~Executor() {};
 	};
 
-	Pthread(Executor *executor);
+	Pthread(Executor *executor, size_t slots = 1);
 	~Pthread();
 
 	void call();
+	void wait();
 
 protected:
 	ThreadControl *_threadControl;
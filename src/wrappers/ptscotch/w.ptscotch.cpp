@@ -40,13 +40,13 @@ esint PTScotch::call(
 	esint vertlocmax = vertlocnbr;
 	esint *vertloctab = eframes;
 	esint *vendloctab = NULL;
-	esint *veloloctab = NULL;
+	esint *veloloctab = verticesWeights;
 	esint *vlblloctab = NULL;
 	esint edgelocnbr = eframes[vertlocnbr];
 	esint edgelocsiz = edgelocnbr;
 	esint *edgeloctab = eneighbors;
 	esint *edgegsttab = NULL;
-	esint *edloloctab = NULL;
+	esint *edloloctab = edgeWeights;
 	int ierr;
 
 	if ((ierr = SCOTCH_dgraphBuild(